@@ -38,6 +38,8 @@
 #include <gvirtus/communicators/Result.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "log4cplus/configurator.h"
 #include "log4cplus/logger.h"
@@ -50,8 +52,58 @@ class Handler {
 
    public:
     virtual bool CanExecute(std::string routine) = 0;
+    /**
+     * @return the names of the routines this handler can execute.
+     */
+    virtual std::vector<std::string> GetRoutines() = 0;
     virtual std::shared_ptr<communicators::Result> Execute(
         std::string routine, std::shared_ptr<communicators::Buffer> input_buffer) = 0;
+    /**
+     * Executes the routine at position routine_id in GetRoutines(), without
+     * looking it up by name.
+     */
+    virtual std::shared_ptr<communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<communicators::Buffer> input_buffer) = 0;
+
+    /**
+     * The backend executes the requests of the sessions (the threads of a
+     * frontend, see RequestHeader) on a pool of worker threads, so the state a
+     * library keeps per thread (e.g. the current CUDA device) must follow the
+     * session. SaveThreadState() is called when a session has no more
+     * requests to execute and RestoreThreadState() whenever a thread starts
+     * executing the requests of a session, so it should be cheap when the
+     * thread has the state already; state is empty for a new
+     * session, which must get the state of a new thread. The default
+     * implementations do nothing.
+     */
+    virtual void SaveThreadState(std::shared_ptr<void> &state) {}
+    virtual void RestoreThreadState(const std::shared_ptr<void> &state) {}
+
+    /**
+     * The state a library keeps per frontend process instead, e.g. the
+     * kernels CUDA registered for it, is shared by all the sessions of all
+     * its connections (see communicators::Hello): RestoreClientState() is
+     * called, with the state of the process locked, whenever a thread starts
+     * executing the requests of a session; state is empty for a new process.
+     * It is destroyed once the last connection of the process is closed,
+     * even if the process did not end cleanly. The default implementation
+     * does nothing.
+     */
+    virtual void RestoreClientState(std::shared_ptr<void> &state) {}
+
+    /**
+     * Called before another handler executes a routine: the work this
+     * handler deferred, e.g. the kernel launches of CUDA it replays as
+     * graphs, must be issued before the routine sees the device. The
+     * default implementation does nothing.
+     */
+    virtual void Flush() {}
+
+    /**
+     * @return true if the handler may defer work, see Flush(); asked once,
+     * when the plugins are loaded. The default implementation returns false.
+     */
+    virtual bool Defers() { return false; }
 
    private:
     log4cplus::Logger logger;
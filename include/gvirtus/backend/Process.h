@@ -3,11 +3,18 @@
 #include <gvirtus/common/LD_Lib.h>
 #include <gvirtus/common/Observable.h>
 #include <gvirtus/communicators/Communicator.h>
+#include <gvirtus/communicators/Protocol.h>
+#include <gvirtus/communicators/Result.h>
 
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Handler.h"
+#include "Reactor.h"
 #include "log4cplus/configurator.h"
 #include "log4cplus/logger.h"
 #include "log4cplus/loggingmacros.h"
@@ -22,15 +29,166 @@ class Process : public common::Observable {
     Process(std::shared_ptr<common::LD_Lib<communicators::Communicator,
                                            std::shared_ptr<communicators::Endpoint>>>
                 communicator,
-            std::vector<std::string> &plugins);
+            std::vector<std::string> &plugins,
+            std::shared_ptr<common::LD_Lib<communicators::Communicator,
+                                           std::shared_ptr<communicators::Endpoint>>>
+                local_communicator = nullptr,
+            unsigned stripes = 1);
     ~Process() override;
     void Start();
 
    private:
+    /**
+     * Accepts the connections to server until SIGINT, executing them on the
+     * workers of mpReactor or with execute.
+     */
+    void Accept(communicators::Communicator *server,
+                const std::function<void(communicators::Communicator *)> &execute);
+    /* a request waiting for its session, see Connection */
+    struct Request {
+        communicators::RequestHeader header;
+        std::shared_ptr<communicators::Buffer> input_buffer;
+    };
+    /* a thread of the frontend, see RequestHeader */
+    struct Session {
+        uint64_t id = 0;
+        /* unique among the sessions of every connection, 0 until the first request */
+        uint64_t key = 0;
+        /* the thread state of the handlers, see Handler::SaveThreadState() */
+        std::vector<std::shared_ptr<void>> states;
+        std::deque<Request> requests;
+        /* true while its requests are being executed */
+        bool running = false;
+        /* true once the frontend ended it while running */
+        bool ended = false;
+        /* where its transfers and large outputs go, see communicators::BulkLane */
+        std::shared_ptr<communicators::Communicator> bulk_lane;
+        /* the stripes of the bulk lane accepted so far, until it has them all */
+        std::vector<std::shared_ptr<communicators::Communicator>> stripes;
+    };
+    /**
+     * Client is a frontend process: its connections share the state of the
+     * handlers, which is released when the last one is closed (see Hello).
+     */
+    struct Client {
+        uint64_t id = 0;
+        /* guards states */
+        std::mutex mutex;
+        /* see Handler::RestoreClientState() */
+        std::vector<std::shared_ptr<void>> states;
+    };
+    /**
+     * Connection is a connection of a frontend, carrying the requests of its
+     * sessions. The requests of a session are executed in order, one at a
+     * time, each session with its own thread state; on a full duplex
+     * communicator served by mpReactor the sessions run on the workers
+     * concurrently, while the connection keeps reading requests. Any other
+     * connection executes each request on the thread reading it.
+     */
+    struct Connection {
+        explicit Connection(communicators::Communicator *c) : communicator(c) {}
+        ~Connection() { delete communicator; }
+
+        communicators::Communicator *communicator;
+        /* compresses the results and decompresses the requests, when a codec was agreed */
+        std::unique_ptr<communicators::Compressor> compressor;
+        std::unique_ptr<communicators::Compressor> decompressor;
+        /* held while writing a result */
+        std::mutex write_mutex;
+        /* guards sessions */
+        std::mutex mutex;
+        std::unordered_map<uint64_t, Session> sessions;
+        /* the frontend process it belongs to, set by the Handshake() */
+        std::shared_ptr<Client> client;
+        /* identifies the connection to the bulk lanes of its sessions */
+        uint64_t token = 0;
+        /* true if its sessions run on the workers of mpReactor, see Serve() */
+        bool concurrent = false;
+    };
+
+    /**
+     * Agrees on the protocol with the frontend, setting the compressors of
+     * the connection if a codec was agreed.
+     *
+     * @return false if the frontend can't be served, or if the connection
+     * has become the bulk lane of a session.
+     */
+    bool Handshake(const std::shared_ptr<Connection> &connection);
+    /**
+     * Gives the communicator of connection to the session whose bulk lane it
+     * is (or is a stripe of), after the Hello.
+     */
+    void AcceptBulkLane(Connection &connection, const communicators::Hello &hello);
+    /* the client with id, created if none of its connections is open */
+    std::shared_ptr<Client> GetClient(uint64_t id);
+    /* what ServeRequest() leaves to its caller */
+    enum class Served {
+        CLOSED,
+        /* the next request can be read */
+        NEXT,
+        /* the session reads the transfer of the request, then reads the next requests */
+        HANDED_OVER,
+    };
+    /**
+     * Reads a request from the connection and executes it, or hands it to its
+     * session if this one is running.
+     */
+    Served ServeRequest(const std::shared_ptr<Connection> &connection);
+    /**
+     * Executes the requests queued for a session, writing their results,
+     * until none is left.
+     */
+    void RunRequests(const std::shared_ptr<Connection> &connection, Session &session);
+    /**
+     * Runs RunRequests() on the workers of mpReactor.
+     */
+    Reactor::Task RunSession(std::shared_ptr<Connection> connection, Session *session);
+    /**
+     * Serves a connection on the workers of mpReactor, releasing it when it
+     * is closed.
+     */
+    Reactor::Task Serve(communicators::Communicator *c);
+    /**
+     * Reads the requests of connection, after the handshake if not connected.
+     */
+    Reactor::Task Serve(std::shared_ptr<Connection> connection, bool connected);
+    void SaveThreadState(std::vector<std::shared_ptr<void>> &states);
+    void RestoreThreadState(const std::vector<std::shared_ptr<void>> &states);
+    void RestoreClientState(Client &client);
+    std::shared_ptr<communicators::Result> Execute(
+        uint32_t routine_id, std::shared_ptr<communicators::Buffer> input_buffer);
+    std::shared_ptr<communicators::Result> ExecuteBatch(
+        std::shared_ptr<communicators::Buffer> batch_buffer);
+
     std::shared_ptr<
         common::LD_Lib<communicators::Communicator, std::shared_ptr<communicators::Endpoint>>>
         _communicator;
+    /* AF_UNIX communicator for the frontends of this host, or nullptr */
+    std::shared_ptr<
+        common::LD_Lib<communicators::Communicator, std::shared_ptr<communicators::Endpoint>>>
+        _local_communicator;
     std::vector<std::shared_ptr<common::LD_Lib<Handler>>> _handlers;
+    std::vector<std::string> mRoutines;
+    /* handler and handler-local id of each routine, indexed by routine id */
+    struct Routine {
+        Handler *handler;
+        size_t id;
+    };
+    std::vector<Routine> mDispatchTable;
+    /* the handlers that may defer work, flushed before the routines of the others */
+    std::vector<Handler *> mDeferringHandlers;
+
+    /* serves the connections whose communicator can be polled, see Serve() */
+    std::unique_ptr<Reactor> mpReactor;
+
+    /* the connections that can get bulk lanes, by token */
+    std::mutex mConnectionsMutex;
+    std::unordered_map<uint64_t, std::weak_ptr<Connection>> mConnections;
+    /* the clients with a connection open, by id */
+    std::mutex mClientsMutex;
+    std::unordered_map<uint64_t, std::weak_ptr<Client>> mClients;
+    /* the most stripes of a bulk lane, see communicators::Endpoint_Tcp::stripes() */
+    unsigned mStripes;
 
     std::vector<std::string> mPlugins;
     log4cplus::Logger logger;
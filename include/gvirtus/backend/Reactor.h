@@ -0,0 +1,105 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gvirtus::backend {
+/**
+ * Reactor serves the connections of the backend on a bounded pool of worker
+ * threads. Each connection is a coroutine (a Task) that waits for its next
+ * request with co_await WaitReadable(fd): the coroutine is suspended and its
+ * file descriptor handed to an epoll set, watched by the reactor thread, that
+ * schedules the coroutine on a worker as soon as data arrives. So an idle
+ * connection holds no thread, and the routines run on the workers.
+ */
+class Reactor {
+   public:
+    /**
+     * Coroutine serving a connection. It does not run until it is given to
+     * Start(), and it frees itself when it returns; an exception escaping it
+     * is logged and shuts down its connection, see ShutdownOnError().
+     */
+    struct Task {
+        struct promise_type {
+            Task get_return_object() {
+                return {std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception();
+            /* the connection of the coroutine, -1 if unknown */
+            int fd = -1;
+        };
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    struct ShutdownOnErrorAwaiter {
+        int fd;
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<Task::promise_type> handle) noexcept {
+            handle.promise().fd = fd;
+            return false;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct ReadableAwaiter {
+        Reactor *reactor;
+        int fd;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @param workers the number of worker threads.
+     */
+    explicit Reactor(size_t workers);
+    ~Reactor();
+
+    /**
+     * Schedules a new coroutine on the workers.
+     */
+    void Start(Task task);
+
+    /**
+     * @return an awaitable resuming the coroutine, on a worker, when fd is
+     * readable.
+     */
+    inline ReadableAwaiter WaitReadable(int fd) { return {this, fd}; }
+
+    /**
+     * @return an awaitable, not suspending the coroutine, making an exception
+     * that escapes it shut fd down: a request left without an answer would
+     * hang its frontend.
+     */
+    static inline ShutdownOnErrorAwaiter ShutdownOnError(int fd) { return {fd}; }
+
+    /**
+     * @return true if fd is readable now.
+     */
+    static bool IsReadable(int fd);
+
+    inline size_t GetWorkers() const { return mWorkers.size(); }
+
+   private:
+    void Schedule(std::coroutine_handle<> handle);
+    void Poll();
+    void Work();
+
+    int mEpollFd;
+    /* eventfd waking up the reactor thread when stopping */
+    int mWakeFd;
+    bool mStopping = false;
+    std::thread mPoller;
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mReady;
+    std::deque<std::coroutine_handle<>> mQueue;
+};
+}  // namespace gvirtus::backend
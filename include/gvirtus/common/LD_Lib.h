@@ -103,6 +103,9 @@ class LD_Lib {
 #endif
     }
 
+    /* CREATE: a new object, which the LD_Lib must outlive */
+    std::shared_ptr<T> create(Args... args) { return this->sym(args...); }
+
     /* OBJ_PTR */
     std::shared_ptr<T> obj_ptr() { return _obj_ptr; }
 
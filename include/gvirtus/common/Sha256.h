@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace gvirtus::common {
+/**
+ * Sha256 computes the SHA-256 digest (FIPS 180-4) of a stream of data, e.g.
+ * to address content shared by frontends that don't trust each other, such as
+ * the fat binaries cached by the backend.
+ */
+class Sha256 {
+   public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256();
+
+    void Update(const void *data, size_t size);
+
+    /**
+     * @return the digest of the data; the object must not be updated anymore.
+     */
+    Digest Final();
+
+    /**
+     * @return the digest as 64 lower case hex digits.
+     */
+    static std::string Hex(const Digest &digest);
+
+    /**
+     * @return the digest of size bytes at data, in hex.
+     */
+    static std::string Hex(const void *data, size_t size);
+
+   private:
+    uint32_t mState[8];
+    uint8_t mBlock[64];
+    /* bytes in mBlock */
+    size_t mBlockSize = 0;
+    uint64_t mSize = 0;
+};
+}  // namespace gvirtus::common
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include "Buffer.h"
+
+namespace gvirtus::communicators {
+/**
+ * Batch coalesces the requests of several routines into a single request,
+ * flagged with REQUEST_BATCH. Each request is stored as the routine id
+ * followed by its marshalled input buffer; the backend executes them in order
+ * and answers with a single Result whose output buffer holds the exit code
+ * (int) of every routine.
+ */
+class Batch {
+   public:
+    Batch();
+
+    /**
+     * Appends the request of a routine to the batch.
+     *
+     * @param routine_id the id of the routine.
+     * @param input_buffer the buffer containing the parameters of the routine.
+     */
+    void Add(uint32_t routine_id, const Buffer *input_buffer);
+
+    /**
+     * Extracts the next request from a buffer holding a batch.
+     *
+     * @param batch_buffer the payload of a REQUEST_BATCH request.
+     * @param routine_id filled with the id of the routine.
+     * @param input_buffer filled with a buffer pointing inside batch_buffer.
+     *
+     * @return false if the batch is over.
+     */
+    static bool Next(Buffer *batch_buffer, uint32_t &routine_id,
+                     std::shared_ptr<Buffer> &input_buffer);
+
+    void Reset();
+
+    inline bool Empty() const { return mCount == 0; }
+    inline size_t GetCount() const { return mCount; }
+    inline size_t GetSize() const { return mpBuffer->GetBufferSize(); }
+    inline const Buffer *GetBuffer() const { return mpBuffer.get(); }
+
+    /**
+     * @return the time elapsed since the first request was added.
+     */
+    std::chrono::microseconds GetAge() const;
+
+   private:
+    std::shared_ptr<Buffer> mpBuffer;
+    size_t mCount;
+    std::chrono::steady_clock::time_point mStart;
+};
+}  // namespace gvirtus::communicators
@@ -38,19 +38,27 @@
 #include <cxxabi.h>
 #include <execinfo.h>
 #include <gvirtus/common/gvirtus-type.h>
+#include <sys/uio.h>
 
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <type_traits>
 #include <typeinfo>
+#include <vector>
 
 #include "Communicator.h"
+#include "Transfer.h"
 
+/* the smallest allocation of a buffer, and the granularity of its growth */
 #define BLOCK_SIZE 4096
 
+/* Arrays added with AddExternal() smaller than this are copied anyway. */
+#define EXTERNAL_SEGMENT_MIN_SIZE (64 * 1024)
+
 static void printStacktrace() {
     void *callstack[128];
     int frames = backtrace(callstack, 128);
@@ -100,11 +108,7 @@ class Buffer {
 
     template <class T>
     void Add(T item) {
-        if ((mLength + safe_sizeof<T>()) >= mSize) {
-            mSize = ((mLength + safe_sizeof<T>()) / mBlockSize + 1) * mBlockSize;
-            if ((mpBuffer = (char *)realloc(mpBuffer, mSize)) == NULL)
-                throw std::runtime_error("Buffer::Add(item): Can't reallocate memory.");
-        }
+        if (mLength + safe_sizeof<T>() >= mSize) Grow(mLength + safe_sizeof<T>());
         memmove(mpBuffer + mLength, (char *)&item, safe_sizeof<T>());
         mLength += safe_sizeof<T>();
         mBackOffset = mLength;
@@ -118,11 +122,7 @@ class Buffer {
         }
         size_t size = safe_sizeof<T>() * n;
         Add(size);
-        if ((mLength + size) >= mSize) {
-            mSize = ((mLength + size) / mBlockSize + 1) * mBlockSize;
-            if ((mpBuffer = (char *)realloc(mpBuffer, mSize)) == NULL)
-                throw std::runtime_error("Buffer::Add(item, n): Can't reallocate memory.");
-        }
+        if (mLength + size >= mSize) Grow(mLength + size);
         memmove(mpBuffer + mLength, (char *)item, size);
         mLength += size;
         mBackOffset = mLength;
@@ -130,11 +130,7 @@ class Buffer {
 
     template <class T>
     void AddConst(const T item) {
-        if ((mLength + safe_sizeof<T>()) >= mSize) {
-            mSize = ((mLength + safe_sizeof<T>()) / mBlockSize + 1) * mBlockSize;
-            if ((mpBuffer = (char *)realloc(mpBuffer, mSize)) == NULL)
-                throw std::runtime_error("Buffer::AddConst(item): Can't reallocate memory.");
-        }
+        if (mLength + safe_sizeof<T>() >= mSize) Grow(mLength + safe_sizeof<T>());
         memmove(mpBuffer + mLength, (char *)&item, safe_sizeof<T>());
         mLength += safe_sizeof<T>();
         mBackOffset = mLength;
@@ -148,16 +144,30 @@ class Buffer {
         }
         size_t size = safe_sizeof<T>() * n;
         Add(size);
-        if ((mLength + size) >= mSize) {
-            mSize = ((mLength + size) / mBlockSize + 1) * mBlockSize;
-            if ((mpBuffer = (char *)realloc(mpBuffer, mSize)) == NULL)
-                throw std::runtime_error("Buffer::AddConst(item, n): Can't reallocate memory.");
-        }
+        if (mLength + size >= mSize) Grow(mLength + size);
         memmove(mpBuffer + mLength, (char *)item, size);
         mLength += size;
         mBackOffset = mLength;
     }
 
+    /**
+     * Adds an array like Add(item, n), but without copying it when it is
+     * large: only its address is stored and the data is written straight
+     * from item by Dump()/WriteTo(), so item must stay valid and unchanged
+     * until then.
+     */
+    template <class T>
+    void AddExternal(const T *item, size_t n = 1) {
+        size_t size = safe_sizeof<T>() * n;
+        if (item == NULL || size < EXTERNAL_SEGMENT_MIN_SIZE) {
+            AddConst(item, n);
+            return;
+        }
+        Add(size);
+        mSegments.push_back({mLength, (const char *)item, size});
+        mExternalLength += size;
+    }
+
     void AddString(const char *s) {
         size_t size = strlen(s) + 1;
         Add(size);
@@ -172,11 +182,7 @@ class Buffer {
     template <class T>
     void Read(Communicator *c) {
         auto required_size = mLength + safe_sizeof<T>();
-        if (required_size >= mSize) {
-            mSize = (required_size / mBlockSize + 1) * mBlockSize;
-            if ((mpBuffer = (char *)realloc(mpBuffer, mSize)) == NULL)
-                throw std::runtime_error("Buffer::Read(*c) Can't reallocate memory.");
-        }
+        if (required_size >= mSize) Grow(required_size);
         c->Read(mpBuffer + mLength, safe_sizeof<T>());
         mLength += safe_sizeof<T>();
         mBackOffset = mLength;
@@ -185,11 +191,7 @@ class Buffer {
     template <class T>
     void Read(Communicator *c, size_t n = 1) {
         auto required_size = mLength + safe_sizeof<T>() * n;
-        if (required_size >= mSize) {
-            mSize = (required_size / mBlockSize + 1) * mBlockSize;
-            if ((mpBuffer = (char *)realloc(mpBuffer, mSize)) == NULL)
-                throw std::runtime_error("Buffer::Read(*c, n): Can't reallocate memory.");
-        }
+        if (required_size >= mSize) Grow(required_size);
         c->Read(mpBuffer + mLength, safe_sizeof<T>() * n);
         mLength += safe_sizeof<T>() * n;
         mBackOffset = mLength;
@@ -233,11 +235,7 @@ class Buffer {
     T *Delegate(size_t n = 1) {
         size_t size = safe_sizeof<T>() * n;
         Add(size);
-        if ((mLength + size) >= mSize) {
-            mSize = ((mLength + size) / mBlockSize + 1) * mBlockSize;
-            if ((mpBuffer = (char *)realloc(mpBuffer, mSize)) == NULL)
-                throw std::runtime_error("Buffer::Delegate(n): Can't reallocate memory.");
-        }
+        if (mLength + size >= mSize) Grow(mLength + size);
         T *dst = (T *)(mpBuffer + mLength);
         mLength += size;
         mBackOffset = mLength;
@@ -291,13 +289,56 @@ class Buffer {
 
     inline bool Empty() { return mOffset == mLength; }
 
+    /**
+     * Makes room for n more bytes of data, so that adding them does not
+     * reallocate the buffer.
+     */
+    void Reserve(size_t n);
+
+    /**
+     * Appends n bytes of data to be filled by the caller.
+     *
+     * @return where the n bytes are.
+     */
+    char *Extend(size_t n);
+
     void Reset();
     void Reset(Communicator *c);
+    /**
+     * @return the data of the buffer, not including the external segments.
+     */
     const char *const GetBuffer() const;
+    /**
+     * @return the size of the data, external segments included.
+     */
     size_t GetBufferSize() const;
+    inline bool HasExternalSegments() const { return !mSegments.empty(); }
+    /**
+     * Appends to iov the segments making up the data of the buffer.
+     */
+    void GetSegments(std::vector<struct iovec> &iov) const;
     void Dump(Communicator *c) const;
+    /**
+     * Writes the data of the buffer, without its size and without syncing.
+     */
+    void WriteTo(Communicator *c) const;
+
+    /**
+     * @return the Transfer following the input buffer of a request, nullptr
+     * if it has none.
+     */
+    inline Transfer *GetTransfer() const { return mpTransfer.get(); }
+    inline void SetTransfer(std::shared_ptr<Transfer> transfer) {
+        mpTransfer = std::move(transfer);
+    }
 
    private:
+    /**
+     * Reallocates the buffer to hold at least required bytes, growing it
+     * geometrically so that adding data piecewise stays linear.
+     */
+    void Grow(size_t required);
+
     size_t mBlockSize;
     size_t mSize;
     size_t mLength;
@@ -305,5 +346,15 @@ class Buffer {
     size_t mBackOffset;
     char *mpBuffer;
     bool mOwnBuffer;
+
+    /* data added with AddExternal(), to be written after mOffset bytes of mpBuffer */
+    struct Segment {
+        size_t offset;
+        const char *data;
+        size_t size;
+    };
+    std::vector<Segment> mSegments;
+    size_t mExternalLength = 0;
+    std::shared_ptr<Transfer> mpTransfer;
 };
 }  // namespace gvirtus::communicators
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <sys/uio.h>
+
 #include <cstddef>
+#include <cstring>
 #include <memory>
 
 #include "Endpoint.h"
@@ -52,8 +55,50 @@ class Communicator {
 
     virtual size_t Read(char *buffer, size_t size) = 0;
     virtual size_t Write(const char *buffer, size_t size) = 0;
+
+    /**
+     * Writes the data of several segments as if it were contiguous (gather
+     * write). The default implementation copies the segments and calls
+     * Write() once, so that message oriented communicators see a single
+     * message; stream communicators should override it with writev().
+     *
+     * @return the number of bytes written.
+     */
+    virtual size_t Writev(const struct iovec *iov, int iovcnt) {
+        size_t size = 0;
+        for (int i = 0; i < iovcnt; i++) size += iov[i].iov_len;
+        std::unique_ptr<char[]> buffer(new char[size]);
+        size_t offset = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            memcpy(buffer.get() + offset, iov[i].iov_base, iov[i].iov_len);
+            offset += iov[i].iov_len;
+        }
+        return Write(buffer.get(), size);
+    }
+
     virtual void Sync() = 0;
 
+    /**
+     * @return the file descriptor that becomes readable when data arrives,
+     * for waiting on it with poll()/epoll, or -1 if the communicator cannot be
+     * waited on this way.
+     */
+    virtual int GetFileDescriptor() const { return -1; }
+
+    /**
+     * @return true if data already received (e.g. buffered by the
+     * communicator) is waiting to be read, so the file descriptor may not
+     * become readable although Read() would not block.
+     */
+    virtual bool HasPendingInput() const { return false; }
+
+    /**
+     * @return true if a thread can Read() while another one writes, as the
+     * frontends and the backends multiplexing several threads on a connection
+     * do; otherwise the connection is used by one thread at a time.
+     */
+    virtual bool IsFullDuplex() const { return false; }
+
     /**
      * Closes the connection with the end point.
      */
@@ -10,6 +10,7 @@
 
 #include "Communicator.h"
 #include "Endpoint.h"
+#include "Endpoint_AfUnix.h"
 #include "Endpoint_Rdma.h"
 #include "Endpoint_Tcp.h"
 
@@ -20,6 +21,21 @@ class CommunicatorFactory {
    public:
     static std::shared_ptr<common::LD_Lib<Communicator, std::shared_ptr<Endpoint>>>
     get_communicator(std::shared_ptr<Endpoint> end, bool secure = false) {
+        auto dl = get_library(end, secure);
+        dl->build_obj(end);
+
+#ifdef DEBUG
+        std::cout << "CommunicatorFactory::get_communicator() ended" << std::endl;
+#endif
+        return dl;
+    }
+
+    /**
+     * @return the library of the communicator of end, which creates its
+     * communicators with LD_Lib::create().
+     */
+    static std::shared_ptr<common::LD_Lib<Communicator, std::shared_ptr<Endpoint>>> get_library(
+        std::shared_ptr<Endpoint> end, bool secure = false) {
 #ifdef DEBUG
         std::cout << "CommunicatorFactory::get_communicator() called." << std::endl;
         std::cout << "CommunicatorFactory::get_communicator(): endpoint is: " << end->to_string()
@@ -35,7 +51,8 @@ class CommunicatorFactory {
 #endif
 
         // Supported unsecure communicators
-        std::vector<std::string> unsecureMatches = {"tcp", "http", "oldtcp", "ws", "ib"};
+        std::vector<std::string> unsecureMatches = {"tcp",  "http", "oldtcp", "ws",
+                                                    "ib",   "shm",  "unix",   "uring"};
 
         // Supported secure communicators
         std::vector<std::string> secureMatches = {"https", "wss"};
@@ -79,13 +96,37 @@ class CommunicatorFactory {
 #ifdef DEBUG
         std::cout << "CommunicatorFactory::get_communicator(): made dl" << std::endl;
 #endif
+        return dl;
+    }
 
-        dl->build_obj(end);
+    /**
+     * @return the AF_UNIX communicator on which the backend serving the TCP
+     * endpoint end also accepts the frontends of its own host, or nullptr if
+     * end is not a TCP endpoint, GVIRTUS_AF_UNIX is off or the communicator
+     * is not installed.
+     */
+    static std::shared_ptr<common::LD_Lib<Communicator, std::shared_ptr<Endpoint>>>
+    get_local_communicator(std::shared_ptr<Endpoint> end) {
+        auto local = get_local_endpoint(end);
+        if (local == nullptr) return nullptr;
+
+        try {
+            return get_communicator(local);
+        } catch (const std::exception &e) {
+            return nullptr;
+        }
+    }
 
-#ifdef DEBUG
-        std::cout << "CommunicatorFactory::get_communicator() ended" << std::endl;
-#endif
-        return dl;
+    /**
+     * @return the AF_UNIX endpoint of get_local_communicator(), or nullptr
+     * if end is not a TCP endpoint or GVIRTUS_AF_UNIX is off.
+     */
+    static std::shared_ptr<Endpoint> get_local_endpoint(std::shared_ptr<Endpoint> end) {
+        auto tcp = std::dynamic_pointer_cast<Endpoint_Tcp>(end);
+        std::string enabled = CommunicatorFactory::getEnvVar("GVIRTUS_AF_UNIX");
+        if (tcp == nullptr || enabled == "off" || enabled == "false" || enabled == "0")
+            return nullptr;
+        return std::make_shared<Endpoint_AfUnix>(Endpoint_AfUnix::for_tcp_port(tcp->port()));
     }
 
    private:
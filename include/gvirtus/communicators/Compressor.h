@@ -0,0 +1,120 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "Communicator.h"
+#include "Protocol.h"
+
+namespace gvirtus::communicators {
+/**
+ * Compressor compresses the large payloads written on a connection and
+ * decompresses the ones read from it, when the Handshake agreed on a codec
+ * (CAPABILITY_COMPRESSION_*). Each side of the connection has its own.
+ *
+ * A payload of at least GVIRTUS_COMPRESSION_THRESHOLD bytes (64 KiB) is
+ * written as a sequence of CompressedBlock(s), each one written as soon as
+ * it is compressed, so compressing a block overlaps with sending the
+ * previous ones. A block that does not shrink below
+ * GVIRTUS_COMPRESSION_MAX_RATIO (0.9) of its size is stored as it is.
+ *
+ * Tensors of fp32 or fp16/bf16 compress much better after a byte shuffle
+ * (the exponents end up together), so GVIRTUS_COMPRESSION_SHUFFLE selects
+ * the element size of the shuffle: 0 for none, 2, 4 or "auto" (the default)
+ * for trying them on a sample of the data now and then and keeping the best.
+ *
+ * Whether compressing pays is decided from the measured compression ratio,
+ * the throughput of the compressor and the bandwidth of the link (measured
+ * on the payloads sent raw, or set with GVIRTUS_LINK_BANDWIDTH in MB/s):
+ * since compressing overlaps with sending, it pays when the data shrinks
+ * and the compressor is faster than the link. One large payload in
+ * PROBE_INTERVAL is sent the other way, for keeping the estimates current.
+ */
+class Compressor {
+   public:
+    /**
+     * @param codec the codec for the payloads written, COMPRESSION_LZ4 or COMPRESSION_ZSTD.
+     */
+    explicit Compressor(uint8_t codec);
+    ~Compressor();
+
+    /**
+     * @return the CAPABILITY_COMPRESSION_* of the codecs built in.
+     */
+    static uint64_t GetCapabilities();
+
+    /**
+     * @param capabilities the capabilities agreed by the Handshake.
+     *
+     * @return the Compressor of a connection, nullptr if no codec was agreed.
+     */
+    static std::unique_ptr<Compressor> Create(uint64_t capabilities);
+
+    /**
+     * @return true if a payload of size bytes has to be compressed.
+     */
+    bool ShouldCompress(size_t size);
+
+    /**
+     * Writes the data of payload, as CompressedBlock(s) if compressed is
+     * true, and syncs the communicator.
+     */
+    void Write(Communicator *c, const Buffer *payload, bool compressed);
+
+    /**
+     * Reads a compressed payload of size bytes into the iovcnt destinations
+     * of iov, whose sizes add up to size.
+     */
+    void Read(Communicator *c, size_t size, const struct iovec *iov, int iovcnt);
+
+    /* bytes of the compressed payloads, before and after compressing them */
+    inline uint64_t GetCompressedBytes() const { return mCompressedBytes; }
+    inline uint64_t GetWrittenBytes() const { return mWrittenBytes; }
+
+   private:
+    bool Pays() const;
+    /**
+     * Compresses size bytes of src into mStaging as a block.
+     *
+     * @return the header of the block.
+     */
+    CompressedBlock CompressBlock(const char *src, size_t size, unsigned shuffle);
+    /**
+     * @return the shuffle compressing best a sample of src.
+     */
+    unsigned ChooseShuffle(const char *src, size_t size);
+    size_t Encode(const char *src, size_t size, char *dst, size_t capacity);
+    void Decode(uint8_t codec, const char *src, size_t stored_size, char *dst, size_t size);
+
+    uint8_t mCodec;
+    size_t mThreshold;
+    double mMaxRatio;
+    /* element size of the shuffle, 0 for choosing it with ChooseShuffle() */
+    unsigned mShuffle;
+    unsigned mAutoShuffle = 0;
+    /* large payloads written, and the compressed ones among them */
+    uint64_t mMessages = 0;
+    uint64_t mCompressedMessages = 0;
+
+    /* moving averages of the measures; 0 when unknown */
+    double mRatio = 0;
+    double mThroughput = 0;    /* bytes/s compressed */
+    double mLinkBandwidth = 0; /* bytes/s written raw */
+    bool mFixedLinkBandwidth = false;
+
+    uint64_t mCompressedBytes = 0;
+    uint64_t mWrittenBytes = 0;
+
+    /* a block gathered (and shuffled), and a block compressed */
+    std::vector<char> mGather;
+    std::vector<char> mShuffled;
+    std::vector<char> mStaging;
+    void *mpZstdCompress = nullptr;
+    void *mpZstdDecompress = nullptr;
+};
+}  // namespace gvirtus::communicators
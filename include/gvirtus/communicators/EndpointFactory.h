@@ -9,7 +9,9 @@
 #include <nlohmann/json.hpp>
 
 #include "Endpoint.h"
+#include "Endpoint_AfUnix.h"
 #include "Endpoint_Rdma.h"
+#include "Endpoint_Shm.h"
 #include "Endpoint_Tcp.h"
 
 namespace gvirtus::communicators {
@@ -52,6 +54,14 @@ class EndpointFactory {
             LOG4CPLUS_INFO(logger, "Initializing Infiniband RDMA Endpoint");
             auto end = common::JSON<Endpoint_Rdma>(json_path).parser();
             ptr = std::make_shared<Endpoint_Rdma>(end);
+        } else if (suite == "unix") {
+            LOG4CPLUS_INFO(logger, "Initializing AF_UNIX Endpoint");
+            auto end = common::JSON<Endpoint_AfUnix>(json_path).parser();
+            ptr = std::make_shared<Endpoint_AfUnix>(end);
+        } else if (suite == "shm") {
+            LOG4CPLUS_INFO(logger, "Initializing shared memory Endpoint");
+            auto end = common::JSON<Endpoint_Shm>(json_path).parser();
+            ptr = std::make_shared<Endpoint_Shm>(end);
         } else {
             throw std::runtime_error("Unsupported endpoint suite: " + suite);
         }
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+#include "Endpoint.h"
+
+/* capacity of the shared memory region carrying the bulk data of each direction: small enough
+ * for the ring to stay in the caches of the CPU */
+#define AFUNIX_DEFAULT_BULK_SIZE (1 << 20)
+
+namespace gvirtus::communicators {
+/**
+ * Endpoint of the AF_UNIX communicator, for a frontend running on the same
+ * host as the backend:
+ *
+ *     "endpoint": {"suite": "unix", "protocol": "unix", "path": "@gvirtus",
+ *                  "mode": "0660", "bulk_size": "1048576"}
+ *
+ * path is the path of the socket, or its name in the abstract namespace when
+ * it starts with '@'; mode the permissions of a socket in the filesystem;
+ * bulk_size the capacity in bytes of the shared memory region carrying the
+ * large transfers of each direction (0 sends everything through the socket).
+ * Only suite and protocol are mandatory.
+ */
+class Endpoint_AfUnix : public Endpoint {
+   public:
+    Endpoint_AfUnix() = default;
+
+    explicit Endpoint_AfUnix(const std::string &endp_suite, const std::string &endp_protocol,
+                             const std::string &endp_path, mode_t endp_mode = 0660,
+                             size_t endp_bulk_size = AFUNIX_DEFAULT_BULK_SIZE);
+
+    /**
+     * @return the endpoint on which a backend listening on the TCP port also
+     * accepts the frontends of its own host.
+     */
+    static Endpoint_AfUnix for_tcp_port(std::uint16_t port);
+
+    Endpoint &suite(const std::string &suite) override;
+    Endpoint &protocol(const std::string &protocol) override;
+
+    Endpoint_AfUnix &path(const std::string &path);
+    inline const std::string &path() const { return _path; }
+
+    Endpoint_AfUnix &mode(mode_t mode);
+    inline mode_t mode() const { return _mode; }
+
+    Endpoint_AfUnix &bulk_size(size_t bulk_size);
+    inline size_t bulk_size() const { return _bulk_size; }
+
+    virtual inline const std::string to_string() const { return _suite + _protocol + _path; }
+
+   private:
+    std::string _path = "@gvirtus";
+    mode_t _mode = 0660;
+    size_t _bulk_size = AFUNIX_DEFAULT_BULK_SIZE;
+};
+
+void from_json(const nlohmann::json &j, Endpoint_AfUnix &end);
+}  // namespace gvirtus::communicators
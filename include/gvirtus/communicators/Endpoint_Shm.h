@@ -0,0 +1,52 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include "Endpoint.h"
+
+/* capacity of each ring of a shared memory connection, if not configured */
+#define SHM_DEFAULT_RING_SIZE (4 << 20)
+
+namespace gvirtus::communicators {
+/**
+ * Endpoint of the shared memory communicator, for a frontend running on the
+ * same host as the backend:
+ *
+ *     "endpoint": {"suite": "shm", "protocol": "shm", "name": "gvirtus",
+ *                  "size": "4194304", "hugepages": false}
+ *
+ * name identifies the backend (the frontends find it through the abstract
+ * unix socket "gvirtus-shm-<name>"), size is the capacity in bytes of each
+ * of the two rings of a connection and hugepages asks for them to be backed
+ * by huge pages. Only suite and protocol are mandatory.
+ */
+class Endpoint_Shm : public Endpoint {
+   public:
+    Endpoint_Shm() = default;
+
+    explicit Endpoint_Shm(const std::string &endp_suite, const std::string &endp_protocol,
+                          const std::string &endp_name, size_t endp_size = SHM_DEFAULT_RING_SIZE,
+                          bool endp_hugepages = false);
+
+    Endpoint &suite(const std::string &suite) override;
+    Endpoint &protocol(const std::string &protocol) override;
+
+    Endpoint_Shm &name(const std::string &name);
+    inline const std::string &name() const { return _name; }
+
+    Endpoint_Shm &size(size_t size);
+    inline size_t size() const { return _size; }
+
+    Endpoint_Shm &hugepages(bool hugepages);
+    inline bool hugepages() const { return _hugepages; }
+
+    virtual inline const std::string to_string() const { return _suite + _protocol + _name; }
+
+   private:
+    std::string _name = "gvirtus";
+    size_t _size = SHM_DEFAULT_RING_SIZE;
+    bool _hugepages = false;
+};
+
+void from_json(const nlohmann::json &j, Endpoint_Shm &end);
+}  // namespace gvirtus::communicators
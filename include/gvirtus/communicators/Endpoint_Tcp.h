@@ -45,6 +45,26 @@ class Endpoint_Tcp : public Endpoint {
      */
     inline const std::uint16_t &port() const { return _port; }
 
+    /**
+     * This method is a setter for the class member _stripes
+     * @param stripes: connections the bulk lane of a session is striped over
+     * (see communicators::BulkLane), between 1 and GVIRTUS_MAX_STRIPES
+     * @return reference to itself (Fluent Interface API)
+     */
+    Endpoint_Tcp &stripes(unsigned stripes);
+
+    /**
+     * This method is a getter for the class member _stripes
+     * @return the value of class member _stripes
+     */
+    inline unsigned stripes() const { return _stripes; }
+
+    /**
+     * @return true if _address is an address of this host, so the backend
+     * can be reached through its AF_UNIX endpoint.
+     */
+    bool is_local() const;
+
     /**
      * This method return an object description
      * @return string that represents the concatenation between class member
@@ -56,6 +76,7 @@ class Endpoint_Tcp : public Endpoint {
    private:
     std::string _address;
     std::uint16_t _port;
+    unsigned _stripes = 1;
 };
 
 /**
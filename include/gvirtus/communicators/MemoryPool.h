@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+namespace gvirtus::communicators {
+/**
+ * MemoryPool provides the storage of the Buffers. Sizes are rounded up to a
+ * power of two size class, from 4 KiB up to 1 MiB, and released blocks are
+ * kept in a per-thread free list of their class, so the buffers created and
+ * destroyed for every routine do not hit malloc() nor take a lock.
+ * The free lists belong to the thread releasing the blocks, not to the one
+ * that allocated them: a buffer handed to another thread (e.g. a request
+ * served by a worker of the backend) ends up in the free lists of the thread
+ * destroying it. They are given back to the system when the thread exits.
+ *
+ * Larger blocks are mapped with mmap(), in multiples of 2 MiB, and the last
+ * few released by each thread are kept for its reuse. Setting
+ * GVIRTUS_HUGEPAGES=1 asks for them to be backed by transparent huge pages.
+ * Setting GVIRTUS_BUFFER_POOL=0 disables the pool (every block is a
+ * malloc()).
+ */
+class MemoryPool {
+   public:
+    struct Stats {
+        /* blocks requested to the pool */
+        size_t allocations;
+        /* blocks that had to be requested to the system */
+        size_t system_allocations;
+        /* blocks mapped with huge pages advised */
+        size_t huge_allocations;
+    };
+
+    /**
+     * Allocates a block of at least size bytes.
+     *
+     * @param size the requested size, updated to the actual size of the block.
+     *
+     * @return the block, never NULL (std::bad_alloc is thrown on failure).
+     */
+    static void *Allocate(size_t &size);
+
+    /**
+     * Gives back a block obtained from Allocate().
+     *
+     * @param ptr the block.
+     * @param size the size of the block, as returned by Allocate().
+     */
+    static void Release(void *ptr, size_t size);
+
+    /**
+     * @return the allocation counters of the process.
+     */
+    static Stats GetStats();
+};
+}  // namespace gvirtus::communicators
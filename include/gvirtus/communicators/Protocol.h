@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+
+/* "GVRT" */
+#define GVIRTUS_PROTOCOL_MAGIC 0x47565254
+#define GVIRTUS_PROTOCOL_VERSION 8
+/* "GVRB": the Hello opening a bulk lane, see BulkLane */
+#define GVIRTUS_BULK_LANE_MAGIC 0x47565242
+
+/* the most connections a bulk lane can be striped over, see BulkLane */
+#define GVIRTUS_MAX_STRIPES 16
+/* the bytes of a striped bulk lane that go on a stripe before moving to the next one */
+#define GVIRTUS_STRIPE_SEGMENT (256 * 1024)
+
+/* the largest size of a CompressedBlock */
+#define GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE (256 * 1024)
+
+namespace gvirtus::communicators {
+/**
+ * Features that are used only when both the frontend and the backend support
+ * them. They are agreed once per connection by the handshake.
+ */
+enum Capability : uint64_t {
+    /* the payload of a request can be a Batch of requests */
+    CAPABILITY_BATCH = 1 << 0,
+    /* large payloads can be compressed with LZ4, see CompressedBlock */
+    CAPABILITY_COMPRESSION_LZ4 = 1 << 1,
+    /* large payloads can be compressed with zstd, see CompressedBlock */
+    CAPABILITY_COMPRESSION_ZSTD = 1 << 2,
+    /* the sessions can open a bulk lane, see BulkLane */
+    CAPABILITY_BULK_LANE = 1 << 3,
+};
+
+/* capabilities implemented by this build, besides the codecs of Compressor::GetCapabilities() */
+constexpr uint64_t SUPPORTED_CAPABILITIES = CAPABILITY_BATCH | CAPABILITY_BULK_LANE;
+
+/**
+ * Flags of a request.
+ */
+enum RequestFlag : uint32_t {
+    /* the payload is a Batch, the routine id is not used */
+    REQUEST_BATCH = 1 << 0,
+    /* the payload is a sequence of CompressedBlock(s) */
+    REQUEST_COMPRESSED = 1 << 1,
+    /* the session is over and its state can be released; it has no response */
+    REQUEST_END_SESSION = 1 << 2,
+    /* the transfer follows on the bulk lane of the session */
+    REQUEST_BULK_LANE = 1 << 3,
+};
+
+/**
+ * Flags of a response.
+ */
+enum ResponseFlag : uint32_t {
+    /* the payload is a sequence of CompressedBlock(s) */
+    RESPONSE_COMPRESSED = 1 << 0,
+    /* the payload, never compressed, follows on the bulk lane of the session */
+    RESPONSE_BULK_LANE = 1 << 1,
+};
+
+/**
+ * Codecs of a CompressedBlock.
+ */
+enum CompressionCodec : uint8_t {
+    /* the block is stored as it is */
+    COMPRESSION_NONE = 0,
+    COMPRESSION_LZ4 = 1,
+    COMPRESSION_ZSTD = 2,
+};
+
+/**
+ * Header of a block of a compressed payload, followed by stored_size bytes.
+ * When a payload is compressed, the payload_size of its header is the size of
+ * the uncompressed data, that is the sum of the size of its blocks. The data
+ * of a block has been byte shuffled before compressing it when shuffle is
+ * greater than 1: the i-th byte of each shuffle-byte element comes first,
+ * then the (i+1)-th one, and so on (the tail of the block that does not make
+ * up an element is left as it is).
+ */
+struct CompressedBlock {
+    uint32_t size;
+    uint32_t stored_size;
+    uint8_t codec;
+    uint8_t shuffle;
+    uint16_t reserved;
+};
+
+/**
+ * First message on a connection, sent by the frontend and answered by the
+ * backend with its own Hello followed by the routine table: a Buffer holding
+ * the number of routines (size_t) and their names (AddString()). The id of a
+ * routine is its position in the table. The capabilities of the answer are
+ * the ones supported by both sides; with CAPABILITY_BULK_LANE the table ends
+ * with the token of the connection (uint64_t) and the most stripes the
+ * backend accepts for a bulk lane (uint32_t).
+ *
+ * All the connections of a frontend process, and their bulk lanes, send the
+ * same client_id, drawn at random by the process: the backend shares what a
+ * process registered (e.g. its kernels) among its connections, and releases
+ * it once they are all closed. 0 makes a connection a client of its own.
+ */
+struct Hello {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capabilities;
+    uint64_t client_id;
+};
+
+/**
+ * A session of a connection that agreed on CAPABILITY_BULK_LANE can open a
+ * second connection, its bulk lane, for the transfers and the large outputs
+ * of its routines, so that they don't hold up the small requests and
+ * responses of the other sessions on the connection. The bulk lane starts
+ * with a Hello with the GVIRTUS_BULK_LANE_MAGIC magic followed by a
+ * BulkLane, and the backend answers with a Hello with CAPABILITY_BULK_LANE
+ * if it accepted it. Then the requests flagged REQUEST_BULK_LANE send their
+ * transfer on the bulk lane, and the responses flagged RESPONSE_BULK_LANE
+ * send their payload there, in the order of their headers: the routines of a
+ * session are executed one at a time.
+ *
+ * A bulk lane can be striped over several connections, opened one after
+ * the other with stripe 0 to stripes - 1, and not more than the backend
+ * accepts: its data is then cut in segments of GVIRTUS_STRIPE_SEGMENT bytes
+ * going on the stripes in turn, see StripedCommunicator. The backend answers
+ * the last stripe once the bulk lane is complete.
+ */
+struct BulkLane {
+    /* the token of the connection, see Hello */
+    uint64_t token;
+    uint64_t session_id;
+    uint32_t stripe;
+    uint32_t stripes;
+};
+
+/**
+ * Header preceding the input buffer of a routine (payload_size bytes), which
+ * may be followed by transfer_size bytes of bulk data (e.g. the host array of
+ * a large cudaMemcpy), never compressed, that the routine reads in chunks
+ * while copying them, see Transfer.
+ *
+ * A connection carries the requests of several threads of the frontend, each
+ * one a session with its own session_id: the requests of a session are
+ * executed in order and with the per-thread state (e.g. the current device)
+ * of that session, while the ones of different sessions may run
+ * concurrently, so the responses come in order of completion.
+ */
+struct RequestHeader {
+    uint32_t routine_id;
+    uint32_t flags;
+    uint64_t request_id;
+    uint64_t session_id;
+    uint64_t payload_size;
+    uint64_t transfer_size;
+};
+
+/**
+ * Header preceding the output buffer of a routine (payload_size bytes).
+ */
+struct ResponseHeader {
+    int32_t exit_code;
+    uint32_t flags;
+    uint64_t request_id;
+    double time_taken;
+    uint64_t payload_size;
+};
+}  // namespace gvirtus::communicators
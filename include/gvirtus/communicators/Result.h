@@ -35,7 +35,11 @@
 
 #pragma once
 
+#include <functional>
+
 #include "Buffer.h"
+#include "Compressor.h"
+#include "Protocol.h"
 
 namespace gvirtus::communicators {
 /**
@@ -45,11 +49,35 @@ class Result {
    public:
     Result(int exit_code);
     Result(int exit_code, const std::shared_ptr<Buffer> output_buffer);
+    /**
+     * A result whose output, of size bytes, is written by writer while it is
+     * being produced (e.g. copied from the device in Transfer chunks) rather
+     * than held in a Buffer. It is never compressed.
+     */
+    Result(int exit_code, size_t size, std::function<void(Communicator *)> writer);
 
     virtual ~Result() = default;
     int GetExitCode();
 
-    void Dump(Communicator *c);
+    /**
+     * Writes the ResponseHeader and the output buffer on the communicator.
+     *
+     * @param c the communicator connected to the frontend.
+     * @param request_id the id of the request this is the result of.
+     * @param compressor the Compressor of the connection, or nullptr.
+     * @param bulk true if the output of a writer goes on the bulk lane of
+     * the session: the header is flagged RESPONSE_BULK_LANE and the output
+     * is written by DumpOutput().
+     */
+    void Dump(Communicator *c, uint64_t request_id, Compressor *compressor = nullptr,
+              bool bulk = false);
+
+    /**
+     * Writes the output of a writer on the bulk lane, after Dump().
+     */
+    void DumpOutput(Communicator *bulk_lane);
+
+    inline bool HasWriter() const { return static_cast<bool>(mWriter); }
 
     void TimeTaken(double time_taken);
     double TimeTaken() const;
@@ -57,6 +85,8 @@ class Result {
    private:
     int mExitCode;
     std::shared_ptr<Buffer> mpOutputBuffer;
+    size_t mWriterSize = 0;
+    std::function<void(Communicator *)> mWriter;
     double mTimeTaken = 0;
 };
 }  // namespace gvirtus::communicators
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Communicator.h"
+
+namespace gvirtus::communicators {
+/**
+ * StripedCommunicator is a connection made of several connected
+ * communicators, its stripes: the stream is cut in segments of
+ * GVIRTUS_STRIPE_SEGMENT bytes, the i-th one going on the stripe i modulo the
+ * number of stripes. A Read() or a Write() spanning several segments moves
+ * them on all their stripes at once, each one from a thread of its own, so
+ * that a large transfer is carried by several TCP flows (and so by several
+ * queues of the network card, and by several cores for the copies of the
+ * network stack) instead of one. The far side, also a StripedCommunicator
+ * over the same stripes in the same order, puts them back together.
+ *
+ * It is used for the bulk lane of a session, see BulkLane: like the other
+ * communicators, a thread may read while another one writes, but only one
+ * thread at a time may read (or write).
+ */
+class StripedCommunicator : public Communicator {
+   public:
+    /**
+     * @param stripes the communicators, connected (or to be connected by
+     * Connect()) in the same order as the ones of the far side.
+     */
+    explicit StripedCommunicator(std::vector<std::shared_ptr<Communicator>> stripes);
+
+    /* a StripedCommunicator is put together from connected communicators */
+    void Serve() override;
+    const Communicator *const Accept() const override;
+
+    /**
+     * Connects every stripe.
+     */
+    void Connect() override;
+
+    size_t Read(char *buffer, size_t size) override;
+    size_t Write(const char *buffer, size_t size) override;
+    void Sync() override;
+    bool IsFullDuplex() const override;
+    void Close() override;
+
+    std::string to_string() override { return "striped"; }
+
+    inline size_t GetStripes() const { return mStripes.size(); }
+
+   private:
+    /* a thread moving the segments of a stripe, one job at a time */
+    class Worker {
+       public:
+        Worker();
+        ~Worker();
+        void Post(std::function<void()> job);
+        /**
+         * Waits for the job posted last, rethrowing its exception.
+         */
+        void Wait();
+
+       private:
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::function<void()> mJob;
+        bool mBusy = false;
+        bool mStop = false;
+        std::exception_ptr mError;
+        std::thread mThread;
+    };
+
+    /* the segments of a Read() or a Write() that go on a stripe */
+    struct Slice {
+        std::vector<struct iovec> segments;
+        size_t done = 0;
+    };
+
+    /**
+     * Cuts size bytes at offset of the stream in the slices of the stripes,
+     * and moves them with move(stripe, slice): on the calling thread for the
+     * stripe of the first segment, on the workers for the other ones.
+     *
+     * @return the bytes moved.
+     */
+    size_t Stripe(char *buffer, size_t size, uint64_t &offset,
+                  std::vector<std::unique_ptr<Worker>> &workers,
+                  const std::function<void(Communicator *, Slice &)> &move);
+
+    std::vector<std::shared_ptr<Communicator>> mStripes;
+    /* position of the stream read and written so far */
+    uint64_t mReadOffset = 0;
+    uint64_t mWriteOffset = 0;
+    /* by stripe, started on their first job */
+    std::vector<std::unique_ptr<Worker>> mReaders;
+    std::vector<std::unique_ptr<Worker>> mWriters;
+};
+}  // namespace gvirtus::communicators
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+
+#include "Communicator.h"
+
+namespace gvirtus::communicators {
+/**
+ * Transfer is the bulk data following the input buffer of a request (see
+ * RequestHeader::transfer_size), e.g. the host array of a large cudaMemcpy.
+ * Instead of being read whole before the routine starts, it is read by the
+ * routine itself in chunks of GVIRTUS_TRANSFER_CHUNK bytes (1 MiB), so that
+ * copying a chunk to the device overlaps with receiving the next one and a
+ * transfer takes just the chunks the routine holds.
+ *
+ * The chunks come from a process-wide pool of staging buffers, which a
+ * handler can make page-locked with SetChunkAllocator() so that they are
+ * copied to the device asynchronously. Routines with a large output can
+ * write it in the same chunks, see Result.
+ */
+class Transfer {
+   public:
+    struct Chunk {
+        char *data;
+        size_t size;
+    };
+
+    /**
+     * @param size the bytes of the transfer.
+     * @param source the communicator it is read from.
+     */
+    Transfer(size_t size, Communicator *source);
+    ~Transfer();
+
+    inline size_t GetSize() const { return mSize; }
+
+    /**
+     * Reads the next chunk from the communicator. It throws if the
+     * connection is closed.
+     *
+     * @return the chunk, with a NULL data at the end of the transfer. It must
+     * be given back with Release().
+     */
+    Chunk Take();
+    void Release(Chunk chunk);
+
+    /**
+     * Reads and discards the chunks not taken yet, which precede the next
+     * request on the connection: the transfer is complete once the routine
+     * returns, whether or not it used all of it.
+     */
+    void Close();
+
+    /**
+     * @return the size of a chunk, see GVIRTUS_TRANSFER_CHUNK.
+     */
+    static size_t GetChunkSize();
+
+    /**
+     * Allocates a staging buffer of GetChunkSize() bytes from the pool.
+     */
+    static char *AllocateChunk();
+    static void ReleaseChunk(char *chunk);
+    /**
+     * Gives chunk back to the pool without ever releasing it, e.g. from a
+     * CUDA host function, which can't call CUDA; the pool is trimmed by the
+     * next ReleaseChunk().
+     */
+    static void ReturnChunk(char *chunk);
+
+    /**
+     * Sets the functions allocating the staging buffers of the pool, e.g.
+     * page-locked ones. It must be called before the first transfer.
+     */
+    static void SetChunkAllocator(void *(*allocate)(size_t size), void (*release)(void *ptr));
+
+   private:
+    size_t mSize;
+    /* bytes read from mpSource */
+    size_t mTaken = 0;
+    Communicator *mpSource;
+    /* chunks released by the routine, reused before taking new ones from the pool */
+    std::deque<char *> mFree;
+};
+}  // namespace gvirtus::communicators
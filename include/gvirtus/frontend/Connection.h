@@ -0,0 +1,174 @@
+#pragma once
+
+#include <gvirtus/communicators/Buffer.h>
+#include <gvirtus/communicators/Communicator.h>
+#include <gvirtus/communicators/Compressor.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gvirtus::frontend {
+/**
+ * Connection is a connection to the backend shared by the Frontends of
+ * several threads, each one a session of its own (see RequestHeader): the
+ * threads send their requests in turn, and whichever thread is waiting for a
+ * response reads the responses arriving, in any order, handing each one to
+ * the thread waiting for it.
+ *
+ * The Frontends get their Connection from a pool of at most
+ * GVIRTUS_CONNECTIONS (default 4) per process: a new thread gets a new
+ * connection while the pool is not full, then the least used one. A
+ * communicator that is not full duplex gets a connection per thread.
+ *
+ * The configuration is read and the communicator libraries are loaded once
+ * per process, and a connection is opened in advance, on a thread of its
+ * own, whenever the next new thread would otherwise have to wait for one
+ * (see Preconnect()).
+ */
+class Connection {
+   public:
+    /**
+     * A request waiting for its response, which Receive() stores in output,
+     * or in dst for the output holding just an array of dst_size bytes (see
+     * Frontend::SetOutputDestination()).
+     */
+    struct Call {
+        communicators::Buffer *output;
+        void *dst = nullptr;
+        size_t dst_size = 0;
+        /* the bulk lane of the session, if it has one (see OpenBulkLane()) */
+        communicators::Communicator *bulk_lane = nullptr;
+
+        /* the response, once received */
+        bool received = false;
+        bool dst_received = false;
+        int exit_code = -1;
+        double time_taken = 0;
+        uint64_t payload_size = 0;
+        /* the payload is still on the bulk lane */
+        bool bulk_payload = false;
+    };
+
+    /**
+     * Connects to the backend of the configuration and agrees on the
+     * protocol with it. It throws on failure.
+     */
+    Connection();
+    /**
+     * Agrees on the protocol with the backend at the other end of
+     * communicator, connected already.
+     */
+    explicit Connection(std::shared_ptr<communicators::Communicator> communicator,
+                        bool local = false);
+    ~Connection();
+
+    /**
+     * @return a connection of the pool for a new thread.
+     */
+    static std::shared_ptr<Connection> Acquire();
+
+    /**
+     * Loads the configuration and starts opening the first connection of
+     * the pool, unless GVIRTUS_PRECONNECT is off; called when the library is
+     * loaded. It never throws: Acquire() reports the errors.
+     */
+    static void Preconnect();
+
+    /**
+     * Closes the connections of the pool, at exit.
+     */
+    static void Release();
+
+    /**
+     * @return false if the routine is not available on the backend.
+     */
+    bool GetRoutineId(const char *routine, uint32_t &routine_id) const;
+
+    inline uint64_t GetCapabilities() const { return mCapabilities; }
+
+    inline bool IsFullDuplex() const { return mpCommunicator->IsFullDuplex(); }
+
+    /**
+     * Opens the bulk lane of a session, which carries the transfers and the
+     * large outputs of its requests (see communicators::BulkLane), striped
+     * over the connections agreed with the backend; it must be used by one
+     * thread at a time.
+     *
+     * @return nullptr if the backend doesn't support them. It throws on
+     * failure.
+     */
+    std::shared_ptr<communicators::Communicator> OpenBulkLane(uint64_t session_id);
+
+    /**
+     * Sends a request of a session.
+     *
+     * @param call where the response goes, nullptr if it has none; it must
+     * stay valid until Receive() returns it.
+     * @param transfer the transfer_size bytes following the input buffer
+     * (see communicators::Transfer), or nullptr; they go on the bulk lane of
+     * call, if it has one.
+     *
+     * @return the id of the request.
+     */
+    uint64_t Send(uint64_t session_id, uint32_t routine_id, uint32_t flags,
+                  const communicators::Buffer *input_buffer, Call *call,
+                  const void *transfer = nullptr, size_t transfer_size = 0);
+
+    /**
+     * Waits for the response of call, reading the responses of the other
+     * threads meanwhile if no other thread is reading.
+     */
+    void Receive(Call *call);
+
+    /**
+     * Tells the backend that a session is over.
+     */
+    void EndSession(uint64_t session_id);
+
+   private:
+    void Handshake(bool local);
+    /**
+     * Reads the next response.
+     *
+     * @return the call it belongs to, nullptr if none is waiting for it.
+     */
+    Call *ReadResponse();
+    /**
+     * Marks the connection as broken, failing every call waiting on it.
+     */
+    void Fail(const std::string &error);
+
+    std::shared_ptr<communicators::Communicator> _communicator;
+    communicators::Communicator *mpCommunicator = nullptr;
+    /* connected to the backend of this host through AF_UNIX */
+    bool mLocal = false;
+    /* given by the backend to the bulk lanes of the sessions */
+    uint64_t mToken = 0;
+    /* connections a bulk lane is striped over, agreed by the Handshake() */
+    uint32_t mStripes = 1;
+
+    /* routine ids and capabilities agreed by the Handshake() */
+    std::unordered_map<std::string, uint32_t> mRoutineIds;
+    uint64_t mCapabilities = 0;
+    /* compress the requests and decompress the responses, when a codec was agreed */
+    std::unique_ptr<communicators::Compressor> mpCompressor;
+    std::unique_ptr<communicators::Compressor> mpDecompressor;
+    /* the array of a compressed result, checked before it is copied to its destination */
+    std::vector<char> mDecompressed;
+
+    /* held while writing a request */
+    std::mutex mWriteMutex;
+    uint64_t mNextRequestId = 0;
+
+    /* guards the following */
+    std::mutex mMutex;
+    std::condition_variable mReceived;
+    std::unordered_map<uint64_t, Call *> mCalls;
+    bool mReading = false;
+    std::string mError;
+};
+}  // namespace gvirtus::frontend
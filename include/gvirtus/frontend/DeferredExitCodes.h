@@ -0,0 +1,36 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace gvirtus::frontend {
+/**
+ * DeferredExitCodes keeps the errors of the routines executed asynchronously
+ * (see Frontend::ExecuteAsync()) by library, the prefix of their names (e.g.
+ * "cuda" or "cublas"), until the library reports them. Like a CUDA sticky
+ * error, only the first error of a library is kept.
+ */
+class DeferredExitCodes {
+   public:
+    /**
+     * @return the library of routine: "cudaLaunchKernel" -> "cuda",
+     * "cublasSgemm_v2" -> "cublas", ...
+     */
+    static std::string Family(const char *routine);
+
+    /**
+     * Keeps exit_code for family, unless it is 0 or family has an error
+     * already.
+     */
+    void Set(const std::string &family, int exit_code);
+
+    /**
+     * @return the error of family, 0 if there is none; it is cleared when
+     * reset is true.
+     */
+    int Get(const std::string &family, bool reset = true);
+
+   private:
+    std::map<std::string, int> mExitCodes;
+};
+}  // namespace gvirtus::frontend
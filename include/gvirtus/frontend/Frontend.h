@@ -36,18 +36,27 @@
 #pragma once
 
 #include <gvirtus/common/LD_Lib.h>
+#include <gvirtus/communicators/Batch.h>
 #include <gvirtus/communicators/Buffer.h>
 #include <gvirtus/communicators/Communicator.h>
+#include <gvirtus/frontend/Connection.h>
+#include <gvirtus/frontend/DeferredExitCodes.h>
 
+#include <atomic>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace gvirtus::frontend {
 /**
  * Frontend is the object used by every cuda routine wrapper for requesting the
  * execution to the backend.
  *
- * Frontend is a singleton, the single instance can be retrived through the
- * static member getInstance().
+ * There is a Frontend for each thread, a session on one of the connections
+ * to the backend shared by the threads (see Connection); it can be retrived
+ * through the static member GetFrontend().
  *
  * For requesting the execution of a cuda routine to the backend the wrapper has
  * to:
@@ -67,13 +76,17 @@ class Frontend {
     virtual ~Frontend();
 
     /**
-     * Retrieves the single instance of the Frontend class.
+     * Retrieves the Frontend of the calling thread, creating and connecting it
+     * on the first call. The Frontend is destroyed when the thread exits.
      *
      * @param register_var
      *
      * @return The instance of the Frontend class.
      */
-    static Frontend *GetFrontend(communicators::Communicator *c = NULL);
+    static inline Frontend *GetFrontend(communicators::Communicator *c = NULL) {
+        if (mspCurrent != nullptr) return mspCurrent;
+        return CreateFrontend(c);
+    }
 
     /**
      * Requests the execution of the CUDA RunTime routine with the arguments
@@ -86,6 +99,66 @@ class Frontend {
      */
     void Execute(const char *routine, const communicators::Buffer *input_buffer = NULL);
 
+    /**
+     * Requests the execution of a routine that has no output parameters
+     * without waiting for its result (fire-and-forget). The exit code is
+     * collected later, at the next synchronous Execute() or Synchronize(); if
+     * it is an error it is kept as a deferred error of the routine's library
+     * (see GetDeferredExitCode()).
+     * The request is queued in a Batch, which is sent when it grows over the
+     * configured number of routines or size, when a routine needs its result,
+     * or by a thread of the process once it is older than the configured age
+     * (see GVIRTUS_BATCH_MAX_AGE), so that it doesn't wait for the next call
+     * while the application computes on the host.
+     * When the asynchronous mode is disabled (GVIRTUS_ASYNC not set) this is
+     * the same as Execute(), unless always is set.
+     *
+     * A routine whose output is just an array can receive it with
+     * SetOutputDestination(): the array lands there when the result is
+     * collected, by the next synchronous Execute() at the latest, or by a
+     * thread synchronizing its stream (see SetOutputStream()).
+     *
+     * @param routine the name of the routine to execute.
+     * @param input_buffer the buffer containing the parameters of the routine.
+     * @param always true for the routines that are asynchronous in their API
+     * (e.g. cudaMemcpyAsync), which are never waited for.
+     */
+    void ExecuteAsync(const char *routine, const communicators::Buffer *input_buffer = NULL,
+                      bool always = false);
+
+    /**
+     * Sends the queued Batch, if any, and collects the results of all the
+     * asynchronous executions still pending.
+     */
+    void Synchronize();
+
+    /**
+     * Receives the outputs of the asynchronous executions on stream (see
+     * SetOutputStream()) still pending in the Frontends of the other threads
+     * of the process, so that a routine synchronizing the stream finds them in
+     * place whichever thread calls it; their errors are deferred on this
+     * Frontend. The outputs of this thread are received by its next
+     * Execute().
+     *
+     * @param stream the stream synchronized.
+     * @param all true for the outputs on every stream.
+     */
+    void SynchronizeOutputs(const void *stream, bool all = false);
+
+    /**
+     * Returns the first error reported by an asynchronous execution of a
+     * routine of the given library (e.g. "cuda", "cublas", "cudnn"), or 0 if
+     * there is none. Only the results already collected are considered, so
+     * it should be called after a synchronous Execute(). Like a CUDA sticky
+     * error, it is cleared when reset is true.
+     *
+     * @param family the routine name prefix identifying the library.
+     * @param reset true for clearing the deferred error.
+     *
+     * @return the deferred exit code.
+     */
+    int GetDeferredExitCode(const char *family, bool reset = true);
+
     /**
      * Prepares the Frontend for the execution. This method _must_ be called
      * before any requests of execution or any method for adding parameters for
@@ -99,6 +172,45 @@ class Frontend {
 
     inline communicators::Buffer *GetLaunchBuffer() { return mpLaunchBuffer.get(); }
 
+    /**
+     * Makes the next Execute() receive the output of the routine straight
+     * into dst instead of the output buffer, saving a copy. It applies when
+     * the output buffer of the routine holds just an array of size bytes (as
+     * added by Add(ptr, n) or Delegate()); otherwise, e.g. when the routine
+     * failed, the output is received in the output buffer as usual.
+     *
+     * @param dst the host memory receiving the array.
+     * @param size the size of the array in bytes.
+     */
+    void SetOutputDestination(void *dst, size_t size);
+
+    /**
+     * Makes the next ExecuteAsync() with an output destination an execution
+     * on stream, whose output any thread can receive by synchronizing the
+     * stream (see SynchronizeOutputs()).
+     */
+    void SetOutputStream(const void *stream);
+
+    /**
+     * Makes the next Execute() send size bytes from src after the input
+     * buffer, without copying them into it, for the routine to take in
+     * chunks as they arrive (see communicators::Transfer). src must stay
+     * valid until Execute() returns.
+     */
+    void SetInputTransfer(const void *src, size_t size);
+
+    /**
+     * @return the size from which host arrays are better sent with
+     * SetInputTransfer(), see GVIRTUS_TRANSFER_THRESHOLD.
+     */
+    inline size_t GetTransferThreshold() const { return mTransferThreshold; }
+
+    /**
+     * @return true if the last Execute() received its output into the
+     * destination set by SetOutputDestination().
+     */
+    inline bool OutputReceived() const { return mOutputReceived; }
+
     /**
      * Returns the exit code of the last execution request.
      *
@@ -220,16 +332,107 @@ class Frontend {
      * setted at compile time.
      */
     void Init(communicators::Communicator *c);
-    std::shared_ptr<
-        common::LD_Lib<communicators::Communicator, std::shared_ptr<communicators::Endpoint>>>
-        _communicator;
+    static Frontend *CreateFrontend(communicators::Communicator *c);
+    static void InitThreadSupport();
+    static void ReleaseFrontend(void *frontend);
+    /**
+     * Sends what is queued and ends the session, once: when the Frontend is
+     * destroyed or, for the threads still running, when the process exits.
+     */
+    void Finish();
+    static void ForgetFrontendsAfterFork();
+    bool GetRoutineId(const char *routine, uint32_t &routine_id);
+    uint64_t Send(uint32_t routine_id, uint32_t flags, const communicators::Buffer *input_buffer,
+                  Connection::Call *call, const void *transfer = nullptr,
+                  size_t transfer_size = 0);
+    /**
+     * Waits for the response of call.
+     *
+     * @return its exit code.
+     */
+    int ReadResult(Connection::Call &call);
+    /**
+     * Queues the result of an asynchronous request.
+     *
+     * @return where the result is received.
+     */
+    Connection::Call *AddPendingResult(bool batch, std::vector<std::string> families);
+    void FlushBatch();
+    /* sends the batch, mBatchMutex is held */
+    void SendBatch();
+    /**
+     * Locks the batch if it is older than the configured age, for the flusher
+     * thread to send it; it gives up if the Frontend is busy.
+     *
+     * @param queued set to true if a batch is left queued.
+     * @return the lock of mBatchMutex, not owned if there is nothing to send.
+     */
+    std::unique_lock<std::mutex> LockOldBatch(bool &queued);
+    /* the flusher thread: sends the batches queued for too long, see NotifyBatchQueued() */
+    static void FlushOldBatches(size_t max_age);
+    static void NotifyBatchQueued();
+    /* reads the oldest pending result into deferred, mBatchMutex is held */
+    void CollectPendingResult(DeferredExitCodes &deferred);
+    /* reads the pending results up to the last output on stream, mBatchMutex is held */
+    void CollectOutputs(const void *stream, bool all, DeferredExitCodes &deferred);
+    /**
+     * Opens the bulk lane of the session the first time a request has a
+     * transfer or a large output, see Connection::OpenBulkLane().
+     */
+    void OpenBulkLane();
+    std::shared_ptr<Connection> mpConnection;
+    uint64_t mSessionId = 0;
+    std::shared_ptr<communicators::Communicator> mpBulkLane;
+    bool mBulkLaneOpened = false;
     std::shared_ptr<communicators::Buffer> mpInputBuffer;
     std::shared_ptr<communicators::Buffer> mpOutputBuffer;
     std::shared_ptr<communicators::Buffer> mpLaunchBuffer;
 
     int mExitCode;
+    /* where the next Execute() receives its output, see SetOutputDestination() */
+    void *mpOutputDestination = nullptr;
+    size_t mOutputDestinationSize = 0;
+    /* the stream of the next asynchronous output, see SetOutputStream() */
+    const void *mpOutputStream = nullptr;
+    bool mOutputOnStream = false;
+    bool mOutputReceived = false;
+    /* what the next Execute() sends after the input buffer, see SetInputTransfer() */
+    const void *mpTransfer = nullptr;
+    size_t mTransferSize = 0;
+    size_t mTransferThreshold = SIZE_MAX;
+    /* the Frontend of the calling thread */
+    static thread_local Frontend *mspCurrent;
+    /* all the Frontends, for releasing the ones of the threads still running at exit */
     static std::map<pthread_t, Frontend *> *mpFrontends;
-    bool mpInitialized;
+    bool mpInitialized = false;
+    bool mFinished = false;
+
+    bool mAsync = false;
+    size_t mMaxPendingResults = 0;
+    /* Families of the routines of each result still to be read: a batch result
+     * carries one exit code per routine. */
+    struct PendingResult {
+        bool batch;
+        std::vector<std::string> families;
+        /* where the result is received */
+        std::unique_ptr<communicators::Buffer> output;
+        std::unique_ptr<Connection::Call> call;
+        /* the output lands on a stream, see SetOutputStream() */
+        bool on_stream = false;
+        const void *stream = nullptr;
+    };
+    std::deque<PendingResult> mPendingResults;
+    /* the pending results on a stream, read without mBatchMutex by SynchronizeOutputs() */
+    std::atomic<size_t> mPendingOutputs{0};
+    /* guards the batch and the pending results, shared with the flusher thread */
+    std::mutex mBatchMutex;
+    DeferredExitCodes mDeferredExitCodes;
+
+    std::shared_ptr<communicators::Batch> mpBatch;
+    std::vector<std::string> mBatchFamilies;
+    size_t mBatchMaxRoutines = 0;
+    size_t mBatchMaxSize = 0;
+    size_t mBatchMaxAge = 0; /* microseconds */
 
     uint64_t mRoutinesExecuted = 0;
     uint64_t mDataSent = 0;
@@ -31,6 +31,7 @@ using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
 
 std::map<string, CublasHandler::CublasRoutineHandler>* CublasHandler::mspHandlers = NULL;
+std::vector<CublasHandler::CublasRoutineHandler>* CublasHandler::mspHandlersById = NULL;
 
 extern "C" std::shared_ptr<CublasHandler> create_t() { return std::make_shared<CublasHandler>(); }
 
@@ -45,6 +46,12 @@ bool CublasHandler::CanExecute(std::string routine) {
     return mspHandlers->find(routine) != mspHandlers->end();
 }
 
+std::vector<std::string> CublasHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
 std::shared_ptr<Result> CublasHandler::Execute(std::string routine,
                                                std::shared_ptr<Buffer> input_buffer) {
     LOG4CPLUS_DEBUG(logger, "Called " << routine);
@@ -59,6 +66,16 @@ std::shared_ptr<Result> CublasHandler::Execute(std::string routine,
     return NULL;
 }
 
+std::shared_ptr<Result> CublasHandler::Execute(size_t routine_id,
+                                               std::shared_ptr<Buffer> input_buffer) {
+    try {
+        return mspHandlersById->at(routine_id)(this, input_buffer);
+    } catch (const std::exception& e) {
+        LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT("Exception: ") << e.what());
+    }
+    return NULL;
+}
+
 void CublasHandler::Initialize() {
     if (mspHandlers != NULL) return;
     mspHandlers = new map<string, CublasHandler::CublasRoutineHandler>();
@@ -285,4 +302,8 @@ void CublasHandler::Initialize() {
     /* CublasHandler Extension functions */
     mspHandlers->insert(CUBLAS_ROUTINE_HANDLER_PAIR(GemmEx));
     mspHandlers->insert(CUBLAS_ROUTINE_HANDLER_PAIR(GemmStridedBatchedEx));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<CublasHandler::CublasRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
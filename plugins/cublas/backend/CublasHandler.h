@@ -55,8 +55,11 @@ class CublasHandler : public gvirtus::backend::Handler {
     CublasHandler();
     virtual ~CublasHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<gvirtus::communicators::Result> Execute(
         std::string routine, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    std::shared_ptr<gvirtus::communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
     log4cplus::Logger &GetLogger() { return logger; }
 
    private:
@@ -65,6 +68,7 @@ class CublasHandler : public gvirtus::backend::Handler {
     typedef std::shared_ptr<gvirtus::communicators::Result> (*CublasRoutineHandler)(
         CublasHandler *, std::shared_ptr<gvirtus::communicators::Buffer>);
     static std::map<std::string, CublasRoutineHandler> *mspHandlers;
+    static std::vector<CublasRoutineHandler> *mspHandlersById;
 };
 
 #define CUBLAS_ROUTINE_HANDLER(name)                              \
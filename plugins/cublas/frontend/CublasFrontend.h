@@ -46,6 +46,16 @@ class CublasFrontend {
         gvirtus::frontend::Frontend::GetFrontend()->Execute(routine, input_buffer);
     }
 
+    /**
+     * Requests the execution of a routine without output parameters without
+     * waiting for its exit code. A failure is reported by the next cuBLAS
+     * routine through GetExitCode().
+     */
+    static inline void ExecuteAsync(const char *routine,
+                                    const gvirtus::communicators::Buffer *input_buffer = NULL) {
+        gvirtus::frontend::Frontend::GetFrontend()->ExecuteAsync(routine, input_buffer);
+    }
+
     /**
      * Prepares the Frontend for the execution. This method _must_ be called
      * before any requests of execution or any method for adding parameters for
@@ -84,12 +94,15 @@ class CublasFrontend {
      * The optional parameter n is usefull when adding an array: with n is
      * possible to specify the length of the array in terms of elements.
      *
+     * Large arrays are not copied but sent from ptr, which must not change
+     * until the request is executed.
+     *
      * @param ptr the pointer to add as a parameter.
      * @param n the length of the array, if ptr is an array.
      */
     template <class T>
     static inline void AddHostPointerForArguments(T *ptr, size_t n = 1) {
-        gvirtus::frontend::Frontend::GetFrontend()->GetInputBuffer()->Add(ptr, n);
+        gvirtus::frontend::Frontend::GetFrontend()->GetInputBuffer()->AddExternal(ptr, n);
     }
 
     /**
@@ -116,7 +129,12 @@ class CublasFrontend {
     }
 
     static inline cublasStatus_t GetExitCode() {
-        return (cublasStatus_t)gvirtus::frontend::Frontend::GetFrontend()->GetExitCode();
+        gvirtus::frontend::Frontend *frontend = gvirtus::frontend::Frontend::GetFrontend();
+        if (!frontend->Success(CUBLAS_STATUS_SUCCESS))
+            return (cublasStatus_t)frontend->GetExitCode();
+        // cuBLAS has no synchronizing routines: errors deferred by asynchronous executions
+        // are reported by the next routine
+        return (cublasStatus_t)frontend->GetDeferredExitCode("cublas");
     }
 
     static inline bool Success() {
@@ -152,7 +152,7 @@ cublasSscal_v2(cublasHandle_t handle, int n, const float *alpha, /* host or devi
     // CublasFrontend::AddDevicePointerForArguments(alpha);
     CublasFrontend::AddDevicePointerForArguments(x);
     CublasFrontend::AddVariableForArguments(incx);
-    CublasFrontend::Execute("cublasSscal_v2");
+    CublasFrontend::ExecuteAsync("cublasSscal_v2");
     return CublasFrontend::GetExitCode();
 }
 
@@ -166,7 +166,7 @@ cublasDscal_v2(cublasHandle_t handle, int n, const double *alpha, /* host or dev
     // CublasFrontend::AddDevicePointerForArguments(alpha);
     CublasFrontend::AddDevicePointerForArguments(x);
     CublasFrontend::AddVariableForArguments(incx);
-    CublasFrontend::Execute("cublasDscal_v2");
+    CublasFrontend::ExecuteAsync("cublasDscal_v2");
     return CublasFrontend::GetExitCode();
 }
 
@@ -238,7 +238,7 @@ extern "C" CUBLASAPI cublasStatus_t CUBLASWINAPI cublasSaxpy_v2(cublasHandle_t h
     CublasFrontend::AddDevicePointerForArguments(y);
     CublasFrontend::AddVariableForArguments<int>(incy);
 
-    CublasFrontend::Execute("cublasSaxpy_v2");
+    CublasFrontend::ExecuteAsync("cublasSaxpy_v2");
 
     return CublasFrontend::GetExitCode();
 }
@@ -256,7 +256,7 @@ extern "C" CUBLASAPI cublasStatus_t CUBLASWINAPI cublasDaxpy_v2(cublasHandle_t h
     CublasFrontend::AddDevicePointerForArguments(y);
     CublasFrontend::AddVariableForArguments<int>(incy);
 
-    CublasFrontend::Execute("cublasDaxpy_v2");
+    CublasFrontend::ExecuteAsync("cublasDaxpy_v2");
 
     return CublasFrontend::GetExitCode();
 }
@@ -308,7 +308,7 @@ extern "C" CUBLASAPI cublasStatus_t CUBLASWINAPI cublasScopy_v2(cublasHandle_t h
     CublasFrontend::AddDevicePointerForArguments(y);
     CublasFrontend::AddVariableForArguments<int>(incy);
 
-    CublasFrontend::Execute("cublasScopy_v2");
+    CublasFrontend::ExecuteAsync("cublasScopy_v2");
     return CublasFrontend::GetExitCode();
 }
 
@@ -323,7 +323,7 @@ extern "C" CUBLASAPI cublasStatus_t CUBLASWINAPI cublasDcopy_v2(cublasHandle_t h
     CublasFrontend::AddDevicePointerForArguments(y);
     CublasFrontend::AddVariableForArguments<int>(incy);
 
-    CublasFrontend::Execute("cublasDcopy_v2");
+    CublasFrontend::ExecuteAsync("cublasDcopy_v2");
     return CublasFrontend::GetExitCode();
 }
 
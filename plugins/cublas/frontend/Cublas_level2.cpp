@@ -43,7 +43,7 @@ extern "C" CUBLASAPI cublasStatus_t CUBLASWINAPI cublasSgemv_v2(
     CublasFrontend::AddHostPointerForArguments<const float>(beta);
     CublasFrontend::AddDevicePointerForArguments(y);
     CublasFrontend::AddVariableForArguments<int>(incy);
-    CublasFrontend::Execute("cublasSgemv_v2");
+    CublasFrontend::ExecuteAsync("cublasSgemv_v2");
     return CublasFrontend::GetExitCode();
 }
 
@@ -63,7 +63,7 @@ extern "C" CUBLASAPI cublasStatus_t CUBLASWINAPI cublasDgemv_v2(
     CublasFrontend::AddHostPointerForArguments<const double>(beta);
     CublasFrontend::AddDevicePointerForArguments(y);
     CublasFrontend::AddVariableForArguments<int>(incy);
-    CublasFrontend::Execute("cublasDgemv_v2");
+    CublasFrontend::ExecuteAsync("cublasDgemv_v2");
     return CublasFrontend::GetExitCode();
 }
 
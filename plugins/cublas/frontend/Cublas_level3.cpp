@@ -56,7 +56,7 @@ cublasSgemm_v2(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_
     CublasFrontend::AddHostPointerForArguments<const float>(beta);
     CublasFrontend::AddDevicePointerForArguments(C);
     CublasFrontend::AddVariableForArguments<int>(ldc);
-    CublasFrontend::Execute("cublasSgemm_v2");
+    CublasFrontend::ExecuteAsync("cublasSgemm_v2");
     return CublasFrontend::GetExitCode();
 }
 
@@ -113,7 +113,7 @@ cublasDgemm_v2(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_
     CublasFrontend::AddDevicePointerForArguments(C);
     CublasFrontend::AddVariableForArguments<int>(ldc);
 
-    CublasFrontend::Execute("cublasDgemm_v2");
+    CublasFrontend::ExecuteAsync("cublasDgemm_v2");
     return CublasFrontend::GetExitCode();
 }
 
@@ -1067,7 +1067,7 @@ cublasHgemm(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t t
             int k, const __half *alpha, const __half *A, int lda, const __half *B, int ldb,
             const __half *beta, __half *C, int ldc) {
     CublasFrontend::Prepare();
-    CublasFrontend::Execute("cublasHgemm");
+    CublasFrontend::ExecuteAsync("cublasHgemm");
     return CublasFrontend::GetExitCode();
 }
 
@@ -1078,7 +1078,7 @@ extern "C" CUBLASAPI cublasStatus_t CUBLASWINAPI cublasHgemmStridedBatched(
     long long int strideB, const __half *beta, __half *C, int ldc, long long int strideC,
     int batchCount) {
     CublasFrontend::Prepare();
-    CublasFrontend::Execute("cublasHgemmStridedBatched");
+    CublasFrontend::ExecuteAsync("cublasHgemmStridedBatched");
     return CublasFrontend::GetExitCode();
 }
 
@@ -1116,6 +1116,6 @@ extern "C" CUBLASAPI cublasStatus_t CUBLASWINAPI cublasSgemmStridedBatched(
     CublasFrontend::AddVariableForArguments<int>(ldc);
     CublasFrontend::AddVariableForArguments<long long int>(strideC);
     CublasFrontend::AddVariableForArguments<int>(batchCount);
-    CublasFrontend::Execute("cublasSgemmStridedBatched");
+    CublasFrontend::ExecuteAsync("cublasSgemmStridedBatched");
     return CublasFrontend::GetExitCode();
 }
\ No newline at end of file
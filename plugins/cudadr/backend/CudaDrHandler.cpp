@@ -37,6 +37,7 @@ using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
 
 map<string, CudaDrHandler::CudaDriverHandler> *CudaDrHandler::mspHandlers = NULL;
+std::vector<CudaDrHandler::CudaDriverHandler> *CudaDrHandler::mspHandlersById = NULL;
 
 extern "C" std::shared_ptr<CudaDrHandler> create_t() { return std::make_shared<CudaDrHandler>(); }
 
@@ -58,6 +59,26 @@ bool CudaDrHandler::CanExecute(std::string routine) {
     return true;
 }
 
+std::vector<std::string> CudaDrHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
+void CudaDrHandler::SaveThreadState(std::shared_ptr<void> &state) {
+    // the current context is the driver state that follows the connection
+    CUcontext context = NULL;
+    if (cuCtxGetCurrent(&context) != CUDA_SUCCESS) return;
+    if (state == nullptr) state = std::make_shared<CUcontext>();
+    *std::static_pointer_cast<CUcontext>(state) = context;
+}
+
+void CudaDrHandler::RestoreThreadState(const std::shared_ptr<void> &state) {
+    CUcontext context = state != nullptr ? *std::static_pointer_cast<CUcontext>(state) : NULL;
+    CUcontext current = NULL;
+    if (cuCtxGetCurrent(&current) == CUDA_SUCCESS && current != context) cuCtxSetCurrent(context);
+}
+
 std::shared_ptr<Result> CudaDrHandler::Execute(std::string routine,
                                                std::shared_ptr<Buffer> input_buffer) {
     map<string, CudaDrHandler::CudaDriverHandler>::iterator it;
@@ -68,6 +89,11 @@ std::shared_ptr<Result> CudaDrHandler::Execute(std::string routine,
     return it->second(this, input_buffer);
 }
 
+std::shared_ptr<Result> CudaDrHandler::Execute(size_t routine_id,
+                                               std::shared_ptr<Buffer> input_buffer) {
+    return mspHandlersById->at(routine_id)(this, input_buffer);
+}
+
 void CudaDrHandler::RegisterFatBinary(std::string &handler, void **fatCubinHandle) {
     map<string, void **>::iterator it = mpFatBinary->find(handler);
     if (it != mpFatBinary->end()) {
@@ -319,4 +345,8 @@ void CudaDrHandler::Initialize() {
 
     /* CudaDrHandler_unified */
     mspHandlers->insert(CUDA_DRIVER_HANDLER_PAIR(PointerGetAttribute));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<CudaDrHandler::CudaDriverHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
@@ -59,8 +59,13 @@ class CudaDrHandler : public gvirtus::backend::Handler {
     CudaDrHandler();
     virtual ~CudaDrHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<gvirtus::communicators::Result> Execute(
         std::string routine, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    std::shared_ptr<gvirtus::communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    void SaveThreadState(std::shared_ptr<void> &state);
+    void RestoreThreadState(const std::shared_ptr<void> &state);
 
     void RegisterFatBinary(std::string &handler, void **fatCubinHandle);
     void RegisterFatBinary(const char *handler, void **fatCubinHandle);
@@ -122,6 +127,7 @@ class CudaDrHandler : public gvirtus::backend::Handler {
     typedef std::shared_ptr<gvirtus::communicators::Result> (*CudaDriverHandler)(
         CudaDrHandler *, std::shared_ptr<gvirtus::communicators::Buffer>);
     static std::map<std::string, CudaDriverHandler> *mspHandlers;
+    static std::vector<CudaDriverHandler> *mspHandlersById;
     std::map<std::string, void **> *mpFatBinary;
     std::map<std::string, std::string> *mpDeviceFunction;
     std::map<std::string, std::string> *mpVar;
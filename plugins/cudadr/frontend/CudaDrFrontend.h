@@ -77,12 +77,15 @@ class CudaDrFrontend {
      * The optional parameter n is usefull when adding an array: with n is
      * possible to specify the length of the array in terms of elements.
      *
+     * Large arrays are not copied but sent from ptr, which must not change
+     * until the request is executed.
+     *
      * @param ptr the pointer to add as a parameter.
      * @param n the length of the array, if ptr is an array.
      */
     template <class T>
     static inline void AddHostPointerForArguments(T *ptr, size_t n = 1) {
-        gvirtus::frontend::Frontend::GetFrontend()->GetInputBuffer()->Add(ptr, n);
+        gvirtus::frontend::Frontend::GetFrontend()->GetInputBuffer()->AddExternal(ptr, n);
     }
 
     /**
@@ -0,0 +1,284 @@
+/*
+ * gVirtuS -- A GPGPU transparent virtualization component.
+ *
+ * Copyright (C) 2009-2010  The University of Napoli Parthenope at Naples.
+ *
+ * This file is part of gVirtuS.
+ *
+ * gVirtuS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gVirtuS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gVirtuS; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "AutoGraphs.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#define DEFAULT_REPETITIONS 3
+
+unsigned AutoGraphs::GetRepetitions(Logger &logger) {
+    const char *value = getenv("GVIRTUS_AUTO_GRAPHS");
+    if (value == nullptr || *value == '\0' || strcmp(value, "off") == 0) return 0;
+    unsigned repetitions =
+        strcmp(value, "on") == 0 ? DEFAULT_REPETITIONS : strtoul(value, NULL, 10);
+    if (repetitions > 0)
+        LOG4CPLUS_INFO(logger, "Replaying the launch sequences repeated " << repetitions
+                                                                          << " times as graphs");
+    return repetitions;
+}
+
+AutoGraphs::AutoGraphs(Logger &logger, unsigned repetitions)
+    : mLogger(logger), mRepetitions(repetitions) {}
+
+AutoGraphs::~AutoGraphs() {
+    for (auto &it : mStreams) Destroy(*it.second);
+}
+
+void **AutoGraphs::Call::GetParams(std::vector<void *> &params) const {
+    const std::vector<NvInfoArg> &layout = function->layout.args;
+    params.resize(std::max<size_t>(layout.size(), 1));
+    for (size_t i = 0; i < layout.size(); i++)
+        params[i] = (void *)(args.data() + layout[i].offset);
+    return params.data();
+}
+
+bool AutoGraphs::Call::Matches(const Call &other) const {
+    return function == other.function && gridDim.x == other.gridDim.x &&
+           gridDim.y == other.gridDim.y && gridDim.z == other.gridDim.z &&
+           blockDim.x == other.blockDim.x && blockDim.y == other.blockDim.y &&
+           blockDim.z == other.blockDim.z && sharedMem == other.sharedMem;
+}
+
+cudaError_t AutoGraphs::Launch(
+    const std::shared_ptr<const CudaRtHandler::RegisteredFunction> &function, dim3 gridDim,
+    dim3 blockDim, size_t sharedMem, cudaStream_t stream, const char *args) {
+    std::shared_ptr<Stream> s = GetStream(stream);
+
+    // the default streams wait for the others, and the others for them: what either side
+    // deferred goes first
+    if (IsDefault(stream) ? mPending.load() > mDefaultPending.load() : mDefaultPending.load() > 0) {
+        for (auto &other : GetStreams(s.get())) {
+            std::lock_guard<std::mutex> lock(other->mutex);
+            SetError(Issue(*other));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s->mutex);
+    uint64_t epoch = mEpoch.load();
+    if (s->epoch != epoch) {
+        EndSegment(*s);
+        s->epoch = epoch;
+    }
+
+    Call call{function, gridDim, blockDim, sharedMem, {}};
+    cudaError_t exit_code = cudaSuccess;
+    if (s->deferring) {
+        if (call.Matches(s->pattern[s->deferred])) {
+            Call &pending = s->pending[s->deferred++];
+            pending = std::move(call);
+            pending.args.assign(args, args + function->layout.size);
+            mPending++;
+            if (IsDefault(stream)) mDefaultPending++;
+            return s->deferred < s->pattern.size() ? cudaSuccess : Replay(*s);
+        }
+        exit_code = Issue(*s);
+        s->deferring = false;
+        s->repeated = 0;
+    }
+
+    if (s->segment.size() < MAX_SEGMENT)
+        s->segment.push_back(call);
+    else
+        s->ignored = true;
+    call.args.assign(args, args + function->layout.size);
+    cudaError_t launched = LaunchNow(call, stream);
+    return exit_code != cudaSuccess ? exit_code : launched;
+}
+
+void AutoGraphs::Flush() {
+    mEpoch++;
+    if (mPending.load() == 0) return;
+    for (auto &s : GetStreams(nullptr)) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        SetError(Issue(*s));
+    }
+}
+
+cudaError_t AutoGraphs::TakeError() {
+    if (mError.load() == cudaSuccess) return cudaSuccess;
+    return (cudaError_t)mError.exchange(cudaSuccess);
+}
+
+void AutoGraphs::Forget(cudaStream_t stream) {
+    int device = 0;
+    cudaGetDevice(&device);
+    std::shared_ptr<Stream> s;
+    {
+        std::lock_guard<std::mutex> lock(mStreamsMutex);
+        auto it = mStreams.find({device, stream});
+        if (it == mStreams.end()) return;
+        s = it->second;
+        mStreams.erase(it);
+    }
+    std::lock_guard<std::mutex> lock(s->mutex);
+    SetError(Issue(*s));
+    Destroy(*s);
+}
+
+std::shared_ptr<AutoGraphs::Stream> AutoGraphs::GetStream(cudaStream_t stream) {
+    // the default stream of each device is another one
+    int device = 0;
+    cudaGetDevice(&device);
+    std::lock_guard<std::mutex> lock(mStreamsMutex);
+    std::shared_ptr<Stream> &s = mStreams[{device, stream}];
+    if (s == nullptr) {
+        s = std::make_shared<Stream>();
+        s->stream = stream;
+    }
+    return s;
+}
+
+std::vector<std::shared_ptr<AutoGraphs::Stream>> AutoGraphs::GetStreams(const Stream *except) {
+    std::vector<std::shared_ptr<Stream>> streams;
+    std::lock_guard<std::mutex> lock(mStreamsMutex);
+    for (auto &it : mStreams)
+        if (it.second.get() != except) streams.push_back(it.second);
+    return streams;
+}
+
+void AutoGraphs::EndSegment(Stream &s) {
+    if (s.deferring) {
+        // cut short: what was deferred of it can't be replayed, the next one is learnt
+        if (s.deferred > 0) SetError(Issue(s));
+        s.ignored = false;
+        return;
+    }
+    bool ignored = s.ignored;
+    s.ignored = false;
+    if (s.segment.empty() || ignored) {
+        s.segment.clear();
+        return;
+    }
+
+    bool repeated = s.segment.size() == s.pattern.size();
+    for (size_t i = 0; repeated && i < s.segment.size(); i++)
+        repeated = s.segment[i].Matches(s.pattern[i]);
+    if (repeated) {
+        s.repeated++;
+        s.segment.clear();
+    } else {
+        Destroy(s);
+        std::swap(s.pattern, s.segment);
+        s.segment.clear();
+        s.repeated = 1;
+    }
+
+    // a single launch is as cheap as the launch of its graph
+    if (s.repeated >= mRepetitions && s.pattern.size() > 1 && !s.failed) {
+        s.deferring = true;
+        s.deferred = 0;
+        s.pending.resize(s.pattern.size());
+    }
+}
+
+cudaError_t AutoGraphs::Issue(Stream &s) {
+    if (s.deferred == 0) return cudaSuccess;
+    cudaError_t exit_code = cudaSuccess;
+    for (size_t i = 0; i < s.deferred; i++) {
+        cudaError_t launched = LaunchNow(s.pending[i], s.stream);
+        if (exit_code == cudaSuccess) exit_code = launched;
+    }
+    mPending -= s.deferred;
+    if (IsDefault(s.stream)) mDefaultPending -= s.deferred;
+    s.deferred = 0;
+    s.deferring = false;
+    s.repeated = 0;
+    // the launches issued are part of the segment, not learnt
+    s.segment.clear();
+    s.ignored = true;
+    return exit_code;
+}
+
+cudaError_t AutoGraphs::Replay(Stream &s) {
+    cudaError_t exit_code = cudaSuccess;
+    if (s.exec != nullptr) {
+        // the kernel nodes copy their arguments: only the ones that changed are set
+        std::vector<void *> params;
+        for (size_t i = 0; i < s.nodes.size() && exit_code == cudaSuccess; i++) {
+            const Call &call = s.pending[i];
+            if (call.args == s.args[i]) continue;
+            cudaKernelNodeParams node_params = {(void *)call.function->host, call.gridDim,
+                                                call.blockDim, (unsigned)call.sharedMem,
+                                                call.GetParams(params), nullptr};
+            exit_code = cudaGraphExecKernelNodeSetParams(s.exec, s.nodes[i], &node_params);
+            s.args[i] = call.args;
+        }
+        if (exit_code != cudaSuccess) {
+            LOG4CPLUS_DEBUG(mLogger, "AutoGraphs: graph not updated (" << exit_code
+                                                                       << "), building it again");
+            Destroy(s);
+        }
+    }
+    if (s.exec == nullptr && (exit_code = Build(s)) != cudaSuccess) {
+        LOG4CPLUS_WARN(mLogger, "AutoGraphs: cannot build the graph of a segment of "
+                                    << s.pattern.size() << " launches (" << exit_code << ")");
+        Destroy(s);
+        s.failed = true;
+        return Issue(s);
+    }
+
+    mPending -= s.deferred;
+    if (IsDefault(s.stream)) mDefaultPending -= s.deferred;
+    s.deferred = 0;
+    return cudaGraphLaunch(s.exec, s.stream);
+}
+
+cudaError_t AutoGraphs::Build(Stream &s) {
+    cudaError_t exit_code = cudaGraphCreate(&s.graph, 0);
+    s.nodes.assign(s.pending.size(), nullptr);
+    s.args.resize(s.pending.size());
+    // a chain, in the order of the stream
+    std::vector<void *> params;
+    for (size_t i = 0; i < s.pending.size() && exit_code == cudaSuccess; i++) {
+        const Call &call = s.pending[i];
+        cudaKernelNodeParams node_params = {(void *)call.function->host, call.gridDim,
+                                            call.blockDim, (unsigned)call.sharedMem,
+                                            call.GetParams(params), nullptr};
+        exit_code = cudaGraphAddKernelNode(&s.nodes[i], s.graph, i > 0 ? &s.nodes[i - 1] : nullptr,
+                                           i > 0 ? 1 : 0, &node_params);
+        s.args[i] = call.args;
+    }
+    if (exit_code == cudaSuccess) exit_code = cudaGraphInstantiate(&s.exec, s.graph, 0);
+    return exit_code;
+}
+
+cudaError_t AutoGraphs::LaunchNow(const Call &call, cudaStream_t stream) {
+    std::vector<void *> params;
+    return cudaLaunchKernel(call.function->host, call.gridDim, call.blockDim,
+                            call.GetParams(params), call.sharedMem, stream);
+}
+
+void AutoGraphs::Destroy(Stream &s) {
+    if (s.exec != nullptr) cudaGraphExecDestroy(s.exec);
+    if (s.graph != nullptr) cudaGraphDestroy(s.graph);
+    s.exec = nullptr;
+    s.graph = nullptr;
+    s.nodes.clear();
+    s.args.clear();
+}
+
+void AutoGraphs::SetError(cudaError_t error) {
+    int success = cudaSuccess;
+    if (error != cudaSuccess) mError.compare_exchange_strong(success, error);
+}
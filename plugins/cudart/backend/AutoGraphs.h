@@ -0,0 +1,172 @@
+/*
+ * gVirtuS -- A GPGPU transparent virtualization component.
+ *
+ * Copyright (C) 2009-2010  The University of Napoli Parthenope at Naples.
+ *
+ * This file is part of gVirtuS.
+ *
+ * gVirtuS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gVirtuS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gVirtuS; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef AUTOGRAPHS_H
+#define AUTOGRAPHS_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "CudaRtHandler.h"
+
+/**
+ * AutoGraphs replays the kernel launches an application repeats, e.g. the
+ * steps of a training or of a decode loop, as CUDA graphs.
+ *
+ * The launches on a stream are split in segments by every other routine
+ * (see Flush()). When the same segment, the same kernels with the same
+ * configurations, comes GVIRTUS_AUTO_GRAPHS times in a row, the next
+ * launches are deferred instead: once they make up the segment once more
+ * they are launched as a graph, built from the first of them, kernel node
+ * after kernel node, and later updated with the arguments that changed.
+ * Launches that don't make up the segment, or a segment cut short, are
+ * issued as they came and the stream goes back to learning.
+ *
+ * Each frontend process has its own, shared by its threads whichever of
+ * its connections they use (see Handler::RestoreClientState()): the
+ * routines of one thread issue what the others deferred, as they may wait
+ * for it, e.g. with cudaStreamSynchronize(), and never see the launches or
+ * the errors of another frontend.
+ */
+class AutoGraphs {
+   public:
+    /**
+     * @return the repetitions of GVIRTUS_AUTO_GRAPHS ("on", or the
+     * repetitions before a segment is replayed), 0 if it is off.
+     */
+    static unsigned GetRepetitions(Logger &logger);
+
+    AutoGraphs(Logger &logger, unsigned repetitions);
+    /* the launches still deferred are dropped with their frontend */
+    ~AutoGraphs();
+
+    /**
+     * Launches function on stream, or defers it; args are packed as its
+     * layout says.
+     */
+    cudaError_t Launch(const std::shared_ptr<const CudaRtHandler::RegisteredFunction> &function,
+                       dim3 gridDim, dim3 blockDim, size_t sharedMem, cudaStream_t stream,
+                       const char *args);
+
+    /**
+     * Ends the segments of all the streams, issuing the launches deferred:
+     * called before any routine but a launch.
+     */
+    void Flush();
+
+    /**
+     * @return the first error of a launch issued late, cleared.
+     */
+    cudaError_t TakeError();
+
+    /**
+     * @return the first error of a launch issued late, left for TakeError().
+     */
+    cudaError_t PeekError() const { return (cudaError_t)mError.load(); }
+
+    /**
+     * Drops the graph of stream, destroyed.
+     */
+    void Forget(cudaStream_t stream);
+
+   private:
+    /* a launch, its arguments packed */
+    struct Call {
+        std::shared_ptr<const CudaRtHandler::RegisteredFunction> function;
+        dim3 gridDim;
+        dim3 blockDim;
+        size_t sharedMem;
+        std::vector<char> args;
+
+        /* the pointers to the arguments, as cudaLaunchKernel() wants them */
+        void **GetParams(std::vector<void *> &params) const;
+        /* true if other launches the same kernel with the same configuration */
+        bool Matches(const Call &other) const;
+    };
+
+    struct Stream {
+        std::mutex mutex;
+        cudaStream_t stream;
+        /* the value of mEpoch at the last launch: when it changes, the segment is over */
+        uint64_t epoch = 0;
+        /* the segment being learnt, without arguments */
+        std::vector<Call> segment;
+        /* set when the segment is not to be learnt: too long, or cut by launches issued late */
+        bool ignored = false;
+        /* the last segment, repeated times in a row */
+        std::vector<Call> pattern;
+        unsigned repeated = 0;
+        /* the launches of pattern deferred, in pending[0, deferred) */
+        bool deferring = false;
+        std::vector<Call> pending;
+        size_t deferred = 0;
+        /* the graph of pattern, its nodes and the arguments it has */
+        cudaGraph_t graph = nullptr;
+        cudaGraphExec_t exec = nullptr;
+        std::vector<cudaGraphNode_t> nodes;
+        std::vector<std::vector<char>> args;
+        /* set when the graph can't be built: the stream is never deferred again */
+        bool failed = false;
+    };
+
+    /* the state of stream on the current device */
+    std::shared_ptr<Stream> GetStream(cudaStream_t stream);
+    /* all the streams but except */
+    std::vector<std::shared_ptr<Stream>> GetStreams(const Stream *except);
+    /* ends the segment of s and learns it; s->mutex is held */
+    void EndSegment(Stream &s);
+    /* issues the launches deferred on s and goes back to learning; s->mutex is held */
+    cudaError_t Issue(Stream &s);
+    /* launches the graph of pattern with the arguments of pending; s->mutex is held */
+    cudaError_t Replay(Stream &s);
+    /* builds the graph of s from pending */
+    cudaError_t Build(Stream &s);
+    /* issues call on stream as it came */
+    static cudaError_t LaunchNow(const Call &call, cudaStream_t stream);
+    void Destroy(Stream &s);
+    void SetError(cudaError_t error);
+
+    /* the legacy and the per-thread default streams, synchronized with the others */
+    static inline bool IsDefault(cudaStream_t stream) {
+        return stream == 0 || stream == cudaStreamLegacy || stream == cudaStreamPerThread;
+    }
+
+    /* the longest segment learnt */
+    static constexpr size_t MAX_SEGMENT = 4096;
+
+    Logger &mLogger;
+    const unsigned mRepetitions;
+    /* bumped by every Flush(): the streams see their segment is over lazily */
+    std::atomic<uint64_t> mEpoch{1};
+    /* launches deferred, on any stream and on the default ones */
+    std::atomic<size_t> mPending{0};
+    std::atomic<size_t> mDefaultPending{0};
+    std::atomic<int> mError{cudaSuccess};
+    std::mutex mStreamsMutex;
+    std::map<std::pair<int, cudaStream_t>, std::shared_ptr<Stream>> mStreams;
+};
+
+#endif /* AUTOGRAPHS_H */
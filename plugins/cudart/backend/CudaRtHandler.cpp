@@ -28,23 +28,39 @@
 
 #include "CudaRtHandler.h"
 
+#include <set>
+
+#include "AutoGraphs.h"
+
 using namespace std;
 using namespace log4cplus;
 
 map<string, CudaRtHandler::CudaRoutineHandler> *CudaRtHandler::mspHandlers = NULL;
+std::vector<CudaRtHandler::CudaRoutineHandler> *CudaRtHandler::mspHandlersById = NULL;
+std::vector<bool> *CudaRtHandler::mspFlushesById = NULL;
+thread_local CudaRtHandler::FrontendState *CudaRtHandler::stFrontend = nullptr;
 
 extern "C" std::shared_ptr<CudaRtHandler> create_t() { return std::make_shared<CudaRtHandler>(); }
 
+/* page-locked staging buffers, copied to and from the device asynchronously */
+static void *allocatePinned(size_t size) {
+    void *ptr = nullptr;
+    if (cudaHostAlloc(&ptr, size, cudaHostAllocPortable) != cudaSuccess) return nullptr;
+    return ptr;
+}
+
+static void releasePinned(void *ptr) { cudaFreeHost(ptr); }
+
 CudaRtHandler::CudaRtHandler() {
     logger = Logger::getInstance(LOG4CPLUS_TEXT("CudaRtHandler"));
+    Transfer::SetChunkAllocator(allocatePinned, releasePinned);
     mpFatBinary = new map<string, void **>();
     mpDeviceFunction = new map<string, string>();
-    mpVar = new map<string, string>();
     mpTexture = new map<string, cudaTextureObject_t *>();
     mpSurface = new map<string, cudaSurfaceObject_t *>();
 
-    mapHost2DeviceFunc = new map<const void *, std::string>();
     mapDeviceFunc2InfoFunc = new map<std::string, NvInfoFunction>();
+    mAutoGraphsRepetitions = AutoGraphs::GetRepetitions(logger);
     Initialize();
 }
 
@@ -57,6 +73,38 @@ bool CudaRtHandler::CanExecute(std::string routine) {
     return true;
 }
 
+std::vector<std::string> CudaRtHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
+void CudaRtHandler::SaveThreadState(std::shared_ptr<void> &state) {
+    // the current device is the runtime state that follows the connection
+    int device = 0;
+    if (cudaGetDevice(&device) != cudaSuccess) return;
+    if (state == nullptr) state = std::make_shared<int>();
+    *std::static_pointer_cast<int>(state) = device;
+}
+
+void CudaRtHandler::RestoreThreadState(const std::shared_ptr<void> &state) {
+    int device = state != nullptr ? *std::static_pointer_cast<int>(state) : 0;
+    int current;
+    if (cudaGetDevice(&current) == cudaSuccess && current != device) cudaSetDevice(device);
+}
+
+void CudaRtHandler::RestoreClientState(std::shared_ptr<void> &state) {
+    // the kernels and the variables of a frontend are registered by any of its threads, on any
+    // of its connections, and any of them can wait for the launches of the others
+    if (state == nullptr) {
+        auto frontend = std::make_shared<FrontendState>(this);
+        if (mAutoGraphsRepetitions > 0)
+            frontend->autoGraphs = std::make_unique<AutoGraphs>(logger, mAutoGraphsRepetitions);
+        state = frontend;
+    }
+    stFrontend = static_cast<FrontendState *>(state.get());
+}
+
 std::shared_ptr<Result> CudaRtHandler::Execute(std::string routine,
                                                std::shared_ptr<Buffer> input_buffer) {
     map<string, CudaRtHandler::CudaRoutineHandler>::iterator it;
@@ -66,6 +114,26 @@ std::shared_ptr<Result> CudaRtHandler::Execute(std::string routine,
     return it->second(this, input_buffer);
 }
 
+std::shared_ptr<Result> CudaRtHandler::Execute(size_t routine_id,
+                                               std::shared_ptr<Buffer> input_buffer) {
+    AutoGraphs *autoGraphs = GetAutoGraphs();
+    if (autoGraphs == nullptr || !mspFlushesById->at(routine_id))
+        return mspHandlersById->at(routine_id)(this, input_buffer);
+
+    // the launches deferred go first, and their errors are the ones of the routine
+    autoGraphs->Flush();
+    cudaError_t deferred = autoGraphs->TakeError();
+    std::shared_ptr<Result> result = mspHandlersById->at(routine_id)(this, input_buffer);
+    if (deferred != cudaSuccess && result->GetExitCode() == cudaSuccess)
+        return std::make_shared<Result>(deferred);
+    return result;
+}
+
+void CudaRtHandler::Flush() {
+    AutoGraphs *autoGraphs = GetAutoGraphs();
+    if (autoGraphs != nullptr) autoGraphs->Flush();
+}
+
 void CudaRtHandler::RegisterFatBinary(std::string &handler, void **fatCubinHandle) {
     map<string, void **>::iterator it = mpFatBinary->find(handler);
     if (it != mpFatBinary->end()) {
@@ -131,32 +199,6 @@ const char *CudaRtHandler::GetDeviceFunction(const char *handler) {
     return GetDeviceFunction(tmp);
 }
 
-void CudaRtHandler::RegisterVar(string &handler, string &symbol) {
-    logger = Logger::getInstance(LOG4CPLUS_TEXT("RegisterVar"));
-    LOG4CPLUS_DEBUG(logger, "Registering Var " << symbol << " with handler " << handler);
-    mpVar->insert(make_pair(handler, symbol));
-    LOG4CPLUS_DEBUG(logger, "Registered Var " << symbol << " with handler " << handler);
-}
-
-void CudaRtHandler::RegisterVar(const char *handler, const char *symbol) {
-    logger = Logger::getInstance(LOG4CPLUS_TEXT("RegisterVar"));
-    LOG4CPLUS_DEBUG(logger, "Registering Var " << symbol << " with handler " << handler);
-    string tmp1(handler);
-    string tmp2(symbol);
-    RegisterVar(tmp1, tmp2);
-}
-
-const char *CudaRtHandler::GetVar(string &handler) {
-    map<string, string>::iterator it = mpVar->find(handler);
-    if (it == mpVar->end()) return NULL;
-    return it->second.c_str();
-}
-
-const char *CudaRtHandler::GetVar(const char *handler) {
-    string tmp(handler);
-    return GetVar(tmp);
-}
-
 // void CudaRtHandler::RegisterTexture(string &handler, cudaTextureObject_t*
 // texref) {
 //   mpTexture->insert(make_pair(handler, texref));
@@ -221,12 +263,11 @@ const char *CudaRtHandler::GetVar(const char *handler) {
 //   return NULL;
 // }
 
-const char *CudaRtHandler::GetSymbol(std::shared_ptr<Buffer> in) {
-    char *symbol_handler = in->AssignString();
-    char *symbol = in->AssignString();
-    char *our_symbol = const_cast<char *>(GetVar(symbol_handler));
-    if (our_symbol != NULL) symbol = const_cast<char *>(our_symbol);
-    return symbol;
+const void *CudaRtHandler::GetSymbol(std::shared_ptr<Buffer> in) {
+    uint32_t id = in->Get<uint32_t>();
+    std::shared_lock<std::shared_mutex> lock(mRegistrationsMutex);
+    if (stFrontend == nullptr || stFrontend->vars.count(id) == 0) return nullptr;
+    return mVars[id];
 }
 
 void CudaRtHandler::Initialize() {
@@ -284,6 +325,7 @@ void CudaRtHandler::Initialize() {
     mspHandlers->insert(CUDA_ROUTINE_HANDLER_PAIR(LaunchKernel));
     /* CudaRtHandler_internal */
     mspHandlers->insert(CUDA_ROUTINE_HANDLER_PAIR(RegisterFatBinary));
+    mspHandlers->insert(CUDA_ROUTINE_HANDLER_PAIR(RegisterCachedFatBinary));
     mspHandlers->insert(CUDA_ROUTINE_HANDLER_PAIR(RegisterFatBinaryEnd));
     mspHandlers->insert(CUDA_ROUTINE_HANDLER_PAIR(UnregisterFatBinary));
     mspHandlers->insert(CUDA_ROUTINE_HANDLER_PAIR(RegisterFunction));
@@ -360,4 +402,18 @@ void CudaRtHandler::Initialize() {
     mspHandlers->insert(CUDA_ROUTINE_HANDLER_PAIR(FuncSetCacheConfig));
     /* CudaRtHandler_api*/
     mspHandlers->insert(CUDA_ROUTINE_HANDLER_PAIR(FuncSetAttribute));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<CudaRtHandler::CudaRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
+
+    // the routines the launches AutoGraphs defers don't have to precede: every other one ends
+    // the segments of the streams. cudaGetLastError() and cudaPeekAtLastError() issue them
+    // themselves, as they return their errors without taking them as their own
+    static const set<string> unordered = {"cudaLaunchKernel", "cudaGetLastError",
+                                          "cudaPeekAtLastError", "cudaGetDevice",
+                                          "cudaGetDeviceCount", "cudaGetDeviceProperties",
+                                          "cudaDeviceGetAttribute", "cudaGetErrorString"};
+    mspFlushesById = new vector<bool>();
+    for (auto &it : *mspHandlers) mspFlushesById->push_back(unordered.count(it.first) == 0);
 }
\ No newline at end of file
@@ -46,7 +46,12 @@
 #include <cstdio>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include "log4cplus/configurator.h"
 #include "log4cplus/logger.h"
@@ -65,13 +70,23 @@ using namespace log4cplus;
 using gvirtus::common::pointer_t;
 using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
+using gvirtus::communicators::Transfer;
+
+class AutoGraphs;
 
 class CudaRtHandler : public gvirtus::backend::Handler {
    public:
     CudaRtHandler();
     virtual ~CudaRtHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<Result> Execute(std::string routine, std::shared_ptr<Buffer> input_buffer);
+    std::shared_ptr<Result> Execute(size_t routine_id, std::shared_ptr<Buffer> input_buffer);
+    void SaveThreadState(std::shared_ptr<void> &state);
+    void RestoreThreadState(const std::shared_ptr<void> &state);
+    void RestoreClientState(std::shared_ptr<void> &state);
+    void Flush();
+    bool Defers() { return mAutoGraphsRepetitions > 0; }
 
     void RegisterFatBinary(std::string &handler, void **fatCubinHandle);
     void RegisterFatBinary(const char *handler, void **fatCubinHandle);
@@ -81,17 +96,120 @@ class CudaRtHandler : public gvirtus::backend::Handler {
     void UnregisterFatBinary(std::string &handler);
     void UnregisterFatBinary(const char *handler);
 
+    /**
+     * A fat binary registered with the CUDA runtime once for all the
+     * frontends that register the same content: its module, loaded on the
+     * device once, is shared by their sessions. It is cached by the hash of
+     * its content, see CudaUtil::HashFatCudaBinary(), and so is registered
+     * again by a frontend without uploading it.
+     */
+    struct CachedFatBinary {
+        std::string hash;
+        __fatBinC_Wrapper_t *bin = nullptr;
+        void **handle = nullptr;
+        /* the kernels of its cubins, with their parameters */
+        std::vector<std::pair<std::string, NvInfoFunction>> functions;
+        /* the registrations not unregistered yet, by handler */
+        std::map<std::string, unsigned> handlers;
+        bool ended = false;
+        /* the host functions its kernels are registered with, by device function */
+        std::map<std::string, const void *> kernels;
+        /* the host shadows its variables are registered with, by device name */
+        std::map<std::string, std::unique_ptr<char[]>> vars;
+
+        ~CachedFatBinary();
+    };
+
+    /**
+     * Registers fatBinary, uploaded by a frontend, for handler: if a fat
+     * binary with the same hash is cached already, that one is registered
+     * instead, and fatBinary is dropped.
+     */
+    void RegisterFatBinary(const char *handler, std::shared_ptr<CachedFatBinary> fatBinary);
+    /**
+     * Registers the fat binary with hash for handler, from memory or from
+     * the directory of GVIRTUS_FATBIN_CACHE.
+     *
+     * @return false if it is in neither: the frontend has to upload it.
+     */
+    bool RegisterCachedFatBinary(const char *handler, const std::string &hash);
+    /**
+     * Ends the registration of the fat binary of handler, once for all the
+     * frontends sharing it.
+     */
+    void EndFatBinary(const char *handler);
+    /**
+     * Unregisters handler, and the fat binary from the CUDA runtime when no
+     * other frontend has it registered.
+     */
+    void ReleaseFatBinary(const char *handler);
+
     void RegisterDeviceFunction(std::string &handler, std::string &function);
     void RegisterDeviceFunction(const char *handler, const char *function);
     const char *GetDeviceFunction(std::string &handler);
     const char *GetDeviceFunction(const char *handler);
 
-    void RegisterVar(std::string &handler, std::string &deviceName);
-    void RegisterVar(const char *handler, const char *deviceName);
-    const char *GetVar(std::string &handler);
-    const char *GetVar(const char *handler);
+    /**
+     * A kernel registered by a frontend. The routines name it by the id
+     * AddFunction() gave it, an index in mFunctions, instead of by its host
+     * function and its name.
+     */
+    struct RegisteredFunction {
+        /* the host function it is registered with in the CUDA runtime */
+        const void *host;
+        /* false if its fat binary has no parameters for it: it cannot be launched */
+        bool found;
+        NvInfoArgsLayout layout;
+    };
 
-    const char *GetSymbol(std::shared_ptr<Buffer> in);
+    /**
+     * Registers the kernel deviceFun of the fat binary of handler with
+     * hostFun, once for all the frontends sharing the fat binary: the others
+     * get the host function of the first.
+     *
+     * @return its id, NO_REGISTRATION_ID if the fat binary has ended
+     * without it.
+     */
+    uint32_t RegisterFunction(const char *handler, const char *hostFun, char *deviceFun,
+                              const char *deviceName, int threadLimit, uint3 *tid, uint3 *bid,
+                              dim3 *bDim, dim3 *gDim, int *wSize);
+    /**
+     * Gives an id to the kernel registered in the fat binary of handler with
+     * host, and finds the layout of its arguments once.
+     */
+    uint32_t AddFunction(const char *handler, const void *host, const std::string &deviceFun);
+    /**
+     * @return the kernel with id, nullptr if there is none or if the
+     * frontend of the current session did not register it.
+     */
+    std::shared_ptr<const RegisteredFunction> GetFunction(uint32_t id);
+
+    /**
+     * Registers a variable of the fat binary of handler with a host shadow
+     * of size bytes, kept until the fat binary is unregistered: the
+     * frontends sharing the fat binary share the shadow, registered once.
+     *
+     * @return its id, NO_REGISTRATION_ID if the fat binary has ended
+     * without it.
+     */
+    uint32_t RegisterVar(const char *handler, char *deviceAddress, const char *deviceName,
+                         int ext, int size, int constant, int global);
+
+    /**
+     * Reads the id of a variable, a symbol, from in.
+     *
+     * @return the host shadow it is registered with, nullptr if there is none
+     * or if the frontend of the current session did not register it.
+     */
+    const void *GetSymbol(std::shared_ptr<Buffer> in);
+
+    /**
+     * @return the AutoGraphs of the frontend of the current session,
+     * nullptr if GVIRTUS_AUTO_GRAPHS is off.
+     */
+    AutoGraphs *GetAutoGraphs() {
+        return stFrontend != nullptr ? stFrontend->autoGraphs.get() : nullptr;
+    }
 
     Logger &GetLogger() { return logger; }
 
@@ -99,27 +217,6 @@ class CudaRtHandler : public gvirtus::backend::Handler {
         mapDeviceFunc2InfoFunc->insert(make_pair(deviceFunc, infoFunction));
     }
 
-    inline NvInfoFunction getInfoFunc(std::string deviceFunc) {
-        if (mapDeviceFunc2InfoFunc->find(deviceFunc) == mapDeviceFunc2InfoFunc->end()) {
-            LOG4CPLUS_ERROR(logger,
-                            "getInfoFunc: device function '" << deviceFunc << "' not found");
-            throw std::runtime_error("getInfoFunc: device function not found");
-        }
-        return mapDeviceFunc2InfoFunc->find(deviceFunc)->second;
-    };
-
-    inline void addHost2DeviceFunc(const void *hostFunc, std::string deviceFunc) {
-        mapHost2DeviceFunc->insert(make_pair(hostFunc, deviceFunc));
-    }
-
-    inline std::string getDeviceFunc(const void *hostFunc) {
-        if (mapHost2DeviceFunc->find(hostFunc) == mapHost2DeviceFunc->end()) {
-            LOG4CPLUS_ERROR(logger, "getDeviceFunc: host function '" << hostFunc << "' not found");
-            throw std::runtime_error("getDeviceFunc: host function not found");
-        }
-        return mapHost2DeviceFunc->find(hostFunc)->second;
-    };
-
     static void hexdump(void *ptr, int buflen) {
         unsigned char *buf = (unsigned char *)ptr;
         int i, j;
@@ -142,15 +239,56 @@ class CudaRtHandler : public gvirtus::backend::Handler {
     void Initialize();
     typedef std::shared_ptr<Result> (*CudaRoutineHandler)(CudaRtHandler *, std::shared_ptr<Buffer>);
     static std::map<std::string, CudaRoutineHandler> *mspHandlers;
+    static std::vector<CudaRoutineHandler> *mspHandlersById;
+    /* false for the routines that don't see the launches AutoGraphs defers, by id */
+    static std::vector<bool> *mspFlushesById;
     std::map<std::string, void **> *mpFatBinary;
     std::map<std::string, std::string> *mpDeviceFunction;
-    std::map<std::string, std::string> *mpVar;
     std::map<std::string, cudaTextureObject_t *> *mpTexture;
     std::map<std::string, cudaSurfaceObject_t *> *mpSurface;
     map<std::string, NvInfoFunction> *mapDeviceFunc2InfoFunc;
-    map<const void *, std::string> *mapHost2DeviceFunc;
     void *mpShm;
     int mShmFd;
+    /* the fat binaries registered, by hash and by handler */
+    std::mutex mFatBinaryCacheMutex;
+    std::map<std::string, std::shared_ptr<CachedFatBinary>> mFatBinaryCache;
+    std::map<std::string, std::shared_ptr<CachedFatBinary>> mCachedFatBinaryByHandler;
+    /* registers fatBinary, cached already, for handler; mFatBinaryCacheMutex is held */
+    void AddFatBinaryHandler(const char *handler,
+                             const std::shared_ptr<CachedFatBinary> &fatBinary);
+    /* the kernels and the variables registered, by id, and the ids to reuse */
+    std::shared_mutex mRegistrationsMutex;
+    std::vector<std::shared_ptr<const RegisteredFunction>> mFunctions;
+    std::vector<const void *> mVars;
+    std::vector<uint32_t> mFreeFunctionIds;
+    std::vector<uint32_t> mFreeVarIds;
+    /* the ids given to the kernels and the variables of each fat binary, by handler */
+    std::map<std::string, std::vector<uint32_t>> mFunctionIdsByHandler;
+    std::map<std::string, std::vector<uint32_t>> mVarIdsByHandler;
+    /* the state of a frontend process, shared by its sessions: see RestoreClientState() */
+    struct FrontendState {
+        explicit FrontendState(CudaRtHandler *owner) : owner(owner) {}
+        /* releases the fat binaries it left registered, e.g. if the frontend crashed */
+        ~FrontendState();
+        CudaRtHandler *owner;
+        /* its registrations, by handler; mFatBinaryCacheMutex guards them */
+        std::map<std::string, unsigned> fatBinaries;
+        /* the ids given to it, the only ones it may use; mRegistrationsMutex guards them */
+        std::set<uint32_t> functions;
+        std::set<uint32_t> vars;
+        /* its launches, replayed as graphs; nullptr if GVIRTUS_AUTO_GRAPHS is off */
+        std::unique_ptr<AutoGraphs> autoGraphs;
+    };
+    /* the one of the frontend whose session runs on this thread, kept by its Client */
+    static thread_local FrontendState *stFrontend;
+    /* releases count registrations of the fat binary of handler made by frontend */
+    void ReleaseFatBinary(const std::string &handler, FrontendState &frontend, unsigned count);
+    /* takes the ids of the fat binary of handler away from frontend */
+    void ForgetIds(const std::string &handler, FrontendState &frontend);
+    /* gives back the ids of the fat binary of handler, unregistered */
+    void ReleaseIds(const std::string &handler);
+    /* the repetitions of GVIRTUS_AUTO_GRAPHS, 0 if it is off */
+    unsigned mAutoGraphsRepetitions;
 };
 
 #define CUDA_ROUTINE_HANDLER(name) \
@@ -210,6 +348,7 @@ CUDA_ROUTINE_HANDLER(PopCallConfiguration);
 
 /* CudaRtHandler_internal */
 CUDA_ROUTINE_HANDLER(RegisterFatBinary);
+CUDA_ROUTINE_HANDLER(RegisterCachedFatBinary);
 CUDA_ROUTINE_HANDLER(RegisterFatBinaryEnd);
 CUDA_ROUTINE_HANDLER(UnregisterFatBinary);
 CUDA_ROUTINE_HANDLER(RegisterFunction);
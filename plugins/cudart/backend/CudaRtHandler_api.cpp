@@ -27,11 +27,12 @@
 #include "CudaRtHandler.h"
 
 CUDA_ROUTINE_HANDLER(FuncSetAttribute) {
-    const void* func = input_buffer->Get<const void*>();
+    auto function = pThis->GetFunction(input_buffer->Get<uint32_t>());
+    if (function == nullptr) return std::make_shared<Result>(cudaErrorInvalidDeviceFunction);
     cudaFuncAttribute attr = input_buffer->Get<cudaFuncAttribute>();
     int value = input_buffer->Get<int>();
 
-    cudaError_t err = cudaFuncSetAttribute(func, attr, value);
+    cudaError_t err = cudaFuncSetAttribute(function->host, attr, value);
     LOG4CPLUS_DEBUG(pThis->GetLogger(), "cudaFuncSetAttribute executed with status: " << err);
 
     return std::make_shared<Result>(err);
@@ -28,6 +28,8 @@
 
 #include "CudaRtHandler.h"
 
+#include "AutoGraphs.h"
+
 CUDA_ROUTINE_HANDLER(GetErrorString) {
     /* const char* cudaGetErrorString(cudaError_t error) */
 
@@ -46,10 +48,20 @@ CUDA_ROUTINE_HANDLER(GetErrorString) {
 
 CUDA_ROUTINE_HANDLER(PeekAtLastError) {
     /* cudaError_t  cudaPeekAtLastError(void) */
-    return std::make_shared<Result>(cudaPeekAtLastError());
+    // the launches deferred are issued first: their errors are the last ones
+    AutoGraphs *autoGraphs = pThis->GetAutoGraphs();
+    if (autoGraphs != nullptr) autoGraphs->Flush();
+    cudaError_t error = cudaPeekAtLastError();
+    if (autoGraphs != nullptr && autoGraphs->PeekError() != cudaSuccess)
+        error = autoGraphs->PeekError();
+    return std::make_shared<Result>(error);
 }
 
 CUDA_ROUTINE_HANDLER(GetLastError) {
     /* cudaError_t cudaGetLastError(void) */
-    return std::make_shared<Result>(cudaGetLastError());
+    AutoGraphs *autoGraphs = pThis->GetAutoGraphs();
+    if (autoGraphs != nullptr) autoGraphs->Flush();
+    cudaError_t error = cudaGetLastError();
+    cudaError_t deferred = autoGraphs != nullptr ? autoGraphs->TakeError() : cudaSuccess;
+    return std::make_shared<Result>(deferred != cudaSuccess ? deferred : error);
 }
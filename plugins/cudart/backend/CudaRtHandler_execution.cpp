@@ -26,6 +26,7 @@
  *             Department of Computer Science, University College Dublin
  */
 
+#include "AutoGraphs.h"
 #include "CudaRtHandler.h"
 #include "cuda_runtime_compat.h"
 
@@ -46,12 +47,14 @@ CUDA_ROUTINE_HANDLER(ConfigureCall) {
 CUDA_ROUTINE_HANDLER(FuncGetAttributes) {
     try {
         cudaFuncAttributes *guestAttr = input_buffer->Assign<cudaFuncAttributes>();
-        const char *handler = (const char *)(input_buffer->Get<pointer_t>());
+        // the host function of the kernel here, registered by another frontend if it was first
+        auto function = pThis->GetFunction(input_buffer->Get<uint32_t>());
+        if (function == nullptr) return std::make_shared<Result>(cudaErrorInvalidDeviceFunction);
         std::shared_ptr<Buffer> out = std::make_shared<Buffer>();
 
         cudaFuncAttributes *attr = out->Delegate<cudaFuncAttributes>();
         memmove(attr, guestAttr, sizeof(cudaFuncAttributes));
-        cudaError_t exit_code = cudaFuncGetAttributes(attr, handler);
+        cudaError_t exit_code = cudaFuncGetAttributes(attr, function->host);
         return std::make_shared<Result>(exit_code, out);
     } catch (const std::exception &e) {
         cerr << e.what() << endl;
@@ -61,11 +64,12 @@ CUDA_ROUTINE_HANDLER(FuncGetAttributes) {
 
 CUDA_ROUTINE_HANDLER(FuncSetCacheConfig) {
     try {
-        const char *handler = (const char *)(input_buffer->Get<pointer_t>());
+        auto function = pThis->GetFunction(input_buffer->Get<uint32_t>());
+        if (function == nullptr) return std::make_shared<Result>(cudaErrorInvalidDeviceFunction);
         cudaFuncCache cacheConfig = input_buffer->Get<cudaFuncCache>();
         std::shared_ptr<Buffer> out = std::make_shared<Buffer>();
 
-        cudaError_t exit_code = cudaFuncSetCacheConfig(handler, cacheConfig);
+        cudaError_t exit_code = cudaFuncSetCacheConfig(function->host, cacheConfig);
         return std::make_shared<Result>(exit_code, out);
     } catch (const std::exception &e) {
         cerr << e.what() << endl;
@@ -74,48 +78,31 @@ CUDA_ROUTINE_HANDLER(FuncSetCacheConfig) {
 }
 
 CUDA_ROUTINE_HANDLER(LaunchKernel) {
-    void *func = input_buffer->GetFromMarshal<void *>();
+    uint32_t id = input_buffer->Get<uint32_t>();
     dim3 gridDim = input_buffer->Get<dim3>();
     dim3 blockDim = input_buffer->Get<dim3>();
     size_t sharedMem = input_buffer->Get<size_t>();
     cudaStream_t stream = input_buffer->Get<cudaStream_t>();
 
-    std::string deviceFunc = pThis->getDeviceFunc(func);
-    NvInfoFunction infoFunction = pThis->getInfoFunc(deviceFunc);
-
-    size_t argsSize = 0;
-    for (const NvInfoKParam &p : infoFunction.params) {
-        size_t end = p.offset + p.size_bytes();
-        if (end > argsSize) {
-            argsSize = end;
-        }
+    std::shared_ptr<const CudaRtHandler::RegisteredFunction> function = pThis->GetFunction(id);
+    if (function == nullptr || !function->found) {
+        LOG4CPLUS_ERROR(pThis->GetLogger(), "LaunchKernel: no kernel with id " << id);
+        return std::make_shared<Result>(cudaErrorInvalidDeviceFunction);
     }
 
-    // cout << "argsSize: " << argsSize << endl;
-
-    byte *pArgs = input_buffer->Assign<byte>(argsSize);
-
-    // cudaLaunchKernel needs an array of pointers to the arguments,
-    // so in the buffer we have the arguments packed in a byte array
-    // and we need to create an array of pointers to the arguments
-    // based on the offsets defined in the infoFunction.params
-    void *args[infoFunction.params.size()];
-
-    for (NvInfoKParam infoKParam : infoFunction.params) {
-        args[infoKParam.ordinal] = (void *)(pArgs + infoKParam.offset);
-        // cout << "Setting argument for ordinal: " << infoKParam.ordinal
-        //     << "param: " << infoKParam.ordinal
-        //     << ", offset: " << infoKParam.offset
-        //     << ", size: " << infoKParam.size_bytes() << endl;
-    }
-
-    // cout << "function: " << deviceFunc << endl;
-    // cout << "GridDim: " << gridDim.x << "," << gridDim.y << "," << gridDim.z
-    // << endl; cout << "BlockDim: " << blockDim.x << "," << blockDim.y << ","
-    // << blockDim.z << endl; cout << "SharedMem: " << sharedMem << endl; cout
-    // << "Stream: " << stream << endl;
-
-    cudaError_t exit_code = cudaLaunchKernel(func, gridDim, blockDim, args, sharedMem, stream);
+    // cudaLaunchKernel needs an array of pointers to the arguments, packed by the frontend
+    // in pArgs as the layout of the kernel says
+    byte *pArgs = input_buffer->Assign<byte>(function->layout.size);
+    AutoGraphs *autoGraphs = pThis->GetAutoGraphs();
+    if (autoGraphs != nullptr)
+        return std::make_shared<Result>(autoGraphs->Launch(function, gridDim, blockDim, sharedMem,
+                                                           stream, (const char *)pArgs));
+    const std::vector<NvInfoArg> &layout = function->layout.args;
+    void *args[std::max<size_t>(layout.size(), 1)];
+    for (size_t i = 0; i < layout.size(); i++) args[i] = (void *)(pArgs + layout[i].offset);
+
+    cudaError_t exit_code =
+        cudaLaunchKernel(function->host, gridDim, blockDim, args, sharedMem, stream);
     LOG4CPLUS_DEBUG(pThis->GetLogger(), "LaunchKernel exit_code: " << exit_code);
     return std::make_shared<Result>(exit_code);
 }
@@ -31,8 +31,13 @@
 #include <cuda.h>
 #include <lz4.h>
 
+#include <atomic>
+#include <fstream>
+
 #include "CudaRtHandler.h"
 
+#include "AutoGraphs.h"
+
 using namespace std;
 using namespace log4cplus;
 
@@ -92,9 +97,9 @@ char *copySectionHeaderStrTable(const Elf64_Ehdr *eh, Elf64_Shdr *sh_table) {
     return sh_str;
 }
 
-// Helper: parse NvInfo sections and register functions
+// Helper: parse NvInfo sections into the kernels of a fat binary
 void parseNvInfoSections(const Elf64_Ehdr *eh, Elf64_Shdr *sh_table, char *sh_str,
-                         CudaRtHandler *pThis) {
+                         std::vector<std::pair<std::string, NvInfoFunction>> &functions) {
     byte *baseAddr = (byte *)eh;
     for (uint32_t i = 0; i < eh->e_shnum; i++) {
         char *sectionName = sh_str + sh_table[i].sh_name;
@@ -121,95 +126,405 @@ void parseNvInfoSections(const Elf64_Ehdr *eh, Elf64_Shdr *sh_table, char *sh_st
             }
             pAttr = (NvInfoAttribute *)((byte *)pAttr + size);
         }
-        pThis->addDeviceFunc2InfoFunc(funcName, infoFunction);
+        functions.emplace_back(funcName, infoFunction);
     }
 }
 
-CUDA_ROUTINE_HANDLER(RegisterFatBinary) {
-    LOG4CPLUS_DEBUG(pThis->GetLogger(), "Entering in RegisterFatBinary");
+// Helper: parse the kernels of the cubins of a fat binary
+static bool parseFatBinary(__fatBinC_Wrapper_t *fatBin,
+                           std::vector<std::pair<std::string, NvInfoFunction>> &functions,
+                           Logger &logger) {
+    struct fatBinaryHeader *fatBinHdr = (struct fatBinaryHeader *)fatBin->data;
+    if (fatBinHdr->magic != FATBIN_MAGIC) {
+        LOG4CPLUS_ERROR(logger, "*** Error: Invalid fat binary header magic number");
+        return false;
+    }
 
-    try {
-        char *handler = input_buffer->AssignString();
-        __fatBinC_Wrapper_t *fatBin = CudaUtil::UnmarshalFatCudaBinary(input_buffer.get());
-        if (fatBin->magic != FATBINWRAPPER_MAGIC) {
-            LOG4CPLUS_ERROR(pThis->GetLogger(),
-                            "*** Error: Invalid fat binary wrapper magic number");
-            return std::make_shared<Result>(cudaErrorInvalidValue);
+    // cout << "Fat binary header size: " << fatBinHdr->headerSize << endl;
+    // cout << "Fat binary size: " << fatBinHdr->fatSize << endl;
+
+    uint8_t *data_ptr = (uint8_t *)fatBin->data + fatBinHdr->headerSize;
+    size_t remaining_size = fatBinHdr->fatSize;
+    std::vector<char> cubin;
+    while (remaining_size > 0) {
+        fatBinData_t *fatBinData = (fatBinData_t *)data_ptr;
+        data_ptr += fatBinData->headerSize;
+
+        if (fatBinData->uncompressedPayload != 0) {
+            uint8_t *compressed_data = data_ptr;
+            int compressed_size = fatBinData->payloadSize;
+
+            // cout << "Uncompressed payload: " <<
+            // fatBinData->uncompressedPayload << endl; Prepare output
+            // buffer with the expected decompressed size
+            cubin.resize(fatBinData->uncompressedPayload);
+
+            // Decompress - LZ4_decompress_safe returns decompressed size or
+            // < 0 on error
+            int decompressed_size =
+                LZ4_decompress_safe((const char *)compressed_data, cubin.data(), compressed_size,
+                                    fatBinData->uncompressedPayload);
+            if (decompressed_size < 0) {
+                LOG4CPLUS_ERROR(logger, "*** Error: LZ4 decompression failed with code "
+                                            << decompressed_size);
+                return false;  // Decompression failed
+            }
+            // Advance pointer for next usage (if needed)
+            data_ptr += fatBinData->paddedPayloadSize;
+        } else {
+            cubin.resize(fatBinData->paddedPayloadSize);
+            memcpy(cubin.data(), data_ptr, fatBinData->paddedPayloadSize);
+            data_ptr += fatBinData->paddedPayloadSize;
         }
-        void **bin = __cudaRegisterFatBinary((void *)fatBin);
-        pThis->RegisterFatBinary(handler, bin);
 
-        struct fatBinaryHeader *fatBinHdr = (struct fatBinaryHeader *)fatBin->data;
-        if (fatBinHdr->magic != FATBIN_MAGIC) {
-            LOG4CPLUS_ERROR(pThis->GetLogger(),
-                            "*** Error: Invalid fat binary header magic number");
-            return std::make_shared<Result>(cudaErrorInvalidValue);
-        }
+        // cout << "kind " << fatBinData->kind << endl;
+        if (fatBinData->kind == 2) {
+            if (memcmp(cubin.data(), ELF_MAGIC, ELF_MAGIC_SIZE) != 0) {
+                cerr << "*** Error: Invalid ELF magic number in fat binary" << endl;
+                return false;  // Not a valid ELF file
+            }
+            Elf64_Ehdr *eh = (Elf64_Ehdr *)(cubin.data());
 
-        // cout << "Fat binary header size: " << fatBinHdr->headerSize << endl;
-        // cout << "Fat binary size: " << fatBinHdr->fatSize << endl;
-
-        uint8_t *data_ptr = (uint8_t *)fatBin->data + fatBinHdr->headerSize;
-        size_t remaining_size = fatBinHdr->fatSize;
-        std::vector<char> cubin;
-        while (remaining_size > 0) {
-            fatBinData_t *fatBinData = (fatBinData_t *)data_ptr;
-            data_ptr += fatBinData->headerSize;
-
-            if (fatBinData->uncompressedPayload != 0) {
-                uint8_t *compressed_data = data_ptr;
-                int compressed_size = fatBinData->payloadSize;
-
-                // cout << "Uncompressed payload: " <<
-                // fatBinData->uncompressedPayload << endl; Prepare output
-                // buffer with the expected decompressed size
-                cubin.resize(fatBinData->uncompressedPayload);
-
-                // Decompress - LZ4_decompress_safe returns decompressed size or
-                // < 0 on error
-                int decompressed_size =
-                    LZ4_decompress_safe((const char *)compressed_data, cubin.data(),
-                                        compressed_size, fatBinData->uncompressedPayload);
-                if (decompressed_size < 0) {
-                    LOG4CPLUS_ERROR(
-                        pThis->GetLogger(),
-                        "*** Error: LZ4 decompression failed with code " << decompressed_size);
-                    return nullptr;  // Decompression failed
-                }
-                // Advance pointer for next usage (if needed)
-                data_ptr += fatBinData->paddedPayloadSize;
-            } else {
-                cubin.resize(fatBinData->paddedPayloadSize);
-                memcpy(cubin.data(), data_ptr, fatBinData->paddedPayloadSize);
-                data_ptr += fatBinData->paddedPayloadSize;
+            Elf64_Shdr *sh_table = copySectionHeaders(eh);
+            if (!sh_table) return false;
+
+            char *sh_str = copySectionHeaderStrTable(eh, sh_table);
+            if (!sh_str) {
+                free(sh_table);
+                return false;
             }
 
-            // cout << "kind " << fatBinData->kind << endl;
-            if (fatBinData->kind == 2) {
-                if (memcmp(cubin.data(), ELF_MAGIC, ELF_MAGIC_SIZE) != 0) {
-                    cerr << "*** Error: Invalid ELF magic number in fat binary" << endl;
-                    return nullptr;  // Not a valid ELF file
-                }
-                Elf64_Ehdr *eh = (Elf64_Ehdr *)(cubin.data());
+            parseNvInfoSections(eh, sh_table, sh_str, functions);
 
-                Elf64_Shdr *sh_table = copySectionHeaders(eh);
-                if (!sh_table) return nullptr;
+            free(sh_str);
+            free(sh_table);
+        } else {
+            // cout << "Ignoring PTX" << endl;
+        }
+        remaining_size -= (fatBinData->paddedPayloadSize + fatBinData->headerSize);
+    }
+    return true;
+}
 
-                char *sh_str = copySectionHeaderStrTable(eh, sh_table);
-                if (!sh_str) {
-                    free(sh_table);
-                    return nullptr;
-                }
+// the directory where the fat binaries are persisted across restarts, if any
+static const char *fatBinaryCacheDirectory() {
+    static const char *directory = getenv("GVIRTUS_FATBIN_CACHE");
+    return directory != nullptr && *directory != '\0' ? directory : nullptr;
+}
 
-                parseNvInfoSections(eh, sh_table, sh_str, pThis);
+static std::string fatBinaryCachePath(const std::string &hash) {
+    return std::string(fatBinaryCacheDirectory()) + "/" + hash + ".fatbin";
+}
 
-                free(sh_str);
-                free(sh_table);
-            } else {
-                // cout << "Ignoring PTX" << endl;
-            }
-            remaining_size -= (fatBinData->paddedPayloadSize + fatBinData->headerSize);
+// Helper: persist a fat binary in the directory of GVIRTUS_FATBIN_CACHE, as
+// marshalled by CudaUtil::MarshalFatCudaBinary()
+static void saveFatBinary(const CudaRtHandler::CachedFatBinary &fatBinary, Logger &logger) {
+    if (fatBinaryCacheDirectory() == nullptr) return;
+    std::string path = fatBinaryCachePath(fatBinary.hash);
+    if (access(path.c_str(), F_OK) == 0) return;
+
+    struct fatBinaryHeader *header = (struct fatBinaryHeader *)fatBinary.bin->data;
+    size_t size = header->fatSize + (unsigned long long)header->headerSize;
+    // written aside and renamed, so that a backend never loads half a file
+    static std::atomic<unsigned> saved(0);
+    std::string tmp =
+        path + "." + std::to_string(getpid()) + "." + std::to_string(saved++) + ".tmp";
+    std::ofstream out(tmp, std::ios::binary);
+    out.write((const char *)&fatBinary.bin->magic, sizeof(fatBinary.bin->magic));
+    out.write((const char *)&fatBinary.bin->version, sizeof(fatBinary.bin->version));
+    out.write((const char *)&size, sizeof(size));
+    out.write((const char *)fatBinary.bin->data, size);
+    out.close();
+    if (!out || rename(tmp.c_str(), path.c_str()) != 0) {
+        LOG4CPLUS_WARN(logger, "Cannot cache fat binary " << fatBinary.hash << " in " << path);
+        unlink(tmp.c_str());
+    }
+}
+
+// Helper: load a fat binary persisted by saveFatBinary(), checking its hash
+static std::shared_ptr<CudaRtHandler::CachedFatBinary> loadFatBinary(const std::string &hash,
+                                                                     Logger &logger) {
+    if (fatBinaryCacheDirectory() == nullptr || hash.size() != 64 ||
+        hash.find_first_not_of("0123456789abcdef") != std::string::npos)
+        return nullptr;
+    std::ifstream in(fatBinaryCachePath(hash), std::ios::binary);
+    if (!in) return nullptr;
+
+    auto fatBinary = std::make_shared<CudaRtHandler::CachedFatBinary>();
+    void *raw = std::aligned_alloc(8, sizeof(__fatBinC_Wrapper_t));
+    fatBinary->bin = new (raw) __fatBinC_Wrapper_t;
+    fatBinary->bin->data = nullptr;
+    fatBinary->bin->filename_or_fatbins = NULL;
+    size_t size = 0;
+    in.read((char *)&fatBinary->bin->magic, sizeof(fatBinary->bin->magic));
+    in.read((char *)&fatBinary->bin->version, sizeof(fatBinary->bin->version));
+    in.read((char *)&size, sizeof(size));
+    if (!in || fatBinary->bin->magic != FATBINWRAPPER_MAGIC || size < sizeof(fatBinaryHeader))
+        return nullptr;
+    char *data = new char[size];
+    fatBinary->bin->data = (const long long unsigned int *)data;
+    in.read(data, size);
+    struct fatBinaryHeader *header = (struct fatBinaryHeader *)data;
+    if (!in || header->fatSize + (unsigned long long)header->headerSize != size ||
+        CudaUtil::HashFatCudaBinary(fatBinary->bin) != hash ||
+        !parseFatBinary(fatBinary->bin, fatBinary->functions, logger)) {
+        LOG4CPLUS_WARN(logger, "Ignoring the corrupted cached fat binary " << hash);
+        return nullptr;
+    }
+    fatBinary->hash = hash;
+    return fatBinary;
+}
+
+CudaRtHandler::CachedFatBinary::~CachedFatBinary() {
+    if (bin == nullptr) return;
+    delete[] (char *)bin->data;
+    free(bin);
+}
+
+void CudaRtHandler::RegisterFatBinary(const char *handler,
+                                      std::shared_ptr<CachedFatBinary> fatBinary) {
+    std::lock_guard<std::mutex> lock(mFatBinaryCacheMutex);
+    auto it = mFatBinaryCache.find(fatBinary->hash);
+    if (it != mFatBinaryCache.end()) {
+        fatBinary = it->second;
+    } else {
+        fatBinary->handle = __cudaRegisterFatBinary((void *)fatBinary->bin);
+        for (auto &function : fatBinary->functions)
+            addDeviceFunc2InfoFunc(function.first, function.second);
+        mFatBinaryCache.emplace(fatBinary->hash, fatBinary);
+        LOG4CPLUS_DEBUG(logger, "Cached FatBinary " << fatBinary->hash);
+    }
+    AddFatBinaryHandler(handler, fatBinary);
+}
+
+bool CudaRtHandler::RegisterCachedFatBinary(const char *handler, const std::string &hash) {
+    {
+        std::lock_guard<std::mutex> lock(mFatBinaryCacheMutex);
+        auto it = mFatBinaryCache.find(hash);
+        if (it != mFatBinaryCache.end()) {
+            AddFatBinaryHandler(handler, it->second);
+            return true;
+        }
+    }
+    auto fatBinary = loadFatBinary(hash, logger);
+    if (fatBinary == nullptr) return false;
+    RegisterFatBinary(handler, fatBinary);
+    return true;
+}
+
+void CudaRtHandler::AddFatBinaryHandler(const char *handler,
+                                        const std::shared_ptr<CachedFatBinary> &fatBinary) {
+    fatBinary->handlers[handler]++;
+    if (stFrontend != nullptr) stFrontend->fatBinaries[handler]++;
+    mCachedFatBinaryByHandler[handler] = fatBinary;
+    RegisterFatBinary(handler, fatBinary->handle);
+}
+
+void CudaRtHandler::EndFatBinary(const char *handler) {
+    std::lock_guard<std::mutex> lock(mFatBinaryCacheMutex);
+    auto it = mCachedFatBinaryByHandler.find(handler);
+    if (it == mCachedFatBinaryByHandler.end())
+        throw runtime_error("Fat Binary '" + string(handler) + "' not found");
+    if (it->second->ended) return;
+    __cudaRegisterFatBinaryEnd(it->second->handle);
+    it->second->ended = true;
+}
+
+void CudaRtHandler::ReleaseFatBinary(const char *handler) {
+    if (stFrontend != nullptr) ReleaseFatBinary(handler, *stFrontend, 1);
+}
+
+void CudaRtHandler::ReleaseFatBinary(const std::string &handler, FrontendState &frontend,
+                                     unsigned count) {
+    std::lock_guard<std::mutex> lock(mFatBinaryCacheMutex);
+    // a frontend releases only what it registered
+    auto registered = frontend.fatBinaries.find(handler);
+    if (registered == frontend.fatBinaries.end()) return;
+    count = std::min(count, registered->second);
+    if ((registered->second -= count) == 0) {
+        frontend.fatBinaries.erase(registered);
+        ForgetIds(handler, frontend);
+    }
+    auto it = mCachedFatBinaryByHandler.find(handler);
+    if (it == mCachedFatBinaryByHandler.end()) return;
+    std::shared_ptr<CachedFatBinary> fatBinary = it->second;
+    auto registration = fatBinary->handlers.find(handler);
+    if (registration != fatBinary->handlers.end()) {
+        registration->second -= std::min(count, registration->second);
+        if (registration->second > 0) return;
+        fatBinary->handlers.erase(registration);
+    }
+    mCachedFatBinaryByHandler.erase(it);
+    UnregisterFatBinary(handler.c_str());
+    ReleaseIds(handler);
+    if (!fatBinary->handlers.empty()) return;
+    // the last frontend is gone: the copy in GVIRTUS_FATBIN_CACHE, if any, is kept
+    __cudaUnregisterFatBinary(fatBinary->handle);
+    mFatBinaryCache.erase(fatBinary->hash);
+    LOG4CPLUS_DEBUG(logger, "Uncached FatBinary " << fatBinary->hash);
+}
+
+CudaRtHandler::FrontendState::~FrontendState() {
+    // its graphs launch the kernels of the fat binaries released below
+    autoGraphs.reset();
+    while (!fatBinaries.empty()) {
+        std::string handler = fatBinaries.begin()->first;
+        owner->ReleaseFatBinary(handler, *this, fatBinaries.begin()->second);
+    }
+}
+
+uint32_t CudaRtHandler::RegisterFunction(const char *handler, const char *hostFun,
+                                         char *deviceFun, const char *deviceName,
+                                         int threadLimit, uint3 *tid, uint3 *bid, dim3 *bDim,
+                                         dim3 *gDim, int *wSize) {
+    const void *host;
+    {
+        std::lock_guard<std::mutex> lock(mFatBinaryCacheMutex);
+        auto it = mCachedFatBinaryByHandler.find(handler);
+        if (it == mCachedFatBinaryByHandler.end())
+            throw runtime_error("Fat Binary '" + string(handler) + "' not found");
+        CachedFatBinary &fatBinary = *it->second;
+        auto kernel = fatBinary.kernels.find(deviceFun);
+        if (kernel != fatBinary.kernels.end()) {
+            host = kernel->second;
+        } else if (fatBinary.ended) {
+            LOG4CPLUS_ERROR(logger, "RegisterFunction: '" << deviceFun << "' of FatBinary "
+                                                          << fatBinary.hash << " ended");
+            return NO_REGISTRATION_ID;
+        } else {
+            __cudaRegisterFunction(fatBinary.handle, hostFun, deviceFun, deviceName, threadLimit,
+                                   tid, bid, bDim, gDim, wSize);
+            fatBinary.kernels.emplace(deviceFun, hostFun);
+            host = hostFun;
+        }
+    }
+    return AddFunction(handler, host, deviceFun);
+}
+
+uint32_t CudaRtHandler::AddFunction(const char *handler, const void *host,
+                                   const std::string &deviceFun) {
+    auto function = std::make_shared<RegisteredFunction>();
+    function->host = host;
+    {
+        // filled by RegisterFatBinary()
+        std::lock_guard<std::mutex> lock(mFatBinaryCacheMutex);
+        auto it = mapDeviceFunc2InfoFunc->find(deviceFun);
+        function->found = it != mapDeviceFunc2InfoFunc->end();
+        if (function->found) function->layout = getArgsLayout(it->second);
+    }
+    if (!function->found)
+        LOG4CPLUS_ERROR(logger, "AddFunction: device function '" << deviceFun << "' not found");
+
+    std::unique_lock<std::shared_mutex> lock(mRegistrationsMutex);
+    uint32_t id;
+    if (mFreeFunctionIds.empty()) {
+        id = mFunctions.size();
+        mFunctions.push_back(function);
+    } else {
+        id = mFreeFunctionIds.back();
+        mFreeFunctionIds.pop_back();
+        mFunctions[id] = function;
+    }
+    mFunctionIdsByHandler[handler].push_back(id);
+    if (stFrontend != nullptr) stFrontend->functions.insert(id);
+    return id;
+}
+
+std::shared_ptr<const CudaRtHandler::RegisteredFunction> CudaRtHandler::GetFunction(uint32_t id) {
+    std::shared_lock<std::shared_mutex> lock(mRegistrationsMutex);
+    if (stFrontend == nullptr || stFrontend->functions.count(id) == 0) return nullptr;
+    return mFunctions[id];
+}
+
+uint32_t CudaRtHandler::RegisterVar(const char *handler, char *deviceAddress,
+                                    const char *deviceName, int ext, int size, int constant,
+                                    int global) {
+    char *host;
+    {
+        std::lock_guard<std::mutex> lock(mFatBinaryCacheMutex);
+        auto it = mCachedFatBinaryByHandler.find(handler);
+        if (it == mCachedFatBinaryByHandler.end())
+            throw runtime_error("Fat Binary '" + string(handler) + "' not found");
+        CachedFatBinary &fatBinary = *it->second;
+        // the CUDA runtime keeps the shadow as long as the module, shared by other frontends
+        auto var = fatBinary.vars.find(deviceName);
+        if (var != fatBinary.vars.end()) {
+            host = var->second.get();
+        } else if (fatBinary.ended) {
+            LOG4CPLUS_ERROR(logger, "RegisterVar: '" << deviceName << "' of FatBinary "
+                                                     << fatBinary.hash << " ended");
+            return NO_REGISTRATION_ID;
+        } else {
+            host = new char[std::max(size, 1)]();
+            fatBinary.vars.emplace(deviceName, std::unique_ptr<char[]>(host));
+            __cudaRegisterVar(fatBinary.handle, host, deviceAddress, deviceName, ext, size,
+                              constant, global);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mRegistrationsMutex);
+    uint32_t id;
+    if (mFreeVarIds.empty()) {
+        id = mVars.size();
+        mVars.push_back(host);
+    } else {
+        id = mFreeVarIds.back();
+        mFreeVarIds.pop_back();
+        mVars[id] = host;
+    }
+    mVarIdsByHandler[handler].push_back(id);
+    if (stFrontend != nullptr) stFrontend->vars.insert(id);
+    return id;
+}
+
+void CudaRtHandler::ForgetIds(const std::string &handler, FrontendState &frontend) {
+    std::unique_lock<std::shared_mutex> lock(mRegistrationsMutex);
+    auto functions = mFunctionIdsByHandler.find(handler);
+    if (functions != mFunctionIdsByHandler.end())
+        for (uint32_t id : functions->second) frontend.functions.erase(id);
+    auto vars = mVarIdsByHandler.find(handler);
+    if (vars != mVarIdsByHandler.end())
+        for (uint32_t id : vars->second) frontend.vars.erase(id);
+}
+
+void CudaRtHandler::ReleaseIds(const std::string &handler) {
+    std::unique_lock<std::shared_mutex> lock(mRegistrationsMutex);
+    auto functions = mFunctionIdsByHandler.find(handler);
+    if (functions != mFunctionIdsByHandler.end()) {
+        for (uint32_t id : functions->second) {
+            mFunctions[id] = nullptr;
+            mFreeFunctionIds.push_back(id);
         }
+        mFunctionIdsByHandler.erase(functions);
+    }
+    auto vars = mVarIdsByHandler.find(handler);
+    if (vars != mVarIdsByHandler.end()) {
+        for (uint32_t id : vars->second) {
+            mVars[id] = nullptr;
+            mFreeVarIds.push_back(id);
+        }
+        mVarIdsByHandler.erase(vars);
+    }
+}
+
+CUDA_ROUTINE_HANDLER(RegisterFatBinary) {
+    LOG4CPLUS_DEBUG(pThis->GetLogger(), "Entering in RegisterFatBinary");
+
+    try {
+        char *handler = input_buffer->AssignString();
+        auto fatBinary = std::make_shared<CudaRtHandler::CachedFatBinary>();
+        fatBinary->bin = CudaUtil::UnmarshalFatCudaBinary(input_buffer.get());
+        if (fatBinary->bin->magic != FATBINWRAPPER_MAGIC) {
+            LOG4CPLUS_ERROR(pThis->GetLogger(),
+                            "*** Error: Invalid fat binary wrapper magic number");
+            return std::make_shared<Result>(cudaErrorInvalidValue);
+        }
+        if (!parseFatBinary(fatBinary->bin, fatBinary->functions, pThis->GetLogger()))
+            return std::make_shared<Result>(cudaErrorInvalidValue);
+        // hashed here: a frontend cannot cache content under the hash of another one
+        fatBinary->hash = CudaUtil::HashFatCudaBinary(fatBinary->bin);
+        saveFatBinary(*fatBinary, pThis->GetLogger());
+        pThis->RegisterFatBinary(handler, fatBinary);
 
         return std::make_shared<Result>(cudaSuccess);
     } catch (const std::exception &e) {
@@ -218,11 +533,26 @@ CUDA_ROUTINE_HANDLER(RegisterFatBinary) {
     }
 }
 
+CUDA_ROUTINE_HANDLER(RegisterCachedFatBinary) {
+    try {
+        char *handler = input_buffer->AssignString();
+        std::string hash = input_buffer->AssignString();
+        bool registered = pThis->RegisterCachedFatBinary(handler, hash);
+        LOG4CPLUS_DEBUG(pThis->GetLogger(),
+                        "FatBinary " << hash << (registered ? " registered" : " not cached"));
+        std::shared_ptr<Buffer> out = std::make_shared<Buffer>();
+        out->Add(registered);
+        return std::make_shared<Result>(cudaSuccess, out);
+    } catch (const std::exception &e) {
+        cerr << e.what() << endl;
+        return std::make_shared<Result>(cudaErrorMemoryAllocation);
+    }
+}
+
 CUDA_ROUTINE_HANDLER(RegisterFatBinaryEnd) {
     try {
         char *handler = input_buffer->AssignString();
-        void **fatCubinHandle = pThis->GetFatBinary(handler);
-        __cudaRegisterFatBinaryEnd(fatCubinHandle);
+        pThis->EndFatBinary(handler);
         cudaError_t error = cudaGetLastError();
         return std::make_shared<Result>(error);
     } catch (const std::exception &e) {
@@ -234,9 +564,7 @@ CUDA_ROUTINE_HANDLER(RegisterFatBinaryEnd) {
 CUDA_ROUTINE_HANDLER(UnregisterFatBinary) {
     try {
         char *handler = input_buffer->AssignString();
-        void **fatCubinHandle = pThis->GetFatBinary(handler);
-        __cudaUnregisterFatBinary(fatCubinHandle);
-        pThis->UnregisterFatBinary(handler);
+        pThis->ReleaseFatBinary(handler);
         return std::make_shared<Result>(cudaSuccess);
     } catch (const std::exception &e) {
         cerr << e.what() << endl;
@@ -247,7 +575,6 @@ CUDA_ROUTINE_HANDLER(UnregisterFatBinary) {
 CUDA_ROUTINE_HANDLER(RegisterFunction) {
     try {
         char *handler = input_buffer->AssignString();
-        void **fatCubinHandle = pThis->GetFatBinary(handler);
         const char *hostfun = (const char *)(input_buffer->Get<pointer_t>());
         char *deviceFun = strdup(input_buffer->AssignString());
         const char *deviceName = strdup(input_buffer->AssignString());
@@ -257,8 +584,11 @@ CUDA_ROUTINE_HANDLER(RegisterFunction) {
         dim3 *bDim = input_buffer->Assign<dim3>();
         dim3 *gDim = input_buffer->Assign<dim3>();
         int *wSize = input_buffer->Assign<int>();
-        __cudaRegisterFunction(fatCubinHandle, hostfun, deviceFun, deviceName, thread_limit, tid,
-                               bid, bDim, gDim, wSize);
+        // the launches name it by its id
+        uint32_t id = pThis->RegisterFunction(handler, hostfun, deviceFun, deviceName,
+                                              thread_limit, tid, bid, bDim, gDim, wSize);
+        if (id == NO_REGISTRATION_ID)
+            return std::make_shared<Result>(cudaErrorInvalidDeviceFunction);
 
 #ifdef DEBUG
         cudaError_t error = cudaGetLastError();
@@ -275,8 +605,7 @@ CUDA_ROUTINE_HANDLER(RegisterFunction) {
         output_buffer->Add(bDim);
         output_buffer->Add(gDim);
         output_buffer->Add(wSize);
-
-        pThis->addHost2DeviceFunc((void *)hostfun, deviceFun);
+        output_buffer->Add(id);
 
         return std::make_shared<Result>(cudaSuccess, output_buffer);
     } catch (const std::exception &e) {
@@ -286,46 +615,30 @@ CUDA_ROUTINE_HANDLER(RegisterFunction) {
 }
 
 CUDA_ROUTINE_HANDLER(RegisterVar) {
-    //   LOG4CPLUS_DEBUG(pThis->GetLogger(), "Entering in RegisterVar");
     try {
         char *handler = input_buffer->AssignString();
-        // LOG4CPLUS_DEBUG(pThis->GetLogger(), "Handler: " << handler);
-        void **fatCubinHandle = pThis->GetFatBinary(handler);
-        // LOG4CPLUS_DEBUG(pThis->GetLogger(), "FatCubinHandle: " <<
-        // fatCubinHandle);
-        char *hostVar = input_buffer->AssignString();
-        // LOG4CPLUS_DEBUG(pThis->GetLogger(), "HostVar: " << hostVar);
         char *deviceAddress = strdup(input_buffer->AssignString());
-        // LOG4CPLUS_DEBUG(pThis->GetLogger(), "DeviceAddress: " <<
-        // deviceAddress);
         const char *deviceName = strdup(input_buffer->AssignString());
-        // LOG4CPLUS_DEBUG(pThis->GetLogger(), "DeviceName: " << deviceName);
         int ext = input_buffer->Get<int>();
         int size = input_buffer->Get<int>();
         int constant = input_buffer->Get<int>();
         int global = input_buffer->Get<int>();
-        // LOG4CPLUS_DEBUG(pThis->GetLogger(), "Calling RegisterVar: " <<
-        // deviceName << " for "
-        //                   << fatCubinHandle << " with hostVar: " << hostVar
-        //                   << ", deviceAddress: " << deviceAddress
-        //                   << ", deviceName: " << deviceName
-        //                   << ", ext: " << ext << ", size: " << size
-        //                   << ", constant: " << constant
-        //                   << ", global: " << global);
-        __cudaRegisterVar(fatCubinHandle, hostVar, deviceAddress, deviceName, ext, size, constant,
-                          global);
+        // registered with a host shadow of its own: the routines name it by its id
+        uint32_t id =
+            pThis->RegisterVar(handler, deviceAddress, deviceName, ext, size, constant, global);
+        if (id == NO_REGISTRATION_ID) return std::make_shared<Result>(cudaErrorInvalidSymbol);
         cudaError_t error = cudaGetLastError();
-        LOG4CPLUS_DEBUG(pThis->GetLogger(), "RegisterVar Executed");
         if (error != cudaSuccess) {
             LOG4CPLUS_DEBUG(pThis->GetLogger(),
                             "error executing RegisterVar: " << cudaGetErrorString(error));
         }
+        std::shared_ptr<Buffer> out = std::make_shared<Buffer>();
+        out->Add(id);
+        return std::make_shared<Result>(cudaSuccess, out);
     } catch (const std::exception &e) {
         LOG4CPLUS_DEBUG(pThis->GetLogger(), "Exception" << e.what() << " in RegisterVar");
         return std::make_shared<Result>(cudaErrorMemoryAllocation);
     }
-
-    return std::make_shared<Result>(cudaSuccess);
 }
 
 CUDA_ROUTINE_HANDLER(RegisterSharedVar) {
@@ -33,6 +33,7 @@ using namespace log4cplus;
 using namespace std;
 
 using gvirtus::common::mappedPointer;
+using gvirtus::communicators::Communicator;
 
 // This is for HostRegister support
 // Key: Frontend pointer that was malloc’d on client side.
@@ -64,7 +65,8 @@ CUDA_ROUTINE_HANDLER(FreeArray) {
 
 CUDA_ROUTINE_HANDLER(GetSymbolAddress) {
     void *devPtr;
-    const char *symbol = pThis->GetSymbol(input_buffer);
+    const void *symbol = pThis->GetSymbol(input_buffer);
+    if (symbol == nullptr) return std::make_shared<Result>(cudaErrorInvalidSymbol);
 
     cudaError_t exit_code = cudaGetSymbolAddress(&devPtr, symbol);
 
@@ -81,7 +83,8 @@ CUDA_ROUTINE_HANDLER(GetSymbolSize) {
 
         size_t *size = out->Delegate<size_t>();
         *size = *(input_buffer->Assign<size_t>());
-        const char *symbol = pThis->GetSymbol(input_buffer);
+        const void *symbol = pThis->GetSymbol(input_buffer);
+        if (symbol == nullptr) return std::make_shared<Result>(cudaErrorInvalidSymbol);
         cudaError_t exit_code = cudaGetSymbolSize(size, symbol);
         return std::make_shared<Result>(exit_code, out);
     } catch (const std::exception &e) {
@@ -217,6 +220,133 @@ CUDA_ROUTINE_HANDLER(MallocPitch) {
     }
 }
 
+/*
+ * Copies the chunks of a transfer to dst on stream as they arrive: a chunk is
+ * copied while the next one is received, and given back once its copy is over.
+ */
+static cudaError_t copyTransferToDevice(char *dst, Transfer *transfer, cudaStream_t stream) {
+    cudaEvent_t events[2];
+    cudaError_t exit_code = cudaEventCreateWithFlags(&events[0], cudaEventDisableTiming);
+    if (exit_code != cudaSuccess) return exit_code;
+    exit_code = cudaEventCreateWithFlags(&events[1], cudaEventDisableTiming);
+    if (exit_code != cudaSuccess) {
+        cudaEventDestroy(events[0]);
+        return exit_code;
+    }
+
+    Transfer::Chunk copying[2] = {{nullptr, 0}, {nullptr, 0}};
+    size_t offset = 0;
+    try {
+        for (int i = 0; exit_code == cudaSuccess; i ^= 1) {
+            // the chunk copied two rounds ago is free again
+            if (copying[i].data != nullptr) {
+                exit_code = cudaEventSynchronize(events[i]);
+                transfer->Release(copying[i]);
+                copying[i] = {nullptr, 0};
+                if (exit_code != cudaSuccess) break;
+            }
+            Transfer::Chunk chunk = transfer->Take();
+            if (chunk.data == nullptr) break;
+            copying[i] = chunk;
+            exit_code = cudaMemcpyAsync(dst + offset, chunk.data, chunk.size,
+                                        cudaMemcpyHostToDevice, stream);
+            if (exit_code == cudaSuccess) exit_code = cudaEventRecord(events[i], stream);
+            offset += chunk.size;
+        }
+    } catch (const std::exception &e) {
+        cerr << e.what() << endl;
+        exit_code = cudaErrorUnknown;
+    }
+
+    // the chunks go back to the pool once their copy is over
+    for (int i = 0; i < 2; i++) {
+        if (copying[i].data != nullptr) {
+            cudaError_t copied = cudaEventSynchronize(events[i]);
+            if (exit_code == cudaSuccess) exit_code = copied;
+            transfer->Release(copying[i]);
+        }
+        cudaEventDestroy(events[i]);
+    }
+    return exit_code;
+}
+
+/* gives a staging chunk back to the pool once the copy queued before it is over */
+static void CUDART_CB returnChunk(void *chunk) { Transfer::ReturnChunk((char *)chunk); }
+
+/*
+ * Queues the copies of the chunks of a transfer to dst on stream as they
+ * arrive, without waiting for them: each chunk goes back to the pool from a
+ * host function queued after its copy, so the routine doesn't wait for the
+ * work queued on stream before it.
+ */
+static cudaError_t copyTransferToDeviceAsync(char *dst, Transfer *transfer, cudaStream_t stream) {
+    cudaError_t exit_code = cudaSuccess;
+    size_t offset = 0;
+    try {
+        while (exit_code == cudaSuccess) {
+            Transfer::Chunk chunk = transfer->Take();
+            if (chunk.data == nullptr) break;
+            exit_code = cudaMemcpyAsync(dst + offset, chunk.data, chunk.size,
+                                        cudaMemcpyHostToDevice, stream);
+            if (exit_code != cudaSuccess) {
+                transfer->Release(chunk);
+                break;
+            }
+            exit_code = cudaLaunchHostFunc(stream, returnChunk, chunk.data);
+            if (exit_code != cudaSuccess) {
+                // the copy may be reading the chunk still
+                cudaStreamSynchronize(stream);
+                transfer->Release(chunk);
+            }
+            offset += chunk.size;
+        }
+    } catch (const std::exception &e) {
+        cerr << e.what() << endl;
+        exit_code = cudaErrorUnknown;
+    }
+    return exit_code;
+}
+
+/*
+ * Answers a large device to host copy writing the array to the connection
+ * through two staging chunks: a chunk is written while the next one is copied.
+ */
+static std::shared_ptr<Result> copyDeviceToResult(const char *src, size_t count) {
+    size_t chunk_size = Transfer::GetChunkSize();
+    std::shared_ptr<char> staging[2] = {
+        std::shared_ptr<char>(Transfer::AllocateChunk(), Transfer::ReleaseChunk),
+        std::shared_ptr<char>(Transfer::AllocateChunk(), Transfer::ReleaseChunk)};
+    // the first chunk is copied before answering, so that an invalid copy is reported
+    cudaError_t exit_code =
+        cudaMemcpy(staging[0].get(), src, std::min(chunk_size, count), cudaMemcpyDeviceToHost);
+    if (exit_code != cudaSuccess) return std::make_shared<Result>(exit_code);
+
+    return std::make_shared<Result>(exit_code, sizeof(size_t) + count, [=](Communicator *c) {
+        cudaEvent_t event;
+        if (cudaEventCreateWithFlags(&event, cudaEventDisableTiming) != cudaSuccess)
+            throw std::runtime_error("cudaMemcpy: can't create an event");
+        std::unique_ptr<CUevent_st, cudaError_t (*)(cudaEvent_t)> copied(event, cudaEventDestroy);
+
+        // the output holds just the array, see Buffer::Delegate()
+        c->Write((const char *)&count, sizeof(count));
+        size_t offset = 0, size = std::min(chunk_size, count);
+        for (int i = 0; offset < count; i ^= 1) {
+            size_t next = offset + size;
+            size_t next_size = std::min(chunk_size, count - next);
+            if (next_size > 0 &&
+                (cudaMemcpyAsync(staging[i ^ 1].get(), src + next, next_size,
+                                 cudaMemcpyDeviceToHost, 0) != cudaSuccess ||
+                 cudaEventRecord(copied.get(), 0) != cudaSuccess))
+                throw std::runtime_error("cudaMemcpy: the copy failed while writing the result");
+            c->Write(staging[i].get(), size);
+            if (next_size > 0 && cudaEventSynchronize(copied.get()) != cudaSuccess)
+                throw std::runtime_error("cudaMemcpy: the copy failed while writing the result");
+            offset = next;
+            size = next_size;
+        }
+    });
+}
+
 CUDA_ROUTINE_HANDLER(Memcpy) {
     /* cudaError_t cudaError_t cudaMemcpy(void *dst, const void *src,
         size_t count, cudaMemcpyKind kind) */
@@ -238,6 +368,13 @@ CUDA_ROUTINE_HANDLER(Memcpy) {
                 result = NULL;
                 break;
             case cudaMemcpyHostToDevice:
+                if (input_buffer->GetTransfer() != nullptr) {
+                    dst = input_buffer->GetFromMarshal<void *>();
+                    exit_code = copyTransferToDevice(static_cast<char *>(dst),
+                                                     input_buffer->GetTransfer(), 0);
+                    result = std::make_shared<Result>(exit_code);
+                    break;
+                }
                 try {
                     dst = input_buffer->GetFromMarshal<void *>();
                     src = input_buffer->AssignAll<char>();
@@ -249,26 +386,26 @@ CUDA_ROUTINE_HANDLER(Memcpy) {
                 result = std::make_shared<Result>(exit_code);
                 break;
             case cudaMemcpyDeviceToHost:
-                // FIXME: use buffer delegate
-                dst = new char[count];
                 /* skipping a char for fake host pointer */
                 try {
                     input_buffer->Assign<char>();
                     src = input_buffer->GetFromMarshal<void *>();
+                    if (count >= 2 * Transfer::GetChunkSize()) {
+                        result = copyDeviceToResult(static_cast<const char *>(src), count);
+                        break;
+                    }
+                    // the copy lands directly in the output buffer
+                    out = std::make_shared<Buffer>(sizeof(size_t) + count);
+                    dst = out->Delegate<char>(count);
                 } catch (const std::exception &e) {
                     cerr << e.what() << endl;
                     return std::make_shared<Result>(cudaErrorMemoryAllocation);
                 }
                 exit_code = cudaMemcpy(dst, src, count, kind);
-                try {
-                    out = std::make_shared<Buffer>();
-                    out->Add<char>((char *)dst, count);
-                } catch (const std::exception &e) {
-                    cerr << e.what() << endl;
-                    return std::make_shared<Result>(cudaErrorMemoryAllocation);
-                }
-                delete[] (char *)dst;
-                result = std::make_shared<Result>(exit_code, out);
+                if (exit_code != cudaSuccess)
+                    result = std::make_shared<Result>(exit_code);
+                else
+                    result = std::make_shared<Result>(exit_code, out);
                 break;
             case cudaMemcpyDeviceToDevice:
                 dst = input_buffer->GetFromMarshal<void *>();
@@ -544,6 +681,13 @@ CUDA_ROUTINE_HANDLER(MemcpyAsync) {
                 result = std::make_shared<Result>(cudaSuccess);
                 break;
             case cudaMemcpyHostToDevice:
+                if (input_buffer->GetTransfer() != nullptr) {
+                    dst = input_buffer->GetFromMarshal<void *>();
+                    exit_code = copyTransferToDeviceAsync(static_cast<char *>(dst),
+                                                          input_buffer->GetTransfer(), stream);
+                    result = std::make_shared<Result>(exit_code);
+                    break;
+                }
                 try {
                     dst = input_buffer->GetFromMarshal<void *>();
                     src = input_buffer->AssignAll<char>();
@@ -555,30 +699,27 @@ CUDA_ROUTINE_HANDLER(MemcpyAsync) {
                 result = std::make_shared<Result>(exit_code);
                 break;
             case cudaMemcpyDeviceToHost:
-                // FIXME: use buffer delegate
-                dst = new char[count];
                 /* skipping a char for fake host pointer */
                 try {
                     input_buffer->Assign<char>();
                     src = input_buffer->GetFromMarshal<void *>();
+                    // the copy lands directly in the output buffer; being
+                    // pageable memory, it is complete when cudaMemcpyAsync returns
+                    out = std::make_shared<Buffer>(sizeof(size_t) + count);
+                    dst = out->Delegate<char>(count);
                 } catch (const std::exception &e) {
                     cerr << e.what() << endl;
                     return std::make_shared<Result>(cudaErrorMemoryAllocation);
                 }
                 exit_code = cudaMemcpyAsync(dst, src, count, kind, stream);
-                try {
-                    LOG4CPLUS_DEBUG(Logger::getInstance(LOG4CPLUS_TEXT("GVirtuS")),
-                                    "cudaMemcpyAsync HostToDevice: dst: "
-                                        << dst << ", src: " << src << ", count: " << count
-                                        << ", kind: " << kind << ", stream: " << stream);
-                    out = std::make_shared<Buffer>();
-                    out->Add<char>((char *)dst, count);
-                } catch (const std::exception &e) {
-                    cerr << e.what() << endl;
-                    return std::make_shared<Result>(cudaErrorMemoryAllocation);
-                }
-                delete[] (char *)dst;
-                result = std::make_shared<Result>(exit_code, out);
+                LOG4CPLUS_DEBUG(Logger::getInstance(LOG4CPLUS_TEXT("GVirtuS")),
+                                "cudaMemcpyAsync DeviceToHost: dst: "
+                                    << dst << ", src: " << src << ", count: " << count
+                                    << ", kind: " << kind << ", stream: " << stream);
+                if (exit_code != cudaSuccess)
+                    result = std::make_shared<Result>(exit_code);
+                else
+                    result = std::make_shared<Result>(exit_code, out);
                 break;
             case cudaMemcpyDeviceToDevice:
                 dst = input_buffer->GetFromMarshal<void *>();
@@ -597,19 +738,12 @@ CUDA_ROUTINE_HANDLER(MemcpyAsync) {
 CUDA_ROUTINE_HANDLER(MemcpyFromSymbol) {
     try {
         void *dst = input_buffer->GetFromMarshal<void *>();
-        char *handler = input_buffer->AssignString();
-        char *symbol = input_buffer->AssignString();
-        handler = (char *)CudaUtil::UnmarshalPointer(handler);
+        const void *symbol = pThis->GetSymbol(input_buffer);
         size_t count = input_buffer->Get<size_t>();
         size_t offset = input_buffer->Get<size_t>();
         cudaMemcpyKind kind = input_buffer->Get<cudaMemcpyKind>();
 
-        size_t size;
-
-        if (cudaGetSymbolSize(&size, symbol) != cudaSuccess) {
-            symbol = handler;
-            cudaGetLastError();
-        }
+        if (symbol == nullptr) return std::make_shared<Result>(cudaErrorInvalidSymbol);
 
         cudaError_t exit_code;
         std::shared_ptr<Result> result = NULL;
@@ -792,16 +926,9 @@ CUDA_ROUTINE_HANDLER(MemcpyToSymbol) {
         cudaMemcpyKind kind = input_buffer->BackGet<cudaMemcpyKind>();
         size_t offset = input_buffer->BackGet<size_t>();
         size_t count = input_buffer->BackGet<size_t>();
-        char *handler = input_buffer->AssignString();
-        char *symbol = input_buffer->AssignString();
-
-        handler = (char *)CudaUtil::UnmarshalPointer(handler);
-        size_t size;
+        const void *symbol = pThis->GetSymbol(input_buffer);
 
-        if (cudaGetSymbolSize(&size, symbol) != cudaSuccess) {
-            symbol = handler;
-            cudaGetLastError();
-        }
+        if (symbol == nullptr) return std::make_shared<Result>(cudaErrorInvalidSymbol);
 
         cudaError_t exit_code;
         std::shared_ptr<Result> result = NULL;
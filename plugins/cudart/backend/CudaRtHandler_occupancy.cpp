@@ -31,7 +31,9 @@
 /*OccupancyMaxActiveBlocksPerMultiprocessor.*/
 CUDA_ROUTINE_HANDLER(OccupancyMaxActiveBlocksPerMultiprocessor) {
     int *numBlocks = input_buffer->Assign<int>();
-    const char *func = (const char *)(input_buffer->Get<pointer_t>());
+    auto function = pThis->GetFunction(input_buffer->Get<uint32_t>());
+    if (function == nullptr) return std::make_shared<Result>(cudaErrorInvalidDeviceFunction);
+    const void *func = function->host;
     int blockSize = input_buffer->Get<int>();
     size_t dynamicSMemSize = input_buffer->Get<size_t>();
 
@@ -53,7 +55,9 @@ CUDA_ROUTINE_HANDLER(OccupancyMaxActiveBlocksPerMultiprocessor) {
 /*OccupancyMaxActiveBlocksPerMultiprocessorWithFlags.*/
 CUDA_ROUTINE_HANDLER(OccupancyMaxActiveBlocksPerMultiprocessorWithFlags) {
     int *numBlocks = input_buffer->Assign<int>();
-    const char *func = (const char *)(input_buffer->Get<pointer_t>());
+    auto function = pThis->GetFunction(input_buffer->Get<uint32_t>());
+    if (function == nullptr) return std::make_shared<Result>(cudaErrorInvalidDeviceFunction);
+    const void *func = function->host;
     int blockSize = input_buffer->Get<int>();
     size_t dynamicSMemSize = input_buffer->Get<size_t>();
     unsigned int flags = input_buffer->Get<unsigned int>();
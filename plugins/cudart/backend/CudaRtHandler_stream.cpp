@@ -26,6 +26,7 @@
  *             Department of Computer Science, University College Dublin
  */
 
+#include "AutoGraphs.h"
 #include "CudaRtHandler.h"
 
 CUDA_ROUTINE_HANDLER(StreamCreate) {
@@ -74,6 +75,7 @@ CUDA_ROUTINE_HANDLER(StreamCreateWithFlags) {
 CUDA_ROUTINE_HANDLER(StreamDestroy) {
     try {
         cudaStream_t stream = input_buffer->Get<cudaStream_t>();
+        if (pThis->GetAutoGraphs() != nullptr) pThis->GetAutoGraphs()->Forget(stream);
         return std::make_shared<Result>(cudaStreamDestroy(stream));
     } catch (const std::exception& e) {
         cerr << e.what() << endl;
@@ -9,6 +9,8 @@
 #include <driver_types.h>
 #include <elf.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -153,4 +155,31 @@ typedef struct {
     std::vector<NvInfoKParam> params;
 } NvInfoFunction;
 
+// where an argument of a kernel goes in the arguments packed for a launch
+typedef struct {
+    uint16_t offset;
+    uint16_t size;
+} NvInfoArg;
+
+// the arguments of a kernel as a launch packs them, found once from its NvInfoKParam(s)
+typedef struct {
+    // the size of the arguments packed
+    size_t size;
+    // by ordinal
+    std::vector<NvInfoArg> args;
+} NvInfoArgsLayout;
+
+inline NvInfoArgsLayout getArgsLayout(const NvInfoFunction &function) {
+    NvInfoArgsLayout layout = {0, {}};
+    for (const NvInfoKParam &param : function.params) {
+        if (param.ordinal >= layout.args.size()) layout.args.resize(param.ordinal + 1, {0, 0});
+        layout.args[param.ordinal] = {param.offset, param.size_bytes()};
+        layout.size = std::max<size_t>(layout.size, param.offset + param.size_bytes());
+    }
+    return layout;
+}
+
+// the id of a kernel or a variable the backend has not registered
+#define NO_REGISTRATION_ID 0xffffffffu
+
 #endif  // GVIRTUS_CUDART_INTERNAL_H
@@ -40,17 +40,96 @@ map<const void*, mappedPointer>* CudaRtFrontend::mappedPointers = NULL;
 set<const void*>* CudaRtFrontend::devicePointers = NULL;
 map<pthread_t, stack<void*>*>* CudaRtFrontend::toManage = NULL;
 
-map<const void*, std::string>* CudaRtFrontend::mapHost2DeviceFunc = NULL;
 map<std::string, NvInfoFunction>* CudaRtFrontend::mapDeviceFunc2InfoFunc = NULL;
+std::vector<std::shared_ptr<KernelParamIndex>>* CudaRtFrontend::kernelParamIndices = NULL;
+std::mutex* CudaRtFrontend::infoFuncMutex = NULL;
+std::unordered_map<const void*, std::unique_ptr<CudaRtFrontend::Kernel>>* CudaRtFrontend::kernels =
+    NULL;
+std::unordered_map<const void*, uint32_t>* CudaRtFrontend::vars = NULL;
+std::shared_mutex* CudaRtFrontend::registrationsMutex = NULL;
+
+std::atomic<size_t> CudaRtFrontend::msLazyModules(0);
+std::atomic<bool> CudaRtFrontend::msCountRequests(false);
+std::atomic<uint64_t> CudaRtFrontend::msRequests(0);
 
 CudaRtFrontend::CudaRtFrontend() {
     if (devicePointers == NULL) devicePointers = new set<const void*>();
     if (mappedPointers == NULL) mappedPointers = new map<const void*, mappedPointer>();
 
-    if (mapHost2DeviceFunc == NULL) mapHost2DeviceFunc = new map<const void*, std::string>();
     if (mapDeviceFunc2InfoFunc == NULL)
         mapDeviceFunc2InfoFunc = new map<std::string, NvInfoFunction>();
+    if (kernelParamIndices == NULL)
+        kernelParamIndices = new std::vector<std::shared_ptr<KernelParamIndex>>();
+    if (infoFuncMutex == NULL) infoFuncMutex = new std::mutex();
+    if (kernels == NULL) kernels = new std::unordered_map<const void*, std::unique_ptr<Kernel>>();
+    if (vars == NULL) vars = new std::unordered_map<const void*, uint32_t>();
+    if (registrationsMutex == NULL) registrationsMutex = new std::shared_mutex();
 
     if (toManage == NULL) toManage = new map<pthread_t, stack<void*>*>();
     gvirtus::frontend::Frontend::GetFrontend();
-}
\ No newline at end of file
+}
+
+void CudaRtFrontend::addKernelParamIndex(std::shared_ptr<KernelParamIndex> index) {
+    std::lock_guard<std::mutex> lock(*infoFuncMutex);
+    kernelParamIndices->push_back(index);
+}
+
+NvInfoFunction CudaRtFrontend::getInfoFunc(std::string deviceFunc) {
+    std::lock_guard<std::mutex> lock(*infoFuncMutex);
+    auto it = mapDeviceFunc2InfoFunc->find(deviceFunc);
+    if (it != mapDeviceFunc2InfoFunc->end()) return it->second;
+    // the first fat binary registered with it, as when they were all parsed at start
+    NvInfoFunction infoFunction;
+    for (auto& index : *kernelParamIndices) {
+        if (!index->Find(deviceFunc, infoFunction)) continue;
+        mapDeviceFunc2InfoFunc->insert(make_pair(deviceFunc, infoFunction));
+        return infoFunction;
+    }
+    throw std::runtime_error("getInfoFunc: device function not found");
+}
+
+void CudaRtFrontend::addKernel(const void* hostFunc, const char* deviceFunc, uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(*registrationsMutex);
+    std::unique_ptr<Kernel>& kernel = (*kernels)[hostFunc];
+    // registered again, e.g. by a library loaded again: a launch may still use the old one
+    if (kernel != nullptr) kernel.release();
+    kernel = std::make_unique<Kernel>();
+    kernel->deviceFunc = deviceFunc;
+    kernel->id = id;
+}
+
+const CudaRtFrontend::Kernel* CudaRtFrontend::getKernel(const void* hostFunc) {
+    Kernel* kernel;
+    {
+        std::shared_lock<std::shared_mutex> lock(*registrationsMutex);
+        auto it = kernels->find(hostFunc);
+        if (it == kernels->end()) return nullptr;
+        kernel = it->second.get();
+    }
+    std::call_once(kernel->laidOut, [kernel]() {
+        try {
+            kernel->layout = getArgsLayout(getInfoFunc(kernel->deviceFunc));
+            kernel->found = true;
+        } catch (const std::exception&) {
+            cerr << "*** Error: no parameters for the kernel " << kernel->deviceFunc << endl;
+        }
+    });
+    return kernel;
+}
+
+uint32_t CudaRtFrontend::getKernelId(const void* hostFunc) {
+    std::shared_lock<std::shared_mutex> lock(*registrationsMutex);
+    auto it = kernels->find(hostFunc);
+    return it != kernels->end() ? it->second->id : NO_REGISTRATION_ID;
+}
+
+void CudaRtFrontend::addVar(const void* hostVar, uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(*registrationsMutex);
+    (*vars)[hostVar] = id;
+}
+
+uint32_t CudaRtFrontend::getVarId(const void* hostVar) {
+    std::shared_lock<std::shared_mutex> lock(*registrationsMutex);
+    auto it = vars->find(hostVar);
+    return it != vars->end() ? it->second : NO_REGISTRATION_ID;
+}
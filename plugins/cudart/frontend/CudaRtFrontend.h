@@ -33,10 +33,17 @@
 #include <cuda_runtime_api.h>
 #include <gvirtus/frontend/Frontend.h>
 
+#include "KernelParamIndex.h"
+
+#include <atomic>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <stack>
+#include <unordered_map>
 
 using namespace std;
 
@@ -48,6 +55,8 @@ typedef struct __configureFunction {
 class CudaRtFrontend {
    public:
     static inline void Execute(const char* routine, const Buffer* input_buffer = NULL) {
+        if (msCountRequests.load(std::memory_order_relaxed))
+            msRequests.fetch_add(1, std::memory_order_relaxed);
         try {
             gvirtus::frontend::Frontend::GetFrontend()->Execute(routine, input_buffer);
         } catch (const std::exception& e) {
@@ -55,6 +64,26 @@ class CudaRtFrontend {
         }
     }
 
+    /**
+     * Requests the execution of a routine without output parameters without
+     * waiting for its exit code. A failure is deferred and reported by the
+     * next synchronizing routine (see GetSynchronizingExitCode()).
+     *
+     * @param always true for the routines asynchronous in the CUDA API, sent
+     * asynchronously even without GVIRTUS_ASYNC.
+     */
+    static inline void ExecuteAsync(const char* routine, const Buffer* input_buffer = NULL,
+                                    bool always = false) {
+        if (msCountRequests.load(std::memory_order_relaxed))
+            msRequests.fetch_add(1, std::memory_order_relaxed);
+        try {
+            gvirtus::frontend::Frontend::GetFrontend()->ExecuteAsync(routine, input_buffer,
+                                                                     always);
+        } catch (const std::exception& e) {
+            cerr << "Execution exception: " << e.what() << endl;
+        }
+    }
+
     /**
      * Prepares the Frontend for the execution. This method _must_ be called
      * before any requests of execution or any method for adding parameters for
@@ -93,12 +122,33 @@ class CudaRtFrontend {
      * The optional parameter n is useful when adding an array: with n is
      * possible to specify the length of the array in terms of elements.
      *
+     * Large arrays are not copied but sent from ptr, which must not change
+     * until the request is executed.
+     *
      * @param ptr the pointer to add as a parameter.
      * @param n the length of the array, if ptr is an array.
      */
     template <class T>
     static inline void AddHostPointerForArguments(T* ptr, size_t n = 1) {
-        gvirtus::frontend::Frontend::GetFrontend()->GetInputBuffer()->Add(ptr, n);
+        gvirtus::frontend::Frontend::GetFrontend()->GetInputBuffer()->AddExternal(ptr, n);
+    }
+
+    /**
+     * Sends the host array src, of n elements, after the input parameters of
+     * the next execution request, for the backend to copy it in chunks as
+     * they arrive (see Frontend::SetInputTransfer()).
+     */
+    template <class T>
+    static inline void TransferInputFrom(const T* src, size_t n) {
+        gvirtus::frontend::Frontend::GetFrontend()->SetInputTransfer(src, sizeof(T) * n);
+    }
+
+    /**
+     * @return the size in bytes from which host arrays are sent with
+     * TransferInputFrom().
+     */
+    static inline size_t GetTransferThreshold() {
+        return gvirtus::frontend::Frontend::GetFrontend()->GetTransferThreshold();
     }
 
     /**
@@ -114,13 +164,24 @@ class CudaRtFrontend {
 
     /**
      * Adds a symbol, a named variable, as an input parameter for the next
-     * execution request.
+     * execution request: the id the backend gave it when it was registered.
      *
      * @param symbol the symbol to add as a parameter.
      */
-    static inline void AddSymbolForArguments(const char* symbol) {
-        AddStringForArguments(CudaUtil::MarshalHostPointer((void*)symbol));
-        AddStringForArguments(symbol);
+    static inline void AddSymbolForArguments(const void* symbol) {
+        AddVariableForArguments(getVarId(symbol));
+    }
+
+    /**
+     * Adds an host array of n elements as an input parameter for the next
+     * execution request, like AddHostPointerForArguments(), but leaves it to
+     * the caller to fill.
+     *
+     * @return where to write the array.
+     */
+    template <class T>
+    static inline T* DelegateForArguments(size_t n) {
+        return gvirtus::frontend::Frontend::GetFrontend()->GetInputBuffer()->Delegate<T>(n);
     }
 
     static inline cudaError_t GetExitCode() {
@@ -131,6 +192,20 @@ class CudaRtFrontend {
         return gvirtus::frontend::Frontend::GetFrontend()->Success(cudaSuccess);
     }
 
+    /**
+     * Returns the exit code of a synchronizing routine (cudaDeviceSynchronize,
+     * cudaStreamSynchronize, cudaGetLastError, device to host copies, ...):
+     * if the routine succeeded, the error deferred by an asynchronous
+     * execution, if any, is returned instead.
+     *
+     * @param reset false for leaving the deferred error in place.
+     */
+    static inline cudaError_t GetSynchronizingExitCode(bool reset = true) {
+        gvirtus::frontend::Frontend* frontend = gvirtus::frontend::Frontend::GetFrontend();
+        if (!frontend->Success(cudaSuccess)) return (cudaError_t)frontend->GetExitCode();
+        return (cudaError_t)frontend->GetDeferredExitCode("cuda", reset);
+    }
+
     template <class T>
     static inline T GetOutputVariable() {
         return gvirtus::frontend::Frontend::GetFrontend()->GetOutputBuffer()->Get<T>();
@@ -151,6 +226,54 @@ class CudaRtFrontend {
         return gvirtus::frontend::Frontend::GetFrontend()->GetOutputBuffer()->Assign<T>(n);
     }
 
+    /**
+     * Retrieves an host array from the output parameters of the last execution
+     * request into dst. If ReceiveOutputInto() was called before Execute() the
+     * array has already been received there and nothing is copied.
+     *
+     * @param dst where to copy the array.
+     * @param n the length of the array.
+     */
+    template <class T>
+    static inline void GetOutputHostArray(T* dst, size_t n = 1) {
+        auto frontend = gvirtus::frontend::Frontend::GetFrontend();
+        if (!frontend->OutputReceived())
+            memmove(dst, frontend->GetOutputBuffer()->Assign<T>(n), sizeof(T) * n);
+    }
+
+    /**
+     * Makes the next Execute() receive its output array, of n elements,
+     * straight into dst (see Frontend::SetOutputDestination()).
+     */
+    template <class T>
+    static inline void ReceiveOutputInto(T* dst, size_t n = 1) {
+        gvirtus::frontend::Frontend::GetFrontend()->SetOutputDestination(dst, sizeof(T) * n);
+    }
+
+    /**
+     * Makes the output array of the next ExecuteAsync() land on stream, so
+     * that any thread synchronizing the stream receives it (see
+     * SynchronizeOutputs()).
+     */
+    static inline void ReceiveOutputOnStream(cudaStream_t stream) {
+        gvirtus::frontend::Frontend::GetFrontend()->SetOutputStream(stream);
+    }
+
+    /**
+     * Receives the device to host copies on stream, or on every stream when
+     * all is true, still pending in the other threads of the process: called
+     * by the routines synchronizing with the host (cudaStreamSynchronize,
+     * cudaEventSynchronize, cudaDeviceSynchronize, ...), their errors are
+     * returned by GetSynchronizingExitCode().
+     */
+    static inline void SynchronizeOutputs(cudaStream_t stream, bool all = false) {
+        try {
+            gvirtus::frontend::Frontend::GetFrontend()->SynchronizeOutputs(stream, all);
+        } catch (const std::exception& e) {
+            cerr << "Execution exception: " << e.what() << endl;
+        }
+    }
+
     /**
      * Retrives a device pointer from the output parameters of the last
      * execution request.
@@ -256,27 +379,73 @@ class CudaRtFrontend {
 
     static inline void addConfigureElement() {}
 
-    static inline void addDeviceFunc2InfoFunc(std::string deviceFunc, NvInfoFunction infoFunction) {
-        mapDeviceFunc2InfoFunc->insert(make_pair(deviceFunc, infoFunction));
-    }
+    /**
+     * Adds the kernels of a fat binary, looked up in index as they are
+     * launched.
+     */
+    static void addKernelParamIndex(std::shared_ptr<KernelParamIndex> index);
 
-    static inline NvInfoFunction getInfoFunc(std::string deviceFunc) {
-        if (mapDeviceFunc2InfoFunc->find(deviceFunc) == mapDeviceFunc2InfoFunc->end()) {
-            throw std::runtime_error("getInfoFunc: device function not found");
-        }
-        return mapDeviceFunc2InfoFunc->find(deviceFunc)->second;
+    static NvInfoFunction getInfoFunc(std::string deviceFunc);
+
+    /**
+     * A kernel registered with the backend: a launch names it by the id the
+     * backend gave it, and packs its arguments as the layout found the first
+     * time it is launched says.
+     */
+    struct Kernel {
+        std::string deviceFunc;
+        uint32_t id = NO_REGISTRATION_ID;
+        std::once_flag laidOut;
+        /* false if no fat binary has its parameters */
+        bool found = false;
+        NvInfoArgsLayout layout;
     };
 
-    static inline void addHost2DeviceFunc(const void* hostFunc, std::string deviceFunc) {
-        mapHost2DeviceFunc->insert(make_pair(hostFunc, deviceFunc));
+    /**
+     * Records the id the backend gave to the kernel deviceFunc, registered
+     * with hostFunc.
+     */
+    static void addKernel(const void* hostFunc, const char* deviceFunc, uint32_t id);
+
+    /**
+     * @return the kernel registered with hostFunc, laid out, nullptr if there
+     * is none.
+     */
+    static const Kernel* getKernel(const void* hostFunc);
+
+    /**
+     * @return the id of the kernel registered with hostFunc, without laying
+     * it out, NO_REGISTRATION_ID if there is none.
+     */
+    static uint32_t getKernelId(const void* hostFunc);
+
+    /**
+     * Records the id the backend gave to the variable registered with hostVar.
+     */
+    static void addVar(const void* hostVar, uint32_t id);
+
+    /**
+     * @return the id of the variable registered with hostVar,
+     * NO_REGISTRATION_ID if there is none.
+     */
+    static uint32_t getVarId(const void* hostVar);
+
+    /**
+     * Sends to the backend the fat binary defining the kernel or the variable
+     * at host, if it was registered lazily (see GVIRTUS_LAZY_MODULES) and is
+     * not there yet: the routines naming a kernel or a symbol call it first.
+     */
+    static inline void LoadModule(const void* host) {
+        if (msLazyModules.load(std::memory_order_acquire) > 0) LoadLazyModule(host);
     }
 
-    static inline std::string getDeviceFunc(const void* hostFunc) {
-        if (mapHost2DeviceFunc->find(hostFunc) == mapHost2DeviceFunc->end()) {
-            throw std::runtime_error("getDeviceFunc: host function not found");
-        }
-        return mapHost2DeviceFunc->find(hostFunc)->second;
-    };
+    static void LoadLazyModule(const void* host);
+
+    /* the fat binaries registered lazily and not sent yet */
+    static std::atomic<size_t> msLazyModules;
+    /* the requests sent, counted while the lazy fat binaries are streamed */
+    static std::atomic<bool> msCountRequests;
+    static std::atomic<uint64_t> msRequests;
 
     CudaRtFrontend();
 
@@ -305,7 +474,12 @@ class CudaRtFrontend {
     Buffer* mpInputBuffer;
     bool configured;
     static map<std::string, NvInfoFunction>* mapDeviceFunc2InfoFunc;
-    static map<const void*, std::string>* mapHost2DeviceFunc;
+    static std::vector<std::shared_ptr<KernelParamIndex>>* kernelParamIndices;
+    static std::mutex* infoFuncMutex;
+    /* the kernels and the variables registered, by host pointer */
+    static std::unordered_map<const void*, std::unique_ptr<Kernel>>* kernels;
+    static std::unordered_map<const void*, uint32_t>* vars;
+    static std::shared_mutex* registrationsMutex;
 };
 
 #endif /* CUDARTFRONTEND_H */
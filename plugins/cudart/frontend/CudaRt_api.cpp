@@ -27,8 +27,11 @@
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaFuncSetAttribute(const void* func,
                                                                cudaFuncAttribute attr, int value) {
+    CudaRtFrontend::LoadModule(func);
+    uint32_t id = CudaRtFrontend::getKernelId(func);
+    if (id == NO_REGISTRATION_ID) return cudaErrorInvalidDeviceFunction;
     CudaRtFrontend::Prepare();
-    CudaRtFrontend::AddDevicePointerForArguments(func);
+    CudaRtFrontend::AddVariableForArguments(id);
     CudaRtFrontend::AddVariableForArguments(attr);
     CudaRtFrontend::AddVariableForArguments(value);
     CudaRtFrontend::Execute("cudaFuncSetAttribute");
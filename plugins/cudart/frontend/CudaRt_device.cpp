@@ -115,9 +115,10 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaDeviceReset(void) {
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaDeviceSynchronize(void) {
+    CudaRtFrontend::SynchronizeOutputs(NULL, true);
     CudaRtFrontend::Prepare();
     CudaRtFrontend::Execute("cudaDeviceSynchronize");
-    return CudaRtFrontend::GetExitCode();
+    return CudaRtFrontend::GetSynchronizingExitCode();
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaSetValidDevices(int *device_arr, int len) {
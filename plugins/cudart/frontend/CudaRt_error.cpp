@@ -44,13 +44,13 @@ extern "C" __host__ const char* CUDARTAPI cudaGetErrorString(cudaError_t error)
 extern "C" __host__ cudaError_t CUDARTAPI cudaPeekAtLastError(void) {
     CudaRtFrontend::Prepare();
     CudaRtFrontend::Execute("cudaPeekAtLastError");
-    return CudaRtFrontend::GetExitCode();
+    return CudaRtFrontend::GetSynchronizingExitCode(false);
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaGetLastError(void) {
     CudaRtFrontend::Prepare();
     CudaRtFrontend::Execute("cudaGetLastError");
-    return CudaRtFrontend::GetExitCode();
+    return CudaRtFrontend::GetSynchronizingExitCode();
 }
 
 extern "C" __host__ __device__ const char* CUDARTAPI cudaGetErrorName(cudaError_t error) {
@@ -65,6 +65,8 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaEventQuery(cudaEvent_t event) {
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddDevicePointerForArguments(event);
     CudaRtFrontend::Execute("cudaEventQuery");
+    // as cudaStreamQuery(), on every stream: the one of the event is not known here
+    if (CudaRtFrontend::Success()) CudaRtFrontend::SynchronizeOutputs(NULL, true);
     return CudaRtFrontend::GetExitCode();
 }
 
@@ -72,13 +74,15 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaEventRecord(cudaEvent_t event, cud
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddDevicePointerForArguments(event);
     CudaRtFrontend::AddDevicePointerForArguments(stream);
-    CudaRtFrontend::Execute("cudaEventRecord");
+    CudaRtFrontend::ExecuteAsync("cudaEventRecord");
     return CudaRtFrontend::GetExitCode();
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaEventSynchronize(cudaEvent_t event) {
+    // the stream the event was recorded on is not known here
+    CudaRtFrontend::SynchronizeOutputs(NULL, true);
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddDevicePointerForArguments(event);
     CudaRtFrontend::Execute("cudaEventSynchronize");
-    return CudaRtFrontend::GetExitCode();
+    return CudaRtFrontend::GetSynchronizingExitCode();
 }
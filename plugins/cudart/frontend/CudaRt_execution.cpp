@@ -47,9 +47,12 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaConfigureCall(dim3 gridDim, dim3 b
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaFuncGetAttributes(struct cudaFuncAttributes *attr,
                                                                 const void *func) {
+    CudaRtFrontend::LoadModule(func);
+    uint32_t id = CudaRtFrontend::getKernelId(func);
+    if (id == NO_REGISTRATION_ID) return cudaErrorInvalidDeviceFunction;
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddHostPointerForArguments(attr);
-    CudaRtFrontend::AddVariableForArguments((gvirtus::common::pointer_t)func);
+    CudaRtFrontend::AddVariableForArguments(id);
     CudaRtFrontend::Execute("cudaFuncGetAttributes");
     if (CudaRtFrontend::Success())
         memmove(attr, CudaRtFrontend::GetOutputHostPointer<cudaFuncAttributes>(),
@@ -59,8 +62,11 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaFuncGetAttributes(struct cudaFuncA
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaFuncSetCacheConfig(const void *func,
                                                                  cudaFuncCache cacheConfig) {
+    CudaRtFrontend::LoadModule(func);
+    uint32_t id = CudaRtFrontend::getKernelId(func);
+    if (id == NO_REGISTRATION_ID) return cudaErrorInvalidDeviceFunction;
     CudaRtFrontend::Prepare();
-    CudaRtFrontend::AddVariableForArguments((gvirtus::common::pointer_t)func);
+    CudaRtFrontend::AddVariableForArguments(id);
     CudaRtFrontend::AddVariableForArguments(cacheConfig);
     CudaRtFrontend::Execute("cudaFuncSetCacheConfig");
 
@@ -68,6 +74,7 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaFuncSetCacheConfig(const void *fun
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaLaunch(const void *entry) {
+    CudaRtFrontend::LoadModule(entry);
     Buffer *launch = CudaRtFrontend::GetLaunchBuffer();
     launch->Add<int>(0x4c41554e);
     launch->Add<gvirtus::common::pointer_t>((gvirtus::common::pointer_t)entry);
@@ -117,6 +124,9 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaSetupArgument(const void *arg, siz
 // TODO: needs testing
 extern "C" __host__ cudaError_t cudaLaunchKernelExC(const cudaLaunchConfig_t *config,
                                                     const void *func, void **args) {
+    CudaRtFrontend::LoadModule(func);
+    const CudaRtFrontend::Kernel *kernel = CudaRtFrontend::getKernel(func);
+    if (kernel == nullptr || !kernel->found) return cudaErrorInvalidDeviceFunction;
     CudaRtFrontend::Prepare();
 
     // A vector with the mapped pointers to be marshalled and unmarshalled
@@ -130,32 +140,14 @@ extern "C" __host__ cudaError_t cudaLaunchKernelExC(const cudaLaunchConfig_t *co
     CudaRtFrontend::AddVariableForArguments(config->dynamicSmemBytes);
     CudaRtFrontend::AddDevicePointerForArguments(config->stream);
 
-    std::string deviceFunc = CudaRtFrontend::getDeviceFunc(const_cast<void *>(func));
-    NvInfoFunction infoFunction = CudaRtFrontend::getInfoFunc(deviceFunc);
-
-    size_t argsPayloadSize = 0;
-    for (NvInfoKParam infoKParam : infoFunction.params) {
-        argsPayloadSize += infoKParam.size_bytes();
-        // argsPayloadSize += (infoKParam.size & 0xf8) >> 2; // masking to get the size in bytes
-    }
-
-    byte *pArgsPayload = static_cast<byte *>(malloc(argsPayloadSize));
-    memset(pArgsPayload, 0x00, argsPayloadSize);
-
-    for (NvInfoKParam infoKParam : infoFunction.params) {
-        byte *p = pArgsPayload + infoKParam.offset;
-        memcpy(p, args[infoKParam.ordinal], infoKParam.size_bytes());
-        // memcpy(p, args[infoKParam.ordinal], (infoKParam.size & 0xf8) >> 2); // masking to get the
-        // size in bytes
-    }
-
-    CudaRtFrontend::AddHostPointerForArguments<byte>(pArgsPayload, argsPayloadSize);
+    const NvInfoArgsLayout &layout = kernel->layout;
+    byte *pArgsPayload = CudaRtFrontend::DelegateForArguments<byte>(layout.size);
+    memset(pArgsPayload, 0x00, layout.size);
+    for (size_t i = 0; i < layout.args.size(); i++)
+        memcpy(pArgsPayload + layout.args[i].offset, args[i], layout.args[i].size);
 
     CudaRtFrontend::Execute("cudaLaunchKernelExC");
-    cudaError_t cudaError = CudaRtFrontend::GetExitCode();
-    free(pArgsPayload);
-
-    return cudaError;
+    return CudaRtFrontend::GetExitCode();
 }
 
 // TODO: needs testing
@@ -172,43 +164,26 @@ extern "C" __host__ cudaError_t cudaLaunchHostFunc(cudaStream_t stream, cudaHost
 extern "C" __host__ cudaError_t cudaLaunchKernel(const void *func, dim3 gridDim, dim3 blockDim,
                                                  void **args, size_t sharedMem,
                                                  cudaStream_t stream) {
+    CudaRtFrontend::LoadModule(func);
+    const CudaRtFrontend::Kernel *kernel = CudaRtFrontend::getKernel(func);
+    if (kernel == nullptr || kernel->id == NO_REGISTRATION_ID || !kernel->found)
+        return cudaErrorInvalidDeviceFunction;
+
     CudaRtFrontend::Prepare();
-    CudaRtFrontend::AddDevicePointerForArguments(func);
+    CudaRtFrontend::AddVariableForArguments(kernel->id);
     CudaRtFrontend::AddVariableForArguments(gridDim);
     CudaRtFrontend::AddVariableForArguments(blockDim);
     CudaRtFrontend::AddVariableForArguments(sharedMem);
     CudaRtFrontend::AddDevicePointerForArguments(stream);
 
-    std::string deviceFunc = CudaRtFrontend::getDeviceFunc(func);
-    NvInfoFunction infoFunction = CudaRtFrontend::getInfoFunc(deviceFunc);
-
-    // to pass the args to the backend we need their total size
-    // we have this info in the infoFunction, so we can calculate the total size
-    size_t argsPayloadSize = 0;
-    for (const NvInfoKParam &p : infoFunction.params) {
-        size_t end = p.offset + p.size_bytes();
-        if (end > argsPayloadSize) {
-            argsPayloadSize = end;
-        }
-    }
-
-    // cout << "argsPayloadSize: " << argsPayloadSize << endl;
+    // the arguments are packed straight into the request, where the backend finds them as the
+    // layout of the kernel says
+    const NvInfoArgsLayout &layout = kernel->layout;
+    byte *pArgsPayload = CudaRtFrontend::DelegateForArguments<byte>(layout.size);
+    memset(pArgsPayload, 0x00, layout.size);
+    for (size_t i = 0; i < layout.args.size(); i++)
+        memcpy(pArgsPayload + layout.args[i].offset, args[i], layout.args[i].size);
 
-    byte *pArgsPayload = (byte *)calloc(argsPayloadSize, 1);
-    for (NvInfoKParam infoKParam : infoFunction.params) {
-        // cout << "Setting argument for ordinal: " << infoKParam.ordinal
-        //      << ", offset: " << infoKParam.offset
-        //      << ", size: " << infoKParam.size_bytes() << endl;
-        memcpy(pArgsPayload + infoKParam.offset, args[infoKParam.ordinal], infoKParam.size_bytes());
-    }
-
-    CudaRtFrontend::AddHostPointerForArguments<byte>(pArgsPayload, argsPayloadSize);
-    // cout << "GridDim: " << gridDim.x << "," << gridDim.y << "," << gridDim.z << endl;
-    // cout << "BlockDim: " << blockDim.x << "," << blockDim.y << "," << blockDim.z << endl;
-    // cout << "SharedMem: " << sharedMem << endl;
-    // cout << "Stream: " << stream << endl;
-
-    CudaRtFrontend::Execute("cudaLaunchKernel");
-    free(pArgsPayload);
+    CudaRtFrontend::ExecuteAsync("cudaLaunchKernel");
     return CudaRtFrontend::GetExitCode();
-}
\ No newline at end of file
+}
@@ -28,103 +28,17 @@
  */
 
 #include <CudaRt_internal.h>
-#include <lz4.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "CudaRt.h"
 
-// Helper: allocate and copy section headers table
-Elf64_Shdr *copySectionHeaders(const Elf64_Ehdr *eh) {
-    // cout << "Will malloc "<< eh->e_shnum << " section headers of " << eh->e_shentsize << " bytes
-    // each." << endl;
-    Elf64_Shdr *sh_table = (Elf64_Shdr *)malloc(eh->e_shentsize * eh->e_shnum);
-    if (!sh_table) return nullptr;
-
-    byte *baseAddr = (byte *)eh;
-    for (uint32_t i = 0; i < eh->e_shnum; i++) {
-        // cout << "Section header " << i << " starts at adress: " << hex << (baseAddr + eh->e_shoff
-        // + i * eh->e_shentsize) << dec << endl;
-        Elf64_Shdr *src = (Elf64_Shdr *)(baseAddr + eh->e_shoff + i * eh->e_shentsize);
-        memcpy(&sh_table[i], src, eh->e_shentsize);
-    }
-    return sh_table;
-}
-
-// Helper: allocate and copy section header string table
-char *copySectionHeaderStrTable(const Elf64_Ehdr *eh, Elf64_Shdr *sh_table) {
-    uint8_t *sh_str_table_bytes = (uint8_t *)&sh_table[eh->e_shstrndx];
-    // for (int i = 0; i < sizeof(Elf64_Shdr); i++) {
-    //     printf("%02x ", sh_str_table_bytes[i]);
-    // }
-    // printf("\n");
-
-    size_t offset = sh_table[eh->e_shstrndx].sh_offset;
-    size_t size = sh_table[eh->e_shstrndx].sh_size;
-    // cout << "sh_table address: " << hex << (void *)sh_table << dec << endl;
-    // cout << "offset address: " << hex << (void *)(&sh_table[eh->e_shstrndx].sh_offset) << dec <<
-    // endl; cout << "size address: " << hex << (void *)(&sh_table[eh->e_shstrndx].sh_size) << dec
-    // << endl; cout << "section header string table index: " << eh->e_shstrndx << " has offset: "
-    // << offset << " and size: " << size << endl;
-    char *sh_str = (char *)malloc(size);
-    if (!sh_str) return nullptr;
-
-    byte *baseAddr = (byte *)eh;
-    memcpy(sh_str, baseAddr + offset, size);
-    return sh_str;
-}
-
-// Helper: parse NvInfo sections and register functions and their parameters
-void parseNvInfoKParams(const Elf64_Ehdr *eh, Elf64_Shdr *sh_table, char *sh_str) {
-    byte *baseAddr = (byte *)eh;
-    // cout << "Processing " << eh->e_shnum << " sections." << endl;
-    for (uint32_t i = 0; i < eh->e_shnum; i++) {
-        // cout << "Processing section " << i + 1 << " of " << eh->e_shnum << endl;
-        char *sectionName = sh_str + sh_table[i].sh_name;
-        if (strncmp(".nv.info.", sectionName, strlen(".nv.info.")) != 0) {
-            // cout << "Skipping section: " << sectionName << endl;
-            continue;
-        }
-
-        char *funcName = sectionName + strlen(".nv.info.");
-        // cout << "Found NvInfo section: " << funcName << endl;
-        byte *sectionData = baseAddr + sh_table[i].sh_offset;
-
-        NvInfoFunction infoFunction;
-
-        NvInfoAttribute *pAttr = (NvInfoAttribute *)sectionData;
-        byte *sectionEnd = sectionData + sh_table[i].sh_size;
-
-        // cout << "Section data start at: " << hex << sectionData << " and end at: " << sectionEnd
-        // << dec << endl;
-
-        while ((byte *)pAttr < sectionEnd) {
-            size_t size = sizeof(NvInfoAttribute);
-            // cout << "Processing attribute: " << pAttr->attr << ", fmt: " << pAttr->fmt << ",
-            // value: " << pAttr->value << endl;
-            if (pAttr->fmt == EIFMT_SVAL) {
-                // cout << "Attribute is a string value." << endl;
-                size += pAttr->value;
-            }
-            if (pAttr->attr == EIATTR_KPARAM_INFO) {
-                // cout << "Attribute is a KParam info." << endl;
-                NvInfoKParam *nvInfoKParam = (NvInfoKParam *)pAttr;
-                infoFunction.params.push_back(*nvInfoKParam);
-                // cout << nvInfoKParam->index << ", "
-                //      << nvInfoKParam->ordinal << ", "
-                //      << nvInfoKParam->offset << ", "
-                //      << nvInfoKParam->log_alignment() << ", "
-                //      << nvInfoKParam->space() << ", "
-                //      << nvInfoKParam->cbank() << ", "
-                //      << nvInfoKParam->is_cbank() << ", "
-                //      << nvInfoKParam->size_bytes() << endl;
-            }
-            pAttr = (NvInfoAttribute *)((byte *)pAttr + size);
-        }
-        CudaRtFrontend::addDeviceFunc2InfoFunc(funcName, infoFunction);
-    }
-}
-
 void writeCudaFatBinaryToFile(const void *data, const unsigned long long int fatBinSize,
                               const std::string &filename) {
     FILE *file = fopen(filename.c_str(), "rb");
@@ -145,130 +59,37 @@ void writeCudaFatBinaryToFile(const void *data, const unsigned long long int fat
     fclose(file);
 }
 
-/*
- Routines not found in the cuda's header files.
- KEEP THEM WITH CARE
- */
-
-extern "C" __host__ void **__cudaRegisterFatBinary(void *fatCubin) {
-    /* Fake host pointer */
-    __fatBinC_Wrapper_t *bin = (__fatBinC_Wrapper_t *)fatCubin;
-    if (bin->magic != FATBINWRAPPER_MAGIC) {
-        cerr << "*** Error: Invalid fat binary magic number" << endl;
-        return nullptr;  // Not a valid fat binary
-    }
-    // cout << "Fat binary wrapper magic: " << hex << bin->magic << endl;
-    struct fatBinaryHeader *fatBinHdr = (struct fatBinaryHeader *)bin->data;
-    if (fatBinHdr->magic != FATBIN_MAGIC || fatBinHdr->version != 1) {
-        cerr << "*** Error: Invalid fat binary" << endl;
-        return nullptr;  // Not a valid fat binary
-    }
-    // cout << "Fat binary header size: " << fatBinHdr->headerSize << endl;
-    // cout << "Fat binary size: " << fatBinHdr->fatSize << endl;
-
-    // only for debugging purposes
-    // writeCudaFatBinaryToFile(fatBinHdr, fatBinHdr->headerSize + fatBinHdr->fatSize,
-    // "fat_binary.cubin");
-
-    uint8_t *data_ptr = (uint8_t *)bin->data + fatBinHdr->headerSize;
-    size_t remaining_size = fatBinHdr->fatSize;
-
-    std::vector<char> cubin;
-    while (remaining_size > 0) {
-        fatBinData_t *fatBinData = (fatBinData_t *)data_ptr;
-        if (fatBinData->version != 0x0101 || (fatBinData->kind != 1 && fatBinData->kind != 2)) {
-            cerr << "*** Error: Invalid fat binary data version or kind" << endl;
-            return nullptr;  // Not a valid fat binary data
-        }
-
-        // cout << "Processing fat binary data of kind: " << fatBinData->kind
-        //     << " and smVersion: " << fatBinData->smVersion << endl;
-
-        data_ptr += fatBinData->headerSize;
-
-        if (fatBinData->uncompressedPayload != 0) {
-            const char *compressed_data = (char *)data_ptr;
-            int compressed_size = fatBinData->payloadSize;
-            data_ptr += fatBinData->paddedPayloadSize;
-
-            // Prepare output buffer with the expected decompressed size
-            cubin.resize(fatBinData->uncompressedPayload);
-
-            // Decompress - LZ4_decompress_safe returns decompressed size or < 0 on error
-            int decompressed_size = LZ4_decompress_safe(
-                compressed_data, cubin.data(), compressed_size, fatBinData->uncompressedPayload);
-
-            if (decompressed_size < 0) {
-                cerr << "*** Error: LZ4 decompression failed with code " << decompressed_size
-                     << endl;
-                return nullptr;  // Decompression failed
-            }
-        } else {
-            cubin.resize(fatBinData->paddedPayloadSize);
-            memcpy(cubin.data(), data_ptr, fatBinData->paddedPayloadSize);
-            data_ptr += fatBinData->paddedPayloadSize;
-        }
-
-        if (fatBinData->kind == 2) {
-            if (memcmp(cubin.data(), ELF_MAGIC, ELF_MAGIC_SIZE) != 0) {
-                cerr << "*** Error: Invalid ELF magic number in fat binary" << endl;
-                return nullptr;  // Not a valid ELF file
-            }
-            Elf64_Ehdr *eh = (Elf64_Ehdr *)(cubin.data());
-
-            Elf64_Shdr *sh_table = copySectionHeaders(eh);
-            if (!sh_table) return nullptr;
-
-            char *sh_str = copySectionHeaderStrTable(eh, sh_table);
-            if (!sh_str) {
-                free(sh_table);
-                return nullptr;
-            }
-
-            parseNvInfoKParams(eh, sh_table, sh_str);
-
-            free(sh_str);
-            free(sh_table);
-        }
-        remaining_size -= (fatBinData->headerSize + fatBinData->paddedPayloadSize);
-    }
-
-    Buffer *input_buffer = new Buffer();
-    input_buffer->AddString(CudaUtil::MarshalHostPointer((void **)bin));
-    input_buffer = CudaUtil::MarshalFatCudaBinary(bin, input_buffer);
-
+// Helper: send a fat binary to the backend, or only its hash if the backend has it already
+static bool sendFatBinary(__fatBinC_Wrapper_t *bin, const std::string &hash) {
+    // the backend may have it already, registered by another frontend or persisted: then it is
+    // not uploaded again
     CudaRtFrontend::Prepare();
-    CudaRtFrontend::Execute("cudaRegisterFatBinary", input_buffer);
-    if (CudaRtFrontend::Success()) return (void **)fatCubin;
-
-    return nullptr;
-}
-
-extern "C" __host__ void **__cudaRegisterFatBinaryEnd(void *fatCubin) {
-    /* Fake host pointer */
-    __fatBinC_Wrapper_t *bin = (__fatBinC_Wrapper_t *)fatCubin;
-    char *data = (char *)bin->data;
+    CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer((void **)bin));
+    CudaRtFrontend::AddStringForArguments(hash.c_str());
+    CudaRtFrontend::Execute("cudaRegisterCachedFatBinary");
+    if (CudaRtFrontend::Success() && CudaRtFrontend::GetOutputVariable<bool>()) return true;
 
     Buffer *input_buffer = new Buffer();
     input_buffer->AddString(CudaUtil::MarshalHostPointer((void **)bin));
     input_buffer = CudaUtil::MarshalFatCudaBinary(bin, input_buffer);
 
     CudaRtFrontend::Prepare();
-    CudaRtFrontend::Execute("cudaRegisterFatBinaryEnd", input_buffer);
-    if (CudaRtFrontend::Success()) return (void **)fatCubin;
-    return NULL;
+    CudaRtFrontend::Execute("cudaRegisterFatBinary", input_buffer);
+    return CudaRtFrontend::Success();
 }
 
-extern "C" __host__ void __cudaUnregisterFatBinary(void **fatCubinHandle) {
+static bool sendFatBinaryEnd(void *fatCubin) {
+    // the backend has the fat binary already: the handler is enough
     CudaRtFrontend::Prepare();
-    CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(fatCubinHandle));
-    CudaRtFrontend::Execute("cudaUnregisterFatBinary");
+    CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(fatCubin));
+    CudaRtFrontend::Execute("cudaRegisterFatBinaryEnd");
+    return CudaRtFrontend::Success();
 }
 
-extern "C" __host__ void __cudaRegisterFunction(void **fatCubinHandle, const char *hostFun,
-                                                char *deviceFun, const char *deviceName,
-                                                int thread_limit, uint3 *tid, uint3 *bid,
-                                                dim3 *bDim, dim3 *gDim, int *wSize) {
+// Helper: register a kernel, recording the id the backend gives it
+static void sendFunction(void **fatCubinHandle, const char *hostFun, const char *deviceFun,
+                         const char *deviceName, int thread_limit, uint3 *tid, uint3 *bid,
+                         dim3 *bDim, dim3 *gDim, int *wSize) {
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(fatCubinHandle));
 
@@ -283,23 +104,23 @@ extern "C" __host__ void __cudaRegisterFunction(void **fatCubinHandle, const cha
     CudaRtFrontend::AddHostPointerForArguments(wSize);
 
     CudaRtFrontend::Execute("cudaRegisterFunction");
+    if (!CudaRtFrontend::Success()) return;
 
     deviceFun = CudaRtFrontend::GetOutputString();
-    tid = CudaRtFrontend::GetOutputHostPointer<uint3>();
-    bid = CudaRtFrontend::GetOutputHostPointer<uint3>();
-    bDim = CudaRtFrontend::GetOutputHostPointer<dim3>();
-    gDim = CudaRtFrontend::GetOutputHostPointer<dim3>();
-    wSize = CudaRtFrontend::GetOutputHostPointer<int>();
-
-    CudaRtFrontend::addHost2DeviceFunc((void *)hostFun, deviceFun);
+    CudaRtFrontend::GetOutputHostPointer<uint3>();
+    CudaRtFrontend::GetOutputHostPointer<uint3>();
+    CudaRtFrontend::GetOutputHostPointer<dim3>();
+    CudaRtFrontend::GetOutputHostPointer<dim3>();
+    CudaRtFrontend::GetOutputHostPointer<int>();
+    CudaRtFrontend::addKernel(hostFun, deviceFun, CudaRtFrontend::GetOutputVariable<uint32_t>());
 }
 
-extern "C" __host__ void __cudaRegisterVar(void **fatCubinHandle, char *hostVar,
-                                           char *deviceAddress, const char *deviceName, int ext,
-                                           int size, int constant, int global) {
+// Helper: register a variable, recording the id the backend gives it
+static void sendVar(void **fatCubinHandle, const char *hostVar, const char *deviceAddress,
+                    const char *deviceName, int ext, int size, int constant, int global) {
+    // the backend registers it with a host shadow of its own
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(fatCubinHandle));
-    CudaRtFrontend::AddStringForArguments(hostVar);
     CudaRtFrontend::AddStringForArguments(deviceAddress);
     CudaRtFrontend::AddStringForArguments(deviceName);
     CudaRtFrontend::AddVariableForArguments(ext);
@@ -315,26 +136,310 @@ extern "C" __host__ void __cudaRegisterVar(void **fatCubinHandle, char *hostVar,
     //      << ", constant: " << constant
     //      << ", global: " << global << endl;
     CudaRtFrontend::Execute("cudaRegisterVar");
+    if (CudaRtFrontend::Success())
+        CudaRtFrontend::addVar(hostVar, CudaRtFrontend::GetOutputVariable<uint32_t>());
 }
 
-extern "C" __host__ void __cudaRegisterShared(void **fatCubinHandle, void **devicePtr) {
+static void sendShared(void **fatCubinHandle, const char *devicePtr) {
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(fatCubinHandle));
-    CudaRtFrontend::AddStringForArguments((char *)devicePtr);
+    CudaRtFrontend::AddStringForArguments(devicePtr);
     CudaRtFrontend::Execute("cudaRegisterShared");
 }
 
-extern "C" __host__ void __cudaRegisterSharedVar(void **fatCubinHandle, void **devicePtr,
-                                                 size_t size, size_t alignment, int storage) {
+static void sendSharedVar(void **fatCubinHandle, const char *devicePtr, size_t size,
+                          size_t alignment, int storage) {
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(fatCubinHandle));
-    CudaRtFrontend::AddStringForArguments((char *)devicePtr);
+    CudaRtFrontend::AddStringForArguments(devicePtr);
     CudaRtFrontend::AddVariableForArguments(size);
     CudaRtFrontend::AddVariableForArguments(alignment);
     CudaRtFrontend::AddVariableForArguments(storage);
     CudaRtFrontend::Execute("cudaRegisterSharedVar");
 }
 
+extern std::string getEnvVar(std::string const &key);
+
+namespace {
+/*
+ * The fat binaries registered lazily (GVIRTUS_LAZY_MODULES=on): a fat binary,
+ * and what is registered in it, is recorded here and sent to the backend only
+ * when a routine first names one of its kernels or variables, see
+ * CudaRtFrontend::LoadModule(); most applications use a few of the kernels of
+ * the libraries they load. With GVIRTUS_LAZY_MODULES=background, a thread
+ * also sends the other ones, one at a time, while the application makes no
+ * requests.
+ */
+class LazyModules {
+   public:
+    /* never destroyed: the fat binaries are unregistered at exit */
+    static LazyModules &Get() {
+        static LazyModules *modules = new LazyModules();
+        return *modules;
+    }
+
+    inline bool IsEnabled() const { return mEnabled; }
+
+    void Add(__fatBinC_Wrapper_t *bin, const std::string &hash) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto &module = mModules[bin];
+        module = std::make_unique<Module>();
+        module->bin = bin;
+        module->hash = hash;
+        CudaRtFrontend::msLazyModules++;
+    }
+
+    /**
+     * Records a registration in the fat binary bin, for the kernel or the
+     * variable at host: it is sent right after the fat binary.
+     */
+    void Record(void *bin, const void *host, std::function<void()> registration) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mModules.find(bin);
+        if (it == mModules.end() || it->second->loaded) {
+            registration();
+            return;
+        }
+        it->second->registrations.push_back(std::move(registration));
+        if (host != nullptr) {
+            it->second->hosts.push_back(host);
+            mByHost[host] = it->second.get();
+        }
+    }
+
+    void End(void *bin) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mModules.find(bin);
+        if (it == mModules.end()) return;
+        if (it->second->loaded) {
+            sendFatBinaryEnd(bin);
+            return;
+        }
+        it->second->ended = true;
+        mCondition.notify_all();
+    }
+
+    /* sends the fat binary defining the kernel or the variable at host */
+    void Load(const void *host) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mByHost.find(host);
+        if (it != mByHost.end()) Load(*it->second);
+    }
+
+    /**
+     * Forgets the fat binary bin.
+     *
+     * @return true if it was sent to the backend, and so has to be
+     * unregistered there.
+     */
+    bool Remove(void *bin) {
+        Stop();
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mModules.find(bin);
+        if (it == mModules.end()) return true;
+        bool loaded = it->second->loaded;
+        if (!loaded) CudaRtFrontend::msLazyModules--;
+        for (const void *host : it->second->hosts) mByHost.erase(host);
+        mModules.erase(it);
+        return loaded;
+    }
+
+   private:
+    struct Module {
+        __fatBinC_Wrapper_t *bin;
+        std::string hash;
+        std::vector<std::function<void()>> registrations;
+        /* the kernels and the variables it defines */
+        std::vector<const void *> hosts;
+        bool ended = false;
+        bool loaded = false;
+    };
+
+    LazyModules() {
+        std::string mode = getEnvVar("GVIRTUS_LAZY_MODULES");
+        mEnabled = mode == "on" || mode == "background";
+        if (mode != "background") return;
+        CudaRtFrontend::msCountRequests = true;
+        mStreamer = std::thread(&LazyModules::Stream, this);
+    }
+
+    /* mMutex is held */
+    void Load(Module &module) {
+        if (module.loaded) return;
+        module.loaded = true;
+        CudaRtFrontend::msLazyModules--;
+        if (!sendFatBinary(module.bin, module.hash)) {
+            cerr << "*** Error: cannot register the fat binary " << module.bin << endl;
+            return;
+        }
+        for (auto &registration : module.registrations) registration();
+        module.registrations.clear();
+        if (module.ended) sendFatBinaryEnd(module.bin);
+    }
+
+    /* sends the fat binaries registered completely while the application is idle */
+    void Stream() {
+        static const std::chrono::milliseconds idle(50);
+        std::unique_lock<std::mutex> lock(mMutex);
+        uint64_t requests = CudaRtFrontend::msRequests.load(std::memory_order_relaxed);
+        while (!mStopping) {
+            auto next = std::find_if(mModules.begin(), mModules.end(), [](auto &it) {
+                return it.second->ended && !it.second->loaded;
+            });
+            if (next == mModules.end()) {
+                mCondition.wait(lock);
+                continue;
+            }
+            if (mCondition.wait_for(lock, idle, [this]() { return mStopping; })) break;
+            uint64_t now = CudaRtFrontend::msRequests.load(std::memory_order_relaxed);
+            if (now != requests) {
+                // the application is busy
+                requests = now;
+                continue;
+            }
+            // the modules were changed while waiting
+            next = std::find_if(mModules.begin(), mModules.end(), [](auto &it) {
+                return it.second->ended && !it.second->loaded;
+            });
+            if (next != mModules.end()) Load(*next->second);
+            requests = CudaRtFrontend::msRequests.load(std::memory_order_relaxed);
+        }
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mStopping) return;
+            mStopping = true;
+        }
+        mCondition.notify_all();
+        if (mStreamer.joinable()) mStreamer.join();
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mEnabled = false;
+    bool mStopping = false;
+    /* by fat binary */
+    std::map<const void *, std::unique_ptr<Module>> mModules;
+    std::map<const void *, Module *> mByHost;
+    std::thread mStreamer;
+};
+}  // namespace
+
+void CudaRtFrontend::LoadLazyModule(const void *host) { LazyModules::Get().Load(host); }
+
+/*
+ Routines not found in the cuda's header files.
+ KEEP THEM WITH CARE
+ */
+
+extern "C" __host__ void **__cudaRegisterFatBinary(void *fatCubin) {
+    /* Fake host pointer */
+    __fatBinC_Wrapper_t *bin = (__fatBinC_Wrapper_t *)fatCubin;
+    if (bin->magic != FATBINWRAPPER_MAGIC) {
+        cerr << "*** Error: Invalid fat binary magic number" << endl;
+        return nullptr;  // Not a valid fat binary
+    }
+    // cout << "Fat binary wrapper magic: " << hex << bin->magic << endl;
+    struct fatBinaryHeader *fatBinHdr = (struct fatBinaryHeader *)bin->data;
+    if (fatBinHdr->magic != FATBIN_MAGIC || fatBinHdr->version != 1) {
+        cerr << "*** Error: Invalid fat binary" << endl;
+        return nullptr;  // Not a valid fat binary
+    }
+    // cout << "Fat binary header size: " << fatBinHdr->headerSize << endl;
+    // cout << "Fat binary size: " << fatBinHdr->fatSize << endl;
+
+    // only for debugging purposes
+    // writeCudaFatBinaryToFile(fatBinHdr, fatBinHdr->headerSize + fatBinHdr->fatSize,
+    // "fat_binary.cubin");
+
+    // the parameters of its kernels, looked up as they are launched
+    std::string hash = CudaUtil::HashFatCudaBinary(bin);
+    std::shared_ptr<KernelParamIndex> index = KernelParamIndex::Open(bin, hash);
+    if (index == nullptr) return nullptr;  // Not a valid fat binary data
+    CudaRtFrontend::addKernelParamIndex(index);
+
+    if (LazyModules::Get().IsEnabled()) {
+        LazyModules::Get().Add(bin, hash);
+        return (void **)fatCubin;
+    }
+    if (sendFatBinary(bin, hash)) return (void **)fatCubin;
+
+    return nullptr;
+}
+
+extern "C" __host__ void **__cudaRegisterFatBinaryEnd(void *fatCubin) {
+    /* Fake host pointer */
+    if (LazyModules::Get().IsEnabled()) {
+        LazyModules::Get().End(fatCubin);
+        return (void **)fatCubin;
+    }
+    if (sendFatBinaryEnd(fatCubin)) return (void **)fatCubin;
+    return NULL;
+}
+
+extern "C" __host__ void __cudaUnregisterFatBinary(void **fatCubinHandle) {
+    // a fat binary registered lazily and never used is unknown to the backend
+    if (LazyModules::Get().IsEnabled() && !LazyModules::Get().Remove(fatCubinHandle)) return;
+    CudaRtFrontend::Prepare();
+    CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(fatCubinHandle));
+    CudaRtFrontend::Execute("cudaUnregisterFatBinary");
+}
+
+extern "C" __host__ void __cudaRegisterFunction(void **fatCubinHandle, const char *hostFun,
+                                                char *deviceFun, const char *deviceName,
+                                                int thread_limit, uint3 *tid, uint3 *bid,
+                                                dim3 *bDim, dim3 *gDim, int *wSize) {
+    if (LazyModules::Get().IsEnabled()) {
+        std::string function(deviceFun), name(deviceName);
+        LazyModules::Get().Record(fatCubinHandle, hostFun, [=]() {
+            sendFunction(fatCubinHandle, hostFun, function.c_str(), name.c_str(), thread_limit,
+                         tid, bid, bDim, gDim, wSize);
+        });
+        return;
+    }
+
+    sendFunction(fatCubinHandle, hostFun, deviceFun, deviceName, thread_limit, tid, bid, bDim,
+                 gDim, wSize);
+}
+
+extern "C" __host__ void __cudaRegisterVar(void **fatCubinHandle, char *hostVar,
+                                           char *deviceAddress, const char *deviceName, int ext,
+                                           int size, int constant, int global) {
+    if (LazyModules::Get().IsEnabled()) {
+        std::string address(deviceAddress), name(deviceName);
+        LazyModules::Get().Record(fatCubinHandle, hostVar, [=]() {
+            sendVar(fatCubinHandle, hostVar, address.c_str(), name.c_str(), ext, size, constant,
+                    global);
+        });
+        return;
+    }
+    sendVar(fatCubinHandle, hostVar, deviceAddress, deviceName, ext, size, constant, global);
+}
+
+extern "C" __host__ void __cudaRegisterShared(void **fatCubinHandle, void **devicePtr) {
+    if (LazyModules::Get().IsEnabled()) {
+        std::string shared((char *)devicePtr);
+        LazyModules::Get().Record(fatCubinHandle, nullptr,
+                                  [=]() { sendShared(fatCubinHandle, shared.c_str()); });
+        return;
+    }
+    sendShared(fatCubinHandle, (char *)devicePtr);
+}
+
+extern "C" __host__ void __cudaRegisterSharedVar(void **fatCubinHandle, void **devicePtr,
+                                                 size_t size, size_t alignment, int storage) {
+    if (LazyModules::Get().IsEnabled()) {
+        std::string shared((char *)devicePtr);
+        LazyModules::Get().Record(fatCubinHandle, nullptr, [=]() {
+            sendSharedVar(fatCubinHandle, shared.c_str(), size, alignment, storage);
+        });
+        return;
+    }
+    sendSharedVar(fatCubinHandle, (char *)devicePtr, size, alignment, storage);
+}
+
 extern "C" __host__ int __cudaSynchronizeThreads(void **x, void *y) {
     // FIXME: implement
     std::cerr << "*** Error: __cudaSynchronizeThreads() not yet implemented!" << std::endl;
@@ -101,9 +101,10 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaFreeHost(void *ptr) {
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaGetSymbolAddress(void **devPtr, const void *symbol) {
+    CudaRtFrontend::LoadModule(symbol);
     CudaRtFrontend::Prepare();
     // Achtung: skip adding devPtr
-    CudaRtFrontend::AddSymbolForArguments((char *)symbol);
+    CudaRtFrontend::AddSymbolForArguments(symbol);
     CudaRtFrontend::Execute("cudaGetSymbolAddress");
     if (CudaRtFrontend::Success())
         *devPtr = CudaUtil::UnmarshalPointer(CudaRtFrontend::GetOutputString());
@@ -111,9 +112,10 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaGetSymbolAddress(void **devPtr, co
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaGetSymbolSize(size_t *size, const void *symbol) {
+    CudaRtFrontend::LoadModule(symbol);
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddHostPointerForArguments(size);
-    CudaRtFrontend::AddSymbolForArguments((char *)symbol);
+    CudaRtFrontend::AddSymbolForArguments(symbol);
     CudaRtFrontend::Execute("cudaGetSymbolSize");
     if (CudaRtFrontend::Success()) *size = *(CudaRtFrontend::GetOutputHostPointer<size_t>());
     return CudaRtFrontend::GetExitCode();
@@ -307,8 +309,12 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpy(void *dst, const void *src,
             break;
         case cudaMemcpyHostToDevice:
             CudaRtFrontend::AddDevicePointerForArguments(dst);
-            CudaRtFrontend::AddHostPointerForArguments<char>(
-                static_cast<char *>(const_cast<void *>(src)), count);
+            if (count >= CudaRtFrontend::GetTransferThreshold())
+                /* NOTE: the backend copies the array while receiving it */
+                CudaRtFrontend::TransferInputFrom(static_cast<const char *>(src), count);
+            else
+                CudaRtFrontend::AddHostPointerForArguments<char>(
+                    static_cast<char *>(const_cast<void *>(src)), count);
             CudaRtFrontend::AddVariableForArguments(count);
             CudaRtFrontend::AddVariableForArguments(kind);
             CudaRtFrontend::Execute("cudaMemcpy");
@@ -319,11 +325,12 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpy(void *dst, const void *src,
             CudaRtFrontend::AddDevicePointerForArguments(src);
             CudaRtFrontend::AddVariableForArguments(count);
             CudaRtFrontend::AddVariableForArguments(kind);
+            CudaRtFrontend::ReceiveOutputInto(static_cast<char *>(dst), count);
             CudaRtFrontend::Execute("cudaMemcpy");
             if (CudaRtFrontend::Success()) {
-                memmove(dst, CudaRtFrontend::GetOutputHostPointer<char>(count), count);
+                CudaRtFrontend::GetOutputHostArray(static_cast<char *>(dst), count);
             }
-            break;
+            return CudaRtFrontend::GetSynchronizingExitCode();
         case cudaMemcpyDeviceToDevice:
             CudaRtFrontend::AddDevicePointerForArguments(dst);
             CudaRtFrontend::AddDevicePointerForArguments(src);
@@ -542,58 +549,47 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyAsync(void *dst, const void
     }
 
     CudaRtFrontend::Prepare();
-    // cout << "cudaMemcpyAsync frontend: "
-    //      << "dst: " << dst << ", src: " << src << ", count: " << count
-    //      << ", kind: " << kind << ", stream: " << stream << endl;
 
+    /* NOTE: the copies are never waited for: the ones from the device land in
+     * dst when their result is collected, at the latest by the next
+     * synchronizing routine (e.g. cudaStreamSynchronize) of any thread */
     switch (kind) {
         case cudaMemcpyHostToHost:
             /* NOTE: no communication is performed, because it's just overhead
              * here */
-            CudaRtFrontend::AddHostPointerForArguments("");
-            CudaRtFrontend::AddHostPointerForArguments("");
-            CudaRtFrontend::AddVariableForArguments(kind);
-            CudaRtFrontend::AddDevicePointerForArguments(stream);
-            CudaRtFrontend::Execute("cudaMemcpyAsync");
-            if (memmove(dst, src, count) == NULL) {
-                return cudaErrorInvalidValue;
-            }
+            if (memmove(dst, src, count) == NULL) return cudaErrorInvalidValue;
             return cudaSuccess;
-            break;
         case cudaMemcpyHostToDevice:
-            // cout << "cudaMemcpyAsync HostToDevice" << endl;
+            /* NOTE: src is sent before returning, so it can change at once */
             CudaRtFrontend::AddDevicePointerForArguments(dst);
-            CudaRtFrontend::AddHostPointerForArguments<char>(
-                static_cast<char *>(const_cast<void *>(src)), count);
+            if (count >= CudaRtFrontend::GetTransferThreshold())
+                CudaRtFrontend::TransferInputFrom(static_cast<const char *>(src), count);
+            else
+                CudaRtFrontend::AddHostPointerForArguments<char>(
+                    static_cast<char *>(const_cast<void *>(src)), count);
             CudaRtFrontend::AddVariableForArguments(count);
             CudaRtFrontend::AddVariableForArguments(kind);
             CudaRtFrontend::AddDevicePointerForArguments(stream);
-            CudaRtFrontend::Execute("cudaMemcpyAsync");
+            CudaRtFrontend::ExecuteAsync("cudaMemcpyAsync", NULL, true);
             break;
         case cudaMemcpyDeviceToHost:
-            // cout << "cudaMemcpyAsync DeviceToHost" << endl;
             /* NOTE: adding a fake host pointer */
             CudaRtFrontend::AddHostPointerForArguments("");
             CudaRtFrontend::AddDevicePointerForArguments(src);
             CudaRtFrontend::AddVariableForArguments(count);
             CudaRtFrontend::AddVariableForArguments(kind);
             CudaRtFrontend::AddDevicePointerForArguments(stream);
-            // cout << "cudaMemcpyAsync DeviceToHost: "
-            //      << "dst: " << dst << ", src: " << src << ", count: " << count
-            //      << ", kind: " << kind << ", stream: " << stream << endl;
-            CudaRtFrontend::Execute("cudaMemcpyAsync");
-            if (CudaRtFrontend::Success()) {
-                memmove(dst, CudaRtFrontend::GetOutputHostPointer<char>(count), count);
-            }
+            CudaRtFrontend::ReceiveOutputInto(static_cast<char *>(dst), count);
+            CudaRtFrontend::ReceiveOutputOnStream(stream);
+            CudaRtFrontend::ExecuteAsync("cudaMemcpyAsync", NULL, true);
             break;
         case cudaMemcpyDeviceToDevice:
-            // cout << "cudaMemcpyAsync DeviceToDevice" << endl;
             CudaRtFrontend::AddDevicePointerForArguments(dst);
             CudaRtFrontend::AddDevicePointerForArguments(src);
             CudaRtFrontend::AddVariableForArguments(count);
             CudaRtFrontend::AddVariableForArguments(kind);
             CudaRtFrontend::AddDevicePointerForArguments(stream);
-            CudaRtFrontend::Execute("cudaMemcpyAsync");
+            CudaRtFrontend::ExecuteAsync("cudaMemcpyAsync", NULL, true);
             break;
     }
     return CudaRtFrontend::GetExitCode();
@@ -684,6 +680,7 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyFromArrayAsync(void *dst, co
 extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyFromSymbol(void *dst, const void *symbol,
                                                                size_t count, size_t offset,
                                                                cudaMemcpyKind kind) {
+    CudaRtFrontend::LoadModule(symbol);
     if (kind == cudaMemcpyDefault) {
         kind = inferMemcpyKindFromDevice(dst);
     }
@@ -699,9 +696,7 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyFromSymbol(void *dst, const
         case cudaMemcpyDeviceToHost:
             // Achtung: adding a fake host pointer
             CudaRtFrontend::AddDevicePointerForArguments((void *)0x666);
-            // Achtung: passing the address and the content of symbol
-            CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(symbol));
-            CudaRtFrontend::AddStringForArguments((char *)symbol);
+            CudaRtFrontend::AddSymbolForArguments(symbol);
             CudaRtFrontend::AddVariableForArguments(count);
             CudaRtFrontend::AddVariableForArguments(offset);
             CudaRtFrontend::AddVariableForArguments(kind);
@@ -711,9 +706,7 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyFromSymbol(void *dst, const
             break;
         case cudaMemcpyDeviceToDevice:
             CudaRtFrontend::AddDevicePointerForArguments(dst);
-            // Achtung: passing the address and the content of symbol
-            CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(symbol));
-            CudaRtFrontend::AddStringForArguments((char *)symbol);
+            CudaRtFrontend::AddSymbolForArguments(symbol);
             CudaRtFrontend::AddVariableForArguments(count);
             CudaRtFrontend::AddVariableForArguments(offset);
             CudaRtFrontend::AddVariableForArguments(kind);
@@ -783,6 +776,7 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyToArrayAsync(cudaArray *dst,
 extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyToSymbol(const void *symbol, const void *src,
                                                              size_t count, size_t offset,
                                                              cudaMemcpyKind kind) {
+    CudaRtFrontend::LoadModule(symbol);
     if (kind == cudaMemcpyDefault) {
         kind = inferMemcpyKindToDevice(src);
     }
@@ -795,9 +789,7 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyToSymbol(const void *symbol,
             return cudaErrorInvalidMemcpyDirection;
             break;
         case cudaMemcpyHostToDevice:
-            // Achtung: passing the address and the content of symbol
-            CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(symbol));
-            CudaRtFrontend::AddStringForArguments((char *)symbol);
+            CudaRtFrontend::AddSymbolForArguments(symbol);
             CudaRtFrontend::AddHostPointerForArguments<char>(
                 static_cast<char *>(const_cast<void *>(src)), count);
             CudaRtFrontend::AddVariableForArguments(count);
@@ -810,11 +802,10 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemcpyToSymbol(const void *symbol,
             return cudaErrorInvalidMemcpyDirection;
             break;
         case cudaMemcpyDeviceToDevice:
-            // Achtung: passing the address and the content of symbol
-            CudaRtFrontend::AddStringForArguments(CudaUtil::MarshalHostPointer(symbol));
-            CudaRtFrontend::AddStringForArguments((char *)symbol);
+            CudaRtFrontend::AddSymbolForArguments(symbol);
             CudaRtFrontend::AddDevicePointerForArguments(src);
             CudaRtFrontend::AddVariableForArguments(count);
+            CudaRtFrontend::AddVariableForArguments(offset);
             CudaRtFrontend::AddVariableForArguments(kind);
             CudaRtFrontend::Execute("cudaMemcpyToSymbol");
             break;
@@ -861,7 +852,7 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaMemsetAsync(void *devPtr, int c, s
     CudaRtFrontend::AddDevicePointerForArguments(devPtr);
     CudaRtFrontend::AddVariableForArguments(c);
     CudaRtFrontend::AddVariableForArguments(count);
-    CudaRtFrontend::Execute("cudaMemset");
+    CudaRtFrontend::ExecuteAsync("cudaMemset");
     return CudaRtFrontend::GetExitCode();
 }
 
@@ -34,9 +34,12 @@ using gvirtus::common::pointer_t;
 /* cudaOccupancyMaxActiveBlocksPerMultiprocessor */
 extern "C" __host__ cudaError_t cudaOccupancyMaxActiveBlocksPerMultiprocessor(
     int* numBlocks, const void* func, int blockSize, size_t dynamicSMemSize) {
+    CudaRtFrontend::LoadModule(func);
+    uint32_t id = CudaRtFrontend::getKernelId(func);
+    if (id == NO_REGISTRATION_ID) return cudaErrorInvalidDeviceFunction;
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddHostPointerForArguments(numBlocks);
-    CudaRtFrontend::AddVariableForArguments((pointer_t)func);
+    CudaRtFrontend::AddVariableForArguments(id);
     CudaRtFrontend::AddVariableForArguments(blockSize);
     CudaRtFrontend::AddVariableForArguments(dynamicSMemSize);
     CudaRtFrontend::Execute("cudaOccupancyMaxActiveBlocksPerMultiprocessor");
@@ -48,9 +51,12 @@ extern "C" __host__ cudaError_t cudaOccupancyMaxActiveBlocksPerMultiprocessor(
 /* cudaOccupancyMaxActiveBlocksPerMultiprocessorWithFlags */
 extern "C" __host__ cudaError_t cudaOccupancyMaxActiveBlocksPerMultiprocessorWithFlags(
     int* numBlocks, const void* func, int blockSize, size_t dynamicSMemSize, unsigned int flags) {
+    CudaRtFrontend::LoadModule(func);
+    uint32_t id = CudaRtFrontend::getKernelId(func);
+    if (id == NO_REGISTRATION_ID) return cudaErrorInvalidDeviceFunction;
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddHostPointerForArguments(numBlocks);
-    CudaRtFrontend::AddVariableForArguments((pointer_t)func);
+    CudaRtFrontend::AddVariableForArguments(id);
     CudaRtFrontend::AddVariableForArguments(blockSize);
     CudaRtFrontend::AddVariableForArguments(dynamicSMemSize);
     CudaRtFrontend::AddVariableForArguments(flags);
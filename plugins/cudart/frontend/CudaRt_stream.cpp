@@ -66,7 +66,7 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaStreamWaitEvent(cudaStream_t strea
     CudaRtFrontend::AddDevicePointerForArguments(stream);
     CudaRtFrontend::AddDevicePointerForArguments(event);
     CudaRtFrontend::AddVariableForArguments(flags);
-    CudaRtFrontend::Execute("cudaStreamWaitEvent");
+    CudaRtFrontend::ExecuteAsync("cudaStreamWaitEvent");
     return CudaRtFrontend::GetExitCode();
 }
 
@@ -74,6 +74,8 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaStreamQuery(cudaStream_t stream) {
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddDevicePointerForArguments(stream);
     CudaRtFrontend::Execute("cudaStreamQuery");
+    // the copies of the other threads on a stream found idle are received by now
+    if (CudaRtFrontend::Success()) CudaRtFrontend::SynchronizeOutputs(stream);
     return CudaRtFrontend::GetExitCode();
 }
 
@@ -90,10 +92,11 @@ extern "C" __host__ cudaError_t CUDARTAPI cudaStreamCreateWithPriority(cudaStrea
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI cudaStreamSynchronize(cudaStream_t stream) {
+    CudaRtFrontend::SynchronizeOutputs(stream);
     CudaRtFrontend::Prepare();
     CudaRtFrontend::AddDevicePointerForArguments(stream);
     CudaRtFrontend::Execute("cudaStreamSynchronize");
-    return CudaRtFrontend::GetExitCode();
+    return CudaRtFrontend::GetSynchronizingExitCode();
 }
 
 extern "C" __host__ cudaError_t CUDARTAPI
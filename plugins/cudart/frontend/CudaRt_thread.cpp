@@ -32,6 +32,7 @@ using namespace std;
 
 // deprecated
 extern "C" __host__ cudaError_t CUDARTAPI cudaThreadSynchronize() {
+    CudaRtFrontend::SynchronizeOutputs(NULL, true);
     CudaRtFrontend::Prepare();
     CudaRtFrontend::Execute("cudaThreadSynchronize");
     return CudaRtFrontend::GetExitCode();
@@ -0,0 +1,323 @@
+/*
+ * gVirtuS -- A GPGPU transparent virtualization component.
+ *
+ * Copyright (C) 2009-2010  The University of Napoli Parthenope at Naples.
+ *
+ * This file is part of gVirtuS.
+ *
+ * gVirtuS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gVirtuS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gVirtuS; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "KernelParamIndex.h"
+
+#include <CudaUtil.h>
+#include <fcntl.h>
+#include <lz4.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string_view>
+#include <thread>
+
+using namespace std;
+
+extern std::string getEnvVar(std::string const &key);
+
+#define KPARAM_INDEX_MAGIC "GVKPIDX"
+#define KPARAM_INDEX_VERSION 2
+
+namespace {
+// Helper: allocate and copy section headers table
+Elf64_Shdr *copySectionHeaders(const Elf64_Ehdr *eh) {
+    Elf64_Shdr *sh_table = (Elf64_Shdr *)malloc(eh->e_shentsize * eh->e_shnum);
+    if (!sh_table) return nullptr;
+
+    byte *baseAddr = (byte *)eh;
+    for (uint32_t i = 0; i < eh->e_shnum; i++) {
+        Elf64_Shdr *src = (Elf64_Shdr *)(baseAddr + eh->e_shoff + i * eh->e_shentsize);
+        memcpy(&sh_table[i], src, eh->e_shentsize);
+    }
+    return sh_table;
+}
+
+// Helper: allocate and copy section header string table
+char *copySectionHeaderStrTable(const Elf64_Ehdr *eh, Elf64_Shdr *sh_table) {
+    size_t offset = sh_table[eh->e_shstrndx].sh_offset;
+    size_t size = sh_table[eh->e_shstrndx].sh_size;
+    char *sh_str = (char *)malloc(size);
+    if (!sh_str) return nullptr;
+
+    byte *baseAddr = (byte *)eh;
+    memcpy(sh_str, baseAddr + offset, size);
+    return sh_str;
+}
+
+// Helper: parse NvInfo sections into the kernels and their parameters
+void parseNvInfoKParams(const Elf64_Ehdr *eh, Elf64_Shdr *sh_table, char *sh_str,
+                        vector<pair<string, NvInfoFunction>> &functions) {
+    byte *baseAddr = (byte *)eh;
+    for (uint32_t i = 0; i < eh->e_shnum; i++) {
+        char *sectionName = sh_str + sh_table[i].sh_name;
+        if (strncmp(".nv.info.", sectionName, strlen(".nv.info.")) != 0) continue;
+
+        char *funcName = sectionName + strlen(".nv.info.");
+        byte *sectionData = baseAddr + sh_table[i].sh_offset;
+
+        NvInfoFunction infoFunction;
+
+        NvInfoAttribute *pAttr = (NvInfoAttribute *)sectionData;
+        byte *sectionEnd = sectionData + sh_table[i].sh_size;
+
+        while ((byte *)pAttr < sectionEnd) {
+            size_t size = sizeof(NvInfoAttribute);
+            if (pAttr->fmt == EIFMT_SVAL) size += pAttr->value;
+            if (pAttr->attr == EIATTR_KPARAM_INFO) {
+                NvInfoKParam *nvInfoKParam = (NvInfoKParam *)pAttr;
+                infoFunction.params.push_back(*nvInfoKParam);
+            }
+            pAttr = (NvInfoAttribute *)((byte *)pAttr + size);
+        }
+        functions.emplace_back(funcName, infoFunction);
+    }
+}
+
+// Helper: parse a cubin of a fat binary, decompressing it if needed
+bool parseCubin(const fatBinData_t *fatBinData, vector<pair<string, NvInfoFunction>> &functions) {
+    const uint8_t *data_ptr = (const uint8_t *)fatBinData + fatBinData->headerSize;
+    std::vector<char> cubin;
+    if (fatBinData->uncompressedPayload != 0) {
+        // Prepare output buffer with the expected decompressed size
+        cubin.resize(fatBinData->uncompressedPayload);
+
+        // Decompress - LZ4_decompress_safe returns decompressed size or < 0 on error
+        int decompressed_size =
+            LZ4_decompress_safe((const char *)data_ptr, cubin.data(), fatBinData->payloadSize,
+                                fatBinData->uncompressedPayload);
+        if (decompressed_size < 0) {
+            cerr << "*** Error: LZ4 decompression failed with code " << decompressed_size << endl;
+            return false;  // Decompression failed
+        }
+    } else {
+        cubin.assign((const char *)data_ptr,
+                     (const char *)data_ptr + fatBinData->paddedPayloadSize);
+    }
+
+    if (memcmp(cubin.data(), ELF_MAGIC, ELF_MAGIC_SIZE) != 0) {
+        cerr << "*** Error: Invalid ELF magic number in fat binary" << endl;
+        return false;  // Not a valid ELF file
+    }
+    Elf64_Ehdr *eh = (Elf64_Ehdr *)(cubin.data());
+
+    Elf64_Shdr *sh_table = copySectionHeaders(eh);
+    if (!sh_table) return false;
+
+    char *sh_str = copySectionHeaderStrTable(eh, sh_table);
+    if (!sh_str) {
+        free(sh_table);
+        return false;
+    }
+
+    parseNvInfoKParams(eh, sh_table, sh_str, functions);
+
+    free(sh_str);
+    free(sh_table);
+    return true;
+}
+
+// Helper: parse the cubins of a fat binary, each one on the first free thread
+bool parseFatBinary(const __fatBinC_Wrapper_t *bin,
+                    vector<pair<string, NvInfoFunction>> &functions) {
+    struct fatBinaryHeader *fatBinHdr = (struct fatBinaryHeader *)bin->data;
+    uint8_t *data_ptr = (uint8_t *)bin->data + fatBinHdr->headerSize;
+    size_t remaining_size = fatBinHdr->fatSize;
+
+    std::vector<const fatBinData_t *> cubins;
+    while (remaining_size > 0) {
+        fatBinData_t *fatBinData = (fatBinData_t *)data_ptr;
+        if (fatBinData->version != 0x0101 || (fatBinData->kind != 1 && fatBinData->kind != 2)) {
+            cerr << "*** Error: Invalid fat binary data version or kind" << endl;
+            return false;  // Not a valid fat binary data
+        }
+        // the PTX has no .nv.info sections
+        if (fatBinData->kind == 2) cubins.push_back(fatBinData);
+        data_ptr += fatBinData->headerSize + fatBinData->paddedPayloadSize;
+        remaining_size -= (fatBinData->headerSize + fatBinData->paddedPayloadSize);
+    }
+
+    std::vector<vector<pair<string, NvInfoFunction>>> parsed(cubins.size());
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    auto parse = [&]() {
+        for (size_t i; (i = next++) < cubins.size() && !failed;)
+            if (!parseCubin(cubins[i], parsed[i])) failed = true;
+    };
+    size_t threads =
+        std::min<size_t>(cubins.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threads; i++) helpers.emplace_back(parse);
+    parse();
+    for (auto &helper : helpers) helper.join();
+    if (failed) return false;
+
+    // in the order of the cubins, as parsed one after the other
+    for (auto &cubin : parsed)
+        for (auto &function : cubin) functions.push_back(std::move(function));
+    return true;
+}
+
+// the directory of the indices, empty if they are not kept
+const std::string &cacheDirectory() {
+    static const std::string directory = []() -> std::string {
+        std::string value = getEnvVar("GVIRTUS_KPARAM_CACHE");
+        if (value == "off") return "";
+        if (!value.empty()) return value;
+        std::string cache_home = getEnvVar("XDG_CACHE_HOME");
+        if (!cache_home.empty()) return cache_home + "/gvirtus";
+        std::string home = getEnvVar("HOME");
+        return home.empty() ? "" : home + "/.cache/gvirtus";
+    }();
+    return directory;
+}
+
+std::string cachePath(const std::string &hash) {
+    return cacheDirectory() + "/" + hash + ".kparams";
+}
+
+// Helper: write an index to the cache, aside and renamed so that no process maps half a file
+void saveIndex(const std::string &hash, const std::vector<char> &index) {
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory(), error);
+    std::string path = cachePath(hash);
+    std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(tmp, std::ios::binary);
+    out.write(index.data(), index.size());
+    out.close();
+    if (!out || rename(tmp.c_str(), path.c_str()) != 0) unlink(tmp.c_str());
+}
+}  // namespace
+
+std::shared_ptr<KernelParamIndex> KernelParamIndex::Open(const __fatBinC_Wrapper_t *bin,
+                                                         const std::string &hash) {
+    std::shared_ptr<KernelParamIndex> index(new KernelParamIndex());
+    if (!cacheDirectory().empty()) {
+        int fd = open(cachePath(hash).c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                index->mMapped = true;
+                index->mData = (const char *)data;
+                index->mSize = st.st_size;
+                if (index->Attach((const char *)data, st.st_size)) {
+                    close(fd);
+                    return index;
+                }
+                munmap(data, st.st_size);
+                index->mMapped = false;
+            }
+        }
+        if (fd >= 0) close(fd);
+    }
+
+    vector<pair<string, NvInfoFunction>> functions;
+    if (!parseFatBinary(bin, functions)) return nullptr;
+    index->mBuilt = Build(functions);
+    if (!index->Attach(index->mBuilt.data(), index->mBuilt.size())) return nullptr;
+    if (!cacheDirectory().empty()) saveIndex(hash, index->mBuilt);
+    return index;
+}
+
+KernelParamIndex::~KernelParamIndex() {
+    if (mMapped) munmap((void *)mData, mSize);
+}
+
+std::vector<char> KernelParamIndex::Build(
+    const vector<pair<string, NvInfoFunction>> &functions) {
+    // the first one of each name, as the frontend always did
+    std::vector<const pair<string, NvInfoFunction> *> sorted;
+    std::set<std::string_view> names;
+    for (auto &function : functions)
+        if (names.insert(function.first).second) sorted.push_back(&function);
+    std::sort(sorted.begin(), sorted.end(),
+              [](auto *a, auto *b) { return a->first < b->first; });
+
+    size_t params = 0, names_size = 0;
+    for (auto *function : sorted) {
+        params += function->second.params.size();
+        names_size += function->first.size();
+    }
+    size_t params_offset = sizeof(Header) + sorted.size() * sizeof(Entry);
+    size_t names_offset = params_offset + params * sizeof(NvInfoKParam);
+    std::vector<char> index(names_offset + names_size);
+
+    Header header = {KPARAM_INDEX_MAGIC, KPARAM_INDEX_VERSION, (uint32_t)sorted.size(),
+                     index.size()};
+    memcpy(index.data(), &header, sizeof(header));
+    Entry *entries = (Entry *)(index.data() + sizeof(Header));
+    for (auto *function : sorted) {
+        auto &kparams = function->second.params;
+        *entries++ = {(uint32_t)names_offset, (uint32_t)function->first.size(),
+                      (uint32_t)params_offset, (uint32_t)kparams.size()};
+        if (!kparams.empty())
+            memcpy(index.data() + params_offset, kparams.data(),
+                   kparams.size() * sizeof(NvInfoKParam));
+        memcpy(index.data() + names_offset, function->first.data(), function->first.size());
+        params_offset += kparams.size() * sizeof(NvInfoKParam);
+        names_offset += function->first.size();
+    }
+    return index;
+}
+
+bool KernelParamIndex::Attach(const char *data, size_t size) {
+    if (size < sizeof(Header) || size > UINT32_MAX) return false;
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, KPARAM_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != KPARAM_INDEX_VERSION || header.size != size ||
+        header.functions > (size - sizeof(Header)) / sizeof(Entry))
+        return false;
+    mData = data;
+    mSize = size;
+    mFunctions = header.functions;
+    return true;
+}
+
+bool KernelParamIndex::Find(const std::string &function, NvInfoFunction &info) const {
+    const Entry *entries = (const Entry *)(mData + sizeof(Header));
+    // the entries of a file are checked as they are read
+    auto name = [this](const Entry &entry) {
+        if ((uint64_t)entry.name_offset + entry.name_size > mSize) return std::string_view();
+        return std::string_view(mData + entry.name_offset, entry.name_size);
+    };
+    const Entry *entry =
+        std::lower_bound(entries, entries + mFunctions, function,
+                         [&name](const Entry &entry, const std::string &function) {
+                             return name(entry) < function;
+                         });
+    if (entry == entries + mFunctions || name(*entry) != function) return false;
+    if ((uint64_t)entry->params_offset + (uint64_t)entry->params * sizeof(NvInfoKParam) > mSize)
+        return false;
+    const NvInfoKParam *params = (const NvInfoKParam *)(mData + entry->params_offset);
+    info.params.assign(params, params + entry->params);
+    return true;
+}
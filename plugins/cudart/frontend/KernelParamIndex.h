@@ -0,0 +1,105 @@
+/*
+ * gVirtuS -- A GPGPU transparent virtualization component.
+ *
+ * Copyright (C) 2009-2010  The University of Napoli Parthenope at Naples.
+ *
+ * This file is part of gVirtuS.
+ *
+ * gVirtuS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gVirtuS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gVirtuS; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef KERNELPARAMINDEX_H
+#define KERNELPARAMINDEX_H
+
+#include <CudaRt_internal.h>
+#include <fatbinary_section.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * KernelParamIndex is the parameter layout of the kernels of a fat binary,
+ * found in the .nv.info sections of its cubins: what the frontend needs to
+ * marshal the arguments of a launch.
+ *
+ * Finding it takes decompressing and parsing every cubin, so the index is
+ * kept in a file named after the hash of the fat binary (see
+ * CudaUtil::HashFatCudaBinary()) in the directory of GVIRTUS_KPARAM_CACHE:
+ * the next runs map it and look the kernels up in it as they are launched,
+ * without reading the ones never launched. On a miss, the cubins are parsed
+ * on several threads.
+ */
+class KernelParamIndex {
+   public:
+    /**
+     * @return the index of bin, whose hash is hash: mapped from the cache, or
+     * built and saved there; nullptr if bin cannot be parsed.
+     */
+    static std::shared_ptr<KernelParamIndex> Open(const __fatBinC_Wrapper_t *bin,
+                                                  const std::string &hash);
+
+    ~KernelParamIndex();
+
+    /**
+     * Looks up the kernel named function.
+     *
+     * @return false if it isn't in the fat binary.
+     */
+    bool Find(const std::string &function, NvInfoFunction &info) const;
+
+    inline size_t GetSize() const { return mFunctions; }
+
+   private:
+    /* the layout of the file, all of it in host byte order */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t functions;
+        /* of the whole file, telling a truncated one */
+        uint64_t size;
+    };
+
+    /* sorted by name */
+    struct Entry {
+        uint32_t name_offset;
+        uint32_t name_size;
+        uint32_t params_offset;
+        uint32_t params;
+    };
+
+    KernelParamIndex() = default;
+
+    /**
+     * Serializes the kernels, the first one of each name only.
+     */
+    static std::vector<char> Build(
+        const std::vector<std::pair<std::string, NvInfoFunction>> &functions);
+
+    /**
+     * @return false if the data is not an index.
+     */
+    bool Attach(const char *data, size_t size);
+
+    /* the file mapped, or mBuilt */
+    const char *mData = nullptr;
+    size_t mSize = 0;
+    bool mMapped = false;
+    std::vector<char> mBuilt;
+    size_t mFunctions = 0;
+};
+
+#endif /* KERNELPARAMINDEX_H */
@@ -25,6 +25,7 @@
 
 #include <CudaUtil.h>
 #include <cuda.h>
+#include <gvirtus/common/Sha256.h>
 
 #include <cstdio>
 #include <iostream>
@@ -93,6 +94,17 @@ __fatBinC_Wrapper_t* CudaUtil::UnmarshalFatCudaBinary(Buffer* marshal) {
     return bin;
 }
 
+std::string CudaUtil::HashFatCudaBinary(const __fatBinC_Wrapper_t* bin) {
+    struct fatBinaryHeader* header = (fatBinaryHeader*)bin->data;
+    size_t size = header->fatSize + (unsigned long long)header->headerSize;
+
+    gvirtus::common::Sha256 sha;
+    sha.Update(&bin->magic, sizeof(bin->magic));
+    sha.Update(&bin->version, sizeof(bin->version));
+    sha.Update(bin->data, size);
+    return gvirtus::common::Sha256::Hex(sha.Final());
+}
+
 Buffer* CudaUtil::MarshalTextureDescForArguments(const cudaTextureDesc* tex,
                                                  Buffer* marshal = NULL) {
     if (marshal == NULL) marshal = new Buffer();
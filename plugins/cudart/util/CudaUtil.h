@@ -43,6 +43,7 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <string>
 
 using gvirtus::communicators::Buffer;
 
@@ -77,6 +78,12 @@ class CudaUtil {
     }
     static Buffer *MarshalFatCudaBinary(__fatBinC_Wrapper_t *bin, Buffer *marshal = NULL);
     static __fatBinC_Wrapper_t *UnmarshalFatCudaBinary(Buffer *marshal);
+    /**
+     * @return the SHA-256 of the fat binary, as marshalled by
+     * MarshalFatCudaBinary(), in hex: the key of the fat binaries cached by the
+     * backend.
+     */
+    static std::string HashFatCudaBinary(const __fatBinC_Wrapper_t *bin);
     static Buffer *MarshalTextureDescForArguments(const cudaTextureDesc *tex, Buffer *marshal);
     static cudaTextureDesc *UnmarshalTextureDesc(Buffer *marshal);
 
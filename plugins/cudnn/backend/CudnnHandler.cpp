@@ -32,6 +32,7 @@ using namespace std;
 using namespace log4cplus;
 
 std::map<string, CudnnHandler::CudnnRoutineHandler> *CudnnHandler::mspHandlers = NULL;
+std::vector<CudnnHandler::CudnnRoutineHandler> *CudnnHandler::mspHandlersById = NULL;
 
 static std::mutex desc_type_mutex;
 static std::unordered_map<void *, bool> desc_is_float_map;
@@ -146,6 +147,12 @@ bool CudnnHandler::CanExecute(std::string routine) {
     return mspHandlers->find(routine) != mspHandlers->end();
 }
 
+std::vector<std::string> CudnnHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
 std::shared_ptr<Result> CudnnHandler::Execute(std::string routine,
                                               std::shared_ptr<Buffer> input_buffer) {
     LOG4CPLUS_DEBUG(logger, "Called " << routine);
@@ -160,6 +167,16 @@ std::shared_ptr<Result> CudnnHandler::Execute(std::string routine,
     return NULL;
 }
 
+std::shared_ptr<Result> CudnnHandler::Execute(size_t routine_id,
+                                              std::shared_ptr<Buffer> input_buffer) {
+    try {
+        return mspHandlersById->at(routine_id)(this, input_buffer);
+    } catch (const std::exception &e) {
+        LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT("Exception: ") << e.what());
+    }
+    return NULL;
+}
+
 void CudnnHandler::Initialize() {
     if (mspHandlers != NULL) return;
     mspHandlers = new map<string, CudnnHandler::CudnnRoutineHandler>();
@@ -439,6 +456,10 @@ void CudnnHandler::Initialize() {
     mspHandlers->insert(CUDNN_ROUTINE_HANDLER_PAIR(SetRNNDescriptor_v6));
     mspHandlers->insert(CUDNN_ROUTINE_HANDLER_PAIR(GetRNNDescriptor_v6));
 #endif
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<CudnnHandler::CudnnRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
 
 CUDNN_ROUTINE_HANDLER(GetConvolutionMathType) {
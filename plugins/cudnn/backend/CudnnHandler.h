@@ -56,7 +56,9 @@ class CudnnHandler : public gvirtus::backend::Handler {
     CudnnHandler();
     virtual ~CudnnHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<Result> Execute(std::string routine, std::shared_ptr<Buffer> input_buffer);
+    std::shared_ptr<Result> Execute(size_t routine_id, std::shared_ptr<Buffer> input_buffer);
     log4cplus::Logger& GetLogger() { return logger; }
 
    private:
@@ -64,6 +66,7 @@ class CudnnHandler : public gvirtus::backend::Handler {
     void Initialize();
     typedef std::shared_ptr<Result> (*CudnnRoutineHandler)(CudnnHandler*, std::shared_ptr<Buffer>);
     static std::map<std::string, CudnnRoutineHandler>* mspHandlers;
+    static std::vector<CudnnRoutineHandler>* mspHandlersById;
 };
 
 #define CUDNN_ROUTINE_HANDLER(name) \
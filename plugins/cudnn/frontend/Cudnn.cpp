@@ -180,11 +180,9 @@ extern "C" cudnnStatus_t CUDNNWINAPI cudnnSetTensor4dDescriptor(cudnnTensorDescr
     CudnnFrontend::AddVariableForArguments<int>(h);
     CudnnFrontend::AddVariableForArguments<int>(w);
 
-    CudnnFrontend::Execute("cudnnSetTensor4dDescriptor");
-    if (CudnnFrontend::Success()) {
-        // tensorDesc = CudnnFrontend::GetOutputVariable<cudnnTensorDescriptor_t>();
-        registerDescriptorType(tensorDesc, dataType);
-    }
+    CudnnFrontend::ExecuteAsync("cudnnSetTensor4dDescriptor");
+    // deferred: a failure is reported by a later call, the type is recorded anyway
+    registerDescriptorType(tensorDesc, dataType);
     return CudnnFrontend::GetExitCode();
 }
 
@@ -205,10 +203,9 @@ extern "C" cudnnStatus_t CUDNNWINAPI cudnnSetTensor4dDescriptorEx(
     CudnnFrontend::AddVariableForArguments<int>(hStride);
     CudnnFrontend::AddVariableForArguments<int>(wStride);
 
-    CudnnFrontend::Execute("cudnnSetTensor4dDescriptorEx");
-    if (CudnnFrontend::Success()) {
-        registerDescriptorType(tensorDesc, dataType);
-    }
+    CudnnFrontend::ExecuteAsync("cudnnSetTensor4dDescriptorEx");
+    // deferred: a failure is reported by a later call, the type is recorded anyway
+    registerDescriptorType(tensorDesc, dataType);
     return CudnnFrontend::GetExitCode();
 }
 
@@ -246,13 +243,9 @@ extern "C" cudnnStatus_t CUDNNWINAPI cudnnSetTensorNdDescriptor(cudnnTensorDescr
     CudnnFrontend::AddHostPointerForArguments<const int>(dimA, nbDims);
     CudnnFrontend::AddHostPointerForArguments<const int>(strideA, nbDims);
 
-    CudnnFrontend::Execute("cudnnSetTensorNdDescriptor");
-    if (CudnnFrontend::Success()) {
-        cout << "Successfully set tensor descriptor " << tensorDesc << " with data type "
-             << dataType << endl;
-        registerDescriptorType(tensorDesc, dataType);
-        cout << "isFloatDescriptor: " << isFloatDescriptor(tensorDesc) << endl;
-    }
+    CudnnFrontend::ExecuteAsync("cudnnSetTensorNdDescriptor");
+    // deferred: a failure is reported by a later call, the type is recorded anyway
+    registerDescriptorType(tensorDesc, dataType);
     return CudnnFrontend::GetExitCode();
 }
 
@@ -804,7 +797,7 @@ extern "C" cudnnStatus_t CUDNNWINAPI cudnnSetTensor(cudnnHandle_t handle,
     CudnnFrontend::AddHostPointerForArguments(y);
     CudnnFrontend::AddHostPointerForArguments((void *)valuePtr);
 
-    CudnnFrontend::Execute("cudnnSetTensor");
+    CudnnFrontend::ExecuteAsync("cudnnSetTensor");
     return CudnnFrontend::GetExitCode();
 }
 
@@ -854,10 +847,9 @@ extern "C" cudnnStatus_t CUDNNWINAPI cudnnSetFilter4dDescriptor(cudnnFilterDescr
     CudnnFrontend::AddVariableForArguments<int>(h);
     CudnnFrontend::AddVariableForArguments<int>(w);
 
-    CudnnFrontend::Execute("cudnnSetFilter4dDescriptor");
-    if (CudnnFrontend::Success()) {
-        registerDescriptorType(filterDesc, dataType);
-    }
+    CudnnFrontend::ExecuteAsync("cudnnSetFilter4dDescriptor");
+    // deferred: a failure is reported by a later call, the type is recorded anyway
+    registerDescriptorType(filterDesc, dataType);
     return CudnnFrontend::GetExitCode();
 }
 
@@ -975,8 +967,9 @@ extern "C" cudnnStatus_t CUDNNWINAPI cudnnSetFilterNdDescriptor(cudnnFilterDescr
     CudnnFrontend::AddVariableForArguments<int>(nbDims);
     CudnnFrontend::AddHostPointerForArguments<const int>(filterDimA);
 
-    CudnnFrontend::Execute("cudnnSetFilterNdDescriptor");
-    if (CudnnFrontend::Success()) registerDescriptorType(filterDesc, dataType);
+    CudnnFrontend::ExecuteAsync("cudnnSetFilterNdDescriptor");
+    // deferred: a failure is reported by a later call, the type is recorded anyway
+    registerDescriptorType(filterDesc, dataType);
     return CudnnFrontend::GetExitCode();
 }
 
@@ -1167,7 +1160,7 @@ cudnnSetConvolutionMathType(cudnnConvolutionDescriptor_t convDesc, cudnnMathType
     CudnnFrontend::AddDevicePointerForArguments(convDesc);
     CudnnFrontend::AddVariableForArguments<cudnnMathType_t>(mathType);
 
-    CudnnFrontend::Execute("cudnnSetConvolutionMathType");
+    CudnnFrontend::ExecuteAsync("cudnnSetConvolutionMathType");
 
     return CudnnFrontend::GetExitCode();
 }
@@ -1192,7 +1185,7 @@ cudnnSetConvolutionGroupCount(cudnnConvolutionDescriptor_t convDesc, int groupCo
     CudnnFrontend::AddDevicePointerForArguments(convDesc);
     CudnnFrontend::AddVariableForArguments<int>(groupCount);
 
-    CudnnFrontend::Execute("cudnnSetConvolutionGroupCount");
+    CudnnFrontend::ExecuteAsync("cudnnSetConvolutionGroupCount");
 
     return CudnnFrontend::GetExitCode();
 }
@@ -1250,7 +1243,7 @@ extern "C" cudnnStatus_t CUDNNWINAPI cudnnSetConvolution2dDescriptor(
     CudnnFrontend::AddVariableForArguments<cudnnConvolutionMode_t>(mode);
     CudnnFrontend::AddVariableForArguments<cudnnDataType_t>(computeType);
 
-    CudnnFrontend::Execute("cudnnSetConvolution2dDescriptor");
+    CudnnFrontend::ExecuteAsync("cudnnSetConvolution2dDescriptor");
     return CudnnFrontend::GetExitCode();
 }
 
@@ -48,6 +48,15 @@ class CudnnFrontend {
         Frontend::GetFrontend()->Execute(routine, input_buffer);
     }
 
+    /**
+     * Requests the execution of a routine without output parameters without
+     * waiting for its exit code. A failure is reported by the next cuDNN
+     * routine through GetExitCode().
+     */
+    static inline void ExecuteAsync(const char *routine, const Buffer *input_buffer = NULL) {
+        Frontend::GetFrontend()->ExecuteAsync(routine, input_buffer);
+    }
+
     /**
      * Prepares the Frontend for the execution. This method _must_ be called
      * before any requests of execution or any method for adding parameters for
@@ -116,7 +125,11 @@ class CudnnFrontend {
     }
 
     static inline cudnnStatus_t GetExitCode() {
-        return (cudnnStatus_t)Frontend::GetFrontend()->GetExitCode();
+        Frontend *frontend = Frontend::GetFrontend();
+        if (!frontend->Success(CUDNN_STATUS_SUCCESS)) return (cudnnStatus_t)frontend->GetExitCode();
+        // cuDNN has no synchronizing routines: errors deferred by asynchronous executions
+        // are reported by the next routine
+        return (cudnnStatus_t)frontend->GetDeferredExitCode("cudnn");
     }
 
     static inline bool Success() { return Frontend::GetFrontend()->Success(cudaSuccess); }
@@ -37,6 +37,7 @@ using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
 
 map<string, CufftHandler::CufftRoutineHandler>* CufftHandler::mspHandlers = NULL;
+std::vector<CufftHandler::CufftRoutineHandler>* CufftHandler::mspHandlersById = NULL;
 
 extern "C" std::shared_ptr<CufftHandler> create_t() { return std::make_shared<CufftHandler>(); }
 
@@ -51,6 +52,12 @@ bool CufftHandler::CanExecute(std::string routine) {
     return mspHandlers->find(routine) != mspHandlers->end();
 }
 
+std::vector<std::string> CufftHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
 std::shared_ptr<Result> CufftHandler::Execute(std::string routine,
                                               std::shared_ptr<Buffer> input_buffer) {
     LOG4CPLUS_DEBUG(logger, "Called " << routine);
@@ -67,6 +74,16 @@ std::shared_ptr<Result> CufftHandler::Execute(std::string routine,
     return NULL;
 }
 
+std::shared_ptr<Result> CufftHandler::Execute(size_t routine_id,
+                                              std::shared_ptr<Buffer> input_buffer) {
+    try {
+        return mspHandlersById->at(routine_id)(this, input_buffer);
+    } catch (const std::exception& e) {
+        LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT("Exception: ") << e.what());
+    }
+    return NULL;
+}
+
 /*
  * cufftResult cufftPlan1d(cufftHandle *plan, int nx, cufftType type, int batch);
  * Creates a 1D FFT plan configuration for a specified signal size and data type.
@@ -1047,4 +1064,8 @@ void CufftHandler::Initialize() {
     mspHandlers->insert(CUFFT_ROUTINE_HANDLER_PAIR(XtMalloc));
     mspHandlers->insert(CUFFT_ROUTINE_HANDLER_PAIR(XtMemcpy));
     mspHandlers->insert(CUFFT_ROUTINE_HANDLER_PAIR(XtFree));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<CufftHandler::CufftRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
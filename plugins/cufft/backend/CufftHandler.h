@@ -58,8 +58,11 @@ class CufftHandler : public gvirtus::backend::Handler {
     CufftHandler();
     virtual ~CufftHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<gvirtus::communicators::Result> Execute(
         std::string routine, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    std::shared_ptr<gvirtus::communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
     log4cplus::Logger& GetLogger() { return logger; }
 
    private:
@@ -68,6 +71,7 @@ class CufftHandler : public gvirtus::backend::Handler {
     typedef std::shared_ptr<gvirtus::communicators::Result> (*CufftRoutineHandler)(
         CufftHandler*, std::shared_ptr<gvirtus::communicators::Buffer>);
     static std::map<std::string, CufftRoutineHandler>* mspHandlers;
+    static std::vector<CufftRoutineHandler>* mspHandlersById;
 };
 
 #define CUFFT_ROUTINE_HANDLER(name)                               \
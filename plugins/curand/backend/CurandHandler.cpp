@@ -35,6 +35,7 @@ using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
 
 std::map<string, CurandHandler::CurandRoutineHandler>* CurandHandler::mspHandlers = NULL;
+std::vector<CurandHandler::CurandRoutineHandler>* CurandHandler::mspHandlersById = NULL;
 
 extern "C" std::shared_ptr<CurandHandler> create_t() { return std::make_shared<CurandHandler>(); }
 
@@ -49,6 +50,12 @@ bool CurandHandler::CanExecute(std::string routine) {
     return mspHandlers->find(routine) != mspHandlers->end();
 }
 
+std::vector<std::string> CurandHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
 std::shared_ptr<Result> CurandHandler::Execute(std::string routine, std::shared_ptr<Buffer> in) {
     LOG4CPLUS_DEBUG(logger, "Called " << routine);
     map<string, CurandHandler::CurandRoutineHandler>::iterator it;
@@ -63,6 +70,16 @@ std::shared_ptr<Result> CurandHandler::Execute(std::string routine, std::shared_
     return NULL;
 }
 
+std::shared_ptr<Result> CurandHandler::Execute(size_t routine_id,
+                                               std::shared_ptr<Buffer> in) {
+    try {
+        return mspHandlersById->at(routine_id)(this, in);
+    } catch (const std::exception& e) {
+        LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT("Exception: ") << e.what());
+    }
+    return NULL;
+}
+
 void CurandHandler::Initialize() {
     if (mspHandlers != NULL) return;
     mspHandlers = new map<string, CurandHandler::CurandRoutineHandler>();
@@ -83,4 +100,8 @@ void CurandHandler::Initialize() {
     mspHandlers->insert(CURAND_ROUTINE_HANDLER_PAIR(GenerateNormalDouble));
     mspHandlers->insert(CURAND_ROUTINE_HANDLER_PAIR(GenerateLogNormalDouble));
     mspHandlers->insert(CURAND_ROUTINE_HANDLER_PAIR(DestroyGenerator));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<CurandHandler::CurandRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
\ No newline at end of file
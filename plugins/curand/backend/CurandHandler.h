@@ -42,8 +42,11 @@ class CurandHandler : public gvirtus::backend::Handler {
     CurandHandler();
     virtual ~CurandHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<gvirtus::communicators::Result> Execute(
         std::string routine, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    std::shared_ptr<gvirtus::communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
     log4cplus::Logger &GetLogger() { return logger; }
 
    private:
@@ -52,6 +55,7 @@ class CurandHandler : public gvirtus::backend::Handler {
     typedef std::shared_ptr<gvirtus::communicators::Result> (*CurandRoutineHandler)(
         CurandHandler *, std::shared_ptr<gvirtus::communicators::Buffer>);
     static std::map<std::string, CurandRoutineHandler> *mspHandlers;
+    static std::vector<CurandRoutineHandler> *mspHandlersById;
 };
 
 #define CURAND_ROUTINE_HANDLER(name)                              \
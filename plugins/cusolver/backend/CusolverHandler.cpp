@@ -35,6 +35,7 @@ using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
 
 std::map<string, CusolverHandler::CusolverRoutineHandler>* CusolverHandler::mspHandlers = NULL;
+std::vector<CusolverHandler::CusolverRoutineHandler>* CusolverHandler::mspHandlersById = NULL;
 
 extern "C" std::shared_ptr<CusolverHandler> create_t() {
     return std::make_shared<CusolverHandler>();
@@ -53,6 +54,12 @@ bool CusolverHandler::CanExecute(std::string routine) {
     return mspHandlers->find(routine) != mspHandlers->end();
 }
 
+std::vector<std::string> CusolverHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
 std::shared_ptr<Result> CusolverHandler::Execute(std::string routine,
                                                  std::shared_ptr<Buffer> input_buffer) {
     LOG4CPLUS_DEBUG(logger, "Called " << routine);
@@ -67,6 +74,16 @@ std::shared_ptr<Result> CusolverHandler::Execute(std::string routine,
     return NULL;
 }
 
+std::shared_ptr<Result> CusolverHandler::Execute(size_t routine_id,
+                                                 std::shared_ptr<Buffer> input_buffer) {
+    try {
+        return mspHandlersById->at(routine_id)(this, input_buffer);
+    } catch (const std::exception& e) {
+        LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT("Exception: ") << e.what());
+    }
+    return NULL;
+}
+
 CUSOLVER_ROUTINE_HANDLER(DnCreate) {
     cusolverDnHandle_t handle;
     cusolverStatus_t cs = cusolverDnCreate(&handle);
@@ -120,4 +137,8 @@ void CusolverHandler::Initialize() {
     mspHandlers->insert(CUSOLVER_ROUTINE_HANDLER_PAIR(DnDestroy));
     mspHandlers->insert(CUSOLVER_ROUTINE_HANDLER_PAIR(DnSetStream));
     mspHandlers->insert(CUSOLVER_ROUTINE_HANDLER_PAIR(DnGetStream));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<CusolverHandler::CusolverRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
\ No newline at end of file
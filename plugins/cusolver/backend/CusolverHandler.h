@@ -50,8 +50,11 @@ class CusolverHandler : public gvirtus::backend::Handler {
     CusolverHandler();
     virtual ~CusolverHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<gvirtus::communicators::Result> Execute(
         std::string routine, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    std::shared_ptr<gvirtus::communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
     log4cplus::Logger& GetLogger() { return logger; }
 
    private:
@@ -60,6 +63,7 @@ class CusolverHandler : public gvirtus::backend::Handler {
     typedef std::shared_ptr<gvirtus::communicators::Result> (*CusolverRoutineHandler)(
         CusolverHandler*, std::shared_ptr<gvirtus::communicators::Buffer>);
     static std::map<std::string, CusolverRoutineHandler>* mspHandlers;
+    static std::vector<CusolverRoutineHandler>* mspHandlersById;
 };
 
 #define CUSOLVER_ROUTINE_HANDLER(name)                            \
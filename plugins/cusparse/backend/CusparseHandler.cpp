@@ -34,6 +34,7 @@ using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
 
 std::map<string, CusparseHandler::CusparseRoutineHandler>* CusparseHandler::mspHandlers = NULL;
+std::vector<CusparseHandler::CusparseRoutineHandler>* CusparseHandler::mspHandlersById = NULL;
 
 extern "C" std::shared_ptr<CusparseHandler> create_t() {
     return std::make_shared<CusparseHandler>();
@@ -52,6 +53,12 @@ bool CusparseHandler::CanExecute(std::string routine) {
     return mspHandlers->find(routine) != mspHandlers->end();
 }
 
+std::vector<std::string> CusparseHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
 std::shared_ptr<Result> CusparseHandler::Execute(std::string routine,
                                                  std::shared_ptr<Buffer> input_buffer) {
     LOG4CPLUS_DEBUG(logger, "Called " << routine);
@@ -66,6 +73,16 @@ std::shared_ptr<Result> CusparseHandler::Execute(std::string routine,
     return NULL;
 }
 
+std::shared_ptr<Result> CusparseHandler::Execute(size_t routine_id,
+                                                 std::shared_ptr<Buffer> input_buffer) {
+    try {
+        return mspHandlersById->at(routine_id)(this, input_buffer);
+    } catch (const std::exception& e) {
+        LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT("Exception: ") << e.what());
+    }
+    return NULL;
+}
+
 CUSPARSE_ROUTINE_HANDLER(GetVersion) {
     cusparseHandle_t handle = in->Get<cusparseHandle_t>();
     int version;
@@ -145,4 +162,8 @@ void CusparseHandler::Initialize() {
     mspHandlers->insert(CUSPARSE_ROUTINE_HANDLER_PAIR(Destroy));
     mspHandlers->insert(CUSPARSE_ROUTINE_HANDLER_PAIR(SetStream));
     mspHandlers->insert(CUSPARSE_ROUTINE_HANDLER_PAIR(GetStream));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<CusparseHandler::CusparseRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
\ No newline at end of file
@@ -48,8 +48,11 @@ class CusparseHandler : public gvirtus::backend::Handler {
     CusparseHandler();
     virtual ~CusparseHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<gvirtus::communicators::Result> Execute(
         std::string routine, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    std::shared_ptr<gvirtus::communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
     log4cplus::Logger& GetLogger() { return logger; }
 
    private:
@@ -58,6 +61,7 @@ class CusparseHandler : public gvirtus::backend::Handler {
     typedef std::shared_ptr<gvirtus::communicators::Result> (*CusparseRoutineHandler)(
         CusparseHandler*, std::shared_ptr<gvirtus::communicators::Buffer>);
     static std::map<std::string, CusparseRoutineHandler>* mspHandlers;
+    static std::vector<CusparseRoutineHandler>* mspHandlersById;
 };
 
 #define CUSPARSE_ROUTINE_HANDLER(name)                            \
@@ -34,6 +34,7 @@ using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
 
 std::map<string, NvmlHandler::NvmlRoutineHandler>* NvmlHandler::mspHandlers = NULL;
+std::vector<NvmlHandler::NvmlRoutineHandler>* NvmlHandler::mspHandlersById = NULL;
 
 extern "C" std::shared_ptr<NvmlHandler> create_t() { return std::make_shared<NvmlHandler>(); }
 
@@ -50,6 +51,12 @@ bool NvmlHandler::CanExecute(std::string routine) {
     return mspHandlers->find(routine) != mspHandlers->end();
 }
 
+std::vector<std::string> NvmlHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
 std::shared_ptr<Result> NvmlHandler::Execute(std::string routine,
                                              std::shared_ptr<Buffer> input_buffer) {
     LOG4CPLUS_DEBUG(logger, "Called " << routine);
@@ -64,6 +71,16 @@ std::shared_ptr<Result> NvmlHandler::Execute(std::string routine,
     return NULL;
 }
 
+std::shared_ptr<Result> NvmlHandler::Execute(size_t routine_id,
+                                             std::shared_ptr<Buffer> input_buffer) {
+    try {
+        return mspHandlersById->at(routine_id)(this, input_buffer);
+    } catch (const std::exception& e) {
+        LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT("Exception: ") << e.what());
+    }
+    return NULL;
+}
+
 void NvmlHandler::Initialize() {
     if (mspHandlers != NULL) return;
     mspHandlers = new map<string, NvmlHandler::NvmlRoutineHandler>();
@@ -106,4 +123,8 @@ void NvmlHandler::Initialize() {
     mspHandlers->insert(NVML_ROUTINE_HANDLER_PAIR(EventSetFree));
     // Internal
     // mspHandlers->insert(NVML_ROUTINE_HANDLER_PAIR(InternalGetExportTable));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<NvmlHandler::NvmlRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
\ No newline at end of file
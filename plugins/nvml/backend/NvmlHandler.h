@@ -48,8 +48,11 @@ class NvmlHandler : public gvirtus::backend::Handler {
     NvmlHandler();
     virtual ~NvmlHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<gvirtus::communicators::Result> Execute(
         std::string routine, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    std::shared_ptr<gvirtus::communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
     log4cplus::Logger &GetLogger() { return logger; }
 
    private:
@@ -58,6 +61,7 @@ class NvmlHandler : public gvirtus::backend::Handler {
     typedef std::shared_ptr<gvirtus::communicators::Result> (*NvmlRoutineHandler)(
         NvmlHandler *, std::shared_ptr<gvirtus::communicators::Buffer>);
     static std::map<std::string, NvmlRoutineHandler> *mspHandlers;
+    static std::vector<NvmlRoutineHandler> *mspHandlersById;
 };
 
 #define NVML_ROUTINE_HANDLER(name)                                \
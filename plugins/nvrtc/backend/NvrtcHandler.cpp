@@ -33,6 +33,7 @@ using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Result;
 
 std::map<string, NvrtcHandler::NvrtcRoutineHandler>* NvrtcHandler::mspHandlers = NULL;
+std::vector<NvrtcHandler::NvrtcRoutineHandler>* NvrtcHandler::mspHandlersById = NULL;
 
 extern "C" std::shared_ptr<NvrtcHandler> create_t() { return std::make_shared<NvrtcHandler>(); }
 
@@ -49,6 +50,12 @@ bool NvrtcHandler::CanExecute(std::string routine) {
     return mspHandlers->find(routine) != mspHandlers->end();
 }
 
+std::vector<std::string> NvrtcHandler::GetRoutines() {
+    std::vector<std::string> routines;
+    for (auto &it : *mspHandlers) routines.push_back(it.first);
+    return routines;
+}
+
 std::shared_ptr<Result> NvrtcHandler::Execute(std::string routine,
                                               std::shared_ptr<Buffer> input_buffer) {
     LOG4CPLUS_DEBUG(logger, "Called " << routine);
@@ -63,9 +70,23 @@ std::shared_ptr<Result> NvrtcHandler::Execute(std::string routine,
     return NULL;
 }
 
+std::shared_ptr<Result> NvrtcHandler::Execute(size_t routine_id,
+                                              std::shared_ptr<Buffer> input_buffer) {
+    try {
+        return mspHandlersById->at(routine_id)(this, input_buffer);
+    } catch (const std::exception& e) {
+        LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT("Exception: ") << e.what());
+    }
+    return NULL;
+}
+
 void NvrtcHandler::Initialize() {
     if (mspHandlers != NULL) return;
     mspHandlers = new map<string, NvrtcHandler::NvrtcRoutineHandler>();
 
     mspHandlers->insert(NVRTC_ROUTINE_HANDLER_PAIR(GetErrorString));
+
+    // the position of a routine in mspHandlersById is its index in GetRoutines()
+    mspHandlersById = new vector<NvrtcHandler::NvrtcRoutineHandler>();
+    for (auto &it : *mspHandlers) mspHandlersById->push_back(it.second);
 }
\ No newline at end of file
@@ -45,8 +45,11 @@ class NvrtcHandler : public gvirtus::backend::Handler {
     NvrtcHandler();
     virtual ~NvrtcHandler();
     bool CanExecute(std::string routine);
+    std::vector<std::string> GetRoutines();
     std::shared_ptr<gvirtus::communicators::Result> Execute(
         std::string routine, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
+    std::shared_ptr<gvirtus::communicators::Result> Execute(
+        size_t routine_id, std::shared_ptr<gvirtus::communicators::Buffer> input_buffer);
     log4cplus::Logger& GetLogger() { return logger; }
 
    private:
@@ -55,6 +58,7 @@ class NvrtcHandler : public gvirtus::backend::Handler {
     typedef std::shared_ptr<gvirtus::communicators::Result> (*NvrtcRoutineHandler)(
         NvrtcHandler*, std::shared_ptr<gvirtus::communicators::Buffer>);
     static std::map<std::string, NvrtcRoutineHandler>* mspHandlers;
+    static std::vector<NvrtcRoutineHandler>* mspHandlersById;
 };
 
 #define NVRTC_ROUTINE_HANDLER(name)                               \
@@ -32,6 +32,7 @@
 
 #include <gvirtus/communicators/CommunicatorFactory.h>
 #include <gvirtus/communicators/EndpointFactory.h>
+#include <gvirtus/communicators/Endpoint_Tcp.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -65,10 +66,16 @@ Backend::Backend(const fs::path &path) {
 
     try {
         for (int i = 0; i < _properties.endpoints(); i++) {
+            auto endpoint = communicators::EndpointFactory::get_endpoint(path);
+            // the frontends of this host connect to the TCP endpoints through AF_UNIX
+            auto local = _properties.secure()
+                             ? nullptr
+                             : communicators::CommunicatorFactory::get_local_communicator(endpoint);
+            auto tcp = std::dynamic_pointer_cast<communicators::Endpoint_Tcp>(endpoint);
             _children.push_back(std::make_unique<Process>(
-                communicators::CommunicatorFactory::get_communicator(
-                    communicators::EndpointFactory::get_endpoint(path), _properties.secure()),
-                _properties.plugins().at(i)));
+                communicators::CommunicatorFactory::get_communicator(endpoint,
+                                                                     _properties.secure()),
+                _properties.plugins().at(i), local, tcp != nullptr ? tcp->stripes() : 1));
         }
         /*
         for (int i = 0; i < _properties.endpoints(); i++) {
@@ -29,73 +29,62 @@
  */
 
 #include <gvirtus/backend/Process.h>
+#include <gvirtus/communicators/Batch.h>
+#include <gvirtus/communicators/Compressor.h>
+#include <gvirtus/communicators/Protocol.h>
+#include <gvirtus/communicators/StripedCommunicator.h>
 #include <gvirtus/common/JSON.h>
 #include <gvirtus/common/SignalException.h>
 #include <gvirtus/common/SignalState.h>
 #include <pthread.h>
 #include <signal.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iostream>
+#include <random>
+#include <set>
 #include <thread>
 
 // #define DEBUG
 
 using gvirtus::backend::Process;
+using gvirtus::backend::Reactor;
 using gvirtus::common::LD_Lib;
+using gvirtus::communicators::Batch;
 using gvirtus::communicators::Buffer;
+using gvirtus::communicators::BulkLane;
 using gvirtus::communicators::Communicator;
+using gvirtus::communicators::Compressor;
 using gvirtus::communicators::Endpoint;
+using gvirtus::communicators::Hello;
+using gvirtus::communicators::RequestHeader;
+using gvirtus::communicators::Result;
+using gvirtus::communicators::StripedCommunicator;
+using gvirtus::communicators::Transfer;
 
 using std::chrono::steady_clock;
 
 using namespace std;
 
 Process::Process(std::shared_ptr<LD_Lib<Communicator, std::shared_ptr<Endpoint>>> communicator,
-                 vector<string> &plugins)
-    : Observable() {
+                 vector<string> &plugins,
+                 std::shared_ptr<LD_Lib<Communicator, std::shared_ptr<Endpoint>>> local_communicator,
+                 unsigned stripes)
+    : Observable(), mStripes(stripes) {
     logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("Process"));
 
     signal(SIGCHLD, SIG_IGN);
+    // a frontend may disconnect while results are still queued for it
+    signal(SIGPIPE, SIG_IGN);
     _communicator = communicator;
+    _local_communicator = local_communicator;
     mPlugins = plugins;
 }
 
-bool getstring(Communicator *c, string &s) {
-    // TODO: FIX LISKOV SUBSTITUTION AND DIPENDENCE INVERSION!!!!!
-    if (c->to_string() == "tcpcommunicator") {
-        s = "";
-        char ch = 0;
-        while (c->Read(&ch, 1) == 1) {
-            // If reading is ended, return true
-            if (ch == 0) {
-                return true;
-            }
-            s += ch;
-        }
-        return false;
-    } else if (c->to_string() == "rdmacommunicator") {
-        try {
-            s = "";
-            size_t size = 30;
-            char *buf = (char *)malloc(size);
-            size = c->Read(buf, size);
-
-            // if read, return true
-            if (size > 0) {
-                s += std::string(buf);
-                return true;
-            }
-        } catch (const std::exception &e) {
-            cerr << e.what() << endl;
-        }
-        return false;
-    }
-
-    throw runtime_error("Communicator getstring read error... Unknown communicator type...");
-}
-
 extern std::string getEnvVar(std::string const &key);
 
 std::string getGVirtuSHome() {
@@ -123,90 +112,441 @@ void Process::Start() {
         }
     });
 
+    // the id of a routine is its position in the table sent by Handshake(); when more plugins
+    // export the same routine the first one wins, as it did with the CanExecute() scan
+    std::set<std::string> known_routines;
+    for (auto &ptr_el : _handlers) {
+        if (ptr_el->obj_ptr()->Defers()) mDeferringHandlers.push_back(ptr_el->obj_ptr().get());
+        auto routines = ptr_el->obj_ptr()->GetRoutines();
+        for (size_t i = 0; i < routines.size(); i++) {
+            if (!known_routines.insert(routines[i]).second) continue;
+            mRoutines.push_back(routines[i]);
+            mDispatchTable.push_back({ptr_el->obj_ptr().get(), i});
+        }
+    }
+    LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "] " << mRoutines.size()
+                                        << " routine(s) available.");
+
     // inserisci i sym dei plugin in h
     std::function<void(Communicator *)> execute = [this](Communicator *client_comm) {
         LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "]"
                                             << "Process::Start()'s \"execute\" lambda called");
         // carica i puntatori ai simboli dei moduli in mHandlers
 
-        string routine;
-        std::shared_ptr<Buffer> input_buffer = std::make_shared<Buffer>();
-
-        while (getstring(client_comm, routine)) {
-            LOG4CPLUS_DEBUG(logger, "Received routine " << routine);
+        auto connection = std::make_shared<Connection>(client_comm);
 
-            input_buffer->Reset(client_comm);
-
-            std::shared_ptr<Handler> h = nullptr;
-            for (auto &ptr_el : _handlers) {
-                if (ptr_el->obj_ptr()->CanExecute(routine)) {
-                    h = ptr_el->obj_ptr();
-                    break;
+        try {
+            if (Handshake(connection)) {
+                while (ServeRequest(connection) != Served::CLOSED) {
                 }
             }
-
-            std::shared_ptr<communicators::Result> result;
-            if (h == nullptr) {
-                LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: Requested unknown routine '"
-                                                    << routine << "'.");
-                result = std::make_shared<communicators::Result>(-1, std::make_shared<Buffer>());
-            } else {
-                // esegue la routine e salva il risultato in result
-                auto start = steady_clock::now();
-                result = h->Execute(routine, input_buffer);
-                result->TimeTaken(std::chrono::duration_cast<std::chrono::milliseconds>(
-                                      steady_clock::now() - start)
-                                      .count() /
-                                  1000.0);
-            }
-
-            // scrive il risultato sul communicator
-            result->Dump(client_comm);
-            LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "]: Routine '" << routine
-                                                << "' returned " << result->GetExitCode() << ".");
+        } catch (const std::exception &e) {
+            LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: " << e.what());
         }
         Notify("process-ended");
     };
 
+    // the connections are served by a pool of workers, unless GVIRTUS_BACKEND_WORKERS=0
+    size_t workers = std::max(4u, std::thread::hardware_concurrency());
+    const char *workers_env = getenv("GVIRTUS_BACKEND_WORKERS");
+    if (workers_env != nullptr && *workers_env != '\0') workers = strtoul(workers_env, NULL, 10);
+    if (workers > 0) {
+        mpReactor = std::make_unique<Reactor>(workers);
+        LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "] Serving the connections on "
+                                            << workers << " worker(s).");
+    }
+
     /*
     common::SignalState sig_hand;
     sig_hand.setup_signal_state(SIGINT);
 */
 
+    if (_local_communicator != nullptr) {
+        try {
+            _local_communicator->obj_ptr()->Serve();
+            std::thread(&Process::Accept, this, _local_communicator->obj_ptr().get(), execute)
+                .detach();
+        } catch (const std::exception &exc) {
+            // e.g. another backend serves the same port: the TCP endpoint is enough
+            LOG4CPLUS_WARN(logger, "[Process " << getpid() << "]: Not serving the local "
+                                               << "frontends through AF_UNIX: " << exc.what());
+        }
+    }
+
     try {
         _communicator->obj_ptr()->Serve();
+        Accept(_communicator->obj_ptr().get(), execute);
+    } catch (const std::exception &exc) {
+        LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: " << exc.what());
+    }
 
-        int pid = 0;
-        while (true) {
-            Communicator *client = const_cast<Communicator *>(_communicator->obj_ptr()->Accept());
+    LOG4CPLUS_DEBUG(logger, "Process::Start() returned [Process " << getpid() << "].");
+    // exit(EXIT_SUCCESS);
+}
+
+void Process::Accept(Communicator *server, const std::function<void(Communicator *)> &execute) {
+    int pid = 0;
+    while (true) {
+        Communicator *client = const_cast<Communicator *>(server->Accept());
 
-            if (client != nullptr) {
-                //      if ((pid = fork()) == 0) {
-                std::thread(execute, client).detach();
-                //        exit(0);
-                //      }
+        if (client != nullptr && mpReactor != nullptr && client->GetFileDescriptor() >= 0) {
+            mpReactor->Start(Serve(client));
+        } else if (client != nullptr) {
+            //      if ((pid = fork()) == 0) {
+            std::thread(execute, client).detach();
+            //        exit(0);
+            //      }
 
-            } else
-                _communicator->obj_ptr()->run();
+        } else
+            server->run();
 
-            // check if process received SIGINT
+        // check if process received SIGINT
 
-            if (common::SignalState::get_signal_state(SIGINT)) {
-                LOG4CPLUS_DEBUG(
-                    logger, "SIGINT received, killing server on [Process " << getpid() << "]...");
-                break;
+        if (common::SignalState::get_signal_state(SIGINT)) {
+            LOG4CPLUS_DEBUG(logger,
+                            "SIGINT received, killing server on [Process " << getpid() << "]...");
+            break;
+        }
+    }
+}
+
+bool Process::Handshake(const std::shared_ptr<Connection> &connection) {
+    Communicator *c = connection->communicator;
+    Hello hello;
+    if (c->Read((char *)&hello, sizeof(hello)) != sizeof(hello)) return false;
+    if (hello.magic == GVIRTUS_BULK_LANE_MAGIC && hello.version == GVIRTUS_PROTOCOL_VERSION) {
+        AcceptBulkLane(*connection, hello);
+        return false;
+    }
+    if (hello.magic != GVIRTUS_PROTOCOL_MAGIC || hello.version != GVIRTUS_PROTOCOL_VERSION) {
+        LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: Unsupported frontend protocol (magic "
+                                            << std::hex << hello.magic << std::dec << ", version "
+                                            << hello.version << ").");
+        return false;
+    }
+    connection->client = GetClient(hello.client_id);
+
+    hello.capabilities &= communicators::SUPPORTED_CAPABILITIES | Compressor::GetCapabilities();
+    c->Write((char *)&hello, sizeof(hello));
+    connection->compressor = Compressor::Create(hello.capabilities);
+    connection->decompressor = Compressor::Create(hello.capabilities);
+
+    Buffer routines;
+    routines.Add(mRoutines.size());
+    for (auto &routine : mRoutines) routines.AddString(routine.c_str());
+    if (hello.capabilities & communicators::CAPABILITY_BULK_LANE) {
+        std::lock_guard<std::mutex> lock(mConnectionsMutex);
+        // std::random_device is not thread safe: it is used under mConnectionsMutex only
+        static std::random_device token_source;
+        for (auto it = mConnections.begin(); it != mConnections.end();)
+            it = it->second.expired() ? mConnections.erase(it) : std::next(it);
+        // not guessable: a bulk lane is given the requests of its session
+        do {
+            connection->token = ((uint64_t)token_source() << 32) | token_source();
+        } while (connection->token == 0 || mConnections.count(connection->token) > 0);
+        mConnections.emplace(connection->token, connection);
+        routines.Add(connection->token);
+        routines.Add((uint32_t)mStripes);
+    }
+    routines.Dump(c);
+
+    LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "]: Handshake completed, capabilities "
+                                        << std::hex << hello.capabilities << std::dec << ".");
+    return true;
+}
+
+void Process::AcceptBulkLane(Connection &connection, const Hello &client_hello) {
+    Communicator *c = connection.communicator;
+    BulkLane bulk_lane;
+    if (c->Read((char *)&bulk_lane, sizeof(bulk_lane)) != sizeof(bulk_lane)) return;
+
+    std::shared_ptr<Connection> owner;
+    {
+        std::lock_guard<std::mutex> lock(mConnectionsMutex);
+        auto it = mConnections.find(bulk_lane.token);
+        if (it != mConnections.end()) owner = it->second.lock();
+    }
+    Hello hello = {GVIRTUS_BULK_LANE_MAGIC, GVIRTUS_PROTOCOL_VERSION, 0};
+    if (owner != nullptr && owner->client->id == client_hello.client_id &&
+        bulk_lane.stripes >= 1 && bulk_lane.stripes <= mStripes &&
+        bulk_lane.stripe < bulk_lane.stripes) {
+        std::lock_guard<std::mutex> lock(owner->mutex);
+        Session &session = owner->sessions[bulk_lane.session_id];
+        auto &stripes = session.stripes;
+        if (stripes.size() != bulk_lane.stripes) stripes.assign(bulk_lane.stripes, nullptr);
+        if (session.bulk_lane == nullptr && stripes[bulk_lane.stripe] == nullptr) {
+            stripes[bulk_lane.stripe].reset(c);
+            connection.communicator = nullptr;
+            hello.capabilities = communicators::CAPABILITY_BULK_LANE;
+            // complete before answering the last stripe: the requests using it come after
+            if (std::find(stripes.begin(), stripes.end(), nullptr) == stripes.end()) {
+                session.bulk_lane = stripes.size() == 1
+                                        ? stripes.front()
+                                        : std::make_shared<StripedCommunicator>(stripes);
+                stripes.clear();
             }
         }
-    } catch (const std::exception &exc) {
-        LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: " << exc.what());
     }
+    c->Write((char *)&hello, sizeof(hello));
+    c->Sync();
+    LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "]: Stripe " << bulk_lane.stripe << "/"
+                                        << bulk_lane.stripes << " of the bulk lane of session "
+                                        << bulk_lane.session_id
+                                        << (hello.capabilities ? " opened." : " refused."));
+}
 
-    LOG4CPLUS_DEBUG(logger, "Process::Start() returned [Process " << getpid() << "].");
-    // exit(EXIT_SUCCESS);
+std::shared_ptr<Process::Client> Process::GetClient(uint64_t id) {
+    // a connection without an id is a client of its own
+    if (id == 0) return std::make_shared<Client>();
+    std::lock_guard<std::mutex> lock(mClientsMutex);
+    for (auto it = mClients.begin(); it != mClients.end();)
+        it = it->second.expired() ? mClients.erase(it) : std::next(it);
+    std::shared_ptr<Client> client = mClients[id].lock();
+    if (client == nullptr) {
+        client = std::make_shared<Client>();
+        client->id = id;
+        mClients[id] = client;
+    }
+    return client;
+}
+
+/* the key of the next session */
+static std::atomic<uint64_t> next_session_key{1};
+
+Process::Served Process::ServeRequest(const std::shared_ptr<Connection> &connection) {
+    Communicator *c = connection->communicator;
+    Request request = {{}, std::make_shared<Buffer>()};
+    RequestHeader &header = request.header;
+    if (c->Read((char *)&header, sizeof(header)) != sizeof(header)) return Served::CLOSED;
+    if (header.flags & communicators::REQUEST_COMPRESSED) {
+        if (connection->decompressor == nullptr)
+            throw runtime_error("Unexpected compressed request");
+        struct iovec iov = {request.input_buffer->Extend(header.payload_size),
+                            header.payload_size};
+        connection->decompressor->Read(c, header.payload_size, &iov, 1);
+    } else if (header.payload_size > 0) {
+        request.input_buffer->Read<char>(c, header.payload_size);
+    }
+
+    std::unique_lock<std::mutex> lock(connection->mutex);
+    if (header.flags & communicators::REQUEST_END_SESSION) {
+        auto it = connection->sessions.find(header.session_id);
+        if (it != connection->sessions.end()) {
+            if (it->second.running)
+                it->second.ended = true;
+            else
+                connection->sessions.erase(it);
+        }
+        LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "]: Session " << header.session_id
+                                            << " ended.");
+        return Served::NEXT;
+    }
+    Session &session = connection->sessions[header.session_id];
+    if (session.key == 0) {
+        // a new session starts with the state of a new thread
+        session.id = header.session_id;
+        session.key = next_session_key++;
+        session.states.resize(_handlers.size());
+    }
+    // the routine reads the transfer itself, as it copies it
+    bool transfer = header.transfer_size > 0;
+    bool bulk = header.flags & communicators::REQUEST_BULK_LANE;
+    if (bulk && session.bulk_lane == nullptr) throw runtime_error("Unexpected bulk lane request");
+    if (transfer)
+        request.input_buffer->SetTransfer(std::make_shared<Transfer>(
+            header.transfer_size, bulk ? session.bulk_lane.get() : c));
+    session.requests.push_back(std::move(request));
+    bool start = !session.running;
+    session.running = true;
+    lock.unlock();
+
+    // the results are written while reading the next requests only on a full duplex communicator
+    // served by the reactor: a connection read by a thread of its own has no one to hand over to
+    if (!connection->concurrent) {
+        RunRequests(connection, session);
+        return Served::NEXT;
+    }
+    if (start) mpReactor->Start(RunSession(connection, &session));
+    return transfer && !bulk ? Served::HANDED_OVER : Served::NEXT;
+}
+
+void Process::RunRequests(const std::shared_ptr<Connection> &connection, Session &session) {
+    // always: the session may have changed its state on another thread since it last ran here
+    RestoreThreadState(session.states);
+    RestoreClientState(*connection->client);
+
+    std::unique_lock<std::mutex> lock(connection->mutex);
+    while (!session.requests.empty()) {
+        Request request = std::move(session.requests.front());
+        session.requests.pop_front();
+        auto bulk_lane = session.bulk_lane;
+        lock.unlock();
+
+        std::shared_ptr<Result> result;
+        try {
+            if (request.header.flags & communicators::REQUEST_BATCH)
+                result = ExecuteBatch(request.input_buffer);
+            else
+                result = Execute(request.header.routine_id, request.input_buffer);
+        } catch (const std::exception &e) {
+            // every request gets an answer, or its frontend waits forever
+            LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: Request "
+                                                << request.header.request_id
+                                                << " failed: " << e.what());
+            result = std::make_shared<Result>(-1, std::make_shared<Buffer>());
+        }
+        auto transfer = request.input_buffer->GetTransfer();
+        if (transfer != nullptr) {
+            transfer->Close();
+            // the connection was left to the routine, see ServeRequest()
+            bool bulk = request.header.flags & communicators::REQUEST_BULK_LANE;
+            if (connection->concurrent && !bulk) mpReactor->Start(Serve(connection, true));
+        }
+
+        // scrive il risultato sul communicator
+        try {
+            // a large output goes on the bulk lane, not holding up the results of other sessions
+            bool bulk = bulk_lane != nullptr && result->HasWriter();
+            {
+                std::lock_guard<std::mutex> write_lock(connection->write_mutex);
+                result->Dump(connection->communicator, request.header.request_id,
+                             connection->compressor.get(), bulk);
+            }
+            if (bulk) result->DumpOutput(bulk_lane.get());
+        } catch (const std::exception &e) {
+            // a result written in part can't be told from the next one: the connection is over
+            LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: " << e.what());
+            int fd = connection->communicator->GetFileDescriptor();
+            if (fd >= 0) shutdown(fd, SHUT_RDWR);
+        }
+        LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "]: Request "
+                                            << request.header.request_id << " returned "
+                                            << result->GetExitCode() << ".");
+        lock.lock();
+    }
+    // another session may run on this thread next
+    SaveThreadState(session.states);
+    session.running = false;
+    if (session.ended) connection->sessions.erase(session.id);
+}
+
+Reactor::Task Process::RunSession(std::shared_ptr<Connection> connection, Session *session) {
+    co_await Reactor::ShutdownOnError(connection->communicator->GetFileDescriptor());
+    RunRequests(connection, *session);
+    co_return;
+}
+
+Reactor::Task Process::Serve(Communicator *client_comm) {
+    auto connection = std::make_shared<Connection>(client_comm);
+    connection->concurrent = client_comm->IsFullDuplex();
+    return Serve(connection, false);
+}
+
+Reactor::Task Process::Serve(std::shared_ptr<Connection> connection, bool connected) {
+    Communicator *client_comm = connection->communicator;
+    int fd = client_comm->GetFileDescriptor();
+    co_await Reactor::ShutdownOnError(fd);
+
+    try {
+        while (true) {
+            // the routines are executed on the workers, waiting for a request on the reactor
+            if (!client_comm->HasPendingInput() && !Reactor::IsReadable(fd))
+                co_await mpReactor->WaitReadable(fd);
+            if (!connected) {
+                if (!Handshake(connection)) break;
+                connected = true;
+            } else {
+                Served served = ServeRequest(connection);
+                if (served == Served::CLOSED) break;
+                // resumed by the session once the routine has read the transfer
+                if (served == Served::HANDED_OVER) co_return;
+            }
+        }
+    } catch (const std::exception &e) {
+        LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: " << e.what());
+    }
+    // the sessions still running release the connection when they are done
+    Notify("process-ended");
+}
+
+void Process::SaveThreadState(std::vector<std::shared_ptr<void>> &states) {
+    for (size_t i = 0; i < _handlers.size(); i++)
+        _handlers[i]->obj_ptr()->SaveThreadState(states[i]);
+}
+
+void Process::RestoreThreadState(const std::vector<std::shared_ptr<void>> &states) {
+    for (size_t i = 0; i < _handlers.size(); i++)
+        _handlers[i]->obj_ptr()->RestoreThreadState(states[i]);
+}
+
+void Process::RestoreClientState(Client &client) {
+    std::lock_guard<std::mutex> lock(client.mutex);
+    client.states.resize(_handlers.size());
+    for (size_t i = 0; i < _handlers.size(); i++)
+        _handlers[i]->obj_ptr()->RestoreClientState(client.states[i]);
+}
+
+std::shared_ptr<Result> Process::Execute(uint32_t routine_id,
+                                         std::shared_ptr<Buffer> input_buffer) {
+    if (routine_id >= mRoutines.size()) {
+        LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: Requested unknown routine id "
+                                            << routine_id << ".");
+        return std::make_shared<Result>(-1, std::make_shared<Buffer>());
+    }
+    LOG4CPLUS_DEBUG(logger, "Received routine " << mRoutines[routine_id]);
+
+    const Routine &routine = mDispatchTable[routine_id];
+    // what the other plugins deferred comes before the routine
+    for (Handler *handler : mDeferringHandlers)
+        if (handler != routine.handler) handler->Flush();
+    // esegue la routine e salva il risultato in result
+    auto start = steady_clock::now();
+    std::shared_ptr<Result> result;
+    try {
+        result = routine.handler->Execute(routine.id, input_buffer);
+    } catch (const std::exception &e) {
+        // e.g. a short input buffer: the routine fails, not the session
+        LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: Routine '" << mRoutines[routine_id]
+                                            << "' threw: " << e.what());
+    }
+    if (result == nullptr) {
+        LOG4CPLUS_ERROR(logger, "[Process " << getpid() << "]: Routine '" << mRoutines[routine_id]
+                                            << "' failed.");
+        result = std::make_shared<Result>(-1, std::make_shared<Buffer>());
+    }
+    result->TimeTaken(
+        std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - start).count() /
+        1000.0);
+    return result;
+}
+
+std::shared_ptr<Result> Process::ExecuteBatch(std::shared_ptr<Buffer> batch_buffer) {
+    auto exit_codes = std::make_shared<Buffer>();
+    int exit_code = 0;
+    double time_taken = 0;
+    size_t count = 0;
+
+    uint32_t routine_id;
+    std::shared_ptr<Buffer> input_buffer;
+    while (Batch::Next(batch_buffer.get(), routine_id, input_buffer)) {
+        auto result = Execute(routine_id, input_buffer);
+        // the routines of a batch have no output parameters: only the exit codes are returned
+        exit_codes->Add(result->GetExitCode());
+        if (exit_code == 0) exit_code = result->GetExitCode();
+        time_taken += result->TimeTaken();
+        count++;
+    }
+    LOG4CPLUS_DEBUG(logger, "[Process " << getpid() << "]: Executed a batch of " << count
+                                        << " routine(s).");
+
+    auto result = std::make_shared<Result>(exit_code, exit_codes);
+    result->TimeTaken(time_taken);
+    return result;
 }
 
 Process::~Process() {
+    mpReactor.reset();
     _communicator.reset();
     _handlers.clear();
     mPlugins.clear();
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+#include <gvirtus/backend/Reactor.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "log4cplus/logger.h"
+#include "log4cplus/loggingmacros.h"
+
+using gvirtus::backend::Reactor;
+
+Reactor::Reactor(size_t workers) {
+    if ((mEpollFd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+        throw std::runtime_error("Reactor: Can't create epoll: " + std::string(strerror(errno)));
+    if ((mWakeFd = eventfd(0, EFD_CLOEXEC)) < 0)
+        throw std::runtime_error("Reactor: Can't create eventfd: " + std::string(strerror(errno)));
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeFd, &event);
+
+    mPoller = std::thread(&Reactor::Poll, this);
+    for (size_t i = 0; i < workers; i++) mWorkers.emplace_back(&Reactor::Work, this);
+}
+
+Reactor::~Reactor() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    uint64_t one = 1;
+    if (write(mWakeFd, &one, sizeof(one)) == sizeof(one))
+        mPoller.join();
+    else
+        mPoller.detach();
+    mReady.notify_all();
+    // the suspended connections are abandoned
+    for (auto &worker : mWorkers) worker.join();
+    close(mWakeFd);
+    close(mEpollFd);
+}
+
+void Reactor::Start(Task task) { Schedule(task.handle); }
+
+void Reactor::Task::promise_type::unhandled_exception() {
+    auto logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("Reactor"));
+    try {
+        throw;
+    } catch (const std::exception &e) {
+        LOG4CPLUS_ERROR(logger, "Connection " << fd << " failed: " << e.what());
+    } catch (...) {
+        LOG4CPLUS_ERROR(logger, "Connection " << fd << " failed");
+    }
+    if (fd >= 0) shutdown(fd, SHUT_RDWR);
+}
+
+void Reactor::ReadableAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    // one shot: the coroutine is scheduled once, then the fd is armed again by the next wait
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.ptr = handle.address();
+    if (epoll_ctl(reactor->mEpollFd, EPOLL_CTL_MOD, fd, &event) != 0 &&
+        (errno != ENOENT || epoll_ctl(reactor->mEpollFd, EPOLL_CTL_ADD, fd, &event) != 0)) {
+        // not pollable: serve it anyway, the next Read() reports the problem
+        reactor->Schedule(handle);
+    }
+}
+
+bool Reactor::IsReadable(int fd) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    return poll(&pfd, 1, 0) > 0;
+}
+
+void Reactor::Schedule(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueue.push_back(handle);
+    }
+    mReady.notify_one();
+}
+
+void Reactor::Poll() {
+    struct epoll_event events[64];
+    while (true) {
+        int count = epoll_wait(mEpollFd, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.ptr == nullptr) return;
+            Schedule(std::coroutine_handle<>::from_address(events[i].data.ptr));
+        }
+    }
+}
+
+void Reactor::Work() {
+    while (true) {
+        std::coroutine_handle<> handle;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mReady.wait(lock, [this]() { return mStopping || !mQueue.empty(); });
+            if (mStopping) return;
+            handle = mQueue.front();
+            mQueue.pop_front();
+        }
+        handle.resume();
+    }
+}
@@ -0,0 +1,172 @@
+#include "gvirtus/common/Sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA256_X86
+#endif
+
+using gvirtus::common::Sha256;
+
+namespace {
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2};
+
+inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+void transformGeneric(uint32_t *state, const uint8_t *block, size_t blocks) {
+    for (; blocks > 0; blocks--, block += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++)
+            w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+                   (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) +
+                          K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef SHA256_X86
+/* with the SHA extensions of x86, about 8 times faster: fat binaries run to hundreds of MB */
+__attribute__((target("sha,sse4.1"))) void transformShaNi(uint32_t *state, const uint8_t *block,
+                                                          size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xb1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);       // CDGH
+
+    for (; blocks > 0; blocks--, block += 64) {
+        __m128i abef = state0, cdgh = state1;
+        __m128i w[4];
+#pragma GCC unroll 16
+        for (int i = 0; i < 16; i++) {
+            __m128i &current = w[i % 4], &previous = w[(i + 3) % 4], &next = w[(i + 1) % 4];
+            if (i < 4)
+                current =
+                    _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(block + 16 * i)), mask);
+            __m128i message = _mm_add_epi32(current, _mm_loadu_si128((const __m128i *)&K[4 * i]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+            if (i >= 3 && i <= 14) {
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, previous, 4));
+                next = _mm_sha256msg2_epu32(next, current);
+            }
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+            if (i >= 1 && i <= 12) previous = _mm_sha256msg1_epu32(previous, current);
+        }
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);                                       // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1);                                    // DCHG
+    _mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(tmp, state1, 0xf0));  // DCBA
+    _mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(state1, tmp, 8));     // HGFE
+}
+
+bool hasShaNi() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1) || !(ecx & bit_SSSE3))
+        return false;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA);
+}
+
+void (*const transform)(uint32_t *, const uint8_t *, size_t) =
+    hasShaNi() ? transformShaNi : transformGeneric;
+#else
+void (*const transform)(uint32_t *, const uint8_t *, size_t) = transformGeneric;
+#endif
+}  // namespace
+
+Sha256::Sha256()
+    : mState{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab,
+             0x5be0cd19} {}
+
+void Sha256::Update(const void *data, size_t size) {
+    auto bytes = (const uint8_t *)data;
+    mSize += size;
+    if (mBlockSize > 0) {
+        size_t n = std::min(size, sizeof(mBlock) - mBlockSize);
+        memcpy(mBlock + mBlockSize, bytes, n);
+        mBlockSize += n;
+        bytes += n;
+        size -= n;
+        if (mBlockSize < sizeof(mBlock)) return;
+        transform(mState, mBlock, 1);
+        mBlockSize = 0;
+    }
+    // whole blocks are hashed where they are
+    size_t blocks = size / sizeof(mBlock);
+    transform(mState, bytes, blocks);
+    bytes += blocks * sizeof(mBlock);
+    size -= blocks * sizeof(mBlock);
+    memcpy(mBlock, bytes, size);
+    mBlockSize = size;
+}
+
+Sha256::Digest Sha256::Final() {
+    uint64_t bits = mSize * 8;
+    uint8_t padding[72] = {0x80};
+    size_t padding_size = (mBlockSize < 56 ? 56 : 120) - mBlockSize;
+    for (int i = 0; i < 8; i++) padding[padding_size + i] = bits >> (56 - 8 * i);
+    Update(padding, padding_size + 8);
+
+    Digest digest;
+    for (int i = 0; i < 8; i++)
+        for (int j = 0; j < 4; j++) digest[4 * i + j] = mState[i] >> (24 - 8 * j);
+    return digest;
+}
+
+std::string Sha256::Hex(const Digest &digest) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (uint8_t byte : digest) {
+        hex += digits[byte >> 4];
+        hex += digits[byte & 0xf];
+    }
+    return hex;
+}
+
+std::string Sha256::Hex(const void *data, size_t size) {
+    Sha256 sha;
+    sha.Update(data, size);
+    return Hex(sha.Final());
+}
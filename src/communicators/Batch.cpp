@@ -0,0 +1,53 @@
+#include "gvirtus/communicators/Batch.h"
+
+using gvirtus::communicators::Batch;
+using gvirtus::communicators::Buffer;
+using std::chrono::steady_clock;
+
+Batch::Batch() {
+    mpBuffer = std::make_shared<Buffer>();
+    mCount = 0;
+}
+
+void Batch::Add(uint32_t routine_id, const Buffer *input_buffer) {
+    if (mCount == 0) mStart = steady_clock::now();
+    mpBuffer->Reserve(sizeof(uint32_t) + 2 * sizeof(size_t) + input_buffer->GetBufferSize());
+    mpBuffer->Add(routine_id);
+    // the length is repeated because Assign() discards the one stored by Add()
+    mpBuffer->Add(input_buffer->GetBufferSize());
+    if (!input_buffer->HasExternalSegments()) {
+        mpBuffer->Add(input_buffer->GetBuffer(), input_buffer->GetBufferSize());
+    } else {
+        // the batch outlives the call, so the external segments are copied
+        std::vector<struct iovec> iov;
+        input_buffer->GetSegments(iov);
+        std::unique_ptr<char[]> data(new char[input_buffer->GetBufferSize()]);
+        size_t offset = 0;
+        for (auto &segment : iov) {
+            memcpy(data.get() + offset, segment.iov_base, segment.iov_len);
+            offset += segment.iov_len;
+        }
+        mpBuffer->Add(data.get(), offset);
+    }
+    mCount++;
+}
+
+bool Batch::Next(Buffer *batch_buffer, uint32_t &routine_id,
+                 std::shared_ptr<Buffer> &input_buffer) {
+    if (batch_buffer->Empty()) return false;
+    routine_id = batch_buffer->Get<uint32_t>();
+    size_t size = batch_buffer->Get<size_t>();
+    char *data = batch_buffer->Assign<char>(size);
+    input_buffer = std::make_shared<Buffer>(data, size);
+    return true;
+}
+
+void Batch::Reset() {
+    mpBuffer->Reset();
+    mCount = 0;
+}
+
+std::chrono::microseconds Batch::GetAge() const {
+    if (mCount == 0) return std::chrono::microseconds(0);
+    return std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now() - mStart);
+}
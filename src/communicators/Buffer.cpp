@@ -35,19 +35,20 @@
 // #define DEBUG
 #include "gvirtus/communicators/Buffer.h"
 
+#include "gvirtus/communicators/MemoryPool.h"
+
 using namespace std;
 using gvirtus::communicators::Buffer;
+using gvirtus::communicators::MemoryPool;
 
 Buffer::Buffer(size_t initial_size, size_t block_size) {
     mSize = initial_size;
     mBlockSize = block_size;
     mLength = 0;
     mOffset = 0;
-    mpBuffer = NULL;
     mOwnBuffer = true;
-    if (mSize == 0) mSize = 0;
-    if ((mSize = (mSize / mBlockSize) * mBlockSize) == 0) mSize = mBlockSize;
-    if ((mpBuffer = (char *)malloc(mSize)) == NULL) throw runtime_error("Can't allocate memory.");
+    if ((mSize = ((mSize + mBlockSize - 1) / mBlockSize) * mBlockSize) == 0) mSize = mBlockSize;
+    mpBuffer = (char *)MemoryPool::Allocate(mSize);
     mBackOffset = mLength;
 }
 
@@ -58,9 +59,11 @@ Buffer::Buffer(const Buffer &orig) {
     mOffset = orig.mOffset;
     mLength = orig.mLength;
     mOwnBuffer = true;
-    if ((mpBuffer = (char *)malloc(mSize)) == NULL) throw runtime_error("Can't allocate memory.");
+    mpBuffer = (char *)MemoryPool::Allocate(mSize);
     memmove(mpBuffer, orig.mpBuffer, mLength);
     mBackOffset = mLength;
+    mSegments = orig.mSegments;
+    mExternalLength = orig.mExternalLength;
 }
 
 Buffer::Buffer(istream &in) {
@@ -69,8 +72,8 @@ Buffer::Buffer(istream &in) {
     mLength = mSize;
     mOffset = 0;
     mOwnBuffer = true;
-    if ((mpBuffer = (char *)malloc(mSize)) == NULL) throw runtime_error("Can't allocate memory.");
-    in.read(mpBuffer, mSize);
+    mpBuffer = (char *)MemoryPool::Allocate(mSize);
+    in.read(mpBuffer, mLength);
     mBackOffset = mLength;
 }
 
@@ -85,34 +88,89 @@ Buffer::Buffer(char *buffer, size_t buffer_size, size_t block_size) {
 }
 
 Buffer::~Buffer() {
-    if (mOwnBuffer) free(mpBuffer);
+    if (mOwnBuffer) MemoryPool::Release(mpBuffer, mSize);
+}
+
+void Buffer::Grow(size_t required) {
+    size_t size = max(required + 1, mSize * 2);
+    size = (size + mBlockSize - 1) / mBlockSize * mBlockSize;
+    char *buffer;
+    try {
+        buffer = (char *)MemoryPool::Allocate(size);
+    } catch (bad_alloc &) {
+        throw runtime_error("Buffer: Can't reallocate memory.");
+    }
+    memcpy(buffer, mpBuffer, mLength);
+    if (mOwnBuffer) MemoryPool::Release(mpBuffer, mSize);
+    mpBuffer = buffer;
+    mSize = size;
+    mOwnBuffer = true;
+}
+
+void Buffer::Reserve(size_t n) {
+    if (mLength + n >= mSize) Grow(mLength + n);
+}
+
+char *Buffer::Extend(size_t n) {
+    Reserve(n);
+    char *data = mpBuffer + mLength;
+    mLength += n;
+    mBackOffset = mLength;
+    return data;
 }
 
 void Buffer::Reset() {
     mLength = 0;
     mOffset = 0;
     mBackOffset = 0;
+    mSegments.clear();
+    mExternalLength = 0;
+    mpTransfer = nullptr;
 }
 
 void Buffer::Reset(Communicator *c) {
-    c->Read((char *)&mLength, sizeof(size_t));
+    mSegments.clear();
+    mExternalLength = 0;
+    mpTransfer = nullptr;
+    size_t length;
+    c->Read((char *)&length, sizeof(size_t));
 #ifdef DEBUG
-    cout << "Read " << mLength << " bytes from the buffer" << endl;
+    cout << "Read " << length << " bytes from the buffer" << endl;
 #endif
+    // the old content is not kept
+    mLength = 0;
+    if (length >= mSize) Grow(length);
+    mLength = length;
     mOffset = 0;
     mBackOffset = mLength;
-    if (mLength >= mSize) {
-        mSize = (mLength / mBlockSize + 1) * mBlockSize;
-        if ((mpBuffer = (char *)realloc(mpBuffer, mSize)) == NULL)
-            throw runtime_error("Can't reallocate memory.");
-    }
 
     c->Read(mpBuffer, mLength);
 }
 
 const char *const Buffer::GetBuffer() const { return mpBuffer; }
 
-size_t Buffer::GetBufferSize() const { return mLength; }
+size_t Buffer::GetBufferSize() const { return mLength + mExternalLength; }
+
+void Buffer::GetSegments(std::vector<struct iovec> &iov) const {
+    size_t offset = 0;
+    for (auto &segment : mSegments) {
+        if (segment.offset > offset)
+            iov.push_back({mpBuffer + offset, segment.offset - offset});
+        iov.push_back({(void *)segment.data, segment.size});
+        offset = segment.offset;
+    }
+    if (mLength > offset) iov.push_back({mpBuffer + offset, mLength - offset});
+}
+
+void Buffer::WriteTo(Communicator *c) const {
+    if (mSegments.empty()) {
+        c->Write(mpBuffer, mLength);
+        return;
+    }
+    std::vector<struct iovec> iov;
+    GetSegments(iov);
+    c->Writev(iov.data(), iov.size());
+}
 
 void Buffer::Dump(Communicator *c) const {
     /**
@@ -121,8 +179,9 @@ void Buffer::Dump(Communicator *c) const {
      *  scrivi
      *  md->write(communicator out, tid, mpBuffer, mLenght);
      */
-    c->Write((char *)&mLength, sizeof(size_t));
-    c->Write(mpBuffer, mLength);
+    size_t length = GetBufferSize();
+    c->Write((char *)&length, sizeof(size_t));
+    WriteTo(c);
     c->Sync();
 
     /**
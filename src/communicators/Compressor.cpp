@@ -0,0 +1,346 @@
+#include "gvirtus/communicators/Compressor.h"
+
+#include <lz4.h>
+#ifdef GVIRTUS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <strings.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using gvirtus::communicators::Communicator;
+using gvirtus::communicators::CompressedBlock;
+using gvirtus::communicators::Compressor;
+using std::chrono::steady_clock;
+
+#define DEFAULT_COMPRESSION_THRESHOLD (64 * 1024)
+#define DEFAULT_COMPRESSION_MAX_RATIO 0.9
+/* bytes of a block compressed by ChooseShuffle() for each candidate */
+#define SHUFFLE_SAMPLE_SIZE (32 * 1024)
+/* one large payload in PROBE_INTERVAL is sent the other way, see Compressor */
+#define PROBE_INTERVAL 16
+/* smaller payloads mostly end up in the socket buffers: their time says nothing of the link */
+#define BANDWIDTH_SAMPLE_MIN_SIZE (1024 * 1024)
+#define ZSTD_LEVEL 1
+
+namespace {
+size_t getEnvSize(const char *key, size_t default_value) {
+    const char *value = getenv(key);
+    if (value == nullptr || *value == '\0') return default_value;
+    return strtoull(value, NULL, 10);
+}
+
+double getEnvDouble(const char *key, double default_value) {
+    const char *value = getenv(key);
+    if (value == nullptr || *value == '\0') return default_value;
+    return strtod(value, NULL);
+}
+
+double Average(double average, double sample) {
+    return average == 0 ? sample : 0.75 * average + 0.25 * sample;
+}
+
+template <unsigned element>
+void ShuffleElements(const char *src, char *dst, size_t count) {
+    for (unsigned b = 0; b < element; b++)
+        for (size_t i = 0; i < count; i++) dst[b * count + i] = src[i * element + b];
+}
+
+template <unsigned element>
+void UnshuffleElements(const char *src, char *dst, size_t count) {
+    for (unsigned b = 0; b < element; b++)
+        for (size_t i = 0; i < count; i++) dst[i * element + b] = src[b * count + i];
+}
+
+/* see CompressedBlock */
+void Shuffle(const char *src, char *dst, size_t size, unsigned element, bool reverse) {
+    size_t count = size / element;
+    switch (element) {
+        case 2:
+            reverse ? UnshuffleElements<2>(src, dst, count) : ShuffleElements<2>(src, dst, count);
+            break;
+        case 4:
+            reverse ? UnshuffleElements<4>(src, dst, count) : ShuffleElements<4>(src, dst, count);
+            break;
+        case 8:
+            reverse ? UnshuffleElements<8>(src, dst, count) : ShuffleElements<8>(src, dst, count);
+            break;
+        default:
+            throw std::runtime_error("Compressor: Unsupported shuffle " + std::to_string(element));
+    }
+    memcpy(dst + count * element, src + count * element, size - count * element);
+}
+
+/* position in a list of iovec */
+struct Cursor {
+    const struct iovec *iov;
+    int iovcnt;
+    int piece = 0;
+    size_t offset = 0;
+
+    /**
+     * @return where the next size bytes are, nullptr if they are not contiguous.
+     */
+    char *Contiguous(size_t size) {
+        while (piece < iovcnt && offset == iov[piece].iov_len) {
+            piece++;
+            offset = 0;
+        }
+        if (piece == iovcnt || iov[piece].iov_len - offset < size) return nullptr;
+        return (char *)iov[piece].iov_base + offset;
+    }
+
+    void Skip(size_t size) { Copy(nullptr, nullptr, size); }
+
+    /* copies the next size bytes to dst, or from src to them */
+    void Copy(char *dst, const char *src, size_t size) {
+        while (size > 0) {
+            if (piece == iovcnt) throw std::runtime_error("Compressor: Payload overflow");
+            size_t n = std::min(size, iov[piece].iov_len - offset);
+            char *base = (char *)iov[piece].iov_base + offset;
+            if (dst != nullptr) memcpy(dst, base, n), dst += n;
+            if (src != nullptr) memcpy(base, src, n), src += n;
+            size -= n;
+            offset += n;
+            if (offset == iov[piece].iov_len) {
+                piece++;
+                offset = 0;
+            }
+        }
+    }
+};
+
+void ReadFully(Communicator *c, char *buffer, size_t size) {
+    if (c->Read(buffer, size) != size)
+        throw std::runtime_error("Compressor: Connection closed while reading a payload");
+}
+}  // namespace
+
+Compressor::Compressor(uint8_t codec) : mCodec(codec) {
+    mThreshold = std::max<size_t>(
+        getEnvSize("GVIRTUS_COMPRESSION_THRESHOLD", DEFAULT_COMPRESSION_THRESHOLD), 1);
+    mMaxRatio = getEnvDouble("GVIRTUS_COMPRESSION_MAX_RATIO", DEFAULT_COMPRESSION_MAX_RATIO);
+
+    // 0 is "auto", a shuffle of 1 byte elements is no shuffle
+    mShuffle = 0;
+    const char *shuffle = getenv("GVIRTUS_COMPRESSION_SHUFFLE");
+    if (shuffle != nullptr && *shuffle != '\0' && strcasecmp(shuffle, "auto") != 0) {
+        mShuffle = std::max(1ul, strtoul(shuffle, NULL, 10));
+        if (mShuffle != 1 && mShuffle != 2 && mShuffle != 4 && mShuffle != 8) mShuffle = 0;
+    }
+
+    double bandwidth = getEnvDouble("GVIRTUS_LINK_BANDWIDTH", 0);
+    if (bandwidth > 0) {
+        mLinkBandwidth = bandwidth * 1e6;
+        mFixedLinkBandwidth = true;
+    }
+
+    size_t bound = LZ4_compressBound(GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE);
+#ifdef GVIRTUS_HAVE_ZSTD
+    bound = std::max(bound, ZSTD_compressBound(GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE));
+    if (mCodec == COMPRESSION_ZSTD) mpZstdCompress = ZSTD_createCCtx();
+#endif
+    mGather.resize(GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE);
+    mShuffled.resize(GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE);
+    mStaging.resize(bound);
+}
+
+Compressor::~Compressor() {
+#ifdef GVIRTUS_HAVE_ZSTD
+    ZSTD_freeCCtx((ZSTD_CCtx *)mpZstdCompress);
+    ZSTD_freeDCtx((ZSTD_DCtx *)mpZstdDecompress);
+#endif
+}
+
+uint64_t Compressor::GetCapabilities() {
+#ifdef GVIRTUS_HAVE_ZSTD
+    return CAPABILITY_COMPRESSION_LZ4 | CAPABILITY_COMPRESSION_ZSTD;
+#else
+    return CAPABILITY_COMPRESSION_LZ4;
+#endif
+}
+
+std::unique_ptr<Compressor> Compressor::Create(uint64_t capabilities) {
+    capabilities &= GetCapabilities();
+    if (capabilities & CAPABILITY_COMPRESSION_ZSTD)
+        return std::make_unique<Compressor>(COMPRESSION_ZSTD);
+    if (capabilities & CAPABILITY_COMPRESSION_LZ4)
+        return std::make_unique<Compressor>(COMPRESSION_LZ4);
+    return nullptr;
+}
+
+bool Compressor::Pays() const {
+    if (mRatio > mMaxRatio) return false;
+    // the blocks are compressed while the previous ones are on the wire, so a payload takes as
+    // long as the slower of the two: compressing pays when it is faster than the link
+    return mThroughput == 0 || mLinkBandwidth == 0 || mThroughput > mLinkBandwidth;
+}
+
+bool Compressor::ShouldCompress(size_t size) {
+    if (size < mThreshold) return false;
+    bool compress = Pays();
+    // now and then the other way round, for keeping the estimates current
+    if (++mMessages % PROBE_INTERVAL == 0 && !(compress && mFixedLinkBandwidth))
+        compress = !compress;
+    return compress;
+}
+
+size_t Compressor::Encode(const char *src, size_t size, char *dst, size_t capacity) {
+#ifdef GVIRTUS_HAVE_ZSTD
+    if (mCodec == COMPRESSION_ZSTD) {
+        size_t n = ZSTD_compressCCtx((ZSTD_CCtx *)mpZstdCompress, dst, capacity, src, size,
+                                     ZSTD_LEVEL);
+        return ZSTD_isError(n) ? 0 : n;
+    }
+#endif
+    return LZ4_compress_default(src, dst, (int)size, (int)capacity);
+}
+
+void Compressor::Decode(uint8_t codec, const char *src, size_t stored_size, char *dst,
+                        size_t size) {
+    if (codec == COMPRESSION_LZ4) {
+        if (LZ4_decompress_safe(src, dst, (int)stored_size, (int)size) != (int)size)
+            throw std::runtime_error("Compressor: LZ4 decompression failed");
+        return;
+    }
+#ifdef GVIRTUS_HAVE_ZSTD
+    if (codec == COMPRESSION_ZSTD) {
+        if (mpZstdDecompress == nullptr) mpZstdDecompress = ZSTD_createDCtx();
+        size_t n = ZSTD_decompressDCtx((ZSTD_DCtx *)mpZstdDecompress, dst, size, src, stored_size);
+        if (ZSTD_isError(n) || n != size)
+            throw std::runtime_error("Compressor: zstd decompression failed");
+        return;
+    }
+#endif
+    throw std::runtime_error("Compressor: Unsupported codec " + std::to_string(codec));
+}
+
+CompressedBlock Compressor::CompressBlock(const char *src, size_t size, unsigned shuffle) {
+    const char *data = src;
+    if (shuffle > 1) {
+        Shuffle(src, mShuffled.data(), size, shuffle, false);
+        data = mShuffled.data();
+    }
+    CompressedBlock block = {};
+    block.size = size;
+    size_t stored_size = Encode(data, size, mStaging.data(), mStaging.size());
+    if (stored_size == 0 || stored_size > size * mMaxRatio) {
+        // not worth it: stored as it is
+        block.stored_size = size;
+        block.codec = COMPRESSION_NONE;
+    } else {
+        block.stored_size = stored_size;
+        block.codec = mCodec;
+        block.shuffle = shuffle > 1 ? shuffle : 0;
+    }
+    return block;
+}
+
+unsigned Compressor::ChooseShuffle(const char *src, size_t size) {
+    size = std::min<size_t>(size, SHUFFLE_SAMPLE_SIZE);
+    unsigned best = 1;
+    size_t best_size = SIZE_MAX;
+    for (unsigned shuffle : {1, 2, 4}) {
+        const char *data = src;
+        if (shuffle > 1) {
+            Shuffle(src, mShuffled.data(), size, shuffle, false);
+            data = mShuffled.data();
+        }
+        size_t stored_size = Encode(data, size, mStaging.data(), mStaging.size());
+        if (stored_size != 0 && stored_size < best_size) {
+            best = shuffle;
+            best_size = stored_size;
+        }
+    }
+    return best;
+}
+
+void Compressor::Write(Communicator *c, const Buffer *payload, bool compressed) {
+    size_t size = payload->GetBufferSize();
+    if (!compressed) {
+        auto start = steady_clock::now();
+        if (size > 0) payload->WriteTo(c);
+        c->Sync();
+        std::chrono::duration<double> elapsed = steady_clock::now() - start;
+        if (!mFixedLinkBandwidth && size >= BANDWIDTH_SAMPLE_MIN_SIZE && elapsed.count() > 0)
+            mLinkBandwidth = Average(mLinkBandwidth, size / elapsed.count());
+        return;
+    }
+
+    std::vector<struct iovec> iov;
+    payload->GetSegments(iov);
+    Cursor cursor = {iov.data(), (int)iov.size()};
+    std::chrono::duration<double> compressing(0);
+    size_t written = 0;
+    for (size_t offset = 0; offset < size;) {
+        size_t block_size = std::min<size_t>(size - offset, GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE);
+        // a block within a segment is compressed where it is, otherwise it is gathered first
+        const char *src = cursor.Contiguous(block_size);
+        if (src != nullptr) {
+            cursor.Skip(block_size);
+        } else {
+            cursor.Copy(mGather.data(), nullptr, block_size);
+            src = mGather.data();
+        }
+
+        auto start = steady_clock::now();
+        unsigned shuffle = mShuffle;
+        if (shuffle == 0) {
+            if (offset == 0 && (mAutoShuffle == 0 || mCompressedMessages % PROBE_INTERVAL == 0))
+                mAutoShuffle = ChooseShuffle(src, block_size);
+            shuffle = mAutoShuffle;
+        }
+        CompressedBlock block = CompressBlock(src, block_size, shuffle);
+        compressing += steady_clock::now() - start;
+
+        c->Write((char *)&block, sizeof(block));
+        c->Write(block.codec == COMPRESSION_NONE ? src : mStaging.data(), block.stored_size);
+        written += sizeof(block) + block.stored_size;
+        offset += block_size;
+    }
+    c->Sync();
+
+    mCompressedMessages++;
+    mCompressedBytes += size;
+    mWrittenBytes += written;
+    mRatio = Average(mRatio, (double)written / size);
+    if (compressing.count() > 0) mThroughput = Average(mThroughput, size / compressing.count());
+}
+
+void Compressor::Read(Communicator *c, size_t size, const struct iovec *iov, int iovcnt) {
+    Cursor cursor = {iov, iovcnt};
+    for (size_t offset = 0; offset < size;) {
+        CompressedBlock block;
+        ReadFully(c, (char *)&block, sizeof(block));
+        if (block.size == 0 || block.size > size - offset ||
+            block.size > GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE || block.stored_size > mStaging.size() ||
+            (block.codec == COMPRESSION_NONE && block.stored_size != block.size))
+            throw std::runtime_error("Compressor: Invalid compressed block");
+
+        // decoded straight into the destination when it is contiguous, otherwise scattered
+        char *dst = cursor.Contiguous(block.size);
+        if (block.codec == COMPRESSION_NONE) {
+            ReadFully(c, dst != nullptr ? dst : mGather.data(), block.size);
+        } else {
+            ReadFully(c, mStaging.data(), block.stored_size);
+            bool shuffled = block.shuffle > 1;
+            Decode(block.codec, mStaging.data(), block.stored_size,
+                   dst != nullptr && !shuffled ? dst : mGather.data(), block.size);
+            if (shuffled) {
+                Shuffle(mGather.data(), dst != nullptr ? dst : mShuffled.data(), block.size,
+                        block.shuffle, true);
+                if (dst == nullptr) std::swap(mGather, mShuffled);
+            }
+        }
+        if (dst != nullptr)
+            cursor.Skip(block.size);
+        else
+            cursor.Copy(nullptr, mGather.data(), block.size);
+        offset += block.size;
+    }
+}
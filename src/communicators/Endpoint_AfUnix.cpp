@@ -0,0 +1,69 @@
+#include "gvirtus/communicators/Endpoint_AfUnix.h"
+
+#include <sys/un.h>
+
+#include "gvirtus/communicators/EndpointFactory.h"
+
+using gvirtus::communicators::Endpoint;
+using gvirtus::communicators::Endpoint_AfUnix;
+using gvirtus::communicators::EndpointFactory;
+
+Endpoint_AfUnix::Endpoint_AfUnix(const std::string &endp_suite, const std::string &endp_protocol,
+                                 const std::string &endp_path, mode_t endp_mode,
+                                 size_t endp_bulk_size) {
+    suite(endp_suite);
+    protocol(endp_protocol);
+    path(endp_path);
+    mode(endp_mode);
+    bulk_size(endp_bulk_size);
+}
+
+Endpoint_AfUnix Endpoint_AfUnix::for_tcp_port(std::uint16_t port) {
+    return Endpoint_AfUnix("unix", "unix", "@gvirtus-tcp-" + std::to_string(port));
+}
+
+Endpoint &Endpoint_AfUnix::suite(const std::string &suite) {
+    if (suite == "unix") _suite = suite;
+
+    return *this;
+}
+
+Endpoint &Endpoint_AfUnix::protocol(const std::string &protocol) {
+    if (protocol == "unix") _protocol = protocol;
+
+    return *this;
+}
+
+Endpoint_AfUnix &Endpoint_AfUnix::path(const std::string &path) {
+    // sun_path has room for the terminator, or for the leading NUL of an abstract name
+    if (path.size() > 1 && path.size() < sizeof(sockaddr_un::sun_path)) _path = path;
+
+    return *this;
+}
+
+Endpoint_AfUnix &Endpoint_AfUnix::mode(mode_t mode) {
+    _mode = mode & 0777;
+
+    return *this;
+}
+
+Endpoint_AfUnix &Endpoint_AfUnix::bulk_size(size_t bulk_size) {
+    _bulk_size = bulk_size;
+
+    return *this;
+}
+
+void gvirtus::communicators::from_json(const nlohmann::json &j, Endpoint_AfUnix &end) {
+    auto el = j["communicator"][EndpointFactory::index()]["endpoint"];
+
+    end.suite(el.at("suite"));
+    end.protocol(el.at("protocol"));
+    if (el.contains("path")) end.path(el.at("path"));
+    if (el.contains("mode"))
+        end.mode(el.at("mode").is_string() ? std::stoul(el.at("mode").get<std::string>(), NULL, 8)
+                                           : el.at("mode").get<mode_t>());
+    if (el.contains("bulk_size"))
+        end.bulk_size(el.at("bulk_size").is_string()
+                          ? std::stoull(el.at("bulk_size").get<std::string>())
+                          : el.at("bulk_size").get<size_t>());
+}
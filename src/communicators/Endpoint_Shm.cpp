@@ -0,0 +1,63 @@
+#include "gvirtus/communicators/Endpoint_Shm.h"
+
+#include <regex>
+
+#include "gvirtus/communicators/EndpointFactory.h"
+
+using gvirtus::communicators::Endpoint;
+using gvirtus::communicators::Endpoint_Shm;
+using gvirtus::communicators::EndpointFactory;
+
+Endpoint_Shm::Endpoint_Shm(const std::string &endp_suite, const std::string &endp_protocol,
+                           const std::string &endp_name, size_t endp_size, bool endp_hugepages) {
+    suite(endp_suite);
+    protocol(endp_protocol);
+    name(endp_name);
+    size(endp_size);
+    hugepages(endp_hugepages);
+}
+
+Endpoint &Endpoint_Shm::suite(const std::string &suite) {
+    if (suite == "shm") _suite = suite;
+
+    return *this;
+}
+
+Endpoint &Endpoint_Shm::protocol(const std::string &protocol) {
+    if (protocol == "shm") _protocol = protocol;
+
+    return *this;
+}
+
+Endpoint_Shm &Endpoint_Shm::name(const std::string &name) {
+    std::regex pattern{R"([[:alnum:]_.-]+)"};
+
+    if (std::regex_match(name, pattern)) _name = name;
+
+    return *this;
+}
+
+Endpoint_Shm &Endpoint_Shm::size(size_t size) {
+    if (size > 0) _size = size;
+
+    return *this;
+}
+
+Endpoint_Shm &Endpoint_Shm::hugepages(bool hugepages) {
+    _hugepages = hugepages;
+
+    return *this;
+}
+
+void gvirtus::communicators::from_json(const nlohmann::json &j, Endpoint_Shm &end) {
+    auto el = j["communicator"][EndpointFactory::index()]["endpoint"];
+
+    end.suite(el.at("suite"));
+    end.protocol(el.at("protocol"));
+    if (el.contains("name")) end.name(el.at("name"));
+    // like the port of the other endpoints, the size can be written as a string
+    if (el.contains("size"))
+        end.size(el.at("size").is_string() ? std::stoull(el.at("size").get<std::string>())
+                                           : el.at("size").get<size_t>());
+    if (el.contains("hugepages")) end.hugepages(el.at("hugepages").get<bool>());
+}
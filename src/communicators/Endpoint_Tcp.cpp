@@ -1,9 +1,15 @@
 #include "gvirtus/communicators/Endpoint_Tcp.h"
 
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+
+#include <algorithm>
 #include <regex>
 
 #include "gvirtus/communicators/EndpointFactory.h"
 #include "gvirtus/communicators/Endpoint_Rdma.h"
+#include "gvirtus/communicators/Protocol.h"
 
 using gvirtus::communicators::Endpoint;
 using gvirtus::communicators::Endpoint_Tcp;
@@ -66,6 +72,29 @@ Endpoint_Tcp &Endpoint_Tcp::port(const std::string &port) {
     return *this;
 }
 
+Endpoint_Tcp &Endpoint_Tcp::stripes(unsigned stripes) {
+    _stripes = std::clamp<unsigned>(stripes, 1, GVIRTUS_MAX_STRIPES);
+
+    return *this;
+}
+
+bool Endpoint_Tcp::is_local() const {
+    struct in_addr addr;
+    if (inet_pton(AF_INET, _address.c_str(), &addr) != 1) return false;
+    // 0.0.0.0 reaches this host, as the loopback network does
+    uint32_t host = ntohl(addr.s_addr);
+    if (host == INADDR_ANY || (host >> 24) == IN_LOOPBACKNET) return true;
+
+    struct ifaddrs *interfaces;
+    if (getifaddrs(&interfaces) != 0) return false;
+    bool local = false;
+    for (auto i = interfaces; i != nullptr && !local; i = i->ifa_next)
+        local = i->ifa_addr != nullptr && i->ifa_addr->sa_family == AF_INET &&
+                ((struct sockaddr_in *)i->ifa_addr)->sin_addr.s_addr == addr.s_addr;
+    freeifaddrs(interfaces);
+    return local;
+}
+
 void gvirtus::communicators::from_json(const nlohmann::json &j, Endpoint_Tcp &end) {
     auto el = j["communicator"][EndpointFactory::index()]["endpoint"];
 
@@ -73,4 +102,8 @@ void gvirtus::communicators::from_json(const nlohmann::json &j, Endpoint_Tcp &en
     end.protocol(el.at("protocol"));
     end.address(el.at("server_address"));
     end.port(el.at("port"));
+    // like the port, the stripes can be written as a string
+    if (el.contains("stripes"))
+        end.stripes(el.at("stripes").is_string() ? std::stoul(el.at("stripes").get<std::string>())
+                                                 : el.at("stripes").get<unsigned>());
 }
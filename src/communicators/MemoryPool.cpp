@@ -0,0 +1,159 @@
+#include "gvirtus/communicators/MemoryPool.h"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+using gvirtus::communicators::MemoryPool;
+
+/* size classes go from 1 << MIN_CLASS_SHIFT to 1 << MAX_CLASS_SHIFT bytes */
+#define MIN_CLASS_SHIFT 12
+#define MAX_CLASS_SHIFT 20
+#define CLASSES (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1)
+/* bytes kept in the free list of a class, at least two blocks */
+#define MAX_FREE_BYTES_PER_CLASS (4 << 20)
+#define LARGE_BLOCK_ALIGNMENT (2 << 20)
+#define MAX_FREE_LARGE_BLOCKS 4
+
+namespace {
+bool getEnvFlag(const char *key, bool default_value) {
+    const char *value = getenv(key);
+    if (value == nullptr || *value == '\0') return default_value;
+    return strcmp(value, "0") != 0 && strcasecmp(value, "false") != 0 &&
+           strcasecmp(value, "no") != 0;
+}
+
+const bool enabled = getEnvFlag("GVIRTUS_BUFFER_POOL", true);
+const bool hugepages = getEnvFlag("GVIRTUS_HUGEPAGES", false);
+
+std::atomic<size_t> allocations{0};
+std::atomic<size_t> system_allocations{0};
+std::atomic<size_t> huge_allocations{0};
+
+struct Block {
+    void *ptr;
+    size_t size;
+};
+
+void *MapLarge(size_t size) {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (hugepages && madvise(ptr, size, MADV_HUGEPAGE) == 0)
+        huge_allocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+    return ptr;
+}
+
+/* set once the cache of the thread is gone: buffers destroyed later (e.g.
+ * static ones) bypass it */
+thread_local bool cache_destroyed = false;
+
+/* the free lists of a thread, given back to the system when it exits */
+struct ThreadCache {
+    std::vector<void *> classes[CLASSES];
+    std::vector<Block> large;
+
+    ~ThreadCache() {
+        cache_destroyed = true;
+        for (auto &free_list : classes)
+            for (auto ptr : free_list) free(ptr);
+        for (auto &block : large) munmap(block.ptr, block.size);
+    }
+};
+
+thread_local ThreadCache cache;
+
+ThreadCache *GetCache() { return cache_destroyed ? nullptr : &cache; }
+
+unsigned SizeClass(size_t size) {
+    unsigned shift = MIN_CLASS_SHIFT;
+    while (((size_t)1 << shift) < size) shift++;
+    return shift - MIN_CLASS_SHIFT;
+}
+}  // namespace
+
+void *MemoryPool::Allocate(size_t &size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (!enabled) {
+        system_allocations.fetch_add(1, std::memory_order_relaxed);
+        void *ptr = malloc(size > 0 ? size : 1);
+        if (ptr == nullptr) throw std::bad_alloc();
+        return ptr;
+    }
+
+    if (size <= ((size_t)1 << MAX_CLASS_SHIFT)) {
+        unsigned size_class = SizeClass(size);
+        size = (size_t)1 << (size_class + MIN_CLASS_SHIFT);
+        auto thread_cache = GetCache();
+        if (thread_cache != nullptr && !thread_cache->classes[size_class].empty()) {
+            void *ptr = thread_cache->classes[size_class].back();
+            thread_cache->classes[size_class].pop_back();
+            return ptr;
+        }
+        system_allocations.fetch_add(1, std::memory_order_relaxed);
+        void *ptr = malloc(size);
+        if (ptr == nullptr) throw std::bad_alloc();
+        return ptr;
+    }
+
+    size = (size + LARGE_BLOCK_ALIGNMENT - 1) / LARGE_BLOCK_ALIGNMENT * LARGE_BLOCK_ALIGNMENT;
+    // reuse a cached block unless it would waste more than half of it
+    auto thread_cache = GetCache();
+    if (thread_cache != nullptr) {
+        auto &large = thread_cache->large;
+        for (auto it = large.begin(); it != large.end(); ++it) {
+            if (it->size >= size && it->size / 2 <= size) {
+                void *ptr = it->ptr;
+                size = it->size;
+                large.erase(it);
+                return ptr;
+            }
+        }
+    }
+    system_allocations.fetch_add(1, std::memory_order_relaxed);
+    return MapLarge(size);
+}
+
+void MemoryPool::Release(void *ptr, size_t size) {
+    if (ptr == nullptr) return;
+    if (!enabled) {
+        free(ptr);
+        return;
+    }
+
+    auto thread_cache = GetCache();
+    if (size <= ((size_t)1 << MAX_CLASS_SHIFT)) {
+        if (thread_cache == nullptr) {
+            free(ptr);
+            return;
+        }
+        auto &free_list = thread_cache->classes[SizeClass(size)];
+        if (free_list.size() < 2 || (free_list.size() + 1) * size <= MAX_FREE_BYTES_PER_CLASS)
+            free_list.push_back(ptr);
+        else
+            free(ptr);
+        return;
+    }
+
+    if (thread_cache == nullptr) {
+        munmap(ptr, size);
+        return;
+    }
+    auto &large = thread_cache->large;
+    if (large.size() == MAX_FREE_LARGE_BLOCKS) {
+        munmap(large.front().ptr, large.front().size);
+        large.erase(large.begin());
+    }
+    large.push_back({ptr, size});
+}
+
+MemoryPool::Stats MemoryPool::GetStats() {
+    return {allocations.load(std::memory_order_relaxed),
+            system_allocations.load(std::memory_order_relaxed),
+            huge_allocations.load(std::memory_order_relaxed)};
+}
@@ -1,5 +1,7 @@
 #include "gvirtus/communicators/Result.h"
 
+using gvirtus::communicators::Compressor;
+using gvirtus::communicators::ResponseHeader;
 using gvirtus::communicators::Result;
 
 Result::Result(int exit_code) {
@@ -12,18 +14,43 @@ Result::Result(int exit_code, const std::shared_ptr<Buffer> output_buffer) {
     mpOutputBuffer = (output_buffer);
 }
 
+Result::Result(int exit_code, size_t size, std::function<void(Communicator *)> writer) {
+    mExitCode = exit_code;
+    mWriterSize = size;
+    mWriter = std::move(writer);
+}
+
 int Result::GetExitCode() { return mExitCode; }
 
-void Result::Dump(Communicator *c) {
-    c->Write((char *)&mExitCode, sizeof(int));
-    c->Write(reinterpret_cast<const char *>(&mTimeTaken), sizeof(mTimeTaken));
-    if (mpOutputBuffer != NULL)
-        mpOutputBuffer->Dump(c);
-    else {
-        size_t size = 0;
-        c->Write((char *)&size, sizeof(size_t));
+void Result::Dump(Communicator *c, uint64_t request_id, Compressor *compressor, bool bulk) {
+    ResponseHeader header;
+    header.exit_code = mExitCode;
+    header.request_id = request_id;
+    header.time_taken = mTimeTaken;
+    header.payload_size = mpOutputBuffer != NULL ? mpOutputBuffer->GetBufferSize() : 0;
+    if (mWriter) {
+        header.payload_size = mWriterSize;
+        header.flags = bulk ? RESPONSE_BULK_LANE : 0;
+        c->Write((char *)&header, sizeof(header));
+        if (!bulk) mWriter(c);
         c->Sync();
+        return;
     }
+    bool compressed = compressor != nullptr && compressor->ShouldCompress(header.payload_size);
+    header.flags = compressed ? RESPONSE_COMPRESSED : 0;
+
+    c->Write((char *)&header, sizeof(header));
+    if (compressor != nullptr && header.payload_size > 0) {
+        compressor->Write(c, mpOutputBuffer.get(), compressed);
+        return;
+    }
+    if (header.payload_size > 0) mpOutputBuffer->WriteTo(c);
+    c->Sync();
+}
+
+void Result::DumpOutput(Communicator *bulk_lane) {
+    mWriter(bulk_lane);
+    bulk_lane->Sync();
 }
 
 void Result::TimeTaken(double time_taken) { mTimeTaken = time_taken; }
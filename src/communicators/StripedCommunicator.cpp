@@ -0,0 +1,149 @@
+#include "gvirtus/communicators/StripedCommunicator.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "gvirtus/communicators/Protocol.h"
+
+using gvirtus::communicators::Communicator;
+using gvirtus::communicators::StripedCommunicator;
+
+StripedCommunicator::Worker::Worker()
+    : mThread([this]() {
+          std::unique_lock<std::mutex> lock(mMutex);
+          while (true) {
+              mCondition.wait(lock, [this]() { return mStop || mJob != nullptr; });
+              if (mJob == nullptr) return;
+              auto job = std::move(mJob);
+              mJob = nullptr;
+              lock.unlock();
+              std::exception_ptr error;
+              try {
+                  job();
+              } catch (...) {
+                  error = std::current_exception();
+              }
+              lock.lock();
+              mError = error;
+              mBusy = false;
+              mCondition.notify_all();
+          }
+      }) {}
+
+StripedCommunicator::Worker::~Worker() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+    mThread.join();
+}
+
+void StripedCommunicator::Worker::Post(std::function<void()> job) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mJob = std::move(job);
+    mBusy = true;
+    mCondition.notify_all();
+}
+
+void StripedCommunicator::Worker::Wait() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]() { return !mBusy; });
+    if (mError != nullptr) std::rethrow_exception(std::exchange(mError, nullptr));
+}
+
+StripedCommunicator::StripedCommunicator(std::vector<std::shared_ptr<Communicator>> stripes)
+    : mStripes(std::move(stripes)), mReaders(mStripes.size()), mWriters(mStripes.size()) {
+    if (mStripes.empty()) throw std::invalid_argument("A StripedCommunicator needs a stripe");
+}
+
+void StripedCommunicator::Serve() {
+    throw std::logic_error("A StripedCommunicator cannot serve");
+}
+
+const Communicator *const StripedCommunicator::Accept() const {
+    throw std::logic_error("A StripedCommunicator cannot accept connections");
+}
+
+void StripedCommunicator::Connect() {
+    for (auto &stripe : mStripes) stripe->Connect();
+}
+
+size_t StripedCommunicator::Stripe(char *buffer, size_t size, uint64_t &offset,
+                                   std::vector<std::unique_ptr<Worker>> &workers,
+                                   const std::function<void(Communicator *, Slice &)> &move) {
+    size_t count = mStripes.size();
+    size_t first = (offset / GVIRTUS_STRIPE_SEGMENT) % count;
+    std::vector<Slice> slices(count);
+    for (size_t done = 0; done < size;) {
+        size_t length =
+            std::min<size_t>(size - done, GVIRTUS_STRIPE_SEGMENT - offset % GVIRTUS_STRIPE_SEGMENT);
+        slices[(offset / GVIRTUS_STRIPE_SEGMENT) % count].segments.push_back(
+            {buffer + done, length});
+        done += length;
+        offset += length;
+    }
+
+    std::vector<size_t> posted;
+    for (size_t i = 0; i < count; i++) {
+        if (i == first || slices[i].segments.empty()) continue;
+        if (workers[i] == nullptr) workers[i] = std::make_unique<Worker>();
+        Communicator *stripe = mStripes[i].get();
+        Slice &slice = slices[i];
+        workers[i]->Post([&move, stripe, &slice]() { move(stripe, slice); });
+        posted.push_back(i);
+    }
+    std::exception_ptr error;
+    try {
+        move(mStripes[first].get(), slices[first]);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // the slices live on this stack: every worker is waited for
+    for (size_t i : posted) {
+        try {
+            workers[i]->Wait();
+        } catch (...) {
+            if (error == nullptr) error = std::current_exception();
+        }
+    }
+    if (error != nullptr) std::rethrow_exception(error);
+
+    size_t moved = 0;
+    for (auto &slice : slices) moved += slice.done;
+    return moved;
+}
+
+size_t StripedCommunicator::Read(char *buffer, size_t size) {
+    return Stripe(buffer, size, mReadOffset, mReaders, [](Communicator *stripe, Slice &slice) {
+        for (auto &segment : slice.segments) {
+            size_t n = stripe->Read((char *)segment.iov_base, segment.iov_len);
+            slice.done += n;
+            // the stripe is closed
+            if (n != segment.iov_len) break;
+        }
+    });
+}
+
+size_t StripedCommunicator::Write(const char *buffer, size_t size) {
+    return Stripe((char *)buffer, size, mWriteOffset, mWriters,
+                  [](Communicator *stripe, Slice &slice) {
+                      slice.done = stripe->Writev(slice.segments.data(), slice.segments.size());
+                  });
+}
+
+void StripedCommunicator::Sync() {
+    for (auto &stripe : mStripes) stripe->Sync();
+}
+
+bool StripedCommunicator::IsFullDuplex() const {
+    return std::all_of(mStripes.begin(), mStripes.end(),
+                       [](const std::shared_ptr<Communicator> &stripe) {
+                           return stripe->IsFullDuplex();
+                       });
+}
+
+void StripedCommunicator::Close() {
+    for (auto &stripe : mStripes) stripe->Close();
+}
@@ -0,0 +1,107 @@
+#include "gvirtus/communicators/Transfer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+using gvirtus::communicators::Transfer;
+
+#define DEFAULT_CHUNK_SIZE (1 << 20)
+/* staging buffers kept in the pool */
+#define POOLED_CHUNKS 16
+
+namespace {
+size_t getChunkSizeFromEnv() {
+    const char *value = getenv("GVIRTUS_TRANSFER_CHUNK");
+    if (value == nullptr || *value == '\0') return DEFAULT_CHUNK_SIZE;
+    return std::max<size_t>(4096, strtoull(value, NULL, 10));
+}
+
+const size_t chunk_size = getChunkSizeFromEnv();
+
+void *allocateAligned(size_t size) { return aligned_alloc(4096, size); }
+
+std::mutex pool_mutex;
+std::vector<char *> pool;
+void *(*allocate_chunk)(size_t) = allocateAligned;
+void (*release_chunk)(void *) = free;
+}  // namespace
+
+Transfer::Transfer(size_t size, Communicator *source) : mSize(size), mpSource(source) {}
+
+Transfer::~Transfer() {
+    for (auto data : mFree) ReleaseChunk(data);
+}
+
+Transfer::Chunk Transfer::Take() {
+    if (mTaken >= mSize) return {nullptr, 0};
+    char *data;
+    if (!mFree.empty()) {
+        data = mFree.front();
+        mFree.pop_front();
+    } else {
+        data = AllocateChunk();
+    }
+    size_t size = std::min(chunk_size, mSize - mTaken);
+    if (mpSource->Read(data, size) != size) {
+        // nothing else can be read from the connection
+        mFree.push_back(data);
+        mSize = mTaken;
+        throw std::runtime_error("Connection closed during a transfer");
+    }
+    mTaken += size;
+    return {data, size};
+}
+
+void Transfer::Release(Chunk chunk) {
+    if (chunk.data != nullptr) mFree.push_back(chunk.data);
+}
+
+void Transfer::Close() {
+    try {
+        for (Chunk chunk = Take(); chunk.data != nullptr; chunk = Take()) Release(chunk);
+    } catch (const std::exception &e) {
+        // the connection is over: reading the next request ends it
+    }
+}
+
+size_t Transfer::GetChunkSize() { return chunk_size; }
+
+char *Transfer::AllocateChunk() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (!pool.empty()) {
+        char *chunk = pool.back();
+        pool.pop_back();
+        return chunk;
+    }
+    auto chunk = (char *)allocate_chunk(chunk_size);
+    if (chunk == nullptr) throw std::bad_alloc();
+    return chunk;
+}
+
+void Transfer::ReleaseChunk(char *chunk) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (pool.size() < POOLED_CHUNKS)
+        pool.push_back(chunk);
+    else
+        release_chunk(chunk);
+    // the chunks returned over the limit, see ReturnChunk()
+    while (pool.size() > POOLED_CHUNKS) {
+        release_chunk(pool.back());
+        pool.pop_back();
+    }
+}
+
+void Transfer::ReturnChunk(char *chunk) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    pool.push_back(chunk);
+}
+
+void Transfer::SetChunkAllocator(void *(*allocate)(size_t size), void (*release)(void *ptr)) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    allocate_chunk = allocate;
+    release_chunk = release;
+}
@@ -0,0 +1,404 @@
+/*
+ * gVirtuS -- A GPGPU transparent virtualization component.
+ *
+ * Copyright (C) 2009-2010  The University of Napoli Parthenope at Naples.
+ *
+ * This file is part of gVirtuS.
+ *
+ * gVirtuS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gVirtuS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gVirtuS; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Written by: Giuseppe Coviello <giuseppe.coviello@uniparthenope.it>,
+ *             Department of Applied Science
+ */
+
+/**
+ * @file   AfUnixCommunicator.cpp
+ * @author Giuseppe Coviello <giuseppe.coviello@uniparthenope.it>
+ * @date   Wed Sep 30 12:01:12 2009
+ *
+ * @brief
+ *
+ *
+ */
+
+#include "AfUnixCommunicator.h"
+
+#include <gvirtus/communicators/Endpoint_AfUnix.h>
+#include <limits.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using gvirtus::communicators::AfUnixCommunicator;
+
+static struct sockaddr_un socketAddress(const string &path, socklen_t &length) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw runtime_error("AfUnixCommunicator: Path too long: '" + path + "'.");
+    memcpy(addr.sun_path, path.data(), path.size());
+    // '@' stands for the NUL starting a name in the abstract namespace
+    if (path[0] == '@') addr.sun_path[0] = '\0';
+    length = offsetof(struct sockaddr_un, sun_path) + path.size();
+    return addr;
+}
+
+AfUnixCommunicator::AfUnixCommunicator(const string &path, mode_t mode, size_t bulk_size) {
+    mPath = path;
+    mMode = mode;
+    // the rings start on a cache line
+    mBulkSize = (bulk_size + 63) & ~(size_t)63;
+}
+
+AfUnixCommunicator::AfUnixCommunicator(int fd, int region_fd, size_t bulk_size) {
+    mSocketFd = fd;
+    mMode = 0;
+    mBulkSize = bulk_size;
+    InitializeStream();
+    if (region_fd >= 0) Map(region_fd, true);
+}
+
+AfUnixCommunicator::~AfUnixCommunicator() { Close(); }
+
+void AfUnixCommunicator::Serve() {
+    if ((mSocketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        throw runtime_error("AfUnixCommunicator: Can't create socket: " + string(strerror(errno)) +
+                            ".");
+
+    socklen_t length;
+    struct sockaddr_un addr = socketAddress(mPath, length);
+    if (mPath[0] != '@') unlink(mPath.c_str());
+    if (bind(mSocketFd, (struct sockaddr *)&addr, length) != 0)
+        throw runtime_error("AfUnixCommunicator: Can't bind socket: " + string(strerror(errno)) +
+                            ".");
+
+    if (listen(mSocketFd, 128) != 0)
+        throw runtime_error("AfUnixCommunicator: Can't listen from socket: " +
+                            string(strerror(errno)) + ".");
+
+    if (mPath[0] != '@') chmod(mPath.c_str(), mMode);
+}
+
+const gvirtus::communicators::Communicator *const AfUnixCommunicator::Accept() const {
+    int client_socket_fd = accept4(mSocketFd, NULL, NULL, SOCK_CLOEXEC);
+    if (client_socket_fd < 0) return nullptr;
+
+    // the frontend sends the size of the halves of the region, with the region attached; a
+    // peer not sending it must not hold the accepting thread
+    struct timeval timeout = {1, 0};
+    setsockopt(client_socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    uint64_t bulk_size = 0;
+    struct iovec iov = {&bulk_size, sizeof(bulk_size)};
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(client_socket_fd, &msg, MSG_CMSG_CLOEXEC | MSG_WAITALL) != sizeof(bulk_size)) {
+        close(client_socket_fd);
+        return nullptr;
+    }
+    timeout = {0, 0};
+    setsockopt(client_socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int region_fd = -1;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        memcpy(&region_fd, CMSG_DATA(cmsg), sizeof(int));
+    if (region_fd < 0) bulk_size = 0;
+
+    try {
+        return new AfUnixCommunicator(client_socket_fd, region_fd, bulk_size);
+    } catch (const std::exception &e) {
+        close(client_socket_fd);
+        return nullptr;
+    }
+}
+
+void AfUnixCommunicator::Connect() {
+    if ((mSocketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        throw runtime_error("AfUnixCommunicator: Can't create socket: " + string(strerror(errno)) +
+                            ".");
+
+    socklen_t length;
+    struct sockaddr_un addr = socketAddress(mPath, length);
+    if (connect(mSocketFd, (struct sockaddr *)&addr, length) != 0)
+        throw runtime_error("AfUnixCommunicator: Can't connect to socket: " +
+                            string(strerror(errno)) + ".");
+
+    int region_fd = -1;
+    if (mBulkSize > 0) {
+        region_fd = memfd_create("gvirtus-afunix", MFD_CLOEXEC);
+        if (region_fd >= 0 && ftruncate(region_fd, 2 * (sizeof(Region) + mBulkSize)) != 0) {
+            close(region_fd);
+            region_fd = -1;
+        }
+        // without the region everything goes through the socket
+        if (region_fd < 0) mBulkSize = 0;
+    }
+
+    uint64_t bulk_size = mBulkSize;
+    struct iovec iov = {&bulk_size, sizeof(bulk_size)};
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (region_fd >= 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &region_fd, sizeof(int));
+    }
+    if (sendmsg(mSocketFd, &msg, MSG_NOSIGNAL) != sizeof(bulk_size)) {
+        if (region_fd >= 0) close(region_fd);
+        throw runtime_error("AfUnixCommunicator: Can't write to socket: " +
+                            string(strerror(errno)) + ".");
+    }
+
+    InitializeStream();
+    if (region_fd >= 0) Map(region_fd, false);
+}
+
+void AfUnixCommunicator::Map(int region_fd, bool server) {
+    // the size comes from the peer: the rings must start on a cache line and be all in the
+    // region, or reading them would fault
+    struct stat st;
+    if (mBulkSize == 0 || mBulkSize % 64 != 0 || mBulkSize > (SIZE_MAX / 2 - sizeof(Region)) ||
+        fstat(region_fd, &st) != 0 || (uint64_t)st.st_size < 2 * (sizeof(Region) + mBulkSize)) {
+        close(region_fd);
+        throw runtime_error("AfUnixCommunicator: Invalid shared memory region.");
+    }
+    mRegionSize = 2 * (sizeof(Region) + mBulkSize);
+    void *region = mmap(NULL, mRegionSize, PROT_READ | PROT_WRITE, MAP_SHARED, region_fd, 0);
+    close(region_fd);
+    if (region == MAP_FAILED)
+        throw runtime_error("AfUnixCommunicator: Can't map the shared memory: " +
+                            string(strerror(errno)) + ".");
+    mpRegion = (char *)region;
+
+    // the frontend writes to the first half, the backend to the second one
+    auto requests = (Region *)mpRegion;
+    auto results = (Region *)(mpRegion + sizeof(Region) + mBulkSize);
+    mpIn = server ? requests : results;
+    mpOut = server ? results : requests;
+}
+
+void AfUnixCommunicator::Close() {
+    if (mpRegion != nullptr) {
+        munmap(mpRegion, mRegionSize);
+        mpRegion = nullptr;
+        mpIn = mpOut = nullptr;
+    }
+    if (mSocketFd >= 0) {
+        close(mSocketFd);
+        mSocketFd = -1;
+    }
+}
+
+bool AfUnixCommunicator::HasPendingInput() const {
+    return mInputStart < mInputEnd || (mRecordLeft > 0 && mRecord.type == RECORD_BULK);
+}
+
+size_t AfUnixCommunicator::Read(char *buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        if (mRecordLeft == 0) {
+            if (ReadSocket((char *)&mRecord, sizeof(mRecord)) != sizeof(mRecord)) return 0;
+            mRecordLeft = mRecord.length;
+            if (mRecord.type == RECORD_BULK &&
+                (mpIn == nullptr || mRecord.length > mBulkSize ||
+                 mRecord.offset > mBulkSize - mRecord.length))
+                throw runtime_error("AfUnixCommunicator: Invalid record.");
+            continue;
+        }
+
+        size_t n = min(mRecordLeft, size - done);
+        if (mRecord.type == RECORD_INLINE) {
+            if (ReadSocket(buffer + done, n) != n) return 0;
+        } else {
+            memcpy(buffer + done, mpIn->data + mRecord.offset, n);
+            mRecord.offset += n;
+            // the sender may reuse this part of the ring
+            if (n == mRecordLeft) mpIn->consumed.store(mRecord.end, memory_order_release);
+        }
+        mRecordLeft -= n;
+        done += n;
+    }
+    return size;
+}
+
+size_t AfUnixCommunicator::ReadSocket(char *buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        if (mInputStart < mInputEnd) {
+            size_t n = min(mInputEnd - mInputStart, size - done);
+            memcpy(buffer + done, mpInputBuffer.get() + mInputStart, n);
+            mInputStart += n;
+            done += n;
+            continue;
+        }
+
+        ssize_t result;
+        if (size - done >= AFUNIX_BUFFER_SIZE) {
+            // large reads skip the buffer
+            result = recv(mSocketFd, buffer + done, size - done, MSG_WAITALL);
+            if (result > 0) done += result;
+        } else {
+            result = recv(mSocketFd, mpInputBuffer.get(), AFUNIX_BUFFER_SIZE, 0);
+            mInputStart = 0;
+            mInputEnd = result > 0 ? result : 0;
+        }
+        if (result < 0 && errno == EINTR) continue;
+        // connection closed or broken
+        if (result <= 0) return 0;
+    }
+    return size;
+}
+
+size_t AfUnixCommunicator::Write(const char *buffer, size_t size) {
+    if (size < AFUNIX_BULK_THRESHOLD || mpOut == nullptr) {
+        WriteInline(buffer, size);
+        return size;
+    }
+    // in chunks, each sent right away so that the peer releases a part of the ring while we
+    // fill the rest; a chunk finding no room goes inline, and the next one tries the ring again
+    size_t chunk = mBulkSize / 4;
+    for (size_t done = 0; done < size; done += chunk) {
+        size_t n = min(chunk, size - done);
+        if (WriteBulk(buffer + done, n))
+            Flush();
+        else
+            WriteInline(buffer + done, n);
+    }
+    return size;
+}
+
+void AfUnixCommunicator::WriteInline(const char *buffer, size_t size) {
+    if (size + sizeof(Record) > AFUNIX_BUFFER_SIZE) {
+        // sent from the memory of the caller, after the queued data
+        QueueRecord({RECORD_INLINE, 0, size, 0, 0});
+        struct iovec iov = {(void *)buffer, size};
+        Flush(&iov, 1);
+        return;
+    }
+
+    if (mOutputLength + (mOpenRecord < 0 ? sizeof(Record) : 0) + size > AFUNIX_BUFFER_SIZE)
+        Flush();
+    if (mOpenRecord < 0) {
+        QueueRecord({RECORD_INLINE, 0, 0, 0, 0});
+        mOpenRecord = mOutputLength - sizeof(Record);
+    }
+    memcpy(mpOutputBuffer.get() + mOutputLength, buffer, size);
+    mOutputLength += size;
+    uint64_t length;
+    char *length_ptr = mpOutputBuffer.get() + mOpenRecord + offsetof(Record, length);
+    memcpy(&length, length_ptr, sizeof(length));
+    length += size;
+    memcpy(length_ptr, &length, sizeof(length));
+}
+
+size_t AfUnixCommunicator::Writev(const struct iovec *iov, int iovcnt) {
+    // the large segments go to the region one by one, the small ones are coalesced
+    size_t size = 0;
+    for (int i = 0; i < iovcnt; i++) size += Write((const char *)iov[i].iov_base, iov[i].iov_len);
+    return size;
+}
+
+bool AfUnixCommunicator::WriteBulk(const char *buffer, size_t size) {
+    // the data of a record is contiguous: skip the end of the ring if it does not fit there
+    uint64_t offset = mProduced % mBulkSize;
+    uint64_t padding = offset + size > mBulkSize ? mBulkSize - offset : 0;
+    if (mProduced + padding + size - mpOut->consumed.load(memory_order_acquire) > mBulkSize)
+        return false;
+    if (padding > 0) offset = 0;
+
+    memcpy(mpOut->data + offset, buffer, size);
+    mProduced += padding + size;
+    QueueRecord({RECORD_BULK, 0, size, offset, mProduced});
+    return true;
+}
+
+void AfUnixCommunicator::QueueRecord(const Record &record) {
+    mOpenRecord = -1;
+    if (mOutputLength + sizeof(record) > AFUNIX_BUFFER_SIZE) Flush();
+    memcpy(mpOutputBuffer.get() + mOutputLength, &record, sizeof(record));
+    mOutputLength += sizeof(record);
+}
+
+void AfUnixCommunicator::Sync() { Flush(); }
+
+void AfUnixCommunicator::Flush(const struct iovec *iov, int iovcnt) {
+    // the queued data goes first
+    std::vector<struct iovec> segments;
+    segments.reserve(iovcnt + 1);
+    if (mOutputLength > 0) segments.push_back({mpOutputBuffer.get(), mOutputLength});
+    for (int i = 0; i < iovcnt; i++)
+        if (iov[i].iov_len > 0) segments.push_back(iov[i]);
+    mOutputLength = 0;
+    mOpenRecord = -1;
+
+    size_t first = 0;
+    while (first < segments.size()) {
+        struct msghdr msg = {};
+        msg.msg_iov = &segments[first];
+        msg.msg_iovlen = min<size_t>(segments.size() - first, IOV_MAX);
+        ssize_t result = sendmsg(mSocketFd, &msg, MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            throw runtime_error("AfUnixCommunicator: Can't write to socket: " +
+                                string(strerror(errno)) + ".");
+        }
+        // skips what has been written, resuming a segment written in part
+        size_t left = result;
+        while (first < segments.size() && left >= segments[first].iov_len) {
+            left -= segments[first].iov_len;
+            first++;
+        }
+        if (left > 0) {
+            segments[first].iov_base = (char *)segments[first].iov_base + left;
+            segments[first].iov_len -= left;
+        }
+    }
+}
+
+void AfUnixCommunicator::InitializeStream() {
+    mpInputBuffer.reset(new char[AFUNIX_BUFFER_SIZE]);
+    mpOutputBuffer.reset(new char[AFUNIX_BUFFER_SIZE]);
+    mInputStart = mInputEnd = 0;
+    mOutputLength = 0;
+    mOpenRecord = -1;
+}
+
+extern "C" std::shared_ptr<AfUnixCommunicator> create_communicator(
+    std::shared_ptr<gvirtus::communicators::Endpoint> end) {
+    auto endpoint = std::dynamic_pointer_cast<gvirtus::communicators::Endpoint_AfUnix>(end);
+    return std::make_shared<AfUnixCommunicator>(endpoint->path(), endpoint->mode(),
+                                                endpoint->bulk_size());
+}
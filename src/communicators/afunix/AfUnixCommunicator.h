@@ -0,0 +1,159 @@
+/*
+ * gVirtuS -- A GPGPU transparent virtualization component.
+ *
+ * Copyright (C) 2009-2010  The University of Napoli Parthenope at Naples.
+ *
+ * This file is part of gVirtuS.
+ *
+ * gVirtuS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gVirtuS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gVirtuS; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Written by: Giuseppe Coviello <giuseppe.coviello@uniparthenope.it>,
+ *             Department of Applied Science
+ */
+
+/**
+ * @file   AfUnixCommunicator.h
+ * @author Giuseppe Coviello <giuseppe.coviello@uniparthenope.it>
+ * @date   Wed Sep 30 12:01:12 2009
+ *
+ * @brief
+ *
+ *
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <memory>
+
+#include "gvirtus/communicators/Communicator.h"
+
+/* size of the user space buffers coalescing small reads and writes */
+#define AFUNIX_BUFFER_SIZE (64 * 1024)
+/* writes of at least this size go through the shared memory region */
+#define AFUNIX_BULK_THRESHOLD (64 * 1024)
+
+namespace gvirtus::communicators {
+/**
+ * AfUnixCommunicator implements a Communicator for the AF_UNIX socket in the
+ * unix domain, for a frontend running on the same host as the backend.
+ *
+ * The socket carries a stream of records: the small data, coalesced until
+ * Sync() like the TcpCommunicator does, is sent inline, while the large
+ * writes (e.g. the host memory of a cudaMemcpy()) are copied to a memfd
+ * region and only their position goes through the socket, so the peer reads
+ * them from the shared memory. The frontend creates the region when it
+ * connects and passes it to the backend with SCM_RIGHTS: each direction has
+ * its own half, used as a ring. A large write goes in chunks, each announced
+ * as soon as it is copied so that the peer frees the ring while the rest is
+ * written; a chunk that finds no room in it (the peer has not read the
+ * previous ones yet) is simply sent inline.
+ */
+class AfUnixCommunicator : public Communicator {
+   public:
+    /**
+     * Creates a new AfUnixCommunicator for binding or connecting it to the
+     * AF_UNIX socket specified from path.
+     *
+     * @param path the path of the AF_UNIX socket, an abstract name if it
+     * starts with '@'.
+     * @param mode the permissions of the socket created by Serve().
+     * @param bulk_size the size of each half of the shared memory region, 0
+     * for sending all the data through the socket.
+     */
+    AfUnixCommunicator(const std::string &path, mode_t mode, size_t bulk_size);
+
+    virtual ~AfUnixCommunicator();
+    void Serve();
+    const Communicator *const Accept() const;
+    void Connect();
+    size_t Read(char *buffer, size_t size);
+    size_t Write(const char *buffer, size_t size);
+    size_t Writev(const struct iovec *iov, int iovcnt) override;
+    void Sync();
+    void Close();
+    int GetFileDescriptor() const override { return mSocketFd; }
+    bool HasPendingInput() const override;
+    bool IsFullDuplex() const override { return true; }
+
+    std::string to_string() override { return "afunixcommunicator"; }
+
+    /* header of the records sent through the socket */
+    struct Record {
+        uint32_t type;
+        uint32_t reserved;
+        uint64_t length;
+        /* RECORD_BULK: where the data is in the region of the sender */
+        uint64_t offset;
+        /* RECORD_BULK: the position the reader releases the region up to */
+        uint64_t end;
+    };
+    static constexpr uint32_t RECORD_INLINE = 0;
+    static constexpr uint32_t RECORD_BULK = 1;
+
+    /* the half of the region written by one of the peers */
+    struct Region {
+        /* bytes of the ring released by the reader so far */
+        alignas(64) std::atomic<uint64_t> consumed;
+        alignas(64) char data[];
+    };
+
+   private:
+    AfUnixCommunicator(int fd, int region_fd, size_t bulk_size);
+    void InitializeStream();
+    void Map(int region_fd, bool server);
+    /**
+     * Copies data to the ring of mpOut and queues the record pointing to it.
+     *
+     * @return false if there is no room for it.
+     */
+    bool WriteBulk(const char *buffer, size_t size);
+    /**
+     * Queues a record header, sending the queued data first if there is no
+     * room for it.
+     */
+    void QueueRecord(const Record &record);
+    /* writes data through the socket, coalesced with the queued data if it is small */
+    void WriteInline(const char *buffer, size_t size);
+    void Flush(const struct iovec *iov = nullptr, int iovcnt = 0);
+    size_t ReadSocket(char *buffer, size_t size);
+
+    std::string mPath;
+    mode_t mMode;
+    int mSocketFd = -1;
+
+    std::unique_ptr<char[]> mpInputBuffer;
+    size_t mInputStart = 0;
+    size_t mInputEnd = 0;
+    /* the record being read */
+    Record mRecord = {};
+    size_t mRecordLeft = 0;
+
+    std::unique_ptr<char[]> mpOutputBuffer;
+    size_t mOutputLength = 0;
+    /* offset in mpOutputBuffer of the inline record being filled, or -1 */
+    ssize_t mOpenRecord = -1;
+
+    size_t mBulkSize;
+    char *mpRegion = nullptr;
+    size_t mRegionSize = 0;
+    Region *mpIn = nullptr;
+    Region *mpOut = nullptr;
+    /* bytes of the ring of mpOut used so far */
+    uint64_t mProduced = 0;
+};
+}  // namespace gvirtus::communicators
@@ -0,0 +1,317 @@
+#include "ShmRingCommunicator.h"
+
+#include <gvirtus/communicators/Endpoint_Shm.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+using gvirtus::communicators::ShmRingCommunicator;
+using std::runtime_error;
+using std::string;
+
+#define MIN_SPIN 64
+#define MAX_SPIN 65536
+/* how often a sleeping reader or writer checks that the peer is still there */
+#define PEER_CHECK_INTERVAL_NS 100000000
+#define HUGE_PAGE_SIZE (2 << 20)
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/* spinning on a single CPU only delays the peer */
+static unsigned spinLimit() {
+    static const unsigned limit = std::thread::hardware_concurrency() > 1 ? MAX_SPIN : 0;
+    return limit;
+}
+
+static struct sockaddr_un socketAddress(const string &name, socklen_t &length) {
+    // abstract socket: no file to clean up
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    string path = "gvirtus-shm-" + name;
+    if (path.size() + 1 > sizeof(addr.sun_path))
+        throw runtime_error("ShmRingCommunicator: name too long: '" + name + "'.");
+    memcpy(addr.sun_path + 1, path.data(), path.size());
+    length = offsetof(struct sockaddr_un, sun_path) + 1 + path.size();
+    return addr;
+}
+
+ShmRingCommunicator::ShmRingCommunicator(const string &name, size_t ring_size, bool hugepages) {
+    mName = name;
+    // a power of two, so positions are turned into offsets with a mask
+    mRingSize = 64 * 1024;
+    while (mRingSize < ring_size) mRingSize <<= 1;
+    mHugepages = hugepages;
+    mReadSpin = mWriteSpin = spinLimit() / 16;
+}
+
+ShmRingCommunicator::ShmRingCommunicator(int socket_fd, int segment_fd, size_t ring_size) {
+    mRingSize = ring_size;
+    mHugepages = false;
+    mReadSpin = mWriteSpin = spinLimit() / 16;
+    mSocketFd = socket_fd;
+    Map(segment_fd, true);
+}
+
+ShmRingCommunicator::~ShmRingCommunicator() { Close(); }
+
+void ShmRingCommunicator::Serve() {
+    if ((mSocketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        throw runtime_error("ShmRingCommunicator: Can't create socket: " +
+                            string(strerror(errno)) + ".");
+    socklen_t length;
+    struct sockaddr_un addr = socketAddress(mName, length);
+    if (bind(mSocketFd, (struct sockaddr *)&addr, length) != 0)
+        throw runtime_error("ShmRingCommunicator: Can't bind socket: " + string(strerror(errno)) +
+                            ".");
+    if (listen(mSocketFd, 128) != 0)
+        throw runtime_error("ShmRingCommunicator: Can't listen from socket: " +
+                            string(strerror(errno)) + ".");
+}
+
+const gvirtus::communicators::Communicator *const ShmRingCommunicator::Accept() const {
+    int client_fd = accept4(mSocketFd, NULL, NULL, SOCK_CLOEXEC);
+    if (client_fd < 0) return nullptr;
+
+    // the frontend sends the size of the rings, with the segment attached
+    uint64_t ring_size = 0;
+    struct iovec iov = {&ring_size, sizeof(ring_size)};
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg;
+    if (recvmsg(client_fd, &msg, MSG_CMSG_CLOEXEC) != sizeof(ring_size) ||
+        (cmsg = CMSG_FIRSTHDR(&msg)) == NULL || cmsg->cmsg_type != SCM_RIGHTS ||
+        ring_size == 0 || (ring_size & (ring_size - 1)) != 0) {
+        close(client_fd);
+        return nullptr;
+    }
+    int segment_fd;
+    memcpy(&segment_fd, CMSG_DATA(cmsg), sizeof(int));
+
+    try {
+        return new ShmRingCommunicator(client_fd, segment_fd, ring_size);
+    } catch (const std::exception &e) {
+        close(client_fd);
+        return nullptr;
+    }
+}
+
+void ShmRingCommunicator::Connect() {
+    if ((mSocketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        throw runtime_error("ShmRingCommunicator: Can't create socket: " +
+                            string(strerror(errno)) + ".");
+    socklen_t length;
+    struct sockaddr_un addr = socketAddress(mName, length);
+    if (connect(mSocketFd, (struct sockaddr *)&addr, length) != 0)
+        throw runtime_error("ShmRingCommunicator: Can't connect to '" + mName +
+                            "': " + string(strerror(errno)) + ".");
+
+    int segment_fd = -1;
+    size_t segment_size = 2 * (sizeof(Ring) + mRingSize);
+#ifdef MFD_HUGETLB
+    if (mHugepages) {
+        segment_fd = memfd_create("gvirtus-shm", MFD_CLOEXEC | MFD_HUGETLB);
+        segment_size = (segment_size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        if (segment_fd >= 0 && ftruncate(segment_fd, segment_size) != 0) {
+            // no huge pages reserved
+            close(segment_fd);
+            segment_fd = -1;
+        }
+    }
+#endif
+    if (segment_fd < 0) {
+        if ((segment_fd = memfd_create("gvirtus-shm", MFD_CLOEXEC)) < 0 ||
+            ftruncate(segment_fd, segment_size) != 0)
+            throw runtime_error("ShmRingCommunicator: Can't create the shared memory: " +
+                                string(strerror(errno)) + ".");
+    }
+
+    uint64_t ring_size = mRingSize;
+    struct iovec iov = {&ring_size, sizeof(ring_size)};
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &segment_fd, sizeof(int));
+    if (sendmsg(mSocketFd, &msg, MSG_NOSIGNAL) != sizeof(ring_size)) {
+        close(segment_fd);
+        throw runtime_error("ShmRingCommunicator: Can't send the shared memory: " +
+                            string(strerror(errno)) + ".");
+    }
+
+    Map(segment_fd, false);
+}
+
+void ShmRingCommunicator::Map(int segment_fd, bool server) {
+    // the size comes from the peer: the rings must be all in the segment
+    struct stat st;
+    if (mRingSize > (SIZE_MAX / 2 - sizeof(Ring)) || fstat(segment_fd, &st) != 0 ||
+        (uint64_t)st.st_size < 2 * (sizeof(Ring) + mRingSize)) {
+        close(segment_fd);
+        throw runtime_error("ShmRingCommunicator: Invalid shared memory segment.");
+    }
+    mSegmentSize = 2 * (sizeof(Ring) + mRingSize);
+    void *segment = mmap(NULL, mSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, segment_fd, 0);
+    close(segment_fd);
+    if (segment == MAP_FAILED)
+        throw runtime_error("ShmRingCommunicator: Can't map the shared memory: " +
+                            string(strerror(errno)) + ".");
+    mpSegment = (char *)segment;
+#ifdef MADV_HUGEPAGE
+    if (mHugepages) madvise(mpSegment, mSegmentSize, MADV_HUGEPAGE);
+#endif
+
+    // the first ring carries the requests, the second one the results
+    auto requests = (Ring *)mpSegment;
+    auto results = (Ring *)(mpSegment + sizeof(Ring) + mRingSize);
+    mpIn = server ? requests : results;
+    mpOut = server ? results : requests;
+}
+
+void ShmRingCommunicator::Close() {
+    if (mpSegment != nullptr) {
+        munmap(mpSegment, mSegmentSize);
+        mpSegment = nullptr;
+        mpIn = mpOut = nullptr;
+    }
+    if (mSocketFd >= 0) {
+        close(mSocketFd);
+        mSocketFd = -1;
+    }
+}
+
+size_t ShmRingCommunicator::Read(char *buffer, size_t size) {
+    size_t mask = mRingSize - 1;
+    size_t done = 0;
+    while (done < size) {
+        uint64_t tail = mpIn->tail.load(std::memory_order_relaxed);
+        uint64_t head = mpIn->head.load(std::memory_order_acquire);
+        if (head == tail) {
+            if (!Wait(mpIn->head, tail, mpIn->head_seq, mpIn->consumer_sleeping, mReadSpin))
+                return 0;
+            continue;
+        }
+        size_t n = std::min<size_t>(head - tail, size - done);
+        size_t offset = tail & mask;
+        size_t first = std::min(n, mRingSize - offset);
+        memcpy(buffer + done, mpIn->data + offset, first);
+        memcpy(buffer + done + first, mpIn->data, n - first);
+        mpIn->tail.store(tail + n, std::memory_order_release);
+        done += n;
+        Wake(mpIn->tail_seq, mpIn->producer_sleeping);
+    }
+    return size;
+}
+
+size_t ShmRingCommunicator::Write(const char *buffer, size_t size) {
+    size_t mask = mRingSize - 1;
+    size_t done = 0;
+    while (done < size) {
+        uint64_t head = mpOut->head.load(std::memory_order_relaxed);
+        uint64_t tail = mpOut->tail.load(std::memory_order_acquire);
+        size_t space = mRingSize - (head - tail);
+        if (space == 0) {
+            // the reader may be waiting for a Sync() that can't come before there is space
+            Wake(mpOut->head_seq, mpOut->consumer_sleeping);
+            if (!Wait(mpOut->tail, tail, mpOut->tail_seq, mpOut->producer_sleeping, mWriteSpin))
+                throw runtime_error("ShmRingCommunicator: Connection closed by the peer.");
+            continue;
+        }
+        size_t n = std::min(space, size - done);
+        size_t offset = head & mask;
+        size_t first = std::min(n, mRingSize - offset);
+        memcpy(mpOut->data + offset, buffer + done, first);
+        memcpy(mpOut->data, buffer + done + first, n - first);
+        mpOut->head.store(head + n, std::memory_order_release);
+        done += n;
+    }
+    return size;
+}
+
+size_t ShmRingCommunicator::Writev(const struct iovec *iov, int iovcnt) {
+    // the ring is a stream: no need to gather the segments
+    size_t size = 0;
+    for (int i = 0; i < iovcnt; i++) size += Write((const char *)iov[i].iov_base, iov[i].iov_len);
+    return size;
+}
+
+void ShmRingCommunicator::Sync() { Wake(mpOut->head_seq, mpOut->consumer_sleeping); }
+
+bool ShmRingCommunicator::Wait(std::atomic<uint64_t> &position, uint64_t value,
+                               std::atomic<uint32_t> &seq, std::atomic<uint32_t> &sleeping,
+                               unsigned &spin) {
+    // waiting for data and waiting for room last differently: each has its own budget
+    for (unsigned i = 0; i < spin; i++) {
+        if (position.load(std::memory_order_acquire) != value) {
+            spin = std::min(spin * 2, spinLimit());
+            return true;
+        }
+        cpu_relax();
+    }
+    // the peer is slower than the spin: spin less next time
+    spin = std::min(std::max(spin / 2, (unsigned)MIN_SPIN), spinLimit());
+
+    while (true) {
+        // sleeping must be visible before position is checked again, see Wake()
+        sleeping.store(1, std::memory_order_seq_cst);
+        uint32_t current = seq.load(std::memory_order_seq_cst);
+        if (position.load(std::memory_order_seq_cst) != value) break;
+        struct timespec timeout = {0, PEER_CHECK_INTERVAL_NS};
+        syscall(SYS_futex, &seq, FUTEX_WAIT, current, &timeout, NULL, 0);
+        if (position.load(std::memory_order_acquire) != value) break;
+        if (!PeerAlive()) {
+            sleeping.store(0, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    sleeping.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void ShmRingCommunicator::Wake(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &sleeping) {
+    // orders the move of the position before the check of sleeping, see Wait()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst) == 0) return;
+    seq.fetch_add(1, std::memory_order_seq_cst);
+    syscall(SYS_futex, &seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+bool ShmRingCommunicator::PeerAlive() {
+    // nothing is sent on the socket after the handshake: any event means it was closed
+    struct pollfd pfd = {mSocketFd, POLLIN | POLLRDHUP, 0};
+    return poll(&pfd, 1, 0) == 0;
+}
+
+extern "C" std::shared_ptr<ShmRingCommunicator> create_communicator(
+    std::shared_ptr<gvirtus::communicators::Endpoint> end) {
+    auto endpoint = std::dynamic_pointer_cast<gvirtus::communicators::Endpoint_Shm>(end);
+    return std::make_shared<ShmRingCommunicator>(endpoint->name(), endpoint->size(),
+                                                 endpoint->hugepages());
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "gvirtus/communicators/Communicator.h"
+
+namespace gvirtus::communicators {
+/**
+ * ShmRingCommunicator implements a Communicator for a frontend and a backend
+ * running on the same host. A connection is a shared memory segment holding
+ * two single producer, single consumer byte rings, one for each direction,
+ * so Read() and Write() are a memcpy() from/to the ring and no system call
+ * is made while the peer keeps up.
+ *
+ * The frontend creates the segment (a memfd) and passes it to the backend
+ * over the abstract unix socket "gvirtus-shm-<name>"; the socket is kept
+ * open for detecting when the peer goes away. A reader or writer that finds
+ * the ring empty or full spins for a while, adapting the length of the spin
+ * to how long the waits usually last, then sleeps on a futex; Sync() and
+ * reads that free space wake the peer only when it is sleeping.
+ *
+ * There is no file descriptor becoming readable with the ring, so the
+ * backend serves a connection on a thread of its own rather than on the
+ * reactor, and the connection is used by one thread at a time.
+ */
+class ShmRingCommunicator : public Communicator {
+   public:
+    ShmRingCommunicator(const std::string &name, size_t ring_size, bool hugepages);
+    virtual ~ShmRingCommunicator();
+    void Serve();
+    const Communicator *const Accept() const;
+    void Connect();
+    size_t Read(char *buffer, size_t size);
+    size_t Write(const char *buffer, size_t size);
+    size_t Writev(const struct iovec *iov, int iovcnt) override;
+    void Sync();
+    void Close();
+
+    std::string to_string() override { return "shmringcommunicator"; }
+
+    /* one direction of a connection, at the beginning of the segment */
+    struct Ring {
+        /* bytes written so far, moved by the producer */
+        alignas(64) std::atomic<uint64_t> head;
+        /* futex word bumped when head moves and the consumer is sleeping */
+        std::atomic<uint32_t> head_seq;
+        std::atomic<uint32_t> consumer_sleeping;
+        /* bytes read so far, moved by the consumer */
+        alignas(64) std::atomic<uint64_t> tail;
+        std::atomic<uint32_t> tail_seq;
+        std::atomic<uint32_t> producer_sleeping;
+        alignas(64) char data[];
+    };
+
+   private:
+    ShmRingCommunicator(int socket_fd, int segment_fd, size_t ring_size);
+    void Map(int segment_fd, bool server);
+    /**
+     * Waits until position moves from value, spinning then sleeping on the
+     * futex seq after raising sleeping; spin is the budget of the direction,
+     * adapted to the wait.
+     *
+     * @return false if the peer went away.
+     */
+    bool Wait(std::atomic<uint64_t> &position, uint64_t value, std::atomic<uint32_t> &seq,
+              std::atomic<uint32_t> &sleeping, unsigned &spin);
+    static void Wake(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &sleeping);
+    bool PeerAlive();
+
+    std::string mName;
+    size_t mRingSize;
+    bool mHugepages;
+    int mSocketFd = -1;
+
+    char *mpSegment = nullptr;
+    size_t mSegmentSize = 0;
+    Ring *mpIn = nullptr;
+    Ring *mpOut = nullptr;
+    /* pause iterations before sleeping, adapted to the waits of Read() and of Write() */
+    unsigned mReadSpin;
+    unsigned mWriteSpin;
+};
+}  // namespace gvirtus::communicators
@@ -39,10 +39,16 @@
 #ifndef _WIN32
 
 #include <arpa/inet.h>
+#include <limits.h>
+#include <linux/errqueue.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #else
 #include <WinSock2.h>
@@ -53,13 +59,22 @@ static bool initialized = false;
 #include <gvirtus/communicators/Endpoint_Rdma.h>
 #include <gvirtus/communicators/Endpoint_Tcp.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 using namespace std;
 using gvirtus::communicators::TcpCommunicator;
 
+static size_t getEnvSize(const char *key, size_t default_value) {
+    const char *value = getenv(key);
+    if (value == nullptr || *value == '\0') return default_value;
+    return strtoull(value, NULL, 10);
+}
+
 TcpCommunicator::TcpCommunicator(const std::string &communicator) {
 #ifdef _WIN32
     if (!initialized) {
@@ -104,12 +119,13 @@ TcpCommunicator::TcpCommunicator(const char *hostname, short port) {
 }
 
 TcpCommunicator::TcpCommunicator(int fd, const char *hostname) {
+    mHostname = string(hostname);
     mSocketFd = fd;
     InitializeStream();
 }
 
 TcpCommunicator::~TcpCommunicator() {
-    //    close(mSocketFd);
+    Close();
     delete[] mInAddr;
 }
 
@@ -120,7 +136,7 @@ void TcpCommunicator::Serve() {
 
     struct sockaddr_in socket_addr;
 
-    if ((mSocketFd = socket(AF_INET, SOCK_STREAM, 0)) == 0)
+    if ((mSocketFd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
         throw runtime_error("TcpCommunicator: Can't create socket: " + string(strerror(errno)) +
                             ".");
 
@@ -130,8 +146,10 @@ void TcpCommunicator::Serve() {
     socket_addr.sin_port = htons(mPort);
     socket_addr.sin_addr.s_addr = INADDR_ANY;
 
-    char on = 1;
+    int on = 1;
     setsockopt(mSocketFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    // inherited by the accepted sockets, it must be set before listen() to size the window
+    SetBufferSizes();
 
     int bindResult = bind(mSocketFd, (struct sockaddr *)&socket_addr, sizeof(struct sockaddr_in));
     if (bindResult != 0)
@@ -152,18 +170,12 @@ const gvirtus::communicators::Communicator *const TcpCommunicator::Accept() cons
     cout << "TcpCommunicator::Accept() called" << endl;
 #endif
 
-    unsigned client_socket_fd;
+    int client_socket_fd;
     struct sockaddr_in client_socket_addr;
-#ifndef _WIN32
-    unsigned client_socket_addr_size;
-#else
-    int client_socket_addr_size;
-#endif
+    socklen_t client_socket_addr_size = sizeof(struct sockaddr_in);
 
-    client_socket_addr_size = sizeof(struct sockaddr_in);
     if ((client_socket_fd =
-             accept(mSocketFd, (sockaddr *)&client_socket_addr, &client_socket_addr_size)) == 0 ||
-        errno == EINTR) {
+             accept(mSocketFd, (sockaddr *)&client_socket_addr, &client_socket_addr_size)) < 0) {
         return nullptr;
     }
 
@@ -175,12 +187,12 @@ const gvirtus::communicators::Communicator *const TcpCommunicator::Accept() cons
 
 void TcpCommunicator::Connect() {
 #ifdef DEBUG
-    cout << "TcpCommunicator::Connect() called " < < < < endl;
+    cout << "TcpCommunicator::Connect() called" << endl;
 #endif
 
     struct sockaddr_in remote;
 
-    if ((mSocketFd = socket(AF_INET, SOCK_STREAM, 0)) == 0)
+    if ((mSocketFd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
         throw runtime_error("TcpCommunicator: Can't create socket: " + string(strerror(errno)) +
                             ".");
 
@@ -188,6 +200,7 @@ void TcpCommunicator::Connect() {
     remote.sin_port = htons(mPort);
     memcpy(&remote.sin_addr, mInAddr, mInAddrSize);
 
+    SetBufferSizes();
     if (connect(mSocketFd, (struct sockaddr *)&remote, sizeof(struct sockaddr_in)) != 0)
         throw runtime_error("TcpCommunicator: Can't connect to socket: " + string(strerror(errno)) +
                             ".");
@@ -199,30 +212,47 @@ void TcpCommunicator::Connect() {
 #endif
 }
 
-void TcpCommunicator::Close() {}
+void TcpCommunicator::Close() {
+    if (mSocketFd < 0) return;
+    close(mSocketFd);
+    mSocketFd = -1;
+}
 
 size_t TcpCommunicator::Read(char *buffer, size_t size) {
 #ifdef DEBUG
     cout << "TcpCommunicator::Read() size: " << size << endl;
 #endif
 
-    mpInput->read(buffer, size);
-
-#ifdef DEBUG
-    for (unsigned int i = 0; i < size; i++) printf("%d LETTO %02X\n", i, buffer[i]);
-#endif
-
-    size_t ret_value;
-    if (mpInput->bad() || mpInput->eof())
-        ret_value = 0;
-    else
-        ret_value = size;
+    size_t done = 0;
+    while (done < size) {
+        if (mInputStart < mInputEnd) {
+            size_t n = min(mInputEnd - mInputStart, size - done);
+            memcpy(buffer + done, mpInputBuffer.get() + mInputStart, n);
+            mInputStart += n;
+            done += n;
+            continue;
+        }
+
+        ssize_t result;
+        if (size - done >= TCP_BUFFER_SIZE) {
+            // large reads skip the buffer
+            result = recv(mSocketFd, buffer + done, size - done, MSG_WAITALL);
+            if (result > 0) done += result;
+        } else {
+            result = recv(mSocketFd, mpInputBuffer.get(), TCP_BUFFER_SIZE, 0);
+            mInputStart = 0;
+            mInputEnd = result > 0 ? result : 0;
+        }
+        if (result < 0 && errno == EINTR) continue;
+        // connection closed or broken
+        if (result <= 0) return 0;
+    }
 
 #ifdef DEBUG
-    cout << "TcpCommunicator::Read() returned " << ret_value << endl;
+    cout << "TcpCommunicator::Read() returned " << size << endl;
 #endif
 
-    return ret_value;
+    return size;
 }
 
 size_t TcpCommunicator::Write(const char *buffer, size_t size) {
@@ -230,11 +260,13 @@ size_t TcpCommunicator::Write(const char *buffer, size_t size) {
     cout << "TcpCommunicator::Write() called" << endl;
 #endif
 
-    mpOutput->write(buffer, size);
-
-#ifdef DEBUG
-    for (unsigned int i = 0; i < size; i++) printf("%d SCRITTO %02X \n", i, buffer[i]);
-#endif
+    if (mOutputLength + size <= TCP_BUFFER_SIZE) {
+        memcpy(mpOutputBuffer.get() + mOutputLength, buffer, size);
+        mOutputLength += size;
+    } else {
+        struct iovec iov = {(void *)buffer, size};
+        Flush(&iov, 1);
+    }
 
 #ifdef DEBUG
     cout << "TcpCommunicator::Write() returned" << size << endl;
@@ -243,21 +275,128 @@ size_t TcpCommunicator::Write(const char *buffer, size_t size) {
     return size;
 }
 
-void TcpCommunicator::Sync() { mpOutput->flush(); }
+size_t TcpCommunicator::Writev(const struct iovec *iov, int iovcnt) {
+    size_t size = 0;
+    for (int i = 0; i < iovcnt; i++) size += iov[i].iov_len;
+
+    if (mOutputLength + size <= TCP_BUFFER_SIZE) {
+        for (int i = 0; i < iovcnt; i++) {
+            memcpy(mpOutputBuffer.get() + mOutputLength, iov[i].iov_base, iov[i].iov_len);
+            mOutputLength += iov[i].iov_len;
+        }
+    } else {
+        Flush(iov, iovcnt);
+    }
+
+    return size;
+}
+
+void TcpCommunicator::Sync() { Flush(); }
+
+void TcpCommunicator::Flush(const struct iovec *iov, int iovcnt) {
+    // the buffered data goes first
+    std::vector<struct iovec> segments;
+    segments.reserve(iovcnt + 1);
+    if (mOutputLength > 0) segments.push_back({mpOutputBuffer.get(), mOutputLength});
+    size_t size = mOutputLength;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) continue;
+        segments.push_back(iov[i]);
+        size += iov[i].iov_len;
+    }
+    mOutputLength = 0;
+
+    int flags = MSG_NOSIGNAL;
+#ifdef MSG_ZEROCOPY
+    if (mZeroCopyThreshold > 0 && size >= mZeroCopyThreshold) flags |= MSG_ZEROCOPY;
+#endif
+
+    size_t first = 0;
+    while (first < segments.size()) {
+        struct msghdr msg = {};
+        msg.msg_iov = &segments[first];
+        msg.msg_iovlen = min<size_t>(segments.size() - first, IOV_MAX);
+        ssize_t result = sendmsg(mSocketFd, &msg, flags);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+#ifdef MSG_ZEROCOPY
+            if (errno == ENOBUFS && (flags & MSG_ZEROCOPY)) {
+                // out of optmem for pinning the pages: copy as usual
+                flags &= ~MSG_ZEROCOPY;
+                continue;
+            }
+#endif
+            throw runtime_error("TcpCommunicator: Can't write to socket: " +
+                                string(strerror(errno)) + ".");
+        }
+#ifdef MSG_ZEROCOPY
+        if (flags & MSG_ZEROCOPY) mZeroCopySent++;
+#endif
+        // skips what has been written, resuming a segment written in part
+        size_t left = result;
+        while (first < segments.size() && left >= segments[first].iov_len) {
+            left -= segments[first].iov_len;
+            first++;
+        }
+        if (left > 0) {
+            segments[first].iov_base = (char *)segments[first].iov_base + left;
+            segments[first].iov_len -= left;
+        }
+    }
+
+    // the caller may reuse its memory as soon as we return
+    if (mZeroCopyCompleted != mZeroCopySent) WaitZeroCopyCompletions();
+}
+
+void TcpCommunicator::WaitZeroCopyCompletions() {
+#ifdef MSG_ZEROCOPY
+    while (mZeroCopyCompleted != mZeroCopySent) {
+        char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+        struct msghdr msg = {};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(mSocketFd, &msg, MSG_ERRQUEUE) < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                throw runtime_error("TcpCommunicator: Can't read the error queue: " +
+                                    string(strerror(errno)) + ".");
+            // the completions are signalled as POLLERR
+            struct pollfd pfd = {mSocketFd, 0, 0};
+            poll(&pfd, 1, -1);
+            continue;
+        }
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+            auto err = (struct sock_extended_err *)CMSG_DATA(cm);
+            if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+            // the sends from ee_info to ee_data are completed
+            mZeroCopyCompleted += err->ee_data - err->ee_info + 1;
+        }
+    }
+#endif
+}
+
+void TcpCommunicator::SetBufferSizes() {
+    int size;
+    if ((size = getEnvSize("GVIRTUS_TCP_SNDBUF", 0)) > 0)
+        setsockopt(mSocketFd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    if ((size = getEnvSize("GVIRTUS_TCP_RCVBUF", 0)) > 0)
+        setsockopt(mSocketFd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+}
 
 void TcpCommunicator::InitializeStream() {
-#ifdef _WIN32
-    FILE *i = _fdopen(mSocketFd, "r");
-    FILE *o = _fdopen(mSocketFd, "w");
-    mpInputBuf = new filebuf(i);
-    mpOutputBuf = new filebuf(o);
-#else
-    mpInputBuf = new __gnu_cxx::stdio_filebuf<char>(mSocketFd, ios_base::in);
-    mpOutputBuf = new __gnu_cxx::stdio_filebuf<char>(mSocketFd, ios_base::out);
+    int on = 1;
+    setsockopt(mSocketFd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+#ifdef SO_ZEROCOPY
+    mZeroCopyThreshold = getEnvSize("GVIRTUS_TCP_ZEROCOPY", 0);
+    if (mZeroCopyThreshold > 0 &&
+        setsockopt(mSocketFd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) != 0)
+        mZeroCopyThreshold = 0;
 #endif
 
-    mpInput = new istream(mpInputBuf);
-    mpOutput = new ostream(mpOutputBuf);
+    mpInputBuffer.reset(new char[TCP_BUFFER_SIZE]);
+    mpOutputBuffer.reset(new char[TCP_BUFFER_SIZE]);
+    mInputStart = mInputEnd = 0;
+    mOutputLength = 0;
 }
 
 extern "C" std::shared_ptr<TcpCommunicator> create_communicator(
@@ -0,0 +1,152 @@
+#include "IoUring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using gvirtus::communicators::IoUring;
+using std::runtime_error;
+using std::string;
+
+#define PAGE_SIZE_ALIGN(size) (((size) + 4095) & ~(size_t)4095)
+
+IoUring::IoUring(unsigned entries) {
+    struct io_uring_params params = {};
+    if ((mFd = syscall(__NR_io_uring_setup, entries, &params)) < 0)
+        throw runtime_error("IoUring: Can't set up io_uring: " + string(strerror(errno)) + ".");
+
+    mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    // the two rings may share a mapping
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        mSqRingSize = mCqRingSize = std::max(mSqRingSize, mCqRingSize);
+    mSqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    mpSqRing = mmap(NULL, mSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd,
+                    IORING_OFF_SQ_RING);
+    if (mpSqRing != MAP_FAILED && (params.features & IORING_FEAT_SINGLE_MMAP))
+        mpCqRing = mpSqRing;
+    else if (mpSqRing != MAP_FAILED)
+        mpCqRing = mmap(NULL, mCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd,
+                        IORING_OFF_CQ_RING);
+    void *sqes = mmap(NULL, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd,
+                      IORING_OFF_SQES);
+    if (mpSqRing == MAP_FAILED || mpCqRing == MAP_FAILED || sqes == MAP_FAILED) {
+        int error = errno;
+        if (mpSqRing != MAP_FAILED) munmap(mpSqRing, mSqRingSize);
+        if (mpCqRing != MAP_FAILED && mpCqRing != mpSqRing) munmap(mpCqRing, mCqRingSize);
+        if (sqes != MAP_FAILED) munmap(sqes, mSqesSize);
+        close(mFd);
+        throw runtime_error("IoUring: Can't map io_uring: " + string(strerror(error)) + ".");
+    }
+    mpSqes = (struct io_uring_sqe *)sqes;
+
+    char *sq = (char *)mpSqRing;
+    mpSqHead = (unsigned *)(sq + params.sq_off.head);
+    mpSqTail = (unsigned *)(sq + params.sq_off.tail);
+    mpSqArray = (unsigned *)(sq + params.sq_off.array);
+    mSqMask = *(unsigned *)(sq + params.sq_off.ring_mask);
+    mSqEntries = params.sq_entries;
+    mSqeTail = *mpSqTail;
+
+    char *cq = (char *)mpCqRing;
+    mpCqHead = (unsigned *)(cq + params.cq_off.head);
+    mpCqTail = (unsigned *)(cq + params.cq_off.tail);
+    mCqMask = *(unsigned *)(cq + params.cq_off.ring_mask);
+    mpCqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+}
+
+IoUring::~IoUring() {
+    // closing the ring cancels the requests still pending, before their buffers go away
+    close(mFd);
+    if (mpBufferRing != nullptr) munmap(mpBufferRing, mBufferRingSize);
+    munmap(mpSqes, mSqesSize);
+    if (mpCqRing != mpSqRing) munmap(mpCqRing, mCqRingSize);
+    munmap(mpSqRing, mSqRingSize);
+}
+
+struct io_uring_sqe *IoUring::GetSqe() {
+    if (GetSqeSpace() == 0) return nullptr;
+    struct io_uring_sqe *sqe = &mpSqes[mSqeTail & mSqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    mSqeTail++;
+    return sqe;
+}
+
+unsigned IoUring::GetSqeSpace() const {
+    return mSqEntries - (mSqeTail - __atomic_load_n(mpSqHead, __ATOMIC_ACQUIRE));
+}
+
+void IoUring::Submit(unsigned wait_nr) {
+    unsigned tail = *mpSqTail;
+    unsigned to_submit = mSqeTail - tail;
+    for (; tail != mSqeTail; tail++) mpSqArray[tail & mSqMask] = tail & mSqMask;
+    __atomic_store_n(mpSqTail, mSqeTail, __ATOMIC_RELEASE);
+
+    while (to_submit > 0 || (wait_nr > 0 && PeekCqe() == nullptr)) {
+        int result = syscall(__NR_io_uring_enter, mFd, to_submit, wait_nr,
+                             wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            throw runtime_error("IoUring: Can't submit: " + string(strerror(errno)) + ".");
+        }
+        to_submit -= result;
+        // the completions arrived, or will after the next enter
+        if (to_submit == 0) break;
+    }
+}
+
+struct io_uring_cqe *IoUring::PeekCqe() const {
+    unsigned head = *mpCqHead;
+    if (head == __atomic_load_n(mpCqTail, __ATOMIC_ACQUIRE)) return nullptr;
+    return &mpCqes[head & mCqMask];
+}
+
+void IoUring::SeenCqe() { __atomic_store_n(mpCqHead, *mpCqHead + 1, __ATOMIC_RELEASE); }
+
+bool IoUring::RegisterBuffers(const struct iovec *iov, unsigned count) {
+    return syscall(__NR_io_uring_register, mFd, IORING_REGISTER_BUFFERS, iov, count) == 0;
+}
+
+bool IoUring::RegisterBufferRing(unsigned short group, char *base, unsigned count,
+                                 unsigned size) {
+    mBufferRingSize = PAGE_SIZE_ALIGN(count * sizeof(struct io_uring_buf));
+    void *ring = mmap(NULL, mBufferRingSize, PROT_READ | PROT_WRITE,
+                      MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ring == MAP_FAILED) return false;
+
+    // the ring is full from the start
+    mpBufferRing = (struct io_uring_buf_ring *)ring;
+    mpBufferBase = base;
+    mBufferCount = count;
+    mBufferSize = size;
+    mBufferTail = 0;
+    for (unsigned i = 0; i < count; i++) ProvideBuffer(i);
+
+    struct io_uring_buf_reg reg = {};
+    reg.ring_addr = (unsigned long)ring;
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (syscall(__NR_io_uring_register, mFd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        munmap(ring, mBufferRingSize);
+        mpBufferRing = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void IoUring::ProvideBuffer(unsigned short bid) {
+    // not through bufs[], which the C++ expansion of __DECLARE_FLEX_ARRAY shifts
+    struct io_uring_buf *buffer =
+        (struct io_uring_buf *)mpBufferRing + (mBufferTail & (mBufferCount - 1));
+    buffer->addr = (unsigned long)(mpBufferBase + (size_t)bid * mBufferSize);
+    buffer->len = mBufferSize;
+    buffer->bid = bid;
+    // the tail overlaps the reserved field of the first buffer
+    __atomic_store_n(&mpBufferRing->tail, ++mBufferTail, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+
+namespace gvirtus::communicators {
+/**
+ * A minimal io_uring instance, set up and driven with the raw system calls:
+ * the submission and completion queues, registered (fixed) buffers and rings
+ * of provided buffers, which is all the UringCommunicator needs.
+ *
+ * It is not thread safe: a ring belongs to the connection using it.
+ */
+class IoUring {
+   public:
+    explicit IoUring(unsigned entries);
+    ~IoUring();
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    /**
+     * @return a cleared submission queue entry, or nullptr if the queue is
+     * full.
+     */
+    struct io_uring_sqe *GetSqe();
+
+    /**
+     * @return the number of entries that can be queued before Submit().
+     */
+    unsigned GetSqeSpace() const;
+
+    /**
+     * Submits the queued entries and waits, in the same system call, for
+     * wait_nr completions.
+     */
+    void Submit(unsigned wait_nr = 0);
+
+    /**
+     * @return the oldest completion not seen yet, or nullptr if there is
+     * none.
+     */
+    struct io_uring_cqe *PeekCqe() const;
+    void SeenCqe();
+
+    /**
+     * Registers iov as the fixed buffers, referred to by their index.
+     *
+     * @return false if the kernel refused them (e.g. RLIMIT_MEMLOCK).
+     */
+    bool RegisterBuffers(const struct iovec *iov, unsigned count);
+
+    /**
+     * Registers count buffers of size bytes at base as the provided buffers
+     * of group, buffer i being at base + i * size; count must be a power of
+     * two.
+     *
+     * @return false if the kernel does not support rings of provided buffers.
+     */
+    bool RegisterBufferRing(unsigned short group, char *base, unsigned count, unsigned size);
+
+    /**
+     * Gives the buffer bid of the ring back to the kernel.
+     */
+    void ProvideBuffer(unsigned short bid);
+
+    /**
+     * @return the file descriptor of the ring, readable when there are
+     * completions.
+     */
+    inline int GetFileDescriptor() const { return mFd; }
+
+   private:
+    int mFd;
+
+    void *mpSqRing = nullptr;
+    size_t mSqRingSize = 0;
+    void *mpCqRing = nullptr;
+    size_t mCqRingSize = 0;
+    struct io_uring_sqe *mpSqes = nullptr;
+    size_t mSqesSize = 0;
+
+    unsigned *mpSqHead;
+    unsigned *mpSqTail;
+    unsigned *mpSqArray;
+    unsigned mSqMask;
+    unsigned mSqEntries;
+    /* the entries up to here are queued, not submitted yet */
+    unsigned mSqeTail = 0;
+
+    unsigned *mpCqHead;
+    unsigned *mpCqTail;
+    unsigned mCqMask;
+    struct io_uring_cqe *mpCqes;
+
+    struct io_uring_buf_ring *mpBufferRing = nullptr;
+    size_t mBufferRingSize = 0;
+    char *mpBufferBase = nullptr;
+    unsigned mBufferCount = 0;
+    unsigned mBufferSize = 0;
+    unsigned short mBufferTail = 0;
+};
+}  // namespace gvirtus::communicators
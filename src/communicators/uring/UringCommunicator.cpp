@@ -0,0 +1,350 @@
+#include "UringCommunicator.h"
+
+#include <gvirtus/communicators/Endpoint_Tcp.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+using gvirtus::communicators::UringCommunicator;
+
+/* user_data of the multishot receive on the receive ring, the single receives use 0; the sends
+ * use their index in mResults */
+#define TAG_RECEIVE (~0ULL)
+
+UringCommunicator::UringCommunicator(const char *hostname, short port) {
+    mHostname = hostname;
+    mPort = port;
+}
+
+UringCommunicator::UringCommunicator(int fd) {
+    mSocketFd = fd;
+    int on = 1;
+    setsockopt(mSocketFd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    InitializeRing(true);
+    // the reactor waits on the ring before the first Read()
+    if (mMultishot) {
+        ArmReceive();
+        mpRing->Submit();
+    }
+}
+
+UringCommunicator::~UringCommunicator() { Close(); }
+
+void UringCommunicator::Serve() {
+    struct sockaddr_in socket_addr = {};
+
+    if ((mSocketFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        throw runtime_error("UringCommunicator: Can't create socket: " + string(strerror(errno)) +
+                            ".");
+
+    socket_addr.sin_family = AF_INET;
+    socket_addr.sin_port = htons(mPort);
+    socket_addr.sin_addr.s_addr = INADDR_ANY;
+
+    int on = 1;
+    setsockopt(mSocketFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    if (bind(mSocketFd, (struct sockaddr *)&socket_addr, sizeof(socket_addr)) != 0)
+        throw runtime_error("UringCommunicator: Can't bind socket: " + string(strerror(errno)) +
+                            ".");
+
+    if (listen(mSocketFd, 128) != 0)
+        throw runtime_error("UringCommunicator: Can't listen from socket: " +
+                            string(strerror(errno)) + ".");
+}
+
+const gvirtus::communicators::Communicator *const UringCommunicator::Accept() const {
+    int client_socket_fd = accept4(mSocketFd, NULL, NULL, SOCK_CLOEXEC);
+    if (client_socket_fd < 0) return nullptr;
+
+    try {
+        return new UringCommunicator(client_socket_fd);
+    } catch (const std::exception &e) {
+        close(client_socket_fd);
+        return nullptr;
+    }
+}
+
+void UringCommunicator::Connect() {
+    struct hostent *ent = gethostbyname(mHostname.c_str());
+    if (ent == NULL)
+        throw runtime_error("UringCommunicator: Can't resolve hostname '" + mHostname + "'.");
+
+    struct sockaddr_in remote = {};
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(mPort);
+    memcpy(&remote.sin_addr, *ent->h_addr_list, ent->h_length);
+
+    if ((mSocketFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        throw runtime_error("UringCommunicator: Can't create socket: " + string(strerror(errno)) +
+                            ".");
+    if (connect(mSocketFd, (struct sockaddr *)&remote, sizeof(remote)) != 0)
+        throw runtime_error("UringCommunicator: Can't connect to socket: " +
+                            string(strerror(errno)) + ".");
+
+    int on = 1;
+    setsockopt(mSocketFd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    InitializeRing(false);
+}
+
+void UringCommunicator::InitializeRing(bool multishot) {
+    mpRing = make_unique<IoUring>(64);
+    mpSendRing = make_unique<IoUring>(64);
+
+    mpOutputBuffer.reset(new char[URING_BUFFER_SIZE]);
+    mpInputBuffer.reset(new char[URING_BUFFER_SIZE]);
+    struct iovec output = {mpOutputBuffer.get(), URING_BUFFER_SIZE};
+    struct iovec input = {mpInputBuffer.get(), URING_BUFFER_SIZE};
+    // without them (e.g. over RLIMIT_MEMLOCK) the same requests go through plain buffers
+    mFixedReads = mpRing->RegisterBuffers(&input, 1);
+    // the sends from a fixed buffer need SEND_ZC, and a write can't say MSG_NOSIGNAL: it is
+    // used only if a closed connection can't kill the process (the backend ignores SIGPIPE)
+    struct sigaction sigpipe;
+    mFixedWrites = sigaction(SIGPIPE, NULL, &sigpipe) == 0 && sigpipe.sa_handler == SIG_IGN &&
+                   mpSendRing->RegisterBuffers(&output, 1);
+
+    if (multishot) {
+        mpReceiveBuffers.reset(new char[URING_RECV_BUFFERS * URING_BUFFER_SIZE]);
+        mMultishot = mpRing->RegisterBufferRing(0, mpReceiveBuffers.get(), URING_RECV_BUFFERS,
+                                                URING_BUFFER_SIZE);
+        if (!mMultishot) mpReceiveBuffers.reset();
+    }
+}
+
+void UringCommunicator::ArmReceive() {
+    struct io_uring_sqe *sqe = mpRing->GetSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = mSocketFd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->user_data = TAG_RECEIVE;
+    mReceiveArmed = true;
+}
+
+void UringCommunicator::Reap() {
+    struct io_uring_cqe *cqe;
+    while ((cqe = mpRing->PeekCqe()) != nullptr) {
+        if (cqe->user_data == TAG_RECEIVE) {
+            if (cqe->res > 0)
+                mChunks.push_back({(unsigned short)(cqe->flags >> IORING_CQE_BUFFER_SHIFT), 0,
+                                   (size_t)cqe->res});
+            // out of provided buffers, or the thread that armed it exited: the data waits in
+            // the socket until the receive is armed again
+            else if (cqe->res != -ENOBUFS && cqe->res != -ECANCELED)
+                mClosed = true;
+            if (!(cqe->flags & IORING_CQE_F_MORE)) mReceiveArmed = false;
+        } else {
+            mReceiveResult = cqe->res;
+            mReceivePending = false;
+        }
+        mpRing->SeenCqe();
+    }
+}
+
+void UringCommunicator::ReapSends() {
+    struct io_uring_cqe *cqe;
+    while ((cqe = mpSendRing->PeekCqe()) != nullptr) {
+        if (cqe->user_data < mResults.size()) {
+            mResults[cqe->user_data] = cqe->res;
+            mPending--;
+        }
+        mpSendRing->SeenCqe();
+    }
+}
+
+int UringCommunicator::GetFileDescriptor() const {
+    return mMultishot ? mpRing->GetFileDescriptor() : mSocketFd;
+}
+
+bool UringCommunicator::HasPendingInput() const {
+    if (mMultishot) return !mChunks.empty() || mClosed || mpRing->PeekCqe() != nullptr;
+    return mInputStart < mInputEnd;
+}
+
+size_t UringCommunicator::Read(char *buffer, size_t size) {
+    size_t done = 0;
+    if (!mMultishot) {
+        while (done < size) {
+            if (mInputStart < mInputEnd) {
+                size_t n = min(mInputEnd - mInputStart, size - done);
+                memcpy(buffer + done, mpInputBuffer.get() + mInputStart, n);
+                mInputStart += n;
+                done += n;
+            } else if (size - done >= URING_BUFFER_SIZE) {
+                // large reads skip the buffer
+                size_t n = Receive(buffer + done, size - done, false);
+                if (n == 0) return 0;
+                done += n;
+            } else {
+                mInputStart = 0;
+                mInputEnd = Receive(mpInputBuffer.get(), URING_BUFFER_SIZE, true);
+                if (mInputEnd == 0) return 0;
+            }
+        }
+        return size;
+    }
+
+    while (done < size) {
+        if (!mChunks.empty()) {
+            Chunk &chunk = mChunks.front();
+            size_t n = min(chunk.end - chunk.start, size - done);
+            memcpy(buffer + done,
+                   mpReceiveBuffers.get() + (size_t)chunk.bid * URING_BUFFER_SIZE + chunk.start, n);
+            chunk.start += n;
+            done += n;
+            if (chunk.start == chunk.end) {
+                mpRing->ProvideBuffer(chunk.bid);
+                mChunks.pop_front();
+            }
+            continue;
+        }
+        if (mClosed) return 0;
+        if (!mReceiveArmed) ArmReceive();
+        mpRing->Submit(1);
+        Reap();
+    }
+    // a receive stopped for lack of buffers must be armed again before the reactor waits
+    if (!mReceiveArmed && !mClosed && mChunks.empty()) {
+        ArmReceive();
+        mpRing->Submit();
+    }
+    return size;
+}
+
+size_t UringCommunicator::Receive(char *buffer, size_t size, bool fixed) {
+    while (true) {
+        struct io_uring_sqe *sqe = mpRing->GetSqe();
+        sqe->fd = mSocketFd;
+        sqe->addr = (unsigned long)buffer;
+        sqe->len = size;
+        if (fixed && mFixedReads) {
+            sqe->opcode = IORING_OP_READ_FIXED;
+            sqe->buf_index = 0;
+        } else {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->msg_flags = fixed ? 0 : MSG_WAITALL;
+        }
+        sqe->user_data = 0;
+        mReceivePending = true;
+        do {
+            mpRing->Submit(1);
+            Reap();
+        } while (mReceivePending);
+
+        int result = mReceiveResult;
+        if (result == -EINTR || result == -EAGAIN) continue;
+        // connection closed or broken
+        return result > 0 ? result : 0;
+    }
+}
+
+size_t UringCommunicator::Write(const char *buffer, size_t size) {
+    if (mOutputLength + size <= URING_BUFFER_SIZE) {
+        memcpy(mpOutputBuffer.get() + mOutputLength, buffer, size);
+        mOutputLength += size;
+    } else {
+        struct iovec iov = {(void *)buffer, size};
+        Flush(&iov, 1);
+    }
+    return size;
+}
+
+size_t UringCommunicator::Writev(const struct iovec *iov, int iovcnt) {
+    size_t size = 0;
+    for (int i = 0; i < iovcnt; i++) size += iov[i].iov_len;
+
+    if (mOutputLength + size <= URING_BUFFER_SIZE) {
+        for (int i = 0; i < iovcnt; i++) {
+            memcpy(mpOutputBuffer.get() + mOutputLength, iov[i].iov_base, iov[i].iov_len);
+            mOutputLength += iov[i].iov_len;
+        }
+    } else {
+        Flush(iov, iovcnt);
+    }
+    return size;
+}
+
+void UringCommunicator::Sync() { Flush(); }
+
+void UringCommunicator::Flush(const struct iovec *iov, int iovcnt) {
+    // the buffered data goes first; it is the only one in the fixed buffer
+    struct Segment {
+        struct iovec iov;
+        bool fixed;
+    };
+    vector<Segment> segments;
+    segments.reserve(iovcnt + 1);
+    if (mOutputLength > 0) segments.push_back({{mpOutputBuffer.get(), mOutputLength}, true});
+    for (int i = 0; i < iovcnt; i++)
+        if (iov[i].iov_len > 0) segments.push_back({iov[i], false});
+    mOutputLength = 0;
+
+    size_t first = 0;
+    while (first < segments.size()) {
+        // one chain of linked sends, in order, submitted and waited for by one io_uring_enter()
+        size_t count = min<size_t>(segments.size() - first, mpSendRing->GetSqeSpace());
+        mResults.assign(count, 0);
+        mPending = count;
+        for (size_t i = 0; i < count; i++) {
+            Segment &segment = segments[first + i];
+            struct io_uring_sqe *sqe = mpSendRing->GetSqe();
+            sqe->fd = mSocketFd;
+            sqe->addr = (unsigned long)segment.iov.iov_base;
+            sqe->len = segment.iov.iov_len;
+            if (segment.fixed && mFixedWrites) {
+                sqe->opcode = IORING_OP_WRITE_FIXED;
+                sqe->buf_index = 0;
+            } else {
+                sqe->opcode = IORING_OP_SEND;
+                sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+            }
+            if (i + 1 < count) sqe->flags = IOSQE_IO_LINK;
+            sqe->user_data = i;
+        }
+        do {
+            mpSendRing->Submit(mPending);
+            ReapSends();
+        } while (mPending > 0);
+
+        // a short send breaks the chain: resume from there
+        for (size_t i = 0; i < count; i++, first++) {
+            Segment &segment = segments[first];
+            int result = mResults[i];
+            if (result == (int)segment.iov.iov_len) continue;
+            if (result > 0) {
+                segment.iov.iov_base = (char *)segment.iov.iov_base + result;
+                segment.iov.iov_len -= result;
+            } else if (result != -ECANCELED && result != -EINTR && result != -EAGAIN) {
+                throw runtime_error("UringCommunicator: Can't write to socket: " +
+                                    string(strerror(-result)) + ".");
+            }
+            break;
+        }
+    }
+}
+
+void UringCommunicator::Close() {
+    // the pending requests are cancelled with the rings, before their buffers go away
+    mpRing.reset();
+    mpSendRing.reset();
+    if (mSocketFd >= 0) {
+        close(mSocketFd);
+        mSocketFd = -1;
+    }
+}
+
+extern "C" std::shared_ptr<UringCommunicator> create_communicator(
+    std::shared_ptr<gvirtus::communicators::Endpoint> end) {
+    auto endpoint = std::dynamic_pointer_cast<gvirtus::communicators::Endpoint_Tcp>(end);
+    return std::make_shared<UringCommunicator>(endpoint->address().c_str(), endpoint->port());
+}
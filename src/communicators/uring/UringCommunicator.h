@@ -0,0 +1,113 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "IoUring.h"
+#include "gvirtus/communicators/Communicator.h"
+
+/* size of the registered buffers coalescing small reads and writes */
+#define URING_BUFFER_SIZE (64 * 1024)
+/* provided buffers the backend receives into */
+#define URING_RECV_BUFFERS 16
+
+namespace gvirtus::communicators {
+/**
+ * UringCommunicator implements a Communicator for the TCP/IP socket on top
+ * of io_uring, for backends serving many concurrent frontends; it is chosen
+ * with "protocol": "uring" in a "tcp/ip" endpoint.
+ *
+ * Like the TcpCommunicator, small writes are coalesced until Sync(), here in
+ * a registered (fixed) buffer; Sync() posts it, together with the large
+ * writes sent from the memory of the caller, as a chain of linked requests in
+ * a single io_uring_enter(), so a request or a result costs one system call
+ * whatever the number of Write() that produced it.
+ *
+ * The connections accepted by the backend keep a multishot receive armed on
+ * a ring of provided buffers: the data arrives with no request submitted, and
+ * GetFileDescriptor() returns the io_uring, which becomes readable with it,
+ * so a Read() usually makes no system call at all. The frontend, which waits
+ * for each result, receives with one request per Read() into its fixed
+ * buffer, or straight into the destination for the large ones.
+ *
+ * The sends have a ring of their own, so a thread can write while another
+ * one is reading.
+ */
+class UringCommunicator : public Communicator {
+   public:
+    UringCommunicator(const char *hostname, short port);
+    virtual ~UringCommunicator();
+    void Serve();
+    const Communicator *const Accept() const;
+    void Connect();
+    size_t Read(char *buffer, size_t size);
+    size_t Write(const char *buffer, size_t size);
+    size_t Writev(const struct iovec *iov, int iovcnt) override;
+    void Sync();
+    void Close();
+    int GetFileDescriptor() const override;
+    bool HasPendingInput() const override;
+    bool IsFullDuplex() const override { return true; }
+
+    std::string to_string() override { return "uringcommunicator"; }
+
+   private:
+    explicit UringCommunicator(int fd);
+    void InitializeRing(bool multishot);
+    void ArmReceive();
+    /**
+     * Handles the completions of the receive ring available, without waiting.
+     */
+    void Reap();
+    /**
+     * Handles the completions of the send ring available, without waiting.
+     */
+    void ReapSends();
+    /**
+     * Receives once, in the frontend.
+     *
+     * @return the bytes received, 0 if the connection was closed.
+     */
+    size_t Receive(char *buffer, size_t size, bool fixed);
+    void Flush(const struct iovec *iov = nullptr, int iovcnt = 0);
+
+    std::string mHostname;
+    short mPort = 0;
+    int mSocketFd = -1;
+    /* the receives, and the sends */
+    std::unique_ptr<IoUring> mpRing;
+    std::unique_ptr<IoUring> mpSendRing;
+    /* the input buffer is received with READ_FIXED */
+    bool mFixedReads = false;
+    /* the output buffer is sent with WRITE_FIXED */
+    bool mFixedWrites = false;
+
+    /* registered as fixed buffer 0 of the send ring */
+    std::unique_ptr<char[]> mpOutputBuffer;
+    size_t mOutputLength = 0;
+    /* registered as fixed buffer 0 of the receive ring, filled by the frontend receives */
+    std::unique_ptr<char[]> mpInputBuffer;
+    size_t mInputStart = 0;
+    size_t mInputEnd = 0;
+
+    /* the backend side: the multishot receive and its provided buffers */
+    bool mMultishot = false;
+    bool mReceiveArmed = false;
+    bool mClosed = false;
+    std::unique_ptr<char[]> mpReceiveBuffers;
+    struct Chunk {
+        unsigned short bid;
+        size_t start;
+        size_t end;
+    };
+    std::deque<Chunk> mChunks;
+
+    /* result of the single receive in flight */
+    int mReceiveResult = 0;
+    bool mReceivePending = false;
+    /* results of the sends in flight, by index */
+    std::vector<int> mResults;
+    size_t mPending = 0;
+};
+}  // namespace gvirtus::communicators
@@ -0,0 +1,584 @@
+#include <gvirtus/common/LD_Lib.h>
+#include <gvirtus/communicators/CommunicatorFactory.h>
+#include <gvirtus/communicators/EndpointFactory.h>
+#include <gvirtus/communicators/Endpoint_Tcp.h>
+#include <gvirtus/communicators/Protocol.h>
+#include <gvirtus/communicators/StripedCommunicator.h>
+#include <gvirtus/frontend/Connection.h>
+#include <pthread.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "log4cplus/logger.h"
+#include "log4cplus/loggingmacros.h"
+
+using gvirtus::common::LD_Lib;
+using gvirtus::communicators::Buffer;
+using gvirtus::communicators::BulkLane;
+using gvirtus::communicators::Communicator;
+using gvirtus::communicators::CommunicatorFactory;
+using gvirtus::communicators::Compressor;
+using gvirtus::communicators::Endpoint;
+using gvirtus::communicators::EndpointFactory;
+using gvirtus::communicators::Endpoint_Tcp;
+using gvirtus::communicators::Hello;
+using gvirtus::communicators::RequestHeader;
+using gvirtus::communicators::ResponseHeader;
+using gvirtus::communicators::StripedCommunicator;
+using gvirtus::frontend::Connection;
+
+#define DEFAULT_CONNECTIONS 4
+
+extern log4cplus::Logger logger;
+extern std::string getEnvVar(std::string const &key);
+
+/* the backend and the libraries of its communicators, resolved once per process */
+struct Configuration {
+    std::shared_ptr<Endpoint> endpoint;
+    std::shared_ptr<LD_Lib<Communicator, std::shared_ptr<Endpoint>>> library;
+    /* the AF_UNIX endpoint of a backend on this host, nullptr if none */
+    std::shared_ptr<Endpoint> local_endpoint;
+    std::shared_ptr<LD_Lib<Communicator, std::shared_ptr<Endpoint>>> local_library;
+    /* connections the bulk lanes are striped over, see Endpoint_Tcp::stripes() */
+    unsigned stripes = 1;
+};
+
+/* The connections shared by the threads, see Connection::Acquire(). They are
+ * never destroyed by the static destructors: a connection may still be
+ * opened in advance while exiting. */
+struct Pool {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::shared_ptr<Connection>> connections;
+    /* a connection opened in advance that can't be shared (not full duplex) */
+    std::shared_ptr<Connection> spare;
+    /* true while a connection is being opened: one at a time */
+    bool connecting = false;
+    /* open the next connection before a thread needs it, see GVIRTUS_PRECONNECT */
+    bool preconnect = false;
+    bool released = false;
+};
+
+/* identifies the connections of this process to the backend, see Hello; 0 until the first one */
+static std::atomic<uint64_t> gClientId{0};
+
+static uint64_t getClientId() {
+    uint64_t id = gClientId.load();
+    if (id != 0) return id;
+    // not guessable: the backend gives the kernels of the process to the connections with it
+    std::random_device source;
+    do {
+        id = ((uint64_t)source() << 32) | source();
+    } while (id == 0);
+    uint64_t unset = 0;
+    return gClientId.compare_exchange_strong(unset, id) ? id : unset;
+}
+
+static bool getEnvFlag(const char *key) {
+    auto env = getenv(key);
+    return env && (strcasecmp(env, "on") == 0 || strcasecmp(env, "true") == 0 ||
+                   strcmp(env, "1") == 0);
+}
+
+/* the compression codecs offered to the backend, see GVIRTUS_COMPRESSION */
+static uint64_t getCompressionCapabilities(bool local) {
+    std::string value = getEnvVar("GVIRTUS_COMPRESSION");
+    uint64_t codecs = Compressor::GetCapabilities();
+    if (strcasecmp(value.c_str(), "zstd") == 0)
+        return codecs & gvirtus::communicators::CAPABILITY_COMPRESSION_ZSTD;
+    if (strcasecmp(value.c_str(), "lz4") == 0 || getEnvFlag("GVIRTUS_COMPRESSION"))
+        return codecs & gvirtus::communicators::CAPABILITY_COMPRESSION_LZ4;
+    // by default only remote backends: nothing compresses faster than a local link
+    if (value.empty() || strcasecmp(value.c_str(), "auto") == 0)
+        return local ? 0 : codecs & gvirtus::communicators::CAPABILITY_COMPRESSION_LZ4;
+    return 0;
+}
+
+static Configuration *loadConfiguration() {
+    // Get the GVIRTUS_CONFIG environment varibale
+    std::string config_path = getEnvVar("GVIRTUS_CONFIG");
+
+    // Check if the configuration file is defined
+    if (config_path.empty()) {
+        // Check if the configuration file is in the GVIRTUS_HOME directory
+        config_path = getEnvVar("GVIRTUS_HOME") + "/etc/properties.json";
+        if (config_path.empty()) {
+            // Finally consider the current directory
+            config_path = "./properties.json";
+        }
+    }
+
+    LOG4CPLUS_INFO(logger, "Using properties file: " + config_path);
+
+    auto configuration = std::make_unique<Configuration>();
+    configuration->endpoint = EndpointFactory::get_endpoint(config_path);
+    configuration->library = CommunicatorFactory::get_library(configuration->endpoint);
+
+    // a backend on this host is reached through its AF_UNIX socket, if it has one
+    auto tcp = std::dynamic_pointer_cast<Endpoint_Tcp>(configuration->endpoint);
+    if (tcp != nullptr) configuration->stripes = tcp->stripes();
+    if (tcp != nullptr && tcp->is_local() &&
+        (configuration->local_endpoint =
+             CommunicatorFactory::get_local_endpoint(configuration->endpoint)) != nullptr) {
+        try {
+            configuration->local_library =
+                CommunicatorFactory::get_library(configuration->local_endpoint);
+        } catch (const std::exception &e) {
+            LOG4CPLUS_DEBUG(logger, "No AF_UNIX communicator: " << e.what());
+            configuration->local_endpoint = nullptr;
+        }
+    }
+    return configuration.release();
+}
+
+/* a failure is not cached: the next connection tries again */
+static const Configuration &getConfiguration() {
+    static const Configuration *configuration = loadConfiguration();
+    return *configuration;
+}
+
+static Pool &getPool() {
+    static Pool *pool = [] {
+        // the connections belong to the parent: closing them would end its sessions
+        pthread_atfork([] { getPool().mutex.lock(); }, [] { getPool().mutex.unlock(); },
+                       [] {
+                           Pool &pool = getPool();
+                           for (auto &connection : pool.connections)
+                               new std::shared_ptr<Connection>(connection);
+                           if (pool.spare != nullptr) new std::shared_ptr<Connection>(pool.spare);
+                           pool.connections.clear();
+                           pool.spare = nullptr;
+                           pool.connecting = false;
+                           // the child is another client of the backend
+                           gClientId = 0;
+                           pool.mutex.unlock();
+                       });
+        return new Pool();
+    }();
+    return *pool;
+}
+
+static size_t getMaxConnections() {
+    std::string value = getEnvVar("GVIRTUS_CONNECTIONS");
+    if (value.empty()) return DEFAULT_CONNECTIONS;
+    return std::max(1ul, strtoul(value.c_str(), NULL, 10));
+}
+
+Connection::Connection() {
+    const Configuration &configuration = getConfiguration();
+    bool local = false;
+
+    if (configuration.local_library != nullptr) {
+        try {
+            _communicator = configuration.local_library->create(configuration.local_endpoint);
+            _communicator->Connect();
+            local = true;
+            LOG4CPLUS_DEBUG(logger, "Connected to the local backend through AF_UNIX");
+        } catch (const std::exception &e) {
+            _communicator = nullptr;
+        }
+    }
+    if (_communicator == nullptr) {
+        _communicator = configuration.library->create(configuration.endpoint);
+        _communicator->Connect();
+    }
+    mpCommunicator = _communicator.get();
+    mLocal = local;
+    Handshake(local);
+}
+
+Connection::Connection(std::shared_ptr<Communicator> communicator, bool local) {
+    _communicator = std::move(communicator);
+    mpCommunicator = _communicator.get();
+    mLocal = local;
+    Handshake(local);
+}
+
+Connection::~Connection() {
+    if (getEnvFlag("GVIRTUS_DUMP_STATS") && mpCompressor != nullptr &&
+        mpCompressor->GetCompressedBytes() > 0) {
+        std::cerr << "[GVIRTUS_STATS] Compressed "
+                  << mpCompressor->GetCompressedBytes() / (1024 * 1024.0) << " Mb(s) into "
+                  << mpCompressor->GetWrittenBytes() / (1024 * 1024.0) << " Mb(s)\n";
+    }
+}
+
+/* Opens a connection on a thread of its own if no thread could take one
+ * without waiting. The pool is locked. */
+static void prepareConnection(Pool &pool) {
+    if (!pool.preconnect || pool.released || pool.connecting || pool.spare != nullptr ||
+        pool.connections.size() >= getMaxConnections())
+        return;
+    for (auto &connection : pool.connections)
+        if (connection.use_count() == 1) return;
+
+    pool.connecting = true;
+    std::thread([&pool] {
+        std::shared_ptr<Connection> connection;
+        try {
+            connection = std::make_shared<Connection>();
+        } catch (const std::exception &e) {
+            LOG4CPLUS_DEBUG(logger, "Can't connect in advance: " << e.what());
+        }
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.connecting = false;
+        pool.changed.notify_all();
+        if (connection == nullptr) return;
+        if (pool.released)
+            new std::shared_ptr<Connection>(connection);  // exiting: nothing is destroyed anymore
+        else if (connection->IsFullDuplex())
+            pool.connections.push_back(connection);
+        else
+            pool.spare = connection;
+    }).detach();
+}
+
+std::shared_ptr<Connection> Connection::Acquire() {
+    Pool &pool = getPool();
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    size_t max_connections = getMaxConnections();
+
+    while (true) {
+        // the broken connections are left to the threads using them
+        std::erase_if(pool.connections, [](const std::shared_ptr<Connection> &connection) {
+            std::lock_guard<std::mutex> lock(connection->mMutex);
+            return !connection->mError.empty();
+        });
+        if (pool.spare != nullptr) {
+            auto connection = std::move(pool.spare);
+            pool.spare = nullptr;
+            prepareConnection(pool);
+            return connection;
+        }
+
+        // the Frontends using a connection hold it besides the pool
+        std::shared_ptr<Connection> *least_used = nullptr;
+        for (auto &connection : pool.connections)
+            if (least_used == nullptr || connection.use_count() < least_used->use_count())
+                least_used = &connection;
+        if (least_used != nullptr &&
+            (least_used->use_count() == 1 || pool.connections.size() >= max_connections)) {
+            auto connection = *least_used;
+            prepareConnection(pool);
+            return connection;
+        }
+        // the connection being opened is as good as a new one
+        if (!pool.connecting) break;
+        pool.changed.wait(lock);
+    }
+
+    pool.connecting = true;
+    lock.unlock();
+    std::shared_ptr<Connection> connection;
+    try {
+        connection = std::make_shared<Connection>();
+    } catch (const std::exception &e) {
+        lock.lock();
+        pool.connecting = false;
+        pool.changed.notify_all();
+        throw;
+    }
+    lock.lock();
+    pool.connecting = false;
+    pool.changed.notify_all();
+    if (connection->IsFullDuplex()) pool.connections.push_back(connection);
+    prepareConnection(pool);
+    return connection;
+}
+
+void Connection::Preconnect() {
+    std::string value = getEnvVar("GVIRTUS_PRECONNECT");
+    if (value == "off" || value == "false" || value == "0") return;
+    try {
+        // the libraries are loaded here, not by the thread connecting
+        getConfiguration();
+    } catch (const std::exception &e) {
+        LOG4CPLUS_DEBUG(logger, "Not connecting in advance: " << e.what());
+        return;
+    }
+    Pool &pool = getPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.preconnect = true;
+    prepareConnection(pool);
+}
+
+void Connection::Release() {
+    Pool &pool = getPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.released = true;
+    pool.connections.clear();
+    pool.spare = nullptr;
+}
+
+void Connection::Handshake(bool local) {
+    Hello hello;
+    hello.magic = GVIRTUS_PROTOCOL_MAGIC;
+    hello.version = GVIRTUS_PROTOCOL_VERSION;
+    hello.capabilities = communicators::SUPPORTED_CAPABILITIES | getCompressionCapabilities(local);
+    hello.client_id = getClientId();
+    // a connection that is not shared by the threads has nothing to hold up
+    std::string bulk_lane = getEnvVar("GVIRTUS_BULK_LANE");
+    if (!mpCommunicator->IsFullDuplex() || strcasecmp(bulk_lane.c_str(), "off") == 0 ||
+        strcasecmp(bulk_lane.c_str(), "false") == 0 || bulk_lane == "0")
+        hello.capabilities &= ~communicators::CAPABILITY_BULK_LANE;
+    mpCommunicator->Write((char *)&hello, sizeof(hello));
+    mpCommunicator->Sync();
+
+    if (mpCommunicator->Read((char *)&hello, sizeof(hello)) != sizeof(hello))
+        throw std::runtime_error("Handshake failed: connection closed by the backend");
+    if (hello.magic != GVIRTUS_PROTOCOL_MAGIC || hello.version != GVIRTUS_PROTOCOL_VERSION)
+        throw std::runtime_error("Handshake failed: unsupported backend protocol version " +
+                                 std::to_string(hello.version));
+    mCapabilities = hello.capabilities;
+    mpCompressor = Compressor::Create(mCapabilities);
+    mpDecompressor = Compressor::Create(mCapabilities);
+
+    Buffer routines;
+    routines.Reset(mpCommunicator);
+    size_t count = routines.Get<size_t>();
+    mRoutineIds.clear();
+    for (size_t i = 0; i < count; i++) mRoutineIds.emplace(routines.AssignString(), i);
+    if (mCapabilities & communicators::CAPABILITY_BULK_LANE) {
+        mToken = routines.Get<uint64_t>();
+        // striping pays off on the network, not on the AF_UNIX socket of this host
+        mStripes = local ? 1
+                         : std::min<unsigned>(getConfiguration().stripes,
+                                              std::max<uint32_t>(routines.Get<uint32_t>(), 1));
+    }
+
+    LOG4CPLUS_DEBUG(logger, "Handshake completed: " << count << " routine(s), capabilities "
+                                                    << std::hex << mCapabilities << std::dec);
+}
+
+std::shared_ptr<Communicator> Connection::OpenBulkLane(uint64_t session_id) {
+    if (!(mCapabilities & communicators::CAPABILITY_BULK_LANE)) return nullptr;
+    const Configuration &configuration = getConfiguration();
+    // opened one after the other: the backend answers the last one once it has them all
+    std::vector<std::shared_ptr<Communicator>> stripes;
+    for (uint32_t stripe = 0; stripe < mStripes; stripe++) {
+        std::shared_ptr<Communicator> bulk_lane =
+            mLocal ? configuration.local_library->create(configuration.local_endpoint)
+                   : configuration.library->create(configuration.endpoint);
+        bulk_lane->Connect();
+
+        Hello hello = {GVIRTUS_BULK_LANE_MAGIC, GVIRTUS_PROTOCOL_VERSION, 0, getClientId()};
+        BulkLane request = {mToken, session_id, stripe, mStripes};
+        bulk_lane->Write((char *)&hello, sizeof(hello));
+        bulk_lane->Write((char *)&request, sizeof(request));
+        bulk_lane->Sync();
+        if (bulk_lane->Read((char *)&hello, sizeof(hello)) != sizeof(hello) ||
+            !(hello.capabilities & communicators::CAPABILITY_BULK_LANE))
+            throw std::runtime_error("The backend refused the bulk lane");
+        stripes.push_back(bulk_lane);
+    }
+    LOG4CPLUS_DEBUG(logger, "Opened the bulk lane of session " << session_id << " over "
+                                                               << mStripes << " stripe(s)");
+    if (mStripes == 1) return stripes.front();
+    return std::make_shared<StripedCommunicator>(std::move(stripes));
+}
+
+bool Connection::GetRoutineId(const char *routine, uint32_t &routine_id) const {
+    auto it = mRoutineIds.find(routine);
+    if (it == mRoutineIds.end()) return false;
+    routine_id = it->second;
+    return true;
+}
+
+uint64_t Connection::Send(uint64_t session_id, uint32_t routine_id, uint32_t flags,
+                          const Buffer *input_buffer, Call *call, const void *transfer,
+                          size_t transfer_size) {
+    std::unique_lock<std::mutex> write_lock(mWriteMutex);
+    RequestHeader header;
+    header.routine_id = routine_id;
+    header.flags = flags;
+    header.request_id = mNextRequestId++;
+    header.session_id = session_id;
+    header.payload_size = input_buffer != nullptr ? input_buffer->GetBufferSize() : 0;
+    header.transfer_size = transfer != nullptr ? transfer_size : 0;
+    Communicator *bulk_lane = call != nullptr ? call->bulk_lane : nullptr;
+    if (header.transfer_size > 0 && bulk_lane != nullptr)
+        header.flags |= communicators::REQUEST_BULK_LANE;
+    {
+        // registered before sending: the response may be read by another thread at once
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mError.empty()) throw std::runtime_error(mError);
+        if (call != nullptr) {
+            call->received = false;
+            mCalls[header.request_id] = call;
+        }
+    }
+
+    try {
+        bool compressed =
+            mpCompressor != nullptr && mpCompressor->ShouldCompress(header.payload_size);
+        if (compressed) header.flags |= communicators::REQUEST_COMPRESSED;
+        mpCommunicator->Write((char *)&header, sizeof(header));
+        if (mpCompressor != nullptr && header.payload_size > 0) {
+            mpCompressor->Write(mpCommunicator, input_buffer, compressed);
+        } else {
+            if (header.payload_size > 0) input_buffer->WriteTo(mpCommunicator);
+            mpCommunicator->Sync();
+        }
+        if (header.transfer_size > 0 && bulk_lane == nullptr) {
+            // never compressed: the backend takes it in chunks as it arrives
+            mpCommunicator->Write((const char *)transfer, header.transfer_size);
+            mpCommunicator->Sync();
+        }
+    } catch (const std::exception &e) {
+        Fail(e.what());
+        throw;
+    }
+    write_lock.unlock();
+
+    // the other threads keep sending their requests meanwhile
+    if (header.flags & communicators::REQUEST_BULK_LANE) {
+        try {
+            bulk_lane->Write((const char *)transfer, header.transfer_size);
+            bulk_lane->Sync();
+        } catch (const std::exception &e) {
+            Fail(e.what());
+            throw;
+        }
+    }
+    return header.request_id;
+}
+
+void Connection::EndSession(uint64_t session_id) {
+    try {
+        Send(session_id, 0, communicators::REQUEST_END_SESSION, nullptr, nullptr);
+    } catch (const std::exception &e) {
+        LOG4CPLUS_DEBUG(logger, "Can't end session " << session_id << ": " << e.what());
+    }
+}
+
+/* Reads an uncompressed payload from c into output, or the array it holds
+ * into dst if dst_size bytes long. It returns true in the latter case. */
+static bool readPayload(Communicator *c, uint64_t payload_size, Buffer *output, void *dst,
+                        size_t dst_size) {
+    if (dst != nullptr && payload_size == sizeof(size_t) + dst_size) {
+        // the size of the array, then the array itself straight into dst
+        output->Read<size_t>(c, 1);
+        if (*(const size_t *)output->GetBuffer() == dst_size) {
+            if (dst_size > 0 && c->Read((char *)dst, dst_size) != dst_size)
+                throw std::runtime_error("Connection closed by the backend");
+            return true;
+        }
+        output->Read<char>(c, dst_size);
+    } else if (payload_size > 0) {
+        output->Read<char>(c, payload_size);
+    }
+    return false;
+}
+
+void Connection::Receive(Call *call) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!call->received) {
+        if (!mError.empty()) throw std::runtime_error(mError);
+        if (mReading) {
+            mReceived.wait(lock);
+            continue;
+        }
+        // this thread reads until its own response arrives, then another waiting one takes over
+        mReading = true;
+        lock.unlock();
+        Call *received;
+        try {
+            received = ReadResponse();
+        } catch (const std::exception &e) {
+            lock.lock();
+            mReading = false;
+            lock.unlock();
+            Fail(e.what());
+            throw;
+        }
+        lock.lock();
+        if (received != nullptr) received->received = true;
+        mReading = false;
+        mReceived.notify_all();
+    }
+    if (call->bulk_payload) {
+        // read by the thread collecting the result (the session's, or one synchronizing the
+        // stream of its output, see Frontend::SynchronizeOutputs()) while the others keep
+        // reading the connection
+        call->bulk_payload = false;
+        lock.unlock();
+        call->dst_received = readPayload(call->bulk_lane, call->payload_size, call->output,
+                                         call->dst, call->dst_size);
+    }
+}
+
+Connection::Call *Connection::ReadResponse() {
+    ResponseHeader header;
+    if (mpCommunicator->Read((char *)&header, sizeof(header)) != sizeof(header))
+        throw std::runtime_error("Connection closed by the backend");
+
+    Call *call = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mCalls.find(header.request_id);
+        if (it != mCalls.end()) {
+            call = it->second;
+            mCalls.erase(it);
+        }
+    }
+    Buffer discarded;
+    Buffer *output = &discarded;
+    void *dst = nullptr;
+    size_t dst_size = 0;
+    if (call != nullptr) {
+        call->exit_code = header.exit_code;
+        call->time_taken = header.time_taken;
+        call->payload_size = header.payload_size;
+        call->dst_received = false;
+        output = call->output;
+        dst = call->dst;
+        dst_size = call->dst_size;
+    } else {
+        LOG4CPLUS_WARN(logger, "Unexpected result for request " << header.request_id);
+    }
+
+    LOG4CPLUS_DEBUG(logger, "Output buffer size: " << header.payload_size);
+    if (header.flags & communicators::RESPONSE_BULK_LANE) {
+        if (call == nullptr || call->bulk_lane == nullptr)
+            throw std::runtime_error("Unexpected result on the bulk lane");
+        call->bulk_payload = true;
+    } else if (header.flags & communicators::RESPONSE_COMPRESSED) {
+        if (mpDecompressor == nullptr) throw std::runtime_error("Unexpected compressed result");
+        struct iovec iov[2];
+        if (dst != nullptr && header.payload_size == sizeof(size_t) + dst_size) {
+            // as below, but the blocks may span the size of the array: dst is written only once
+            // it is known to be the whole output
+            mDecompressed.resize(dst_size);
+            iov[0] = {output->Extend(sizeof(size_t)), sizeof(size_t)};
+            iov[1] = {mDecompressed.data(), dst_size};
+            mpDecompressor->Read(mpCommunicator, header.payload_size, iov, 2);
+            if (*(const size_t *)output->GetBuffer() == dst_size) {
+                memcpy(dst, mDecompressed.data(), dst_size);
+                call->dst_received = true;
+            } else {
+                memcpy(output->Extend(dst_size), mDecompressed.data(), dst_size);
+            }
+        } else {
+            iov[0] = {output->Extend(header.payload_size), header.payload_size};
+            mpDecompressor->Read(mpCommunicator, header.payload_size, iov, 1);
+        }
+    } else if (readPayload(mpCommunicator, header.payload_size, output, dst, dst_size)) {
+        call->dst_received = true;
+    }
+    return call;
+}
+
+void Connection::Fail(const std::string &error) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mError.empty()) mError = error;
+    mCalls.clear();
+    mReceived.notify_all();
+}
@@ -0,0 +1,21 @@
+#include <gvirtus/frontend/DeferredExitCodes.h>
+
+using gvirtus::frontend::DeferredExitCodes;
+
+std::string DeferredExitCodes::Family(const char *routine) {
+    const char *end = routine;
+    while (*end >= 'a' && *end <= 'z') end++;
+    return std::string(routine, end - routine);
+}
+
+void DeferredExitCodes::Set(const std::string &family, int exit_code) {
+    if (exit_code != 0) mExitCodes.emplace(family, exit_code);
+}
+
+int DeferredExitCodes::Get(const std::string &family, bool reset) {
+    auto it = mExitCodes.find(family);
+    if (it == mExitCodes.end()) return 0;
+    int exit_code = it->second;
+    if (reset) mExitCodes.erase(it);
+    return exit_code;
+}
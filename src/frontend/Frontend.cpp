@@ -33,8 +33,8 @@
  *            Department of Computer Science, University College Dublin
  */
 
-#include <gvirtus/communicators/CommunicatorFactory.h>
 #include <gvirtus/communicators/EndpointFactory.h>
+#include <gvirtus/communicators/Protocol.h>
 #include <gvirtus/frontend/Frontend.h>
 #include <pthread.h>
 #include <stdlib.h> /* getenv */
@@ -42,9 +42,12 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <iostream>
 #include <mutex>
+#include <thread>
 
 #include "log4cplus/configurator.h"
 #include "log4cplus/logger.h"
@@ -53,10 +56,10 @@
 using namespace std;
 using namespace log4cplus;
 
+using gvirtus::communicators::Batch;
 using gvirtus::communicators::Buffer;
 using gvirtus::communicators::Communicator;
-using gvirtus::communicators::CommunicatorFactory;
-using gvirtus::communicators::EndpointFactory;
+using gvirtus::frontend::Connection;
 using gvirtus::frontend::Frontend;
 
 using std::chrono::steady_clock;
@@ -64,7 +67,27 @@ using std::chrono::steady_clock;
 static Frontend msFrontend;
 std::mutex gFrontendMutex;
 map<pthread_t, Frontend *> *Frontend::mpFrontends = NULL;
+thread_local Frontend *Frontend::mspCurrent = nullptr;
+static pthread_key_t gFrontendKey;
+static pthread_once_t gFrontendOnce = PTHREAD_ONCE_INIT;
 static bool initialized = false;
+/* the session of each Frontend */
+static std::atomic<uint64_t> gNextSessionId{1};
+/* wakes the flusher thread up when a batch is queued, see Frontend::FlushOldBatches() */
+static std::mutex gFlusherMutex;
+static std::condition_variable gFlusherCondition;
+static bool gFlusherStarted = false;
+static bool gBatchQueued = false;
+
+/* Results of asynchronous executions that can be left unread before reading
+ * them: this keeps the backend from blocking on a full socket. */
+#define DEFAULT_MAX_PENDING_RESULTS 256
+
+/* Thresholds for sending the batch of queued asynchronous routines. */
+#define DEFAULT_BATCH_MAX_ROUTINES 64
+#define DEFAULT_BATCH_MAX_SIZE (64 * 1024)
+#define DEFAULT_BATCH_MAX_AGE 1000 /* microseconds */
+#define DEFAULT_TRANSFER_THRESHOLD (4 << 20)
 
 Logger logger;
 
@@ -73,63 +96,66 @@ std::string getEnvVar(std::string const &key) {
     return (env_var == nullptr) ? std::string("") : std::string(env_var);
 }
 
-void Frontend::Init(Communicator *c) {
-    // Logger configuration
-    BasicConfigurator basicConfigurator;
-    basicConfigurator.configure();
-
-    // Set the logging level
-    std::string logLevelString = getEnvVar("GVIRTUS_LOGLEVEL");
-    LogLevel logLevel = INFO_LOG_LEVEL;
-    if (!logLevelString.empty()) {
-        try {
-            logLevel = static_cast<LogLevel>(std::stoi(logLevelString));
-        } catch (const std::exception &e) {
-            std::cerr << "[GVIRTUS WARNING] Invalid GVIRTUS_LOGLEVEL value: '" << logLevelString
-                      << "'. Using default INFO_LOG_LEVEL. (" << e.what() << ")\n";
-            logLevel = INFO_LOG_LEVEL;
-        }
-    }
-
-    Logger root = Logger::getRoot();
-    root.setLogLevel(logLevel);
-
-    logger = Logger::getInstance(LOG4CPLUS_TEXT("Frontend"));
-
-    pid_t tid = syscall(SYS_gettid);
+static bool getEnvFlag(const char *key) {
+    auto env = getenv(key);
+    return env && (strcasecmp(env, "on") == 0 || strcasecmp(env, "true") == 0 ||
+                   strcmp(env, "1") == 0);
+}
 
-    // Get the GVIRTUS_CONFIG environment varibale
-    std::string config_path = getEnvVar("GVIRTUS_CONFIG");
+static size_t getEnvSize(const char *key, size_t default_value) {
+    std::string value = getEnvVar(key);
+    if (value.empty()) return default_value;
+    try {
+        return std::stoul(value);
+    } catch (const std::exception &e) {
+        LOG4CPLUS_WARN(logger, "Invalid " << key << " value: '" << value << "'. Using default "
+                                          << default_value << ".");
+    }
+    return default_value;
+}
 
-    // Check if the configuration file is defined
-    if (config_path.empty()) {
-        // Check if the configuration file is in the GVIRTUS_HOME directory
-        config_path = getEnvVar("GVIRTUS_HOME") + "/etc/properties.json";
-        if (config_path.empty()) {
-            // Finally consider the current directory
-            config_path = "./properties.json";
+/* configures log4cplus for the whole process, once */
+static void configureLogging() {
+    static std::once_flag configured;
+    std::call_once(configured, [] {
+        // Logger configuration
+        BasicConfigurator basicConfigurator;
+        basicConfigurator.configure();
+
+        // Set the logging level
+        std::string logLevelString = getEnvVar("GVIRTUS_LOGLEVEL");
+        LogLevel logLevel = INFO_LOG_LEVEL;
+        if (!logLevelString.empty()) {
+            try {
+                logLevel = static_cast<LogLevel>(std::stoi(logLevelString));
+            } catch (const std::exception &e) {
+                std::cerr << "[GVIRTUS WARNING] Invalid GVIRTUS_LOGLEVEL value: '"
+                          << logLevelString << "'. Using default INFO_LOG_LEVEL. (" << e.what()
+                          << ")\n";
+                logLevel = INFO_LOG_LEVEL;
+            }
         }
-    }
 
-    std::unique_ptr<char> default_endpoint;
+        Logger root = Logger::getRoot();
+        root.setLogLevel(logLevel);
 
-    // no frontend found
-    {
-        std::lock_guard<std::mutex> lock(gFrontendMutex);
-        if (mpFrontends->find(tid) == mpFrontends->end()) {
-            Frontend *f = new Frontend();
-            mpFrontends->insert(make_pair(tid, f));
-        }
+        logger = Logger::getInstance(LOG4CPLUS_TEXT("Frontend"));
+    });
+}
+
+/* the first connection is opened while the application starts up, see Connection::Preconnect() */
+static struct Preconnect {
+    Preconnect() {
+        configureLogging();
+        Connection::Preconnect();
     }
+} gPreconnect;
 
-    LOG4CPLUS_INFO(logger, "Using properties file: " + config_path);
+void Frontend::Init(Communicator *c) {
+    configureLogging();
 
     try {
-        auto endpoint = EndpointFactory::get_endpoint(config_path);
-
-        mpFrontends->find(tid)->second->_communicator =
-            CommunicatorFactory::get_communicator(endpoint);
-        mpFrontends->find(tid)->second->_communicator->obj_ptr()->Connect();
+        mpConnection = Connection::Acquire();
     } catch (const std::exception &e) {
         LOG4CPLUS_FATAL(logger, fs::path(__FILE__).filename()
                                     << ":" << __LINE__ << ":"
@@ -137,115 +163,162 @@ void Frontend::Init(Communicator *c) {
         exit(EXIT_FAILURE);
     }
 
-    mpFrontends->find(tid)->second->mpInputBuffer = std::make_shared<Buffer>();
-    mpFrontends->find(tid)->second->mpOutputBuffer = std::make_shared<Buffer>();
-    mpFrontends->find(tid)->second->mpLaunchBuffer = std::make_shared<Buffer>();
-    mpFrontends->find(tid)->second->mExitCode = -1;
-    mpFrontends->find(tid)->second->mpInitialized = true;
+    mSessionId = gNextSessionId++;
+    mpInputBuffer = std::make_shared<Buffer>();
+    mpOutputBuffer = std::make_shared<Buffer>();
+    mpLaunchBuffer = std::make_shared<Buffer>();
+    mExitCode = -1;
+    mAsync = getEnvFlag("GVIRTUS_ASYNC");
+    mMaxPendingResults = getEnvSize("GVIRTUS_ASYNC_MAX_PENDING", DEFAULT_MAX_PENDING_RESULTS);
+    mpBatch = std::make_shared<Batch>();
+    mBatchMaxRoutines = getEnvSize("GVIRTUS_BATCH_MAX_ROUTINES", DEFAULT_BATCH_MAX_ROUTINES);
+    mBatchMaxSize = getEnvSize("GVIRTUS_BATCH_MAX_SIZE", DEFAULT_BATCH_MAX_SIZE);
+    mBatchMaxAge = getEnvSize("GVIRTUS_BATCH_MAX_AGE", DEFAULT_BATCH_MAX_AGE);
+    mTransferThreshold = getEnvSize("GVIRTUS_TRANSFER_THRESHOLD", DEFAULT_TRANSFER_THRESHOLD);
+    if (mTransferThreshold == 0) mTransferThreshold = SIZE_MAX;
+    mpInitialized = true;
 }
 
 Frontend::~Frontend() {
-    static bool destroying = false;
-    if (destroying || mpFrontends == nullptr) return;
-    destroying = true;
-
-    std::lock_guard<std::mutex> lock(gFrontendMutex);
-    {
-        pid_t tid = syscall(SYS_gettid);
-
-        auto env = getenv("GVIRTUS_DUMP_STATS");
-        bool dump_stats = env && (strcasecmp(env, "on") == 0 || strcasecmp(env, "true") == 0 ||
-                                  strcmp(env, "1") == 0);
-
-        // Safe iteration while erasing entries
-        for (auto it = mpFrontends->begin(); it != mpFrontends->end(); /* no increment here */) {
-            if (it->second == this) {
-                it = mpFrontends->erase(it);
-                continue;
-            }
-
-            if (dump_stats) {
-                std::cerr << "[GVIRTUS_STATS] Executed " << it->second->mRoutinesExecuted
-                          << " routine(s) in " << it->second->mRoutineExecutionTime
-                          << " second(s)\n"
-                          << "[GVIRTUS_STATS] Sent " << it->second->mDataSent / (1024 * 1024.0)
-                          << " Mb(s) in " << it->second->mSendingTime << " second(s)\n"
-                          << "[GVIRTUS_STATS] Received "
-                          << it->second->mDataReceived / (1024 * 1024.0) << " Mb(s) in "
-                          << it->second->mReceivingTime << " second(s)\n";
-            }
-
-            delete it->second;
-            it = mpFrontends->erase(it);
-        }
-
-        // Delete the map itself and set pointer to nullptr
+    if (this == &msFrontend) {
+        // exiting: end the sessions of the threads still running; their Frontends are left to
+        // them, as they may still make calls, and not freed (see ReleaseFrontend())
+        std::lock_guard<std::mutex> lock(gFrontendMutex);
+        if (mpFrontends == nullptr) return;
+        for (auto &it : *mpFrontends) it.second->Finish();
         delete mpFrontends;
         mpFrontends = nullptr;
+        Connection::Release();
+        // a later call (e.g. from a static destructor) opens a new connection
+        mspCurrent = nullptr;
+        return;
     }
+    Finish();
 }
 
-Frontend *Frontend::GetFrontend(Communicator *c) {
-    {
-        std::lock_guard<std::mutex> lock(gFrontendMutex);
-        if (mpFrontends == nullptr) mpFrontends = new map<pthread_t, Frontend *>();
+void Frontend::Finish() {
+    if (!mpInitialized || mFinished) return;
+    mFinished = true;
+
+    // the queued asynchronous routines must reach the backend before disconnecting; this waits
+    // for the flusher thread too, if it is sending the batch
+    try {
+        Synchronize();
+    } catch (const std::exception &e) {
+        LOG4CPLUS_WARN(logger, "Error synchronizing Frontend: " << e.what());
+    }
+    // the connection is shared: only the session of this thread ends
+    mpConnection->EndSession(mSessionId);
+
+    if (getEnvFlag("GVIRTUS_DUMP_STATS")) {
+        std::cerr << "[GVIRTUS_STATS] Executed " << mRoutinesExecuted << " routine(s) in "
+                  << mRoutineExecutionTime << " second(s)\n"
+                  << "[GVIRTUS_STATS] Sent " << mDataSent / (1024 * 1024.0) << " Mb(s) in "
+                  << mSendingTime << " second(s)\n"
+                  << "[GVIRTUS_STATS] Received " << mDataReceived / (1024 * 1024.0)
+                  << " Mb(s) in " << mReceivingTime << " second(s)\n";
     }
+}
 
-    pid_t tid = syscall(SYS_gettid);  // getting frontend's tid
+void Frontend::InitThreadSupport() {
+    pthread_key_create(&gFrontendKey, ReleaseFrontend);
+    pthread_atfork(NULL, NULL, ForgetFrontendsAfterFork);
+}
 
-    {
-        std::lock_guard<std::mutex> lock(gFrontendMutex);
-        auto it = mpFrontends->find(tid);
-        if (it != mpFrontends->end()) return it->second;
-    }
+Frontend *Frontend::CreateFrontend(Communicator *c) {
+    pthread_once(&gFrontendOnce, InitThreadSupport);
 
     Frontend *f = new Frontend();
     try {
         f->Init(c);
-        {
-            std::lock_guard<std::mutex> lock(gFrontendMutex);
-            mpFrontends->insert(make_pair(tid, f));
-        }
     } catch (const std::exception &e) {
         LOG4CPLUS_ERROR(logger, "Error initializing Frontend: " << e.what());
         delete f;  // Clean up on failure
         return nullptr;
     }
 
+    pid_t tid = syscall(SYS_gettid);  // getting frontend's tid
+    {
+        std::lock_guard<std::mutex> lock(gFrontendMutex);
+        if (mpFrontends == nullptr) mpFrontends = new map<pthread_t, Frontend *>();
+        mpFrontends->insert(make_pair(tid, f));
+    }
+    // ReleaseFrontend() is called with f when the thread exits
+    pthread_setspecific(gFrontendKey, f);
+    mspCurrent = f;
+
+    if (f->mAsync && f->mBatchMaxRoutines > 1 && f->mBatchMaxAge > 0) {
+        std::lock_guard<std::mutex> lock(gFlusherMutex);
+        if (!gFlusherStarted) {
+            std::thread(FlushOldBatches, f->mBatchMaxAge).detach();
+            gFlusherStarted = true;
+        }
+    }
+
     return f;
 }
 
+void Frontend::ReleaseFrontend(void *frontend) {
+    Frontend *f = static_cast<Frontend *>(frontend);
+    bool owned = false;
+    {
+        std::lock_guard<std::mutex> lock(gFrontendMutex);
+        if (mpFrontends != nullptr) {
+            for (auto it = mpFrontends->begin(); it != mpFrontends->end(); it++) {
+                if (it->second == f) {
+                    mpFrontends->erase(it);
+                    owned = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (mspCurrent == f) mspCurrent = nullptr;
+    // once the process is exiting, the Frontend is finished already and is not freed
+    if (owned) delete f;
+}
+
+void Frontend::ForgetFrontendsAfterFork() {
+    // the connections belong to the parent: the child opens its own (see Connection)
+    mspCurrent = nullptr;
+    pthread_setspecific(gFrontendKey, NULL);
+    if (mpFrontends != nullptr) mpFrontends->clear();
+    // nor does the child have the flusher thread
+    gFlusherStarted = false;
+    gBatchQueued = false;
+}
+
 void Frontend::Execute(const char *routine, const Buffer *input_buffer) {
     if (input_buffer == nullptr) input_buffer = mpInputBuffer.get();
     // if (!strcmp(routine, "cudaLaunchKernel")) {
     //     cerr << "cudaLaunchKernel called" << endl;
     // }
 
-    pid_t tid = syscall(SYS_gettid);
+    Frontend *frontend = this;
+    void *dst = mpOutputDestination;
+    size_t dst_size = mOutputDestinationSize;
+    mpOutputDestination = nullptr;
+    const void *transfer = mpTransfer;
+    size_t transfer_size = mTransferSize;
+    mpTransfer = nullptr;
+    mOutputReceived = false;
 
-    Frontend *frontend = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(gFrontendMutex);
-        auto it = mpFrontends->find(tid);
-        if (it == mpFrontends->end()) {
-            LOG4CPLUS_ERROR(logger, "Cannot send any job request");
-            return;
-        }
-        frontend = it->second;
-    }
+    // the queued asynchronous routines must be executed first
+    frontend->Synchronize();
 
     frontend->mRoutinesExecuted++;
-    auto start = steady_clock::now();
-    frontend->_communicator->obj_ptr()->Write(routine, strlen(routine) + 1);
-    frontend->mDataSent += input_buffer->GetBufferSize();
-    input_buffer->Dump(frontend->_communicator->obj_ptr().get());
-    frontend->_communicator->obj_ptr()->Sync();
-    frontend->mSendingTime +=
-        std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - start).count() /
-        1000.0;
+    uint32_t routine_id;
+    if (!frontend->GetRoutineId(routine, routine_id)) {
+        frontend->mpOutputBuffer->Reset();
+        frontend->mExitCode = -1;
+        return;
+    }
     frontend->mpOutputBuffer->Reset();
-
-    frontend->_communicator->obj_ptr()->Read((char *)&frontend->mExitCode, sizeof(int));
+    if (transfer != nullptr || dst_size >= mTransferThreshold) OpenBulkLane();
+    Connection::Call call = {frontend->mpOutputBuffer.get(), dst, dst_size, mpBulkLane.get()};
+    frontend->Send(routine_id, 0, input_buffer, &call, transfer, transfer_size);
+    frontend->mExitCode = frontend->ReadResult(call);
+    frontend->mOutputReceived = call.dst_received;
     LOG4CPLUS_DEBUG(logger, "Routine '" << routine << "' returned " << frontend->mExitCode);
     // if (frontend->mExitCode != 0
     //     && strcmp(routine, "cudnnGetVersion") != 0
@@ -259,31 +332,255 @@ void Frontend::Execute(const char *routine, const Buffer *input_buffer) {
     //     LOG4CPLUS_ERROR(logger, "Error executing routine '" << routine << "': exit code " <<
     //     frontend->mExitCode); return;
     // }
-    double time_taken;
-    frontend->_communicator->obj_ptr()->Read(reinterpret_cast<char *>(&time_taken),
-                                             sizeof(time_taken));
-    frontend->mRoutineExecutionTime += time_taken;
-
-    start = steady_clock::now();
-    size_t out_buffer_size;
-    frontend->_communicator->obj_ptr()->Read((char *)&out_buffer_size, sizeof(size_t));
-    LOG4CPLUS_DEBUG(logger, "Output buffer size: " << out_buffer_size);
-    frontend->mDataReceived += out_buffer_size;
-    if (out_buffer_size > 0) {
-        LOG4CPLUS_DEBUG(logger, "Output buffer size is greater than 0, reading...");
-        frontend->mpOutputBuffer->Read<char>(frontend->_communicator->obj_ptr().get(),
-                                             out_buffer_size);
-        LOG4CPLUS_DEBUG(logger, "Output buffer read successfully.");
+}
+
+void Frontend::ExecuteAsync(const char *routine, const Buffer *input_buffer, bool always) {
+    if (!mAsync && !always) {
+        Execute(routine, input_buffer);
+        return;
+    }
+    // the output of an asynchronous routine is received only into its destination
+    void *dst = mpOutputDestination;
+    size_t dst_size = mOutputDestinationSize;
+    mpOutputDestination = nullptr;
+    const void *transfer = mpTransfer;
+    size_t transfer_size = mTransferSize;
+    mpTransfer = nullptr;
+    bool on_stream = mOutputOnStream && dst != nullptr;
+    mOutputOnStream = false;
+    if (input_buffer == nullptr) input_buffer = mpInputBuffer.get();
+
+    mRoutinesExecuted++;
+    uint32_t routine_id;
+    if (!GetRoutineId(routine, routine_id)) {
+        mDeferredExitCodes.Set(DeferredExitCodes::Family(routine), -1);
+    } else if ((mpConnection->GetCapabilities() & communicators::CAPABILITY_BATCH) &&
+               mBatchMaxRoutines > 1 && transfer == nullptr && dst == nullptr &&
+               input_buffer->GetBufferSize() < mBatchMaxSize) {
+        std::unique_lock<std::mutex> lock(mBatchMutex);
+        bool queued = mpBatch->Empty();
+        mpBatch->Add(routine_id, input_buffer);
+        mBatchFamilies.push_back(DeferredExitCodes::Family(routine));
+        if (mpBatch->GetCount() >= mBatchMaxRoutines || mpBatch->GetSize() >= mBatchMaxSize ||
+            mpBatch->GetAge() >= std::chrono::microseconds(mBatchMaxAge))
+            SendBatch();
+        else if (queued)
+            NotifyBatchQueued();
+    } else {
+        // too large for being copied into the batch: it is sent on its own
+        std::unique_lock<std::mutex> lock(mBatchMutex);
+        SendBatch();
+        if (mPendingResults.size() >= mMaxPendingResults) CollectPendingResult(mDeferredExitCodes);
+        if (transfer != nullptr || dst_size >= mTransferThreshold) OpenBulkLane();
+        Connection::Call *call = AddPendingResult(false, {DeferredExitCodes::Family(routine)});
+        call->dst = dst;
+        call->dst_size = dst_size;
+        if (on_stream) {
+            mPendingResults.back().on_stream = true;
+            mPendingResults.back().stream = mpOutputStream;
+            mPendingOutputs++;
+        }
+        Send(routine_id, 0, input_buffer, call, transfer, transfer_size);
+    }
+
+    mExitCode = 0;
+    LOG4CPLUS_DEBUG(logger, "Routine '" << routine << "' sent asynchronously");
+}
+
+void Frontend::Synchronize() {
+    std::lock_guard<std::mutex> lock(mBatchMutex);
+    SendBatch();
+    while (!mPendingResults.empty()) CollectPendingResult(mDeferredExitCodes);
+}
+
+void Frontend::SynchronizeOutputs(const void *stream, bool all) {
+    std::vector<std::pair<Frontend *, std::unique_lock<std::mutex>>> others;
+    {
+        std::lock_guard<std::mutex> lock(gFrontendMutex);
+        if (mpFrontends == nullptr) return;
+        // locked in the order of mpFrontends, as by any other thread synchronizing
+        for (auto &it : *mpFrontends) {
+            if (it.second == this || it.second->mPendingOutputs == 0) continue;
+            others.emplace_back(it.second, std::unique_lock<std::mutex>(it.second->mBatchMutex));
+        }
+    }
+    // read without holding the threads creating or releasing a Frontend, as by the flusher
+    // thread; the errors are of this thread's routine synchronizing the stream
+    for (auto &it : others) it.first->CollectOutputs(stream, all, mDeferredExitCodes);
+}
+
+int Frontend::GetDeferredExitCode(const char *family, bool reset) {
+    return mDeferredExitCodes.Get(family, reset);
+}
+
+bool Frontend::GetRoutineId(const char *routine, uint32_t &routine_id) {
+    if (!mpConnection->GetRoutineId(routine, routine_id)) {
+        LOG4CPLUS_ERROR(logger, "Routine '" << routine << "' is not available on the backend");
+        return false;
     }
-    frontend->mReceivingTime +=
+    return true;
+}
+
+uint64_t Frontend::Send(uint32_t routine_id, uint32_t flags, const Buffer *input_buffer,
+                        Connection::Call *call, const void *transfer, size_t transfer_size) {
+    auto start = steady_clock::now();
+    uint64_t request_id = mpConnection->Send(mSessionId, routine_id, flags, input_buffer, call,
+                                             transfer, transfer_size);
+    mDataSent += input_buffer->GetBufferSize() + (transfer != nullptr ? transfer_size : 0);
+    mSendingTime +=
         std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - start).count() /
         1000.0;
+    return request_id;
+}
+
+Connection::Call *Frontend::AddPendingResult(bool batch, std::vector<std::string> families) {
+    PendingResult pending = {batch, std::move(families), std::make_unique<Buffer>(),
+                             std::make_unique<Connection::Call>()};
+    pending.call->output = pending.output.get();
+    pending.call->bulk_lane = mpBulkLane.get();
+    mPendingResults.push_back(std::move(pending));
+    return mPendingResults.back().call.get();
+}
+
+void Frontend::FlushBatch() {
+    std::lock_guard<std::mutex> lock(mBatchMutex);
+    SendBatch();
 }
 
-void Frontend::Prepare() {
-    pid_t tid = syscall(SYS_gettid);
+void Frontend::SendBatch() {
+    if (mpBatch == nullptr || mpBatch->Empty()) return;
+
+    if (mPendingResults.size() >= mMaxPendingResults) CollectPendingResult(mDeferredExitCodes);
+    LOG4CPLUS_DEBUG(logger, "Sending a batch of " << mpBatch->GetCount() << " routine(s), "
+                                                  << mpBatch->GetSize() << " byte(s)");
+    Send(0, communicators::REQUEST_BATCH, mpBatch->GetBuffer(),
+         AddPendingResult(true, std::move(mBatchFamilies)));
+    mBatchFamilies.clear();
+    mpBatch->Reset();
+}
+
+std::unique_lock<std::mutex> Frontend::LockOldBatch(bool &queued) {
+    std::unique_lock<std::mutex> lock(mBatchMutex, std::try_to_lock);
+    // a busy Frontend sends its batch itself
+    if (!lock.owns_lock() || mpBatch == nullptr || mpBatch->Empty()) return {};
+    // reading a result here would race with the thread of the Frontend
+    if (mpBatch->GetAge() < std::chrono::microseconds(mBatchMaxAge) ||
+        mPendingResults.size() >= mMaxPendingResults) {
+        queued = true;
+        return {};
+    }
+    return lock;
+}
+
+void Frontend::NotifyBatchQueued() {
     {
-        if (this->mpFrontends->find(tid) != mpFrontends->end())
-            mpFrontends->find(tid)->second->mpInputBuffer->Reset();
+        std::lock_guard<std::mutex> lock(gFlusherMutex);
+        if (!gFlusherStarted || gBatchQueued) return;
+        gBatchQueued = true;
     }
+    gFlusherCondition.notify_one();
 }
+
+void Frontend::FlushOldBatches(size_t max_age) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(gFlusherMutex);
+            gFlusherCondition.wait(lock, [] { return gBatchQueued; });
+            gBatchQueued = false;
+        }
+        // the batches queued before the notification are old by now, the others at the next round
+        std::this_thread::sleep_for(std::chrono::microseconds(max_age));
+        bool queued = false;
+        std::vector<std::pair<Frontend *, std::unique_lock<std::mutex>>> old;
+        {
+            std::lock_guard<std::mutex> lock(gFrontendMutex);
+            // exiting, see ~Frontend()
+            if (mpFrontends == nullptr) return;
+            for (auto &it : *mpFrontends) {
+                std::unique_lock<std::mutex> batch = it.second->LockOldBatch(queued);
+                if (batch.owns_lock()) old.emplace_back(it.second, std::move(batch));
+            }
+        }
+        // sent without holding the threads creating or releasing a Frontend; a Frontend is
+        // released only once its batch is unlocked, see Finish()
+        for (auto &it : old) it.first->SendBatch();
+        old.clear();
+        if (queued) {
+            std::lock_guard<std::mutex> lock(gFlusherMutex);
+            gBatchQueued = true;
+        }
+    }
+}
+
+void Frontend::CollectPendingResult(DeferredExitCodes &deferred) {
+    if (mPendingResults.empty()) return;
+
+    PendingResult &pending = mPendingResults.front();
+    // mExitCode is left alone: this may be another thread, see SynchronizeOutputs()
+    int result;
+    try {
+        result = ReadResult(*pending.call);
+    } catch (const std::exception &e) {
+        LOG4CPLUS_ERROR(logger, "Error reading an asynchronous result: " << e.what());
+        result = -1;
+    }
+    for (auto &family : pending.families) {
+        // a batch failed as a whole has no exit code for each routine
+        int exit_code =
+            pending.batch && !pending.output->Empty() ? pending.output->Get<int>() : result;
+        if (exit_code != 0)
+            LOG4CPLUS_DEBUG(logger, "Deferred error " << exit_code << " from an asynchronous '"
+                                                      << family << "' routine");
+        deferred.Set(family, exit_code);
+    }
+    if (pending.on_stream) mPendingOutputs--;
+    mPendingResults.pop_front();
+}
+
+void Frontend::CollectOutputs(const void *stream, bool all, DeferredExitCodes &deferred) {
+    // the results are read in order: the payloads on the bulk lane follow it
+    size_t count = 0;
+    for (size_t i = 0; i < mPendingResults.size(); i++) {
+        if (mPendingResults[i].on_stream && (all || mPendingResults[i].stream == stream))
+            count = i + 1;
+    }
+    while (count-- > 0) CollectPendingResult(deferred);
+}
+
+void Frontend::SetOutputDestination(void *dst, size_t size) {
+    mpOutputDestination = dst;
+    mOutputDestinationSize = size;
+}
+
+void Frontend::SetOutputStream(const void *stream) {
+    mpOutputStream = stream;
+    mOutputOnStream = true;
+}
+
+void Frontend::OpenBulkLane() {
+    if (mBulkLaneOpened) return;
+    mBulkLaneOpened = true;
+    try {
+        mpBulkLane = mpConnection->OpenBulkLane(mSessionId);
+    } catch (const std::exception &e) {
+        LOG4CPLUS_WARN(logger, "Can't open the bulk lane: " << e.what());
+    }
+}
+
+void Frontend::SetInputTransfer(const void *src, size_t size) {
+    mpTransfer = src;
+    mTransferSize = size;
+}
+
+int Frontend::ReadResult(Connection::Call &call) {
+    auto start = steady_clock::now();
+    mpConnection->Receive(&call);
+    mRoutineExecutionTime += call.time_taken;
+    mDataReceived += call.payload_size;
+    mReceivingTime +=
+        std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - start).count() /
+        1000.0;
+    return call.exit_code;
+}
+
+void Frontend::Prepare() { mpInputBuffer->Reset(); }
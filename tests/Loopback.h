@@ -0,0 +1,64 @@
+/*
+ * Helpers of the host tests: a communicator connected to itself, and the
+ * payloads they send through it.
+ */
+
+#pragma once
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/Buffer.h>
+#include <gvirtus/communicators/Communicator.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/* a connection to itself: what is written is read back, in order */
+class Loopback : public gvirtus::communicators::Communicator {
+   public:
+    void Serve() override {}
+    const Communicator *const Accept() const override { return nullptr; }
+    void Connect() override {}
+    size_t Read(char *buffer, size_t size) override {
+        size = std::min(size, mData.size() - mRead);
+        memcpy(buffer, mData.data() + mRead, size);
+        mRead += size;
+        return size;
+    }
+    size_t Write(const char *buffer, size_t size) override {
+        mData.insert(mData.end(), buffer, buffer + size);
+        return size;
+    }
+    void Sync() override {}
+    void Close() override {}
+
+    const std::vector<char> &GetData() const { return mData; }
+    size_t GetUnread() const { return mData.size() - mRead; }
+
+    template <class T>
+    T Read() {
+        T item;
+        EXPECT_EQ(Read((char *)&item, sizeof(item)), sizeof(item));
+        return item;
+    }
+
+   private:
+    std::vector<char> mData;
+    size_t mRead = 0;
+};
+
+/* floats of a slow signal: their exponents repeat, as in a tensor */
+inline gvirtus::communicators::Buffer MakeTensor(size_t count) {
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; i++) values[i] = 1.0f + (i % 1024) / 1024.0f;
+    gvirtus::communicators::Buffer tensor;
+    tensor.Add(values.data(), count);
+    return tensor;
+}
+
+/* the bytes of buffer, as written on a communicator */
+inline std::vector<char> GetBytes(const gvirtus::communicators::Buffer &buffer) {
+    Loopback c;
+    buffer.WriteTo(&c);
+    return c.GetData();
+}
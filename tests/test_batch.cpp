@@ -0,0 +1,71 @@
+/*
+ * The batches: the routines queued by the frontend are sent as the payload
+ * of a single request and read back one by one by the backend.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/Batch.h>
+#include <gvirtus/communicators/Buffer.h>
+#include <gvirtus/communicators/Protocol.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Loopback.h"
+
+using namespace gvirtus::communicators;
+
+TEST(Batch, RequestsAreReadBackInOrder) {
+    Buffer small, empty;
+    small.Add(11);
+    Buffer large = MakeTensor(EXTERNAL_SEGMENT_MIN_SIZE / sizeof(float));
+    std::vector<char> external(EXTERNAL_SEGMENT_MIN_SIZE, 'x');
+    large.AddExternal(external.data(), external.size());
+
+    Batch batch;
+    EXPECT_TRUE(batch.Empty());
+    batch.Add(3, &small);
+    batch.Add(5, &empty);
+    batch.Add(8, &large);
+    EXPECT_EQ(batch.GetCount(), 3u);
+
+    // sent as the payload of a request and read by the backend
+    Loopback c;
+    batch.GetBuffer()->WriteTo(&c);
+    Buffer payload;
+    payload.Read<char>(&c, batch.GetSize());
+
+    uint32_t routine_id;
+    std::shared_ptr<Buffer> input_buffer;
+    ASSERT_TRUE(Batch::Next(&payload, routine_id, input_buffer));
+    EXPECT_EQ(routine_id, 3u);
+    EXPECT_EQ(input_buffer->Get<int>(), 11);
+    ASSERT_TRUE(Batch::Next(&payload, routine_id, input_buffer));
+    EXPECT_EQ(routine_id, 5u);
+    EXPECT_EQ(input_buffer->GetBufferSize(), 0u);
+    ASSERT_TRUE(Batch::Next(&payload, routine_id, input_buffer));
+    EXPECT_EQ(routine_id, 8u);
+    EXPECT_EQ(GetBytes(*input_buffer), GetBytes(large));
+    EXPECT_FALSE(Batch::Next(&payload, routine_id, input_buffer));
+
+    batch.Reset();
+    EXPECT_TRUE(batch.Empty());
+    EXPECT_EQ(batch.GetSize(), 0u);
+    EXPECT_EQ(batch.GetAge().count(), 0);
+}
+
+TEST(Batch, TruncatedRequestIsRejected) {
+    Buffer input;
+    input.Add(11);
+    input.Add(12);
+    Batch batch;
+    batch.Add(3, &input);
+
+    // the last bytes of the request are missing
+    std::vector<char> bytes = GetBytes(*batch.GetBuffer());
+    Buffer payload(bytes.data(), bytes.size() - sizeof(int));
+    uint32_t routine_id;
+    std::shared_ptr<Buffer> input_buffer;
+    EXPECT_THROW(Batch::Next(&payload, routine_id, input_buffer), std::exception);
+}
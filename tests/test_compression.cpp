@@ -0,0 +1,72 @@
+/*
+ * The compressed payloads: the blocks of a large transfer are compressed one
+ * by one, stored as they are when they don't shrink, and read back into the
+ * destinations of the receiver.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/Buffer.h>
+#include <gvirtus/communicators/Compressor.h>
+#include <gvirtus/communicators/Protocol.h>
+#include <sys/uio.h>
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "Loopback.h"
+
+using namespace gvirtus::communicators;
+
+TEST(Compression, CompressedPayloadIsReadBack) {
+    // several blocks, the last one short
+    Buffer payload = MakeTensor((2 * GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE + 1000) / sizeof(float));
+    size_t size = payload.GetBufferSize();
+    Loopback c;
+    Compressor(COMPRESSION_LZ4).Write(&c, &payload, true);
+    EXPECT_LT(c.GetUnread(), size);
+
+    // scattered in two destinations cut within a block
+    std::vector<char> received(size);
+    size_t cut = GVIRTUS_COMPRESSED_BLOCK_MAX_SIZE / 2 + 3;
+    struct iovec iov[2] = {{received.data(), cut}, {received.data() + cut, size - cut}};
+    Compressor(COMPRESSION_LZ4).Read(&c, size, iov, 2);
+    EXPECT_EQ(received, GetBytes(payload));
+    EXPECT_EQ(c.GetUnread(), 0u);
+}
+
+TEST(Compression, IncompressibleBlockIsStored) {
+    std::mt19937 random(1);
+    std::vector<uint32_t> noise(100000 / sizeof(uint32_t));
+    for (auto &value : noise) value = random();
+    Buffer payload;
+    payload.Add(noise.data(), noise.size());
+    size_t size = payload.GetBufferSize();
+    Loopback c;
+    Compressor(COMPRESSION_LZ4).Write(&c, &payload, true);
+
+    CompressedBlock block;
+    memcpy(&block, c.GetData().data(), sizeof(block));
+    EXPECT_EQ(block.codec, COMPRESSION_NONE);
+    EXPECT_EQ(block.size, size);
+    EXPECT_EQ(block.stored_size, size);
+
+    std::vector<char> received(size);
+    struct iovec iov = {received.data(), size};
+    Compressor(COMPRESSION_LZ4).Read(&c, size, &iov, 1);
+    EXPECT_EQ(received, GetBytes(payload));
+}
+
+TEST(Compression, BlockLargerThanThePayloadIsRejected) {
+    Loopback c;
+    CompressedBlock block = {1024, 1024, COMPRESSION_NONE, 0, 0};
+    c.Write((char *)&block, sizeof(block));
+    std::vector<char> data(1024);
+    c.Write(data.data(), data.size());
+
+    std::vector<char> received(512);
+    struct iovec iov = {received.data(), received.size()};
+    EXPECT_THROW(Compressor(COMPRESSION_LZ4).Read(&c, received.size(), &iov, 1),
+                 std::runtime_error);
+}
@@ -0,0 +1,159 @@
+/*
+ * The connections of the frontend shared by several threads: the responses
+ * arrive in any order and each one goes to the thread waiting for it. The
+ * backend is played by the test on the other end of a socket pair.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/Buffer.h>
+#include <gvirtus/communicators/Communicator.h>
+#include <gvirtus/communicators/Protocol.h>
+#include <gvirtus/frontend/Connection.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace gvirtus::communicators;
+using gvirtus::frontend::Connection;
+
+/* one end of a socket pair, read by a thread while another one writes */
+class Socket : public Communicator {
+   public:
+    explicit Socket(int fd) : mFd(fd) {}
+    ~Socket() override { Close(); }
+    void Serve() override {}
+    const Communicator *const Accept() const override { return nullptr; }
+    void Connect() override {}
+    size_t Read(char *buffer, size_t size) override {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = recv(mFd, buffer + done, size - done, 0);
+            if (n <= 0) break;
+            done += n;
+        }
+        return done;
+    }
+    size_t Write(const char *buffer, size_t size) override {
+        if (send(mFd, buffer, size, MSG_NOSIGNAL) != (ssize_t)size)
+            throw std::runtime_error("Can't write to socket");
+        return size;
+    }
+    void Sync() override {}
+    void Close() override {
+        if (mFd >= 0) close(mFd);
+        mFd = -1;
+    }
+    bool IsFullDuplex() const override { return true; }
+
+    template <class T>
+    T Read() {
+        T item = {};
+        EXPECT_EQ(Read((char *)&item, sizeof(item)), sizeof(item));
+        return item;
+    }
+
+   private:
+    int mFd;
+};
+
+class ConnectionTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        int fds[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        mBackend = std::make_unique<Socket>(fds[1]);
+        // the backend answers the handshake with its routines, and no capability
+        std::thread backend([this] {
+            auto hello = mBackend->Read<Hello>();
+            EXPECT_EQ(hello.magic, (uint32_t)GVIRTUS_PROTOCOL_MAGIC);
+            EXPECT_NE(hello.client_id, 0u);
+            hello.capabilities = 0;
+            mBackend->Write((char *)&hello, sizeof(hello));
+            Buffer routines;
+            routines.Add((size_t)2);
+            routines.AddString("cudaMalloc");
+            routines.AddString("cudaFree");
+            routines.Dump(mBackend.get());
+        });
+        mConnection = std::make_unique<Connection>(std::make_shared<Socket>(fds[0]));
+        backend.join();
+    }
+
+    /* reads a request, whose input is an int */
+    std::pair<RequestHeader, int> ReadRequest() {
+        auto header = mBackend->Read<RequestHeader>();
+        EXPECT_EQ(header.payload_size, sizeof(int));
+        return {header, mBackend->Read<int>()};
+    }
+
+    void WriteResponse(uint64_t request_id, int exit_code, int output) {
+        ResponseHeader header = {};
+        header.exit_code = exit_code;
+        header.request_id = request_id;
+        header.payload_size = sizeof(output);
+        mBackend->Write((char *)&header, sizeof(header));
+        mBackend->Write((char *)&output, sizeof(output));
+    }
+
+    std::unique_ptr<Socket> mBackend;
+    std::unique_ptr<Connection> mConnection;
+};
+
+TEST_F(ConnectionTest, RoutinesAreNamedByTheirIds) {
+    uint32_t routine_id;
+    ASSERT_TRUE(mConnection->GetRoutineId("cudaFree", routine_id));
+    EXPECT_EQ(routine_id, 1u);
+    EXPECT_FALSE(mConnection->GetRoutineId("cudaMemcpy", routine_id));
+}
+
+TEST_F(ConnectionTest, ResponsesGoToTheThreadsWaitingForThem) {
+    const int threads = 4;
+    std::vector<int> outputs(threads), exit_codes(threads);
+    std::vector<std::thread> frontends;
+    for (int i = 0; i < threads; i++) {
+        frontends.emplace_back([this, i, &outputs, &exit_codes] {
+            Buffer input, output;
+            input.Add(i);
+            Connection::Call call = {&output};
+            mConnection->Send(i + 1, 0, 0, &input, &call);
+            mConnection->Receive(&call);
+            exit_codes[i] = call.exit_code;
+            outputs[i] = output.Get<int>();
+        });
+    }
+
+    // answered in the reverse order of the requests
+    std::map<uint64_t, int> requests;
+    for (int i = 0; i < threads; i++) {
+        auto request = ReadRequest();
+        EXPECT_EQ(request.first.session_id, (uint64_t)request.second + 1);
+        requests[request.first.request_id] = request.second;
+    }
+    EXPECT_EQ(requests.size(), (size_t)threads);
+    for (auto it = requests.rbegin(); it != requests.rend(); ++it)
+        WriteResponse(it->first, it->second, 10 * it->second);
+
+    for (auto &frontend : frontends) frontend.join();
+    for (int i = 0; i < threads; i++) {
+        EXPECT_EQ(exit_codes[i], i);
+        EXPECT_EQ(outputs[i], 10 * i);
+    }
+}
+
+TEST_F(ConnectionTest, ClosedConnectionFailsTheWaitingCalls) {
+    Buffer input, output;
+    input.Add(1);
+    Connection::Call call = {&output};
+    mConnection->Send(1, 0, 0, &input, &call);
+    ReadRequest();
+    mBackend->Close();
+
+    EXPECT_THROW(mConnection->Receive(&call), std::runtime_error);
+    // and the next ones
+    EXPECT_THROW(mConnection->Send(1, 0, 0, &input, &call), std::runtime_error);
+}
@@ -0,0 +1,89 @@
+/*
+ * The errors of the routines executed asynchronously: kept by library until
+ * a synchronous call of the library takes them, as the CUDA runtime does
+ * with its sticky errors.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/Batch.h>
+#include <gvirtus/communicators/Buffer.h>
+#include <gvirtus/communicators/Protocol.h>
+#include <gvirtus/communicators/Result.h>
+#include <gvirtus/frontend/DeferredExitCodes.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Loopback.h"
+
+using namespace gvirtus::communicators;
+using gvirtus::frontend::DeferredExitCodes;
+
+TEST(DeferredExitCodes, FamilyIsThePrefixOfTheRoutine) {
+    EXPECT_EQ(DeferredExitCodes::Family("cudaLaunchKernel"), "cuda");
+    EXPECT_EQ(DeferredExitCodes::Family("cublasSgemm_v2"), "cublas");
+    EXPECT_EQ(DeferredExitCodes::Family("cudnnConvolutionForward"), "cudnn");
+    EXPECT_EQ(DeferredExitCodes::Family("nvrtc"), "nvrtc");
+}
+
+TEST(DeferredExitCodes, FirstErrorIsKeptUntilTaken) {
+    DeferredExitCodes exit_codes;
+    exit_codes.Set("cuda", 0);
+    EXPECT_EQ(exit_codes.Get("cuda"), 0);
+
+    exit_codes.Set("cuda", 2);
+    exit_codes.Set("cuda", 0);
+    exit_codes.Set("cuda", 3);
+    EXPECT_EQ(exit_codes.Get("cuda", false), 2);
+    EXPECT_EQ(exit_codes.Get("cuda"), 2);
+    EXPECT_EQ(exit_codes.Get("cuda"), 0);
+
+    exit_codes.Set("cuda", 3);
+    EXPECT_EQ(exit_codes.Get("cuda"), 3);
+}
+
+TEST(DeferredExitCodes, ErrorsOfALibraryStayWithIt) {
+    DeferredExitCodes exit_codes;
+    exit_codes.Set("cublas", 13);
+    EXPECT_EQ(exit_codes.Get("cuda"), 0);
+    EXPECT_EQ(exit_codes.Get("cublas"), 13);
+}
+
+TEST(DeferredExitCodes, ErrorsOfABatchGoToTheLibrariesOfItsRoutines) {
+    const char *routines[] = {"cudaMemsetAsync", "cublasSetStream_v2", "cudaLaunchKernel",
+                              "cudaMemsetAsync"};
+    const int returned[] = {0, 0, 700, 1};
+
+    // the frontend queues the routines, remembering their libraries
+    Batch batch;
+    std::vector<std::string> families;
+    for (uint32_t i = 0; i < 4; i++) {
+        Buffer input;
+        input.Add(i);
+        batch.Add(i, &input);
+        families.push_back(DeferredExitCodes::Family(routines[i]));
+    }
+
+    // the backend answers with the first error and the exit code of each routine
+    Buffer payload(*batch.GetBuffer());
+    auto exit_codes = std::make_shared<Buffer>();
+    int exit_code = 0;
+    uint32_t routine_id;
+    std::shared_ptr<Buffer> input_buffer;
+    while (Batch::Next(&payload, routine_id, input_buffer)) {
+        EXPECT_EQ(input_buffer->Get<uint32_t>(), routine_id);
+        exit_codes->Add(returned[routine_id]);
+        if (exit_code == 0) exit_code = returned[routine_id];
+    }
+    Loopback c;
+    Result(exit_code, exit_codes).Dump(&c, 9);
+
+    auto header = c.Read<ResponseHeader>();
+    EXPECT_EQ(header.exit_code, 700);
+    DeferredExitCodes deferred;
+    for (auto &family : families) deferred.Set(family, c.Read<int>());
+    EXPECT_EQ(c.GetUnread(), 0u);
+    EXPECT_EQ(deferred.Get("cublas"), 0);
+    EXPECT_EQ(deferred.Get("cuda"), 700);
+}
@@ -0,0 +1,237 @@
+/*
+ * The index of the kernel parameters of a fat binary (KernelParamIndex),
+ * built from a fat binary made up here: neither a GPU nor nvcc is needed.
+ */
+
+#include <CudaUtil.h>
+#include <elf.h>
+#include <gtest/gtest.h>
+#include <lz4.h>
+#include <stdlib.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "KernelParamIndex.h"
+
+using Kernels = std::vector<std::pair<std::string, std::vector<NvInfoKParam>>>;
+
+static NvInfoKParam MakeParam(uint16_t ordinal, uint16_t offset, uint16_t size) {
+    NvInfoKParam param = {};
+    param.nvInfoAttribute = {EIFMT_SVAL, EIATTR_KPARAM_INFO,
+                             sizeof(NvInfoKParam) - sizeof(NvInfoAttribute)};
+    param.ordinal = ordinal;
+    param.offset = offset;
+    param.tmp = (uint32_t)size << 18;
+    return param;
+}
+
+/* an ELF with a .nv.info.<kernel> section for each kernel, as in a cubin */
+static std::vector<char> MakeCubin(const Kernels &kernels) {
+    std::string names(1, '\0');
+    std::vector<Elf64_Shdr> sections(2, Elf64_Shdr{});
+    std::vector<char> data;
+    for (auto &kernel : kernels) {
+        Elf64_Shdr section = {};
+        section.sh_name = names.size();
+        section.sh_offset = sizeof(Elf64_Ehdr) + data.size();
+        names += ".nv.info." + kernel.first + '\0';
+        // the attributes that are not parameters are skipped
+        NvInfoAttribute max_threads = {EIFMT_HVAL, EIATTR_MAX_THREADS, 256};
+        data.insert(data.end(), (char *)&max_threads, (char *)(&max_threads + 1));
+        for (auto &param : kernel.second)
+            data.insert(data.end(), (char *)&param, (char *)(&param + 1));
+        section.sh_size = sizeof(Elf64_Ehdr) + data.size() - section.sh_offset;
+        sections.push_back(section);
+    }
+    sections[1].sh_name = names.size();
+    names += ".shstrtab";
+    names += '\0';
+    sections[1].sh_offset = sizeof(Elf64_Ehdr) + data.size();
+    sections[1].sh_size = names.size();
+    data.insert(data.end(), names.begin(), names.end());
+    data.resize((data.size() + 7) & ~7);
+
+    Elf64_Ehdr header = {};
+    memcpy(header.e_ident, ELF_MAGIC, ELF_MAGIC_SIZE);
+    header.e_shoff = sizeof(Elf64_Ehdr) + data.size();
+    header.e_shentsize = sizeof(Elf64_Shdr);
+    header.e_shnum = sections.size();
+    header.e_shstrndx = 1;
+    std::vector<char> cubin((char *)&header, (char *)(&header + 1));
+    cubin.insert(cubin.end(), data.begin(), data.end());
+    cubin.insert(cubin.end(), (char *)sections.data(), (char *)(sections.data() + sections.size()));
+    return cubin;
+}
+
+/* a fat binary of entries, each one a cubin (kind 2) or PTX (kind 1) */
+class FatBinary {
+   public:
+    void Add(unsigned short kind, const std::vector<char> &payload, bool compressed = false) {
+        fatBinData_t entry = {};
+        entry.kind = kind;
+        entry.version = 0x0101;
+        entry.headerSize = sizeof(entry);
+        std::vector<char> stored = payload;
+        if (compressed) {
+            stored.resize(LZ4_compressBound(payload.size()));
+            stored.resize(LZ4_compress_default(payload.data(), stored.data(), payload.size(),
+                                               stored.size()));
+            entry.uncompressedPayload = payload.size();
+        }
+        entry.payloadSize = stored.size();
+        stored.resize((stored.size() + 7) & ~7);
+        entry.paddedPayloadSize = stored.size();
+        mEntries.insert(mEntries.end(), (char *)&entry, (char *)(&entry + 1));
+        mEntries.insert(mEntries.end(), stored.begin(), stored.end());
+    }
+
+    const __fatBinC_Wrapper_t *Get() {
+        fatBinaryHeader header = {FATBIN_MAGIC, 1, sizeof(fatBinaryHeader), mEntries.size()};
+        mData.assign((sizeof(header) + mEntries.size()) / 8, 0);
+        memcpy(mData.data(), &header, sizeof(header));
+        memcpy((char *)mData.data() + sizeof(header), mEntries.data(), mEntries.size());
+        mWrapper = {FATBINWRAPPER_MAGIC, 1, mData.data(), nullptr};
+        return &mWrapper;
+    }
+
+   private:
+    std::vector<char> mEntries;
+    std::vector<unsigned long long> mData;
+    __fatBinC_Wrapper_t mWrapper;
+};
+
+class KernelParamIndexTest : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() {
+        char directory[] = "/tmp/gvirtus-kparams-XXXXXX";
+        ASSERT_NE(mkdtemp(directory), nullptr);
+        msCache = directory;
+        // read once, by the first Open()
+        setenv("GVIRTUS_KPARAM_CACHE", directory, 1);
+    }
+
+    static void TearDownTestSuite() { std::filesystem::remove_all(msCache); }
+
+    static std::string GetPath(const std::string &hash) { return msCache + "/" + hash + ".kparams"; }
+
+    /* saxpy(int, float, float *, float *) in a cubin, scale(float *, double) in another */
+    static FatBinary MakeFatBinary(bool compressed = false) {
+        FatBinary bin;
+        bin.Add(1, std::vector<char>(100, 'p'));
+        bin.Add(2,
+                MakeCubin({{"saxpy",
+                            {MakeParam(3, 16, 8), MakeParam(2, 8, 8), MakeParam(1, 4, 4),
+                             MakeParam(0, 0, 4)}}}),
+                compressed);
+        bin.Add(2, MakeCubin({{"scale", {MakeParam(1, 8, 8), MakeParam(0, 0, 8)}},
+                              {"saxpy", {MakeParam(0, 0, 4)}}}));
+        return bin;
+    }
+
+    static void ExpectKernels(const KernelParamIndex &index) {
+        EXPECT_EQ(index.GetSize(), 2u);
+        NvInfoFunction info;
+        // the first kernel of a name is the one kept
+        ASSERT_TRUE(index.Find("saxpy", info));
+        NvInfoArgsLayout layout = getArgsLayout(info);
+        EXPECT_EQ(layout.size, 24u);
+        ASSERT_EQ(layout.args.size(), 4u);
+        EXPECT_EQ(layout.args[1].offset, 4);
+        EXPECT_EQ(layout.args[1].size, 4);
+        EXPECT_EQ(layout.args[3].offset, 16);
+        EXPECT_EQ(layout.args[3].size, 8);
+        ASSERT_TRUE(index.Find("scale", info));
+        EXPECT_EQ(getArgsLayout(info).size, 16u);
+        EXPECT_FALSE(index.Find("gemm", info));
+        EXPECT_FALSE(index.Find("sax", info));
+    }
+
+    static std::string msCache;
+};
+
+std::string KernelParamIndexTest::msCache;
+
+TEST_F(KernelParamIndexTest, FindsTheParametersOfTheKernels) {
+    FatBinary bin = MakeFatBinary();
+    auto index = KernelParamIndex::Open(bin.Get(), "built");
+    ASSERT_NE(index, nullptr);
+    ExpectKernels(*index);
+}
+
+TEST_F(KernelParamIndexTest, DecompressesTheCubins) {
+    FatBinary bin = MakeFatBinary(true);
+    auto index = KernelParamIndex::Open(bin.Get(), "compressed");
+    ASSERT_NE(index, nullptr);
+    ExpectKernels(*index);
+}
+
+TEST_F(KernelParamIndexTest, IsReadFromTheCache) {
+    FatBinary bin = MakeFatBinary();
+    ASSERT_NE(KernelParamIndex::Open(bin.Get(), "cached"), nullptr);
+    ASSERT_TRUE(std::filesystem::exists(GetPath("cached")));
+
+    // the fat binary is not parsed again: one that can't be parsed is as good
+    FatBinary invalid;
+    invalid.Add(3, std::vector<char>(8));
+    auto index = KernelParamIndex::Open(invalid.Get(), "cached");
+    ASSERT_NE(index, nullptr);
+    ExpectKernels(*index);
+}
+
+TEST_F(KernelParamIndexTest, CorruptedCacheIsBuiltAgain) {
+    std::ofstream(GetPath("corrupted")) << "not an index";
+    FatBinary bin = MakeFatBinary();
+    auto index = KernelParamIndex::Open(bin.Get(), "corrupted");
+    ASSERT_NE(index, nullptr);
+    ExpectKernels(*index);
+
+    // and saved in place of the corrupted one
+    FatBinary invalid;
+    invalid.Add(3, std::vector<char>(8));
+    index = KernelParamIndex::Open(invalid.Get(), "corrupted");
+    ASSERT_NE(index, nullptr);
+    ExpectKernels(*index);
+}
+
+TEST_F(KernelParamIndexTest, InvalidFatBinaryHasNoIndex) {
+    FatBinary bin;
+    bin.Add(3, std::vector<char>(8));
+    EXPECT_EQ(KernelParamIndex::Open(bin.Get(), "invalid"), nullptr);
+
+    FatBinary not_elf;
+    not_elf.Add(2, std::vector<char>(64, 'x'));
+    EXPECT_EQ(KernelParamIndex::Open(not_elf.Get(), "not-elf"), nullptr);
+    EXPECT_FALSE(std::filesystem::exists(GetPath("not-elf")));
+}
+
+TEST_F(KernelParamIndexTest, TruncatedCacheIsBuiltAgain) {
+    FatBinary bin = MakeFatBinary();
+    ASSERT_NE(KernelParamIndex::Open(bin.Get(), "truncated"), nullptr);
+    // e.g. a frontend killed while saving it
+    std::filesystem::resize_file(GetPath("truncated"),
+                                 std::filesystem::file_size(GetPath("truncated")) / 2);
+
+    auto index = KernelParamIndex::Open(bin.Get(), "truncated");
+    ASSERT_NE(index, nullptr);
+    ExpectKernels(*index);
+}
+
+TEST_F(KernelParamIndexTest, FindsTheKernelsOfManyCubins) {
+    // parsed on several threads
+    FatBinary bin;
+    for (int i = 0; i < 64; i++)
+        bin.Add(2, MakeCubin({{"kernel" + std::to_string(i), {MakeParam(0, 0, 4 * (i % 2 + 1))}}}));
+    auto index = KernelParamIndex::Open(bin.Get(), "many");
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->GetSize(), 64u);
+    NvInfoFunction info;
+    for (int i = 0; i < 64; i++) {
+        ASSERT_TRUE(index->Find("kernel" + std::to_string(i), info));
+        EXPECT_EQ(getArgsLayout(info).size, 4u * (i % 2 + 1));
+    }
+}
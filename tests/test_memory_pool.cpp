@@ -0,0 +1,107 @@
+/*
+ * The pool of the Buffers: the sizes are rounded up to their class, and the
+ * blocks released are kept by the thread releasing them for its next
+ * allocations.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/MemoryPool.h>
+
+#include <functional>
+#include <thread>
+
+using gvirtus::communicators::MemoryPool;
+
+/* the blocks that had to be requested to the system since the last call */
+static size_t SystemAllocations() {
+    static size_t last = 0;
+    size_t current = MemoryPool::GetStats().system_allocations;
+    size_t allocations = current - last;
+    last = current;
+    return allocations;
+}
+
+/* runs test on a thread of its own, whose free lists start empty */
+static void OnNewThread(const std::function<void()> &test) { std::thread(test).join(); }
+
+TEST(MemoryPool, SizesAreRoundedUpToTheirClass) {
+    OnNewThread([] {
+        const size_t sizes[][2] = {{0, 4096},
+                                   {1, 4096},
+                                   {4096, 4096},
+                                   {5000, 8192},
+                                   {1 << 20, 1 << 20},
+                                   {(1 << 20) + 1, 2 << 20},
+                                   {(2 << 20) + 1, 4 << 20}};
+        for (auto &expected : sizes) {
+            size_t size = expected[0];
+            void *ptr = MemoryPool::Allocate(size);
+            ASSERT_NE(ptr, nullptr);
+            EXPECT_EQ(size, expected[1]);
+            // the whole block is usable
+            static_cast<char *>(ptr)[size - 1] = 1;
+            MemoryPool::Release(ptr, size);
+        }
+    });
+}
+
+TEST(MemoryPool, ReleasedBlockIsReused) {
+    OnNewThread([] {
+        size_t size = 10000;
+        void *ptr = MemoryPool::Allocate(size);
+        MemoryPool::Release(ptr, size);
+        SystemAllocations();
+
+        // a block of the same class
+        size_t other_size = 9000;
+        EXPECT_EQ(MemoryPool::Allocate(other_size), ptr);
+        EXPECT_EQ(other_size, size);
+        EXPECT_EQ(SystemAllocations(), 0u);
+        MemoryPool::Release(ptr, size);
+
+        size = 3 << 20;
+        ptr = MemoryPool::Allocate(size);
+        MemoryPool::Release(ptr, size);
+        SystemAllocations();
+        EXPECT_EQ(MemoryPool::Allocate(size), ptr);
+        EXPECT_EQ(SystemAllocations(), 0u);
+        MemoryPool::Release(ptr, size);
+    });
+}
+
+TEST(MemoryPool, LargeBlockIsNotWastedOnASmallerOne) {
+    OnNewThread([] {
+        size_t size = 16 << 20;
+        void *ptr = MemoryPool::Allocate(size);
+        MemoryPool::Release(ptr, size);
+        SystemAllocations();
+
+        // smaller than half of it
+        size_t small_size = 6 << 20;
+        void *small = MemoryPool::Allocate(small_size);
+        EXPECT_NE(small, ptr);
+        EXPECT_EQ(SystemAllocations(), 1u);
+        MemoryPool::Release(small, small_size);
+    });
+}
+
+TEST(MemoryPool, BlockReleasedByAnotherThreadIsKeptByIt) {
+    OnNewThread([] {
+        size_t size = 64 * 1024;
+        void *ptr = MemoryPool::Allocate(size);
+        void *reused = nullptr;
+        std::thread([&] {
+            MemoryPool::Release(ptr, size);
+            size_t other_size = size;
+            reused = MemoryPool::Allocate(other_size);
+            MemoryPool::Release(reused, other_size);
+        }).join();
+        EXPECT_EQ(reused, ptr);
+
+        // and given back to the system when the thread exits
+        SystemAllocations();
+        ptr = MemoryPool::Allocate(size);
+        EXPECT_EQ(SystemAllocations(), 1u);
+        MemoryPool::Release(ptr, size);
+    });
+}
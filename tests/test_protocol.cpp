@@ -0,0 +1,83 @@
+/*
+ * The wire protocol between the frontend and the backend: the headers and
+ * the results. Neither a GPU nor a backend is needed.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/Buffer.h>
+#include <gvirtus/communicators/Communicator.h>
+#include <gvirtus/communicators/Protocol.h>
+#include <gvirtus/communicators/Result.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Loopback.h"
+
+using namespace gvirtus::communicators;
+
+TEST(Protocol, HeadersLayout) {
+    // both sides write and read the headers as they are
+    EXPECT_EQ(sizeof(Hello), 24u);
+    EXPECT_EQ(sizeof(BulkLane), 24u);
+    EXPECT_EQ(sizeof(CompressedBlock), 12u);
+    EXPECT_EQ(sizeof(RequestHeader), 40u);
+    EXPECT_EQ(offsetof(RequestHeader, request_id), 8u);
+    EXPECT_EQ(offsetof(RequestHeader, transfer_size), 32u);
+    EXPECT_EQ(sizeof(ResponseHeader), 32u);
+    EXPECT_EQ(offsetof(ResponseHeader, request_id), 8u);
+    EXPECT_EQ(offsetof(ResponseHeader, payload_size), 24u);
+}
+
+TEST(Protocol, ResultIsFramedByItsHeader) {
+    auto output = std::make_shared<Buffer>();
+    output->Add(7);
+    output->Add(2.5);
+    Result result(3, output);
+    result.TimeTaken(0.25);
+    Loopback c;
+    result.Dump(&c, 42);
+
+    auto header = c.Read<ResponseHeader>();
+    EXPECT_EQ(header.exit_code, 3);
+    EXPECT_EQ(header.flags, 0u);
+    EXPECT_EQ(header.request_id, 42u);
+    EXPECT_EQ(header.time_taken, 0.25);
+    ASSERT_EQ(header.payload_size, output->GetBufferSize());
+    ASSERT_EQ(c.GetUnread(), header.payload_size);
+    EXPECT_EQ(c.Read<int>(), 7);
+    EXPECT_EQ(c.Read<double>(), 2.5);
+}
+
+TEST(Protocol, ResultWithoutOutputIsJustItsHeader) {
+    Result result(5);
+    Loopback c;
+    result.Dump(&c, 1);
+
+    auto header = c.Read<ResponseHeader>();
+    EXPECT_EQ(header.exit_code, 5);
+    EXPECT_EQ(header.payload_size, 0u);
+    EXPECT_EQ(c.GetUnread(), 0u);
+}
+
+TEST(Protocol, OutputOfAWriterGoesOnTheBulkLane) {
+    auto writer = [](Communicator *c) { c->Write("abcdef", 6); };
+    Loopback c, bulk_lane;
+    Result bulk(0, 6, writer);
+    bulk.Dump(&c, 2, nullptr, true);
+    auto header = c.Read<ResponseHeader>();
+    EXPECT_EQ(header.flags, (uint32_t)RESPONSE_BULK_LANE);
+    EXPECT_EQ(header.payload_size, 6u);
+    EXPECT_EQ(c.GetUnread(), 0u);
+    bulk.DumpOutput(&bulk_lane);
+    EXPECT_EQ(std::string(bulk_lane.GetData().begin(), bulk_lane.GetData().end()), "abcdef");
+
+    // without a bulk lane, the output follows the header
+    Result inline_output(0, 6, writer);
+    inline_output.Dump(&c, 3);
+    header = c.Read<ResponseHeader>();
+    EXPECT_EQ(header.flags, 0u);
+    ASSERT_EQ(c.GetUnread(), 6u);
+}
@@ -0,0 +1,81 @@
+/*
+ * The reactor of the backend: a connection waits for its requests without
+ * holding a thread, is served on a worker, and is handed over to a session
+ * and back, as Process does for the routines reading a transfer.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/backend/Reactor.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+using gvirtus::backend::Reactor;
+
+class ReactorTest : public ::testing::Test {
+   protected:
+    void SetUp() override { ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, mFds), 0); }
+
+    void TearDown() override {
+        close(mFds[0]);
+        close(mFds[1]);
+    }
+
+    /* the frontend writes on mFds[1], the backend serves mFds[0] */
+    int mFds[2];
+    Reactor mReactor{2};
+};
+
+/* reads a byte once fd is readable, on the thread it is resumed on */
+static Reactor::Task ReadByte(Reactor &reactor, int fd, std::promise<char> &read,
+                              std::promise<std::thread::id> &thread) {
+    co_await reactor.WaitReadable(fd);
+    thread.set_value(std::this_thread::get_id());
+    char byte = 0;
+    if (::read(fd, &byte, 1) != 1) byte = 0;
+    read.set_value(byte);
+}
+
+static Reactor::Task Fail(int fd) {
+    co_await Reactor::ShutdownOnError(fd);
+    throw std::runtime_error("routine failed");
+}
+
+TEST_F(ReactorTest, ConnectionIsServedOnAWorkerOnceReadable) {
+    std::promise<char> read;
+    std::promise<std::thread::id> thread;
+    auto read_future = read.get_future();
+    mReactor.Start(ReadByte(mReactor, mFds[0], read, thread));
+
+    // waiting holds no worker
+    EXPECT_EQ(read_future.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+    EXPECT_FALSE(Reactor::IsReadable(mFds[0]));
+    ASSERT_EQ(write(mFds[1], "r", 1), 1);
+    ASSERT_EQ(read_future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(read_future.get(), 'r');
+    EXPECT_NE(thread.get_future().get(), std::this_thread::get_id());
+}
+
+TEST_F(ReactorTest, HandedOverConnectionIsServedAgain) {
+    // the coroutine returns once the session has the connection, and a new one serves it next
+    for (char request : {'a', 'b', 'c'}) {
+        std::promise<char> read;
+        std::promise<std::thread::id> thread;
+        auto read_future = read.get_future();
+        mReactor.Start(ReadByte(mReactor, mFds[0], read, thread));
+        ASSERT_EQ(write(mFds[1], &request, 1), 1);
+        ASSERT_EQ(read_future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+        EXPECT_EQ(read_future.get(), request);
+    }
+}
+
+TEST_F(ReactorTest, ErrorShutsTheConnectionDown) {
+    mReactor.Start(Fail(mFds[0]));
+    // the frontend sees the connection closed rather than waiting for an answer
+    char byte;
+    EXPECT_EQ(read(mFds[1], &byte, 1), 0);
+}
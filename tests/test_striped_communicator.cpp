@@ -0,0 +1,100 @@
+/*
+ * The striped connections of the bulk lanes: the stream is dealt in segments
+ * to the stripes, moved on all of them at once, and put back together in
+ * order by the far side.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/Protocol.h>
+#include <gvirtus/communicators/StripedCommunicator.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Loopback.h"
+
+using namespace gvirtus::communicators;
+
+/* a stripe whose connection is broken */
+class Broken : public Loopback {
+   public:
+    size_t Write(const char *buffer, size_t size) override {
+        throw std::runtime_error("Can't write to socket");
+    }
+};
+
+static std::vector<std::shared_ptr<Communicator>> MakeStripes(size_t count) {
+    std::vector<std::shared_ptr<Communicator>> stripes;
+    for (size_t i = 0; i < count; i++) stripes.push_back(std::make_shared<Loopback>());
+    return stripes;
+}
+
+static std::vector<char> MakeData(size_t size) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++) data[i] = (char)(i * 7 + i / 1021);
+    return data;
+}
+
+TEST(StripedCommunicator, SegmentsAreDealtToTheStripesInTurn) {
+    auto stripes = MakeStripes(2);
+    StripedCommunicator striped(stripes);
+    EXPECT_EQ(striped.GetStripes(), 2u);
+    std::vector<char> data = MakeData(3 * GVIRTUS_STRIPE_SEGMENT + 10);
+    EXPECT_EQ(striped.Write(data.data(), data.size()), data.size());
+
+    auto first = std::static_pointer_cast<Loopback>(stripes[0]);
+    auto second = std::static_pointer_cast<Loopback>(stripes[1]);
+    EXPECT_EQ(first->GetData().size(), 2u * GVIRTUS_STRIPE_SEGMENT);
+    EXPECT_EQ(second->GetData().size(), GVIRTUS_STRIPE_SEGMENT + 10u);
+    EXPECT_TRUE(std::equal(second->GetData().begin(), second->GetData().end() - 10,
+                           data.begin() + GVIRTUS_STRIPE_SEGMENT));
+}
+
+TEST(StripedCommunicator, StreamIsPutBackTogether) {
+    auto stripes = MakeStripes(3);
+    StripedCommunicator writer(stripes), reader(stripes);
+    std::vector<char> data = MakeData(10 * GVIRTUS_STRIPE_SEGMENT + 12345);
+
+    // written and read in pieces not matching the segments
+    const size_t writes[] = {100, GVIRTUS_STRIPE_SEGMENT, 3 * GVIRTUS_STRIPE_SEGMENT + 7};
+    size_t written = 0;
+    for (size_t i = 0; written < data.size(); i++) {
+        size_t size = std::min(writes[i % 3], data.size() - written);
+        ASSERT_EQ(writer.Write(data.data() + written, size), size);
+        written += size;
+    }
+    std::vector<char> received(data.size());
+    const size_t reads[] = {5 * GVIRTUS_STRIPE_SEGMENT + 1, 99, GVIRTUS_STRIPE_SEGMENT / 2};
+    size_t read = 0;
+    for (size_t i = 0; read < received.size(); i++) {
+        size_t size = std::min(reads[i % 3], received.size() - read);
+        ASSERT_EQ(reader.Read(received.data() + read, size), size);
+        read += size;
+    }
+    EXPECT_EQ(received, data);
+}
+
+TEST(StripedCommunicator, ClosedStripeEndsTheRead) {
+    auto stripes = MakeStripes(2);
+    StripedCommunicator writer(stripes), reader(stripes);
+    std::vector<char> data = MakeData(GVIRTUS_STRIPE_SEGMENT + 10);
+    writer.Write(data.data(), data.size());
+
+    std::vector<char> received(4 * GVIRTUS_STRIPE_SEGMENT);
+    EXPECT_EQ(reader.Read(received.data(), received.size()), data.size());
+}
+
+TEST(StripedCommunicator, ErrorOfAStripeIsThrown) {
+    std::vector<std::shared_ptr<Communicator>> stripes = {std::make_shared<Loopback>(),
+                                                          std::make_shared<Broken>()};
+    StripedCommunicator striped(stripes);
+    std::vector<char> data = MakeData(2 * GVIRTUS_STRIPE_SEGMENT);
+    EXPECT_THROW(striped.Write(data.data(), data.size()), std::runtime_error);
+    // the next segment goes on the stripe that works
+    EXPECT_EQ(striped.Write(data.data(), GVIRTUS_STRIPE_SEGMENT), GVIRTUS_STRIPE_SEGMENT);
+}
+
+TEST(StripedCommunicator, NeedsAStripe) {
+    EXPECT_THROW(StripedCommunicator({}), std::invalid_argument);
+}
@@ -0,0 +1,89 @@
+/*
+ * The transfers following a request: read by the routine in chunks from the
+ * connection, up to the next request whatever the routine takes of them.
+ */
+
+#include <gtest/gtest.h>
+#include <gvirtus/communicators/Transfer.h>
+
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Loopback.h"
+
+using namespace gvirtus::communicators;
+
+/* a connection carrying a transfer of size bytes, then the next request */
+static std::vector<char> SendTransfer(Loopback &c, size_t size) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++) data[i] = (char)(i * 31 + i / 4093);
+    c.Write(data.data(), data.size());
+    c.Write("next", 4);
+    return data;
+}
+
+static std::string ReadNext(Loopback &c) {
+    char next[4];
+    EXPECT_EQ(c.Read(next, sizeof(next)), sizeof(next));
+    return std::string(next, sizeof(next));
+}
+
+TEST(Transfer, ChunksCoverTheTransfer) {
+    Loopback c;
+    size_t chunk_size = Transfer::GetChunkSize();
+    std::vector<char> data = SendTransfer(c, 2 * chunk_size + chunk_size / 2);
+
+    Transfer transfer(data.size(), &c);
+    EXPECT_EQ(transfer.GetSize(), data.size());
+    std::vector<char> received;
+    std::set<char *> buffers;
+    size_t chunks = 0;
+    for (auto chunk = transfer.Take(); chunk.data != nullptr; chunk = transfer.Take()) {
+        EXPECT_LE(chunk.size, chunk_size);
+        received.insert(received.end(), chunk.data, chunk.data + chunk.size);
+        buffers.insert(chunk.data);
+        transfer.Release(chunk);
+        chunks++;
+    }
+    EXPECT_EQ(chunks, 3u);
+    EXPECT_EQ(received, data);
+    // a chunk released is taken again
+    EXPECT_EQ(buffers.size(), 1u);
+    EXPECT_EQ(ReadNext(c), "next");
+}
+
+TEST(Transfer, CloseSkipsTheChunksNotTaken) {
+    Loopback c;
+    SendTransfer(c, 3 * Transfer::GetChunkSize());
+
+    Transfer transfer(3 * Transfer::GetChunkSize(), &c);
+    auto chunk = transfer.Take();
+    ASSERT_NE(chunk.data, nullptr);
+    transfer.Release(chunk);
+    transfer.Close();
+    EXPECT_EQ(transfer.Take().data, nullptr);
+    EXPECT_EQ(ReadNext(c), "next");
+}
+
+TEST(Transfer, ConnectionClosedDuringATransferThrows) {
+    Loopback c;
+    std::vector<char> data(Transfer::GetChunkSize() / 2);
+    c.Write(data.data(), data.size());
+
+    Transfer transfer(Transfer::GetChunkSize(), &c);
+    EXPECT_THROW(transfer.Take(), std::runtime_error);
+    // nothing else is read
+    EXPECT_EQ(transfer.Take().data, nullptr);
+    transfer.Close();
+}
+
+TEST(Transfer, EmptyTransferHasNoChunks) {
+    Loopback c;
+    c.Write("next", 4);
+    Transfer transfer(0, &c);
+    EXPECT_EQ(transfer.Take().data, nullptr);
+    transfer.Close();
+    EXPECT_EQ(ReadNext(c), "next");
+}
@@ -0,0 +1,24 @@
+/*
+ * Micro-benchmark of the AfUnixCommunicator, see pingpong.h.
+ *
+ * Usage: gvirtus-benchmark-afunix [bulk size] [round trips]
+ */
+
+#include <gvirtus/communicators/Endpoint_AfUnix.h>
+#include <unistd.h>
+
+#include "AfUnixCommunicator.h"
+#include "pingpong.h"
+
+using gvirtus::communicators::AfUnixCommunicator;
+
+int main(int argc, char **argv) {
+    size_t bulk_size = argc > 1 ? std::strtoul(argv[1], NULL, 10) : AFUNIX_DEFAULT_BULK_SIZE;
+    size_t round_trips = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 20000;
+
+    std::string path = "@gvirtus-benchmark-" + std::to_string(getpid());
+    AfUnixCommunicator server(path, 0600, bulk_size);
+    AfUnixCommunicator frontend(path, 0600, bulk_size);
+    PingPong(server, frontend, round_trips);
+    return EXIT_SUCCESS;
+}
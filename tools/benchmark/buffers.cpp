@@ -0,0 +1,92 @@
+/*
+ * Micro-benchmark of the allocations made by the backend to answer a routine:
+ * the output Buffer and the Result built by a handler, for outputs of several
+ * sizes, either written at once (Delegate()) or piecewise (Add() of 4 bytes).
+ * It reports the time, the heap allocations (operator new) and the blocks
+ * requested to the system by the MemoryPool, per call.
+ *
+ * Run it with GVIRTUS_BUFFER_POOL=0 to compare against plain malloc().
+ *
+ * Usage: gvirtus-benchmark-buffers [calls]
+ */
+
+#include <gvirtus/communicators/MemoryPool.h>
+#include <gvirtus/communicators/Result.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+using gvirtus::communicators::Buffer;
+using gvirtus::communicators::MemoryPool;
+using gvirtus::communicators::Result;
+using std::chrono::steady_clock;
+
+static std::atomic<size_t> heap_allocations{0};
+
+void *operator new(size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = malloc(size > 0 ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+static size_t volatile sink;
+
+/* what a handler does: an output buffer holding a pointer and size bytes */
+static std::shared_ptr<Result> Handle(size_t size, bool piecewise) {
+    auto out = std::make_shared<Buffer>();
+    out->AddMarshal((void *)0x1000);
+    if (piecewise) {
+        for (size_t i = 0; i < size / sizeof(int); i++) out->Add((int)i);
+    } else if (size > 0) {
+        char *data = out->Delegate<char>(size);
+        data[0] = data[size - 1] = 1;
+    }
+    return std::make_shared<Result>(0, out);
+}
+
+static void Run(const std::string &name, size_t size, bool piecewise, size_t calls) {
+    // warm up the pool, as a connection serving many calls would
+    for (size_t i = 0; i < 4; i++) sink = Handle(size, piecewise)->GetExitCode();
+
+    size_t heap_before = heap_allocations.load();
+    auto pool_before = MemoryPool::GetStats();
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < calls; i++) sink = Handle(size, piecewise)->GetExitCode();
+    double elapsed = std::chrono::duration<double, std::nano>(steady_clock::now() - start).count();
+    auto pool_after = MemoryPool::GetStats();
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(12) << std::fixed
+              << std::setprecision(0) << elapsed / calls << " ns" << std::setw(10)
+              << std::setprecision(2) << (double)(heap_allocations.load() - heap_before) / calls
+              << std::setw(12)
+              << (double)(pool_after.allocations - pool_before.allocations) / calls
+              << std::setw(12)
+              << (double)(pool_after.system_allocations - pool_before.system_allocations) / calls
+              << std::endl;
+}
+
+int main(int argc, char **argv) {
+    size_t calls = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 100000;
+
+    std::cout << std::left << std::setw(28) << "output" << std::right << std::setw(15)
+              << "time/call" << std::setw(10) << "new/call" << std::setw(12) << "blocks/call"
+              << std::setw(12) << "system/call" << std::endl;
+    Run("empty", 0, false, calls);
+    Run("64 B", 64, false, calls);
+    Run("64 KiB", 64 << 10, false, calls);
+    Run("1 MiB", 1 << 20, false, calls / 10 + 1);
+    Run("16 MiB", 16 << 20, false, calls / 1000 + 1);
+    Run("64 KiB, 4 bytes at a time", 64 << 10, true, calls / 10 + 1);
+    Run("4 MiB, 4 bytes at a time", 4 << 20, true, calls / 1000 + 1);
+
+    return EXIT_SUCCESS;
+}
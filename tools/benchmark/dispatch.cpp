@@ -0,0 +1,131 @@
+/*
+ * Micro-benchmark of the backend routine dispatch: the per-call cost of
+ * finding and invoking the handler of a routine, before (CanExecute() scan of
+ * the plugins plus a lookup by name in the plugin) and after (routine id
+ * indexing the dispatch table, then the handler-local id) the binary protocol.
+ *
+ * Usage: gvirtus-benchmark-dispatch [calls]
+ */
+
+#include <gvirtus/backend/Handler.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using gvirtus::backend::Handler;
+using gvirtus::communicators::Buffer;
+using gvirtus::communicators::Result;
+using std::chrono::steady_clock;
+
+/* A plugin exporting the given number of routines, which do nothing. */
+class FakeHandler : public Handler {
+   public:
+    FakeHandler(const std::string &prefix, size_t routines) {
+        mpResult = std::make_shared<Result>(0);
+        for (size_t i = 0; i < routines; i++)
+            mHandlers.insert(std::make_pair(prefix + "Routine" + std::to_string(i), &Noop));
+        for (auto &it : mHandlers) mHandlersById.push_back(it.second);
+    }
+
+    bool CanExecute(std::string routine) { return mHandlers.find(routine) != mHandlers.end(); }
+
+    std::vector<std::string> GetRoutines() {
+        std::vector<std::string> routines;
+        for (auto &it : mHandlers) routines.push_back(it.first);
+        return routines;
+    }
+
+    std::shared_ptr<Result> Execute(std::string routine, std::shared_ptr<Buffer> input_buffer) {
+        auto it = mHandlers.find(routine);
+        if (it == mHandlers.end()) throw std::runtime_error("No handler for '" + routine + "'");
+        return it->second(this, input_buffer);
+    }
+
+    std::shared_ptr<Result> Execute(size_t routine_id, std::shared_ptr<Buffer> input_buffer) {
+        return mHandlersById.at(routine_id)(this, input_buffer);
+    }
+
+   private:
+    typedef std::shared_ptr<Result> (*RoutineHandler)(FakeHandler *, std::shared_ptr<Buffer>);
+    static std::shared_ptr<Result> Noop(FakeHandler *pThis, std::shared_ptr<Buffer> in) {
+        return pThis->mpResult;
+    }
+
+    std::map<std::string, RoutineHandler> mHandlers;
+    std::vector<RoutineHandler> mHandlersById;
+    std::shared_ptr<Result> mpResult;
+};
+
+int main(int argc, char **argv) {
+    size_t calls = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 10000000;
+
+    // roughly the number of routines of the cudart, cudadr, cublas, cudnn, cufft, curand,
+    // cusolver, cusparse, nvml and nvrtc plugins, loaded in this order
+    std::vector<std::pair<std::string, size_t>> plugins = {
+        {"cuda", 130},    {"cu", 70},       {"cublas", 220},   {"cudnn", 200}, {"cufft", 40},
+        {"curand", 20},   {"cusolver", 60}, {"cusparse", 110}, {"nvml", 60},   {"nvrtc", 15}};
+    std::vector<std::shared_ptr<Handler>> handlers;
+    for (auto &plugin : plugins)
+        handlers.push_back(std::make_shared<FakeHandler>(plugin.first, plugin.second));
+
+    // the dispatch table as built by Process::Start()
+    struct Routine {
+        Handler *handler;
+        size_t id;
+    };
+    std::vector<std::string> routines;
+    std::vector<Routine> dispatch_table;
+    std::set<std::string> known_routines;
+    for (auto &handler : handlers) {
+        auto handler_routines = handler->GetRoutines();
+        for (size_t i = 0; i < handler_routines.size(); i++) {
+            if (!known_routines.insert(handler_routines[i]).second) continue;
+            routines.push_back(handler_routines[i]);
+            dispatch_table.push_back({handler.get(), i});
+        }
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<uint32_t> distribution(0, routines.size() - 1);
+    std::vector<uint32_t> sequence(4096);
+    for (auto &routine_id : sequence) routine_id = distribution(generator);
+
+    auto input_buffer = std::make_shared<Buffer>();
+    size_t failures = 0;
+
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < calls; i++) {
+        const std::string &routine = routines[sequence[i % sequence.size()]];
+        std::shared_ptr<Handler> h = nullptr;
+        for (auto &handler : handlers) {
+            if (handler->CanExecute(routine)) {
+                h = handler;
+                break;
+            }
+        }
+        if (h == nullptr || h->Execute(routine, input_buffer)->GetExitCode() != 0) failures++;
+    }
+    double by_name = std::chrono::duration<double, std::nano>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    for (size_t i = 0; i < calls; i++) {
+        const Routine &routine = dispatch_table[sequence[i % sequence.size()]];
+        if (routine.handler->Execute(routine.id, input_buffer)->GetExitCode() != 0) failures++;
+    }
+    double by_id = std::chrono::duration<double, std::nano>(steady_clock::now() - start).count();
+
+    std::cout << routines.size() << " routines in " << handlers.size() << " plugins, " << calls
+              << " calls" << std::endl
+              << "by name (CanExecute() scan + map lookup): " << by_name / calls << " ns/call"
+              << std::endl
+              << "by id (dispatch table):                   " << by_id / calls << " ns/call"
+              << std::endl;
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,104 @@
+/*
+ * Ping-pong between a backend and a frontend Communicator, shared by the
+ * communicator micro-benchmarks: the round trip latency of a small request (a
+ * RequestHeader and 64 bytes of arguments, answered by a ResponseHeader), and
+ * the throughput of large transfers in both directions, framed like a memcpy
+ * request and its result.
+ */
+
+#pragma once
+
+#include <gvirtus/communicators/Protocol.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using gvirtus::communicators::Communicator;
+using gvirtus::communicators::RequestHeader;
+using gvirtus::communicators::ResponseHeader;
+using std::chrono::steady_clock;
+
+/* the backend: reads a request, whose routine_id is the size of the answer */
+static void Serve(Communicator *c) {
+    std::vector<char> buffer;
+    RequestHeader request;
+    while (c->Read((char *)&request, sizeof(request)) == sizeof(request)) {
+        buffer.resize(std::max<size_t>(request.payload_size, request.routine_id));
+        if (request.payload_size > 0) c->Read(buffer.data(), request.payload_size);
+        ResponseHeader response = {};
+        response.request_id = request.request_id;
+        response.payload_size = request.routine_id;
+        c->Write((char *)&response, sizeof(response));
+        if (response.payload_size > 0) c->Write(buffer.data(), response.payload_size);
+        c->Sync();
+    }
+}
+
+static void Call(Communicator *c, uint64_t request_id, const char *input, size_t input_size,
+                 char *output, uint32_t output_size) {
+    RequestHeader request = {output_size, 0, request_id, 0, input_size};
+    c->Write((char *)&request, sizeof(request));
+    if (input_size > 0) c->Write(input, input_size);
+    c->Sync();
+    ResponseHeader response;
+    if (c->Read((char *)&response, sizeof(response)) != sizeof(response) ||
+        response.request_id != request_id ||
+        (response.payload_size > 0 && c->Read(output, response.payload_size) == 0)) {
+        std::cerr << "Unexpected response" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* the throughput of transfers of 64 KiB, 1 MiB and 64 MiB in both directions */
+static void Throughput(Communicator &frontend, uint64_t &request_id) {
+    for (size_t size : {(size_t)64 << 10, (size_t)1 << 20, (size_t)64 << 20}) {
+        std::unique_ptr<char[]> data(new char[size]);
+        memset(data.get(), 1, size);
+        size_t transfers = std::max<size_t>(4, ((size_t)1 << 30) / size);
+
+        auto start = steady_clock::now();
+        for (size_t i = 0; i < transfers; i++)
+            Call(&frontend, request_id++, data.get(), size, NULL, 0);
+        double upload = std::chrono::duration<double>(steady_clock::now() - start).count();
+
+        start = steady_clock::now();
+        for (size_t i = 0; i < transfers; i++)
+            Call(&frontend, request_id++, NULL, 0, data.get(), size);
+        double download = std::chrono::duration<double>(steady_clock::now() - start).count();
+
+        std::cout << size / 1024 << " KiB transfers:  frontend to backend "
+                  << transfers * size / upload / 1e9 << " GB/s, backend to frontend "
+                  << transfers * size / download / 1e9 << " GB/s" << std::endl;
+    }
+}
+
+/* serves the first connection accepted by server and measures it from frontend */
+static void PingPong(Communicator &server, Communicator &frontend, size_t round_trips) {
+    server.Serve();
+    std::thread backend([&server]() {
+        auto client = const_cast<Communicator *>(server.Accept());
+        if (client == nullptr) return;
+        Serve(client);
+        delete client;
+    });
+
+    frontend.Connect();
+    uint64_t request_id = 0;
+
+    char arguments[64] = {};
+    for (size_t i = 0; i < 1000; i++) Call(&frontend, request_id++, arguments, 64, NULL, 0);
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < round_trips; i++) Call(&frontend, request_id++, arguments, 64, NULL, 0);
+    double elapsed = std::chrono::duration<double, std::micro>(steady_clock::now() - start).count();
+    std::cout << "round trip of a small request:  " << elapsed / round_trips << " us" << std::endl;
+
+    Throughput(frontend, request_id);
+
+    frontend.Close();
+    backend.join();
+}
@@ -0,0 +1,23 @@
+/*
+ * Micro-benchmark of the ShmRingCommunicator, see pingpong.h.
+ *
+ * Usage: gvirtus-benchmark-shm [ring size] [round trips]
+ */
+
+#include <unistd.h>
+
+#include "ShmRingCommunicator.h"
+#include "pingpong.h"
+
+using gvirtus::communicators::ShmRingCommunicator;
+
+int main(int argc, char **argv) {
+    size_t ring_size = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 4 << 20;
+    size_t round_trips = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 20000;
+
+    std::string name = "benchmark-" + std::to_string(getpid());
+    ShmRingCommunicator server(name, ring_size, false);
+    ShmRingCommunicator frontend(name, ring_size, false);
+    PingPong(server, frontend, round_trips);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/*
+ * Micro-benchmark of the bulk lanes striped over several TCP connections, see
+ * StripedCommunicator: the throughput of large transfers with 1, 2, 4, ...
+ * stripes, up to the given number, see pingpong.h.
+ *
+ * Usage: gvirtus-benchmark-striping [max stripes] [port]
+ *        gvirtus-benchmark-striping --serve address port
+ *        gvirtus-benchmark-striping --connect address port [max stripes]
+ *
+ * Without options both ends run in this process over loopback. Over a veth
+ * pair, the backend end runs in another network namespace:
+ *
+ *   ip netns add gvirtus
+ *   ip link add veth0 type veth peer name veth1 netns gvirtus
+ *   ip addr add 10.99.0.1/24 dev veth0 && ip link set veth0 up
+ *   ip -n gvirtus addr add 10.99.0.2/24 dev veth1 && ip -n gvirtus link set veth1 up
+ *   ip netns exec gvirtus gvirtus-benchmark-striping --serve 10.99.0.2 9992 &
+ *   gvirtus-benchmark-striping --connect 10.99.0.2 9992 16
+ */
+
+#include <gvirtus/communicators/StripedCommunicator.h>
+
+#include <cstring>
+
+#include "TcpCommunicator.h"
+#include "pingpong.h"
+
+using gvirtus::communicators::StripedCommunicator;
+using gvirtus::communicators::TcpCommunicator;
+
+/* accepts the stripes of a connection, each one starting with its index and their number */
+static std::shared_ptr<Communicator> AcceptStriped(Communicator &server) {
+    std::vector<std::shared_ptr<Communicator>> stripes(1);
+    for (size_t accepted = 0; accepted < stripes.size(); accepted++) {
+        std::shared_ptr<Communicator> stripe(const_cast<Communicator *>(server.Accept()));
+        uint32_t header[2];
+        if (stripe == nullptr || stripe->Read((char *)header, sizeof(header)) != sizeof(header))
+            return nullptr;
+        if (header[1] < 1 || header[1] > GVIRTUS_MAX_STRIPES || header[0] >= header[1]) {
+            std::cerr << "Unexpected stripe" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        stripes.resize(header[1]);
+        stripes[header[0]] = stripe;
+    }
+    if (stripes.size() == 1) return stripes.front();
+    return std::make_shared<StripedCommunicator>(stripes);
+}
+
+static std::shared_ptr<Communicator> ConnectStriped(const char *address, short port,
+                                                    uint32_t count) {
+    std::vector<std::shared_ptr<Communicator>> stripes;
+    for (uint32_t i = 0; i < count; i++) {
+        auto stripe = std::make_shared<TcpCommunicator>(address, port);
+        stripe->Connect();
+        uint32_t header[2] = {i, count};
+        stripe->Write((char *)header, sizeof(header));
+        stripe->Sync();
+        stripes.push_back(stripe);
+    }
+    if (count == 1) return stripes.front();
+    return std::make_shared<StripedCommunicator>(stripes);
+}
+
+/* serves the frontends, one after the other */
+static void ServeStriped(Communicator &server, size_t sessions) {
+    for (size_t i = 0; i < sessions; i++) {
+        auto client = AcceptStriped(server);
+        if (client != nullptr) Serve(client.get());
+    }
+}
+
+static void Measure(const char *address, short port, uint32_t max_stripes) {
+    for (uint32_t stripes = 1; stripes <= max_stripes; stripes *= 2) {
+        auto frontend = ConnectStriped(address, port, stripes);
+        std::cout << stripes << " stripe(s)" << std::endl;
+        uint64_t request_id = 0;
+        Throughput(*frontend, request_id);
+        frontend->Close();
+    }
+}
+
+/* the runs of Measure() */
+static size_t Runs(uint32_t max_stripes) {
+    size_t runs = 0;
+    for (uint32_t stripes = 1; stripes <= max_stripes; stripes *= 2) runs++;
+    return runs;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 3 && strcmp(argv[1], "--serve") == 0) {
+        TcpCommunicator server(argv[2], atoi(argv[3]));
+        server.Serve();
+        ServeStriped(server, SIZE_MAX);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 3 && strcmp(argv[1], "--connect") == 0) {
+        uint32_t max_stripes = argc > 4 ? atoi(argv[4]) : GVIRTUS_MAX_STRIPES;
+        Measure(argv[2], atoi(argv[3]), std::min<uint32_t>(max_stripes, GVIRTUS_MAX_STRIPES));
+        return EXIT_SUCCESS;
+    }
+
+    uint32_t max_stripes = std::min<uint32_t>(argc > 1 ? atoi(argv[1]) : 8, GVIRTUS_MAX_STRIPES);
+    short port = argc > 2 ? atoi(argv[2]) : 9992;
+    TcpCommunicator server("127.0.0.1", port);
+    server.Serve();
+    std::thread backend(ServeStriped, std::ref(server), Runs(max_stripes));
+    Measure("127.0.0.1", port, max_stripes);
+    backend.join();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,20 @@
+/*
+ * Micro-benchmark of the TcpCommunicator on loopback, see pingpong.h.
+ *
+ * Usage: gvirtus-benchmark-tcp [port] [round trips]
+ */
+
+#include "TcpCommunicator.h"
+#include "pingpong.h"
+
+using gvirtus::communicators::TcpCommunicator;
+
+int main(int argc, char **argv) {
+    short port = argc > 1 ? atoi(argv[1]) : 9991;
+    size_t round_trips = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 20000;
+
+    TcpCommunicator server("127.0.0.1", port);
+    TcpCommunicator frontend("127.0.0.1", port);
+    PingPong(server, frontend, round_trips);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,20 @@
+/*
+ * Micro-benchmark of the UringCommunicator on loopback, see pingpong.h.
+ *
+ * Usage: gvirtus-benchmark-uring [port] [round trips]
+ */
+
+#include "UringCommunicator.h"
+#include "pingpong.h"
+
+using gvirtus::communicators::UringCommunicator;
+
+int main(int argc, char **argv) {
+    short port = argc > 1 ? atoi(argv[1]) : 9992;
+    size_t round_trips = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 20000;
+
+    UringCommunicator server("127.0.0.1", port);
+    UringCommunicator frontend("127.0.0.1", port);
+    PingPong(server, frontend, round_trips);
+    return EXIT_SUCCESS;
+}